@@ -0,0 +1,490 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "aggregate.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GROUP_BENCH_EDITS 200000 // 基准测试中调整库存的次数
+#define GROUP_BENCH_MOVES 20000  // 基准测试中修改品牌或类别、删除和重新添加的次数
+
+//报表行排序：品牌名升序，同一品牌按类别
+static int compareGroupRows(const void* a, const void* b)
+{
+    const GroupRow* x = (const GroupRow*)a;
+    const GroupRow* y = (const GroupRow*)b;
+    if (x->brand != NULL && y->brand != NULL)
+    {
+        int cmp = strcmp(x->brand, y->brand);
+        if (cmp != 0)
+        {
+            return cmp;
+        }
+    }
+    return x->category - y->category;
+}
+
+//由品牌×类别分组表生成报表
+//功能：按品牌×类别分组时直接取表中商品数不为0的项；按品牌或类别分组时先按品牌ID或类别哈希汇总，再排序
+//返回：成功返回1，内存不足返回0
+static int reportFromTable(GoodsManager* manager, const GroupTable* table, GroupBy by, GroupReport* report)
+{
+    GroupTable rollup;
+    initGroupTable(&rollup);
+    const GroupTable* source = table;
+    if (by != GROUP_BY_BRAND_CATEGORY)
+    {
+        if (!reserveGroupTable(&rollup, table->used))
+        {
+            return 0;
+        }
+        for (int i = 0; i < table->size; i++)
+        {
+            const GroupEntry* entry = &table->entries[i];
+            if (entry->key != 0 && entry->count != 0)
+            {
+                unsigned int key = entry->key - 1;
+                groupTableAdd(&rollup, by == GROUP_BY_BRAND ? key >> GROUP_CATEGORY_BITS : key & ((1u << GROUP_CATEGORY_BITS) - 1),
+                              entry->count, entry->stock, entry->value);
+            }
+        }
+        source = &rollup;
+    }
+
+    report->rows = (GroupRow*)malloc((size_t)(source->used > 0 ? source->used : 1) * sizeof(GroupRow));
+    if (report->rows == NULL)
+    {
+        freeGroupTable(&rollup);
+        return 0;
+    }
+    for (int i = 0; i < source->size; i++)
+    {
+        const GroupEntry* entry = &source->entries[i];
+        if (entry->key == 0 || entry->count == 0)
+        {
+            continue;
+        }
+        unsigned int key = entry->key - 1;
+        GroupRow* row = &report->rows[report->count++];
+        switch (by)
+        {
+        case GROUP_BY_BRAND:
+            row->brand = brandName(&manager->brands, (int)key);
+            row->category = -1;
+            break;
+        case GROUP_BY_CATEGORY:
+            row->brand = NULL;
+            row->category = (int)key;
+            break;
+        default:
+            row->brand = brandName(&manager->brands, (int)(key >> GROUP_CATEGORY_BITS));
+            row->category = (int)(key & ((1u << GROUP_CATEGORY_BITS) - 1));
+            break;
+        }
+        row->count = entry->count;
+        row->stock = entry->stock;
+        row->value = entry->value;
+        report->totalCount += entry->count;
+        report->totalStock += entry->stock;
+        report->totalValue += entry->value;
+    }
+    freeGroupTable(&rollup);
+    qsort(report->rows, (size_t)report->count, sizeof(GroupRow), compareGroupRows);
+    return 1;
+}
+
+//生成报表
+//参数：useLive - 开启增量维护时是否直接使用管理器中的分组表；为0时总是扫描建表
+static int collectGroupReport(GoodsManager* manager, GroupBy by, GroupReport* report, int useLive)
+{
+    memset(report, 0, sizeof(*report));
+    report->by = by;
+    if (useLive && manager->groups.live)
+    {
+        return reportFromTable(manager, &manager->groups, by, report);
+    }
+
+    GroupTable table;
+    initGroupTable(&table);
+    if (!buildGroupTable(&table, &manager->store))
+    {
+        return 0;
+    }
+    report->examined = manager->store.slotLimit;
+    int ok = reportFromTable(manager, &table, by, report);
+    freeGroupTable(&table);
+    return ok;
+}
+
+//生成分组统计报表
+//功能：开启增量维护时直接汇总管理器中的分组表，否则扫描一遍热数据
+//返回：成功返回1，内存不足返回0
+int buildGroupReport(GoodsManager* manager, GroupBy by, GroupReport* report)
+{
+    STATS_BEGIN(STAT_GROUP);
+    int ok = collectGroupReport(manager, by, report, 1);
+    STATS_VISIT_N(report->examined);
+    STATS_END();
+    return ok;
+}
+
+//释放报表
+void freeGroupReport(GroupReport* report)
+{
+    free(report->rows);
+    report->rows = NULL;
+    report->count = 0;
+}
+
+//以表格显示报表
+//功能：按分组方式显示品牌列和/或类别列，最后一行为合计，价值占比为各行价值占合计的百分比
+void displayGroupReport(const GroupReport* report)
+{
+    int showBrand = report->by != GROUP_BY_CATEGORY;
+    int showCategory = report->by != GROUP_BY_BRAND;
+    char text[MONEY_TEXT_SIZE];
+
+    if (report->count == 0)
+    {
+        printf("No products to report.\n");
+        return;
+    }
+    if (showBrand)
+    {
+        printf("%-20s  ", "Brand");
+    }
+    if (showCategory)
+    {
+        printf("%-12s  ", "Category");
+    }
+    printf("%10s  %12s  %16s  %7s\n", "Products", "Stock", "Value", "Value%");
+    int width = (showBrand ? 22 : 0) + (showCategory ? 14 : 0) + 53;
+    for (int i = 0; i < width; i++)
+    {
+        putchar('-');
+    }
+    printf("\n");
+
+    for (int i = 0; i < report->count; i++)
+    {
+        const GroupRow* row = &report->rows[i];
+        if (showBrand)
+        {
+            char brand[21];
+            truncateString(brand, row->brand, sizeof(brand));
+            printf("%-20s  ", brand);
+        }
+        if (showCategory)
+        {
+            printf("%-12s  ", categoryToString((GoodsCategory)row->category));
+        }
+        double share = report->totalValue > 0 ? 100.0 * (double)row->value / (double)report->totalValue : 0.0;
+        printf("%10d  %12lld  %16s  %6.2f%%\n", row->count, row->stock, formatMoney(row->value, text, sizeof(text)), share);
+    }
+
+    for (int i = 0; i < width; i++)
+    {
+        putchar('-');
+    }
+    printf("\n");
+    printf("%-*s  ", (showBrand ? 22 : 0) + (showCategory ? 14 : 0) - 2, "Total");
+    printf("%10d  %12lld  %16s  %6.2f%%\n", report->totalCount, report->totalStock,
+           formatMoney(report->totalValue, text, sizeof(text)), report->totalValue > 0 ? 100.0 : 0.0);
+    printf("\n%d groups\n", report->count);
+}
+
+//写出一个CSV字段
+//功能：含逗号、引号或换行的字段用双引号括起，字段内的双引号写成两个
+static void writeCsvField(FILE* file, const char* text)
+{
+    if (strpbrk(text, ",\"\r\n") == NULL)
+    {
+        fputs(text, file);
+        return;
+    }
+    fputc('"', file);
+    for (const char* p = text; *p != '\0'; p++)
+    {
+        if (*p == '"')
+        {
+            fputc('"', file);
+        }
+        fputc(*p, file);
+    }
+    fputc('"', file);
+}
+
+//将报表导出为CSV文件
+//功能：首行为列名，之后每组一行；金额以元为单位，保留两位小数
+//返回：成功返回1，失败返回0
+int exportGroupReportCsv(const GroupReport* report, const char* filename)
+{
+    FILE* file = NULL;
+    errno_t err = fopen_s(&file, filename, "w");
+    if (err != 0 || file == NULL)
+    {
+        return 0;
+    }
+
+    int showBrand = report->by != GROUP_BY_CATEGORY;
+    int showCategory = report->by != GROUP_BY_BRAND;
+    fprintf(file, "%s%sproducts,stock,value\n", showBrand ? "brand," : "", showCategory ? "category," : "");
+    for (int i = 0; i < report->count; i++)
+    {
+        const GroupRow* row = &report->rows[i];
+        char text[MONEY_TEXT_SIZE];
+        if (showBrand)
+        {
+            writeCsvField(file, row->brand);
+            fputc(',', file);
+        }
+        if (showCategory)
+        {
+            fprintf(file, "%s,", categoryToString((GoodsCategory)row->category));
+        }
+        fprintf(file, "%d,%lld,%s\n", row->count, row->stock, formatMoney(row->value, text, sizeof(text)));
+    }
+    int ok = !ferror(file);
+    ok &= fclose(file) == 0;
+    return ok;
+}
+
+//开启或关闭分组统计的增量维护
+//功能：开启时扫描一遍热数据建表，之后由增删改维护；关闭时释放分组表
+//返回：成功返回1，开启时内存不足返回0且保持关闭
+int setLiveGroups(GoodsManager* manager, int enable)
+{
+    if (!enable)
+    {
+        freeGroupTable(&manager->groups);
+        return 1;
+    }
+    if (manager->groups.live)
+    {
+        return 1;
+    }
+    manager->groups.live = 1;
+    if (!buildGroupTable(&manager->groups, &manager->store))
+    {
+        freeGroupTable(&manager->groups);
+        return 0;
+    }
+    return 1;
+}
+
+//解析分组方式
+//返回：分组方式，无效返回-1
+int parseGroupBy(const char* text)
+{
+    if (_stricmp(text, "brand") == 0)
+    {
+        return GROUP_BY_BRAND;
+    }
+    if (_stricmp(text, "category") == 0)
+    {
+        return GROUP_BY_CATEGORY;
+    }
+    if (_stricmp(text, "brand,category") == 0 || _stricmp(text, "category,brand") == 0)
+    {
+        return GROUP_BY_BRAND_CATEGORY;
+    }
+    return -1;
+}
+
+//分组方式转换为字符串
+const char* groupByToString(GroupBy by)
+{
+    switch (by)
+    {
+        case GROUP_BY_BRAND: return "brand";
+        case GROUP_BY_CATEGORY: return "category";
+        default: return "brand,category";
+    }
+}
+
+//当前计时器刻度
+static long long groupNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//两份报表是否相同
+static int sameGroupReport(const GroupReport* a, const GroupReport* b)
+{
+    if (a->count != b->count || a->totalCount != b->totalCount || a->totalStock != b->totalStock || a->totalValue != b->totalValue)
+    {
+        return 0;
+    }
+    for (int i = 0; i < a->count; i++)
+    {
+        const GroupRow* x = &a->rows[i];
+        const GroupRow* y = &b->rows[i];
+        if (x->brand != y->brand || x->category != y->category || x->count != y->count || x->stock != y->stock || x->value != y->value)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//报表与按类别统计、总价值是否一致
+static int matchesCategoryCounts(GoodsManager* manager, const GroupReport* report)
+{
+    int ok = report->totalValue == calculateTotalValue(manager) && report->totalCount == manager->count;
+    for (int i = 0; i < report->count; i++)
+    {
+        ok &= report->rows[i].count == countGoodsByCategory(manager, (GoodsCategory)report->rows[i].category);
+    }
+    return ok;
+}
+
+//测量分组统计的耗时
+//功能：分别取rounds次中最快的一次：扫描建表生成三种报表、开启增量维护、由增量维护的表生成报表；
+//      再对比关闭和开启增量维护时调整库存的耗时，并在随机修改品牌、类别、删除和重新添加之后，
+//      核对增量维护的结果与重新扫描一致，按类别的结果与countGoodsByCategory和calculateTotalValue一致
+//返回：结果一致返回1，否则返回0
+int runGroupBenchmark(const char* filename, int rounds)
+{
+    if (rounds <= 0)
+    {
+        rounds = 3;
+    }
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL || !loadFromFile(manager, filename) || manager->count == 0)
+    {
+        printf("Failed to load %s.\n", filename);
+        freeGoodsManager(manager);
+        return 0;
+    }
+    int count = manager->count;
+    int* slots = (int*)malloc((size_t)count * sizeof(int));
+    if (slots == NULL)
+    {
+        printf("Out of memory.\n");
+        freeGoodsManager(manager);
+        return 0;
+    }
+    prefixSearch(&manager->idPrefix, "", slots, count);
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ms = 1000.0 / (double)frequency.QuadPart;
+    printf("\n=== Group-By Benchmark (%d products, best of %d) ===\n", count, rounds);
+    printf("%-16s %8s %10s %10s\n", "Grouping", "Groups", "Scan ms", "Live ms");
+
+    int identical = 1;
+    long long bestScan[GROUP_BY_COUNT], bestLive[GROUP_BY_COUNT];
+    int groups[GROUP_BY_COUNT];
+    for (int by = 0; by < GROUP_BY_COUNT; by++)
+    {
+        bestScan[by] = -1;
+        for (int r = 0; r < rounds; r++)
+        {
+            GroupReport report;
+            long long start = groupNow();
+            identical &= collectGroupReport(manager, (GroupBy)by, &report, 0);
+            long long ticks = groupNow() - start;
+            bestScan[by] = bestScan[by] < 0 || ticks < bestScan[by] ? ticks : bestScan[by];
+            groups[by] = report.count;
+            if (by == GROUP_BY_CATEGORY)
+            {
+                identical &= matchesCategoryCounts(manager, &report);
+            }
+            freeGroupReport(&report);
+        }
+    }
+    long long start = groupNow();
+    identical &= setLiveGroups(manager, 1);
+    long long enableTicks = groupNow() - start;
+    for (int by = 0; by < GROUP_BY_COUNT; by++)
+    {
+        bestLive[by] = -1;
+        for (int r = 0; r < rounds; r++)
+        {
+            GroupReport report;
+            start = groupNow();
+            identical &= collectGroupReport(manager, (GroupBy)by, &report, 1);
+            long long ticks = groupNow() - start;
+            bestLive[by] = bestLive[by] < 0 || ticks < bestLive[by] ? ticks : bestLive[by];
+            freeGroupReport(&report);
+        }
+        printf("%-16s %8d %10.2f %10.3f\n", groupByToString((GroupBy)by), groups[by], bestScan[by] * ms, bestLive[by] * ms);
+    }
+    printf("Enabling live updates (one scan): %.2f ms\n", enableTicks * ms);
+
+    //调整库存：关闭和开启增量维护各做一遍，库存先加后减，结束时与开始相同
+    unsigned int seed = 12345;
+    long long editTicks[2];
+    for (int live = 0; live < 2; live++)
+    {
+        setLiveGroups(manager, live);
+        start = groupNow();
+        for (int i = 0; i < GROUP_BENCH_EDITS; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const char* id = STORE_COLD(&manager->store, slots[(seed >> 8) % (unsigned int)count])->id;
+            adjustStock(manager, id, (i & 1) ? -1 : 1);
+            adjustStock(manager, id, (i & 1) ? 1 : -1);
+        }
+        editTicks[live] = groupNow() - start;
+    }
+    printf("%d stock adjustments: %.2f ms without live groups, %.2f ms with (%.1f ns extra per edit)\n",
+           GROUP_BENCH_EDITS * 2, editTicks[0] * ms, editTicks[1] * ms,
+           (double)(editTicks[1] - editTicks[0]) * ms * 1e6 / (GROUP_BENCH_EDITS * 2.0));
+
+    //移动商品到其他品牌或类别，删除后重新添加，再核对
+    for (int i = 0; i < GROUP_BENCH_MOVES; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        int slot = slots[(seed >> 8) % (unsigned int)count];
+        if ((STORE_HOT(&manager->store, slot)->flags & GOODS_FLAG_USED) == 0)
+        {
+            continue;  //已删除且未被重新添加到该槽位
+        }
+        Goods goods;
+        slotToGoods(manager, slot, &goods);
+        switch (i % 3)
+        {
+        case 0:
+            goods.category = (GoodsCategory)((goods.category + 1) % 4);
+            goods.stock += 7;
+            updateGoods(manager, goods.id, goods);
+            break;
+        case 1:
+            strcpy_s(goods.brand, sizeof(goods.brand), brandName(&manager->brands, (int)(seed % (unsigned int)manager->brands.count)));
+            goods.price += 1;
+            updateGoods(manager, goods.id, goods);
+            break;
+        default:
+            deleteGoods(manager, goods.id);
+            if (i % 2 == 0)
+            {
+                addGoods(manager, goods);
+            }
+            break;
+        }
+    }
+    for (int by = 0; by < GROUP_BY_COUNT; by++)
+    {
+        GroupReport live, scanned;
+        int ok = collectGroupReport(manager, (GroupBy)by, &live, 1);
+        ok &= collectGroupReport(manager, (GroupBy)by, &scanned, 0);
+        identical &= ok && sameGroupReport(&live, &scanned);
+        if (by == GROUP_BY_CATEGORY)
+        {
+            identical &= matchesCategoryCounts(manager, &live);
+        }
+        freeGroupReport(&live);
+        freeGroupReport(&scanned);
+    }
+
+    free(slots);
+    freeGoodsManager(manager);
+    printf(identical ? "Live and rescanned reports agree after %d edits, and match the category counts and total value.\n"
+                     : "MISMATCH: group reports differ (%d edits)!\n", GROUP_BENCH_MOVES);
+    return identical;
+}
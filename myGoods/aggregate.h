@@ -0,0 +1,54 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include "goods.h"
+
+// 分组统计报表
+// 按品牌、按类别或按品牌×类别统计商品数、总库存和总库存价值。
+// 报表先得到品牌×类别的分组统计表(见groups.h)：开启增量维护时直接使用管理器中随修改更新的表，
+// 否则扫描一遍热数据临时建表；按品牌或按类别的报表再把该表按品牌或类别哈希汇总一次。
+// 报表行按品牌名、类别排列，可以显示为表格或导出为CSV。
+#define GROUP_CSV_FILE "goods_groups.csv" // 默认CSV导出文件路径
+
+// 分组方式
+typedef enum
+{
+    GROUP_BY_BRAND,          // 按品牌
+    GROUP_BY_CATEGORY,       // 按类别
+    GROUP_BY_BRAND_CATEGORY, // 按品牌和类别
+    GROUP_BY_COUNT           // 分组方式总数
+} GroupBy;
+
+// 报表行
+typedef struct
+{
+    const char *brand; // 品牌名(指向品牌字典，调用者持有读锁期间有效)，按类别分组时为NULL
+    int category;      // 类别，按品牌分组时为-1
+    int count;         // 商品数
+    long long stock;   // 总库存
+    Money value;       // 总库存价值(分)
+} GroupRow;
+
+// 分组统计报表
+typedef struct
+{
+    GroupBy by;           // 分组方式
+    GroupRow *rows;       // 报表行
+    int count;            // 行数
+    int totalCount;       // 商品总数
+    long long totalStock; // 库存合计
+    Money totalValue;     // 库存价值合计(分)
+    int examined;         // 扫描的记录数，使用增量维护的表时为0
+} GroupReport;
+
+// 分组统计函数声明(调用者持有读锁，开关增量维护时持有写锁)
+int buildGroupReport(GoodsManager *manager, GroupBy by, GroupReport *report); // 生成报表，内存不足返回0
+void freeGroupReport(GroupReport *report);                                    // 释放报表
+void displayGroupReport(const GroupReport *report);                           // 以表格显示报表
+int exportGroupReportCsv(const GroupReport *report, const char *filename);    // 将报表导出为CSV文件，成功返回1
+int setLiveGroups(GoodsManager *manager, int enable);                         // 开启或关闭分组统计的增量维护，开启失败返回0
+int parseGroupBy(const char *text);                                           // 解析"brand"/"category"/"brand,category"，无效返回-1
+const char *groupByToString(GroupBy by);                                      // 将分组方式转换为字符串
+int runGroupBenchmark(const char *filename, int rounds);                      // 测量建表和增量维护的耗时，并核对两种方式的结果
+
+#endif
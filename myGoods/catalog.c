@@ -0,0 +1,351 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "catalog.h"
+#include <stdlib.h>
+
+#define CATALOG_OPEN_RETRIES 8 // 读者打开新映像失败(已被更新的版本替换)时的重试次数
+
+//生成映像的共享内存名称："目录名称.版本号"
+static void imageName(char* buffer, size_t size, const char* name, long long sequence)
+{
+    sprintf_s(buffer, size, "%s.%lld", name, sequence);
+}
+
+//向上取整到8字节边界
+static unsigned int align8(size_t value)
+{
+    return (unsigned int)((value + 7) & ~(size_t)7);
+}
+
+//创建控制块
+//功能：控制块已存在(上一个所有者退出后仍有读者)时沿用其中的版本号，保证版本号单调递增
+//返回：成功返回1，失败返回0
+int initCatalogPublisher(CatalogPublisher* publisher, const char* name)
+{
+    memset(publisher, 0, sizeof(*publisher));
+    strncpy_s(publisher->name, sizeof(publisher->name), name, _TRUNCATE);
+
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(CatalogControl), name);
+    if (mapping == NULL)
+    {
+        return 0;
+    }
+    int existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    CatalogControl* control = (CatalogControl*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(CatalogControl));
+    if (control == NULL)
+    {
+        CloseHandle(mapping);
+        return 0;
+    }
+    if (!existed || control->magic != CATALOG_MAGIC)
+    {
+        control->sequence = 0;
+    }
+    control->magic = CATALOG_MAGIC;
+    control->format = CATALOG_FORMAT;
+
+    publisher->controlMapping = mapping;
+    publisher->control = control;
+    publisher->sequence = control->sequence;
+    return 1;
+}
+
+//发布新版本映像
+//功能：按商品列表顺序写出记录、编号索引和字符串区(同一品牌只写一次)，写完后才更新控制块中的版本号，
+//      读者不会看到写了一半的映像；从快照读取数据，发布期间不需要持锁
+//返回：成功返回1，失败返回0
+int publishCatalog(CatalogPublisher* publisher, const GoodsSnapshot* snapshot)
+{
+    if (publisher == NULL || publisher->control == NULL || snapshot == NULL)
+    {
+        return 0;
+    }
+
+    //计算映像大小
+    int count = snapshot->count;
+    int indexSize = 16;
+    while (indexSize < count * 2)
+    {
+        indexSize *= 2;
+    }
+    size_t stringsSize = 0;
+    for (int current = snapshot->head; current != GOODS_NIL; current = SNAPSHOT_HOT(snapshot, current)->next)
+    {
+        const GoodsCold* cold = SNAPSHOT_COLD(snapshot, current);
+        stringsSize += strlen(cold->id) + 1 + cold->name.length + 1;
+    }
+    for (int brandId = 0; brandId < snapshot->brandCount; brandId++)
+    {
+        stringsSize += strlen(snapshot->brands[brandId]) + 1;
+    }
+    unsigned int recordsOffset = align8(sizeof(CatalogHeader));
+    unsigned int indexOffset = align8((size_t)recordsOffset + (size_t)count * sizeof(CatalogRecord));
+    unsigned int stringsOffset = align8((size_t)indexOffset + (size_t)indexSize * sizeof(CatalogIndexEntry));
+    size_t imageSize = (size_t)stringsOffset + stringsSize;
+    if (imageSize > 0xFFFFFFFFu)
+    {
+        return 0;
+    }
+
+    //创建新版本的共享内存
+    char name[CATALOG_NAME_SIZE + 24];
+    long long sequence = publisher->sequence + 1;
+    imageName(name, sizeof(name), publisher->name, sequence);
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)imageSize, name);
+    if (mapping == NULL)
+    {
+        return 0;
+    }
+    unsigned char* image = (unsigned char*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, imageSize);
+    if (image == NULL)
+    {
+        CloseHandle(mapping);
+        return 0;
+    }
+    unsigned int* brandOffsets = (unsigned int*)malloc((size_t)(snapshot->brandCount > 0 ? snapshot->brandCount : 1) * sizeof(unsigned int));
+    if (brandOffsets == NULL)
+    {
+        UnmapViewOfFile(image);
+        CloseHandle(mapping);
+        return 0;
+    }
+
+    CatalogHeader* header = (CatalogHeader*)image;
+    CatalogRecord* records = (CatalogRecord*)(image + recordsOffset);
+    CatalogIndexEntry* index = (CatalogIndexEntry*)(image + indexOffset);
+    char* strings = (char*)(image + stringsOffset);
+    unsigned int stringsUsed = 0;
+    memset(header, 0, sizeof(*header));
+
+    //字符串区：先写全部品牌，记录中只保存偏移
+    for (int brandId = 0; brandId < snapshot->brandCount; brandId++)
+    {
+        const char* brand = snapshot->brands[brandId];
+        size_t length = strlen(brand) + 1;
+        memcpy(strings + stringsUsed, brand, length);
+        brandOffsets[brandId] = stringsUsed;
+        stringsUsed += (unsigned int)length;
+    }
+    for (int i = 0; i < indexSize; i++)
+    {
+        index[i].hash = 0;
+        index[i].record = -1;
+    }
+
+    //记录和索引
+    int record = 0;
+    for (int current = snapshot->head; current != GOODS_NIL; current = SNAPSHOT_HOT(snapshot, current)->next)
+    {
+        const GoodsHot* hot = SNAPSHOT_HOT(snapshot, current);
+        const GoodsCold* cold = SNAPSHOT_COLD(snapshot, current);
+        CatalogRecord* out = &records[record];
+        memset(out, 0, sizeof(*out));
+        out->price = hot->price;
+        out->stock = hot->stock;
+        out->reorderPoint = cold->reorderPoint;
+        out->idHash = hot->idHash;
+        out->category = hot->category;
+        out->brandOffset = brandOffsets[hot->brandId];
+
+        size_t length = strlen(cold->id) + 1;
+        memcpy(strings + stringsUsed, cold->id, length);
+        out->idOffset = stringsUsed;
+        stringsUsed += (unsigned int)length;
+        length = (size_t)cold->name.length + 1;
+        memcpy(strings + stringsUsed, snapshotGoodsName(snapshot, current), length);
+        out->nameOffset = stringsUsed;
+        stringsUsed += (unsigned int)length;
+
+        unsigned int pos = hot->idHash & (unsigned int)(indexSize - 1);
+        while (index[pos].record != -1)
+        {
+            pos = (pos + 1) & (unsigned int)(indexSize - 1);
+        }
+        index[pos].hash = hot->idHash;
+        index[pos].record = record;
+
+        if (hot->category < 4)
+        {
+            header->categoryCounts[hot->category]++;
+        }
+        header->totalValue += hot->price * (Money)hot->stock;
+        record++;
+    }
+
+    header->magic = CATALOG_MAGIC;
+    header->format = CATALOG_FORMAT;
+    header->sequence = sequence;
+    header->imageSize = (unsigned int)imageSize;
+    header->recordCount = record;
+    header->indexSize = indexSize;
+    header->reorderCount = snapshot->reorderCount;
+    header->recordsOffset = recordsOffset;
+    header->indexOffset = indexOffset;
+    header->stringsOffset = stringsOffset;
+    free(brandOffsets);
+    UnmapViewOfFile(image);
+
+    //映像写完后原子地切换版本号；上一版保留到下次发布，供正在切换的读者打开
+    InterlockedExchange64((volatile LONGLONG*)&publisher->control->sequence, sequence);
+    if (publisher->previous != NULL)
+    {
+        CloseHandle(publisher->previous);
+    }
+    publisher->previous = publisher->current;
+    publisher->current = mapping;
+    publisher->sequence = sequence;
+    return 1;
+}
+
+//关闭发布者
+//功能：关闭所有句柄；仍在映射旧映像的读者不受影响，直到它们自己释放
+void closeCatalogPublisher(CatalogPublisher* publisher)
+{
+    if (publisher->previous != NULL)
+    {
+        CloseHandle(publisher->previous);
+    }
+    if (publisher->current != NULL)
+    {
+        CloseHandle(publisher->current);
+    }
+    if (publisher->control != NULL)
+    {
+        UnmapViewOfFile(publisher->control);
+        CloseHandle(publisher->controlMapping);
+    }
+    memset(publisher, 0, sizeof(*publisher));
+}
+
+//连接目录并映射当前映像
+//返回：成功返回1，目录不存在或尚未发布返回0
+int openCatalogView(CatalogView* view, const char* name)
+{
+    memset(view, 0, sizeof(*view));
+    strncpy_s(view->name, sizeof(view->name), name, _TRUNCATE);
+
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+    if (mapping == NULL)
+    {
+        return 0;
+    }
+    const CatalogControl* control = (const CatalogControl*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(CatalogControl));
+    if (control == NULL || control->magic != CATALOG_MAGIC || control->format != CATALOG_FORMAT)
+    {
+        if (control != NULL)
+        {
+            UnmapViewOfFile(control);
+        }
+        CloseHandle(mapping);
+        return 0;
+    }
+    view->controlMapping = mapping;
+    view->control = control;
+
+    refreshCatalogView(view);
+    if (view->image == NULL)
+    {
+        closeCatalogView(view);
+        return 0;
+    }
+    return 1;
+}
+
+//有新版本时切换到新映像
+//功能：只读一次控制块中的版本号，版本未变化时立即返回；新映像映射成功后才释放旧映像，
+//      切换期间读者始终持有一个完整的映像
+//返回：切换到新映像返回1，否则返回0
+int refreshCatalogView(CatalogView* view)
+{
+    for (int attempt = 0; attempt < CATALOG_OPEN_RETRIES; attempt++)
+    {
+        long long sequence = view->control->sequence;
+        if (sequence == 0 || (view->image != NULL && view->image->sequence == sequence))
+        {
+            return 0;
+        }
+
+        char name[CATALOG_NAME_SIZE + 24];
+        imageName(name, sizeof(name), view->name, sequence);
+        HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+        if (mapping == NULL)
+        {
+            continue;  //该版本已被更新的版本替换，重新读取版本号
+        }
+        const CatalogHeader* image = (const CatalogHeader*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (image == NULL || image->magic != CATALOG_MAGIC || image->sequence != sequence)
+        {
+            if (image != NULL)
+            {
+                UnmapViewOfFile(image);
+            }
+            CloseHandle(mapping);
+            continue;
+        }
+
+        if (view->image != NULL)
+        {
+            UnmapViewOfFile(view->image);
+            CloseHandle(view->imageMapping);
+        }
+        view->image = image;
+        view->imageMapping = mapping;
+        return 1;
+    }
+    return 0;
+}
+
+//释放映像和控制块
+void closeCatalogView(CatalogView* view)
+{
+    if (view->image != NULL)
+    {
+        UnmapViewOfFile(view->image);
+        CloseHandle(view->imageMapping);
+    }
+    if (view->control != NULL)
+    {
+        UnmapViewOfFile(view->control);
+        CloseHandle(view->controlMapping);
+    }
+    memset(view, 0, sizeof(*view));
+}
+
+//记录数组
+const CatalogRecord* catalogRecords(const CatalogView* view)
+{
+    return (const CatalogRecord*)((const unsigned char*)view->image + view->image->recordsOffset);
+}
+
+//取字符串区中的字符串
+const char* catalogString(const CatalogView* view, unsigned int offset)
+{
+    return (const char*)view->image + view->image->stringsOffset + offset;
+}
+
+//按编号查找
+//功能：直接在共享映像的索引中探测，先比较哈希值再核对编号，不复制任何数据
+//返回：记录指针，未找到返回NULL
+const CatalogRecord* catalogFind(const CatalogView* view, const char* id)
+{
+    if (view->image == NULL || id == NULL)
+    {
+        return NULL;
+    }
+    const CatalogIndexEntry* index = (const CatalogIndexEntry*)((const unsigned char*)view->image + view->image->indexOffset);
+    const CatalogRecord* records = catalogRecords(view);
+    unsigned int mask = (unsigned int)view->image->indexSize - 1;
+    unsigned int hash = hashGoodsId(id);
+    unsigned int pos = hash & mask;
+    while (index[pos].record != -1)
+    {
+        const CatalogRecord* record = &records[index[pos].record];
+        if (index[pos].hash == hash && strcmp(catalogString(view, record->idOffset), id) == 0)
+        {
+            return record;
+        }
+        pos = (pos + 1) & mask;
+    }
+    return NULL;
+}
@@ -0,0 +1,95 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include "snapshot.h"
+
+// 共享内存只读目录
+// 所有者进程把商品记录和ID索引写成一个与地址无关的映像(只含偏移量，不含指针)，放在命名共享内存中；
+// 其他进程只读映射该映像，直接在共享内存中查找和遍历，不复制任何记录，因此读者增加时总内存基本不变。
+// 每次发布都创建新版本的映像，再原子地更新控制块中的版本号；读者发现版本号变化后映射新映像并释放旧映像。
+#define CATALOG_DEFAULT_NAME "Local\\myGoodsCatalog" // 默认共享内存名称
+#define CATALOG_MAGIC 0x474F4443u                    // 映像标识"CDOG"
+#define CATALOG_FORMAT 1                             // 映像格式版本
+#define CATALOG_NAME_SIZE 96                         // 共享内存名称最大长度
+
+// 控制块(单独的小共享内存，名称为目录名称本身)
+typedef struct
+{
+    unsigned int magic;          // 映像标识
+    unsigned int format;         // 映像格式版本
+    volatile long long sequence; // 当前映像的版本号，0表示尚未发布
+} CatalogControl;
+
+// 映像头
+typedef struct
+{
+    unsigned int magic;         // 映像标识
+    unsigned int format;        // 映像格式版本
+    long long sequence;         // 映像版本号
+    unsigned int imageSize;     // 映像总字节数
+    int recordCount;            // 记录数
+    int indexSize;              // 索引槽数(2的幂)
+    int reorderCount;           // 需要补货的商品数
+    Money totalValue;           // 库存总价值(分)
+    int categoryCounts[4];      // 各类别商品数
+    unsigned int recordsOffset; // 记录数组偏移
+    unsigned int indexOffset;   // 索引数组偏移
+    unsigned int stringsOffset; // 字符串区偏移
+} CatalogHeader;
+
+// 映像中的商品记录，按商品列表顺序存放
+typedef struct
+{
+    Money price;               // 单价(分)
+    int stock;                 // 库存
+    int reorderPoint;          // 补货点
+    unsigned int idHash;       // 编号哈希值
+    unsigned int idOffset;     // 编号在字符串区中的偏移
+    unsigned int nameOffset;   // 名称在字符串区中的偏移
+    unsigned int brandOffset;  // 品牌在字符串区中的偏移(同一品牌共用)
+    unsigned char category;    // 类别
+    unsigned char reserved[7]; // 保留，补齐到8字节边界
+} CatalogRecord;
+
+// 映像中的索引项，开放寻址
+typedef struct
+{
+    unsigned int hash; // 编号哈希值
+    int record;        // 记录下标，-1表示空项
+} CatalogIndexEntry;
+
+// 发布者(所有者进程)
+typedef struct
+{
+    char name[CATALOG_NAME_SIZE]; // 目录名称
+    void *controlMapping;         // 控制块共享内存句柄
+    CatalogControl *control;      // 控制块视图
+    void *current;                // 当前映像的共享内存句柄
+    void *previous;               // 上一版映像的句柄，保留到下次发布，供正在切换的读者打开
+    long long sequence;           // 已发布的版本号
+} CatalogPublisher;
+
+// 读者视图
+typedef struct
+{
+    char name[CATALOG_NAME_SIZE];  // 目录名称
+    void *controlMapping;          // 控制块共享内存句柄
+    const CatalogControl *control; // 控制块视图
+    void *imageMapping;            // 当前映像的共享内存句柄
+    const CatalogHeader *image;    // 当前映像视图
+} CatalogView;
+
+// 发布者函数声明
+int initCatalogPublisher(CatalogPublisher *publisher, const char *name);    // 创建控制块，成功返回1
+int publishCatalog(CatalogPublisher *publisher, const GoodsSnapshot *snapshot); // 从快照发布新版本映像，成功返回1
+void closeCatalogPublisher(CatalogPublisher *publisher);                    // 关闭发布者，释放所有共享内存
+
+// 读者函数声明
+int openCatalogView(CatalogView *view, const char *name);                   // 连接目录并映射当前映像，成功返回1
+int refreshCatalogView(CatalogView *view);                                  // 有新版本时切换到新映像，切换返回1
+void closeCatalogView(CatalogView *view);                                   // 释放映像和控制块
+const CatalogRecord *catalogRecords(const CatalogView *view);               // 记录数组
+const CatalogRecord *catalogFind(const CatalogView *view, const char *id);  // 按编号查找，未找到返回NULL
+const char *catalogString(const CatalogView *view, unsigned int offset);    // 取字符串区中的字符串
+
+#endif
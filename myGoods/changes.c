@@ -0,0 +1,137 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "changes.h"
+#include <stdlib.h>
+#include <string.h>
+
+//初始化变更集合
+void initChangeSet(ChangeSet* set)
+{
+    memset(set, 0, sizeof(*set));
+}
+
+//释放变更集合
+void freeChangeSet(ChangeSet* set)
+{
+    free(set->entries);
+    initChangeSet(set);
+}
+
+//清空变更集合
+//功能：释放哈希表，检查点之后按变更数量重新分配，占用内存只与变更量有关
+void clearChangeSet(ChangeSet* set)
+{
+    freeChangeSet(set);
+}
+
+//扩大哈希表
+//功能：容量翻倍并重新放入有净变化的项，无净变化的项在此丢弃
+//返回：成功返回1，失败返回0
+static int growChangeSet(ChangeSet* set)
+{
+    int newSize = set->size == 0 ? 256 : set->size * 2;
+    ChangeEntry* table = (ChangeEntry*)calloc((size_t)newSize, sizeof(ChangeEntry));
+    if (table == NULL)
+    {
+        return 0;
+    }
+    int used = 0;
+    unsigned int mask = (unsigned int)newSize - 1;
+    for (int i = 0; i < set->size; i++)
+    {
+        const ChangeEntry* entry = &set->entries[i];
+        if (entry->hash == 0 || entry->kind == CHANGE_NONE)
+        {
+            continue;
+        }
+        unsigned int pos = entry->hash & mask;
+        while (table[pos].hash != 0)
+        {
+            pos = (pos + 1) & mask;
+        }
+        table[pos] = *entry;
+        used++;
+    }
+    free(set->entries);
+    set->entries = table;
+    set->size = newSize;
+    set->used = used;
+    set->counts[CHANGE_NONE] = 0;
+    return 1;
+}
+
+//合并两次变更
+//功能：根据已有的净变化和新的操作得到新的净变化
+static ChangeKind combineChange(ChangeKind previous, ChangeKind next)
+{
+    switch (previous)
+    {
+    case CHANGE_INSERTED:
+        return next == CHANGE_DELETED ? CHANGE_NONE : CHANGE_INSERTED;
+    case CHANGE_UPDATED:
+        return next == CHANGE_DELETED ? CHANGE_DELETED : CHANGE_UPDATED;
+    case CHANGE_DELETED:
+        return next == CHANGE_INSERTED ? CHANGE_UPDATED : CHANGE_DELETED;
+    default:
+        return next;
+    }
+}
+
+//记录一次变更
+//功能：按编号查找已有项并合并净变化；内存不足时置overflow，之后的增量导出会拒绝执行
+void recordChange(ChangeSet* set, const char* id, ChangeKind kind)
+{
+    if ((set->used + 1) * 2 > set->size && !growChangeSet(set))
+    {
+        set->overflow = 1;
+        return;
+    }
+
+    unsigned int hash = hashGoodsId(id);
+    unsigned int mask = (unsigned int)set->size - 1;
+    unsigned int pos = hash & mask;
+    while (set->entries[pos].hash != 0)
+    {
+        ChangeEntry* entry = &set->entries[pos];
+        if (entry->hash == hash && strcmp(entry->id, id) == 0)
+        {
+            set->counts[entry->kind]--;
+            entry->kind = (unsigned char)combineChange((ChangeKind)entry->kind, kind);
+            set->counts[entry->kind]++;
+            return;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    ChangeEntry* entry = &set->entries[pos];
+    entry->hash = hash;
+    entry->kind = (unsigned char)kind;
+    strcpy_s(entry->id, sizeof(entry->id), id);
+    set->counts[kind]++;
+    set->used++;
+}
+
+//合并另一集合中的净变化
+//功能：把staged(如事务期间暂存的变更)中每件商品的净变化依次记入set；
+//      净变化的合并满足结合律，结果与逐次记录每个操作相同。staged曾漏记时set也标记为漏记
+void mergeChangeSet(ChangeSet* set, const ChangeSet* staged)
+{
+    for (int i = 0; i < staged->size; i++)
+    {
+        const ChangeEntry* entry = &staged->entries[i];
+        if (entry->hash != 0 && entry->kind != CHANGE_NONE)
+        {
+            recordChange(set, entry->id, (ChangeKind)entry->kind);
+        }
+    }
+    if (staged->overflow)
+    {
+        set->overflow = 1;
+    }
+}
+
+//有净变化的商品数
+int changeCount(const ChangeSet* set)
+{
+    return set->counts[CHANGE_INSERTED] + set->counts[CHANGE_UPDATED] + set->counts[CHANGE_DELETED];
+}
@@ -0,0 +1,43 @@
+#ifndef CHANGES_H
+#define CHANGES_H
+
+#include "store.h"
+
+// 变更类型(相对于上一个检查点)
+typedef enum
+{
+    CHANGE_NONE,     // 无净变化(检查点后新增又删除)
+    CHANGE_INSERTED, // 检查点后新增
+    CHANGE_UPDATED,  // 检查点时已存在，之后被修改(或删除后又重新添加)
+    CHANGE_DELETED   // 检查点时已存在，之后被删除
+} ChangeKind;
+
+// 变更项
+typedef struct
+{
+    unsigned int hash;  // 编号哈希值，0表示空项
+    unsigned char kind; // 变更类型
+    char id[20];        // 商品编号
+} ChangeEntry;
+
+// 变更集合结构体
+// 按商品编号记录上一个检查点之后的净变化，同一商品多次修改只占一项；
+// 删除后槽位会被复用，因此按编号而不是槽位号记录
+typedef struct
+{
+    ChangeEntry *entries; // 开放寻址哈希表
+    int size;             // 表大小(2的幂)
+    int used;             // 已使用的项数(含无净变化的项)
+    int counts[4];        // 各变更类型的项数
+    int overflow;         // 曾因内存不足漏记变更，此时只能完整保存
+} ChangeSet;
+
+// 变更集合函数声明
+void initChangeSet(ChangeSet *set);                                 // 初始化变更集合
+void freeChangeSet(ChangeSet *set);                                 // 释放变更集合
+void clearChangeSet(ChangeSet *set);                                // 清空变更集合(设置检查点)
+void recordChange(ChangeSet *set, const char *id, ChangeKind kind); // 记录一次新增、修改或删除
+void mergeChangeSet(ChangeSet *set, const ChangeSet *staged);       // 合并另一集合中的净变化
+int changeCount(const ChangeSet *set);                              // 有净变化的商品数
+
+#endif
@@ -0,0 +1,127 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "crc32c.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <nmmintrin.h>
+#define CRC32C_HAS_SSE42 1 // 可以使用SSE4.2指令(运行时再检查处理器是否支持)
+#endif
+
+#define CRC32C_POLY 0x82F63B78u // 反射后的Castagnoli多项式
+
+static INIT_ONCE g_crcInit = INIT_ONCE_STATIC_INIT; // 查表和处理器检查只做一次
+static unsigned int g_crcTable[8][256];             // 按8字节查表的软件实现所用的表
+static int g_crcHardware = 0;                       // 处理器是否支持SSE4.2
+
+//生成查表并检查处理器
+static BOOL CALLBACK initCrc32c(PINIT_ONCE once, PVOID param, PVOID* context)
+{
+    (void)once;
+    (void)param;
+    (void)context;
+    for (unsigned int i = 0; i < 256; i++)
+    {
+        unsigned int crc = i;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        }
+        g_crcTable[0][i] = crc;
+    }
+    for (unsigned int i = 0; i < 256; i++)
+    {
+        for (int k = 1; k < 8; k++)
+        {
+            unsigned int prev = g_crcTable[k - 1][i];
+            g_crcTable[k][i] = (prev >> 8) ^ g_crcTable[0][prev & 0xFF];
+        }
+    }
+#ifdef CRC32C_HAS_SSE42
+    int info[4];
+    __cpuid(info, 1);
+    g_crcHardware = (info[2] & (1 << 20)) != 0;  //ECX第20位：SSE4.2
+#endif
+    return TRUE;
+}
+
+//软件实现：每次查8张表处理8字节
+static unsigned int crc32cSoftware(unsigned int crc, const unsigned char* p, size_t size)
+{
+    while (size >= 8)
+    {
+        unsigned int low;
+        unsigned int high;
+        memcpy(&low, p, 4);
+        memcpy(&high, p + 4, 4);
+        low ^= crc;
+        crc = g_crcTable[7][low & 0xFF] ^ g_crcTable[6][(low >> 8) & 0xFF]
+            ^ g_crcTable[5][(low >> 16) & 0xFF] ^ g_crcTable[4][low >> 24]
+            ^ g_crcTable[3][high & 0xFF] ^ g_crcTable[2][(high >> 8) & 0xFF]
+            ^ g_crcTable[1][(high >> 16) & 0xFF] ^ g_crcTable[0][high >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0)
+    {
+        crc = (crc >> 8) ^ g_crcTable[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef CRC32C_HAS_SSE42
+//硬件实现：crc32指令
+static unsigned int crc32cSse42(unsigned int crc, const unsigned char* p, size_t size)
+{
+#ifdef _M_X64
+    unsigned long long crc64 = crc;
+    while (size >= 8)
+    {
+        unsigned long long value;
+        memcpy(&value, p, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+        p += 8;
+        size -= 8;
+    }
+    crc = (unsigned int)crc64;
+#endif
+    while (size >= 4)
+    {
+        unsigned int value;
+        memcpy(&value, p, 4);
+        crc = _mm_crc32_u32(crc, value);
+        p += 4;
+        size -= 4;
+    }
+    while (size-- > 0)
+    {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+//计算CRC32C校验和
+//参数：crc - 前一段的校验和(首段为0)，data/size - 本段数据
+//返回：到本段为止的校验和
+unsigned int crc32c(unsigned int crc, const void* data, size_t size)
+{
+    InitOnceExecuteOnce(&g_crcInit, initCrc32c, NULL, NULL);
+    crc = ~crc;
+#ifdef CRC32C_HAS_SSE42
+    if (g_crcHardware)
+    {
+        return ~crc32cSse42(crc, (const unsigned char*)data, size);
+    }
+#endif
+    return ~crc32cSoftware(crc, (const unsigned char*)data, size);
+}
+
+//是否使用硬件指令
+int crc32cHardware()
+{
+    InitOnceExecuteOnce(&g_crcInit, initCrc32c, NULL, NULL);
+    return g_crcHardware;
+}
@@ -0,0 +1,14 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+
+// CRC32C(Castagnoli多项式0x1EDC6F41)校验和
+// 处理器支持SSE4.2时用crc32指令每次处理8字节，否则用按8字节查表的软件实现，两者结果相同。
+// 可以分段计算：crc32c(crc32c(0, a, n), b, m)等于对a、b连续数据一次计算的结果。
+
+// 校验和函数声明
+unsigned int crc32c(unsigned int crc, const void *data, size_t size); // 在crc的基础上继续计算data的校验和，首段传0
+int crc32cHardware();                                                  // 是否使用硬件指令
+
+#endif
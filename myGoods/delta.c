@@ -0,0 +1,348 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "delta.h"
+#include "protocol.h"
+#include "crc32c.h"
+#include <stdlib.h>
+
+#define DELTA_RECORD_MAX 512 // 单条二进制记录的最大字节数
+
+// 解析后的增量记录
+typedef struct
+{
+    char op;          // 'U'新增或修改，'D'删除
+    Goods goods;      // 商品信息(删除记录只使用编号)
+    int reorderPoint; // 补货点
+} DeltaRecord;
+
+//写出一条二进制记录
+//参数：crc - 累计已写出内容的校验和
+//返回：成功返回1，失败返回0
+static int writeBinaryRecord(FILE* file, char op, const Goods* goods, int reorderPoint, unsigned int* crc)
+{
+    unsigned char data[DELTA_RECORD_MAX];
+    ProtoBuffer out;
+    protoBufferInit(&out, data, sizeof(data));
+    protoPutU8(&out, (unsigned char)op);
+    if (op == 'U')
+    {
+        protoPutGoods(&out, goods);
+        protoPutI32(&out, reorderPoint);
+    }
+    else
+    {
+        protoPutString(&out, goods->id);
+    }
+    *crc = crc32c(*crc, data, out.pos);
+    return !out.overflow && fwrite(data, 1, out.pos, file) == out.pos;
+}
+
+//导出检查点之后的变更
+//功能：只访问变更集合中的商品，每个商品按当前状态写出一条新增/修改或删除记录；
+//      调用者需持有读锁，导出成功后由调用者决定是否设置新的检查点
+//返回：写出的记录数，变更记录不完整或写文件失败返回-1
+int exportDelta(GoodsManager* manager, const char* filename, DeltaFormat format)
+{
+    if (manager == NULL || manager->changes.overflow)
+    {
+        return -1;  //变更记录不完整，只能完整保存
+    }
+
+    FILE* file = NULL;
+    errno_t err = fopen_s(&file, filename, format == DELTA_BINARY ? "wb" : "w");
+    if (err != 0 || file == NULL)
+    {
+        return -1;
+    }
+
+    const ChangeSet* changes = &manager->changes;
+    int total = changeCount(changes);
+    int ok = 1;
+    unsigned int crc = 0;
+    if (format == DELTA_BINARY)
+    {
+        unsigned char header[12];
+        ProtoBuffer out;
+        protoBufferInit(&out, header, sizeof(header));
+        protoPutI32(&out, (int)DELTA_MAGIC);
+        protoPutI32(&out, DELTA_FORMAT);
+        protoPutI32(&out, total);
+        crc = crc32c(0, header, sizeof(header));
+        ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    }
+    else
+    {
+        ok = fprintf(file, "%s %d %d\n", DELTA_TEXT_HEADER, DELTA_FORMAT, total) > 0;
+    }
+
+    int written = 0;
+    char price_text[MONEY_TEXT_SIZE];
+    for (int i = 0; ok && i < changes->size; i++)
+    {
+        const ChangeEntry* entry = &changes->entries[i];
+        if (entry->hash == 0 || entry->kind == CHANGE_NONE)
+        {
+            continue;
+        }
+
+        Goods goods;
+        int reorderPoint = 0;
+        char op = 'D';
+        if (entry->kind != CHANGE_DELETED && findGoodsById(manager, entry->id, &goods))
+        {
+            op = 'U';
+            reorderPoint = getReorderPoint(manager, entry->id);
+        }
+        else
+        {
+            strcpy_s(goods.id, sizeof(goods.id), entry->id);
+        }
+
+        if (format == DELTA_BINARY)
+        {
+            ok = writeBinaryRecord(file, op, &goods, reorderPoint, &crc);
+        }
+        else if (op == 'U')
+        {
+            ok = fprintf(file, "U %s %s %s %s %s %d %d\n", goods.id, goods.name,
+                         categoryToString(goods.category), goods.brand,
+                         formatMoney(goods.price, price_text, sizeof(price_text)),
+                         goods.stock, reorderPoint) > 0;
+        }
+        else
+        {
+            ok = fprintf(file, "D %s\n", goods.id) > 0;
+        }
+        written++;
+    }
+
+    if (ok && format == DELTA_BINARY)
+    {
+        unsigned char trailer[4];
+        ProtoBuffer out;
+        protoBufferInit(&out, trailer, sizeof(trailer));
+        protoPutI32(&out, (int)crc);
+        ok = fwrite(trailer, 1, sizeof(trailer), file) == sizeof(trailer);
+    }
+    if (fclose(file) != 0)
+    {
+        ok = 0;
+    }
+    return ok ? written : -1;
+}
+
+//解析文本增量
+//功能：逐行解析，新增/修改记录复用数据文件的行解析和校验
+//返回：记录数，格式错误返回-1
+static int parseTextDelta(char* text, DeltaRecord* records, int capacity)
+{
+    int count = 0;
+    int lineNumber = 0;
+    char* line = text;
+    while (line != NULL && *line != '\0')
+    {
+        char* next = strchr(line, '\n');
+        if (next != NULL)
+        {
+            *next++ = '\0';
+        }
+        lineNumber++;
+
+        if (line[0] == '#' || line[0] == '\0' || line[0] == '\r')
+        {
+            line = next;
+            continue;  //首行和空行
+        }
+        if (count == capacity)
+        {
+            printf("Warning: Line %d - More records than the header announced.\n", lineNumber);
+            return -1;
+        }
+
+        DeltaRecord* record = &records[count];
+        record->op = line[0];
+        record->reorderPoint = 0;
+        if (line[0] == 'U' && line[1] == ' ')
+        {
+            if (!parseGoodsLine(line + 2, lineNumber, &record->goods, &record->reorderPoint))
+            {
+                return -1;
+            }
+        }
+        else if (line[0] != 'D' || line[1] != ' '
+                 || sscanf_s(line + 2, "%19s", record->goods.id, (unsigned)sizeof(record->goods.id)) != 1)
+        {
+            printf("Warning: Line %d - Invalid delta record.\n", lineNumber);
+            return -1;
+        }
+        count++;
+        line = next;
+    }
+    return count;
+}
+
+//解析二进制增量
+//功能：先核对文件末尾的校验和，再逐条解析
+//返回：记录数，校验和不符或格式错误返回-1
+static int parseBinaryDelta(unsigned char* data, size_t size, DeltaRecord* records, int capacity)
+{
+    if (size < 16)
+    {
+        return -1;
+    }
+    size -= 4;
+    ProtoBuffer trailer;
+    protoBufferInit(&trailer, data + size, 4);
+    if ((unsigned int)protoGetI32(&trailer) != crc32c(0, data, size))
+    {
+        printf("Warning: Delta file checksum mismatch.\n");
+        return -1;
+    }
+
+    ProtoBuffer in;
+    protoBufferInit(&in, data, size);
+    protoGetI32(&in);  //魔数已由调用者检查
+    int format = protoGetI32(&in);
+    int count = protoGetI32(&in);
+    if (in.overflow || format != DELTA_FORMAT || count < 0 || count > capacity)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        DeltaRecord* record = &records[i];
+        record->op = (char)protoGetU8(&in);
+        record->reorderPoint = 0;
+        if (record->op == 'U')
+        {
+            protoGetGoods(&in, &record->goods);
+            record->reorderPoint = protoGetI32(&in);
+            if (!in.overflow && (!isValidGoods(record->goods) || record->reorderPoint < 0))
+            {
+                printf("Warning: Record %d - Invalid product '%s'.\n", i + 1, record->goods.id);
+                return -1;
+            }
+        }
+        else if (record->op == 'D')
+        {
+            protoGetString(&in, record->goods.id, sizeof(record->goods.id));
+        }
+        else
+        {
+            return -1;
+        }
+        if (in.overflow)
+        {
+            return -1;
+        }
+    }
+    return in.pos == in.size ? count : -1;
+}
+
+//将增量文件合并到管理器
+//功能：先完整解析并校验全部记录，有任何错误都不修改管理器；再依次应用：
+//      'U'记录存在则更新否则新增，'D'记录删除(商品已不存在时忽略)；调用者需持有写锁
+//返回：应用的记录数，文件无法读取或格式错误返回-1
+int applyDelta(GoodsManager* manager, const char* filename)
+{
+    if (manager == NULL)
+    {
+        return -1;
+    }
+    size_t size = 0;
+    unsigned char* data = readWholeFile(filename, &size);
+    if (data == NULL)
+    {
+        return -1;
+    }
+
+    //记录数不会超过文件中的行数(文本)或文件大小的1/2(二进制每条至少2字节)
+    int binary = size >= 4 && (data[0] | data[1] << 8 | data[2] << 16 | (unsigned int)data[3] << 24) == DELTA_MAGIC;
+    int text = !binary && strncmp((const char*)data, DELTA_TEXT_HEADER, strlen(DELTA_TEXT_HEADER)) == 0;
+    int capacity = (int)(size / 2) + 1;
+    DeltaRecord* records = (binary || text) ? (DeltaRecord*)malloc((size_t)capacity * sizeof(DeltaRecord)) : NULL;
+    int count = -1;
+    if (records != NULL)
+    {
+        count = binary ? parseBinaryDelta(data, size, records, capacity)
+                       : parseTextDelta((char*)data, records, capacity);
+    }
+    free(data);
+    if (count < 0)
+    {
+        free(records);
+        return -1;
+    }
+
+    int applied = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const DeltaRecord* record = &records[i];
+        if (record->op == 'D')
+        {
+            applied += deleteGoods(manager, record->goods.id);
+            continue;
+        }
+        int stored = findGoodsById(manager, record->goods.id, NULL) ? updateGoods(manager, record->goods.id, record->goods)
+                                                                    : addGoods(manager, record->goods);
+        if (stored && setReorderPoint(manager, record->goods.id, record->reorderPoint))
+        {
+            applied++;
+        }
+        else
+        {
+            printf("Warning: Failed to apply product '%s'.\n", record->goods.id);
+        }
+    }
+    free(records);
+    return applied;
+}
+
+//将增量合并到已有的数据文件
+//功能：加载基准数据文件，应用增量后另存为新文件，基准文件保持不变
+//返回：成功返回1，失败返回0
+int mergeDeltaFile(const char* baseFile, const char* deltaFile, const char* outFile)
+{
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL)
+    {
+        return 0;
+    }
+    int merged = 0;
+    if (!loadFromFile(manager, baseFile))
+    {
+        printf("Failed to load %s.\n", baseFile);
+    }
+    else
+    {
+        int applied = applyDelta(manager, deltaFile);
+        if (applied < 0)
+        {
+            printf("Failed to read delta file %s.\n", deltaFile);
+        }
+        else if (saveToFile(manager, outFile))
+        {
+            printf("Applied %d delta records, %d products written to %s.\n", applied, manager->count, outFile);
+            merged = 1;
+        }
+        else
+        {
+            printf("Failed to save %s.\n", outFile);
+        }
+    }
+    freeGoodsManager(manager);
+    return merged;
+}
+
+//显示检查点之后的变更统计
+void displayChangeSummary(GoodsManager* manager)
+{
+    const ChangeSet* changes = &manager->changes;
+    printf("Changes since last checkpoint: %d inserted, %d updated, %d deleted.\n",
+           changes->counts[CHANGE_INSERTED], changes->counts[CHANGE_UPDATED], changes->counts[CHANGE_DELETED]);
+    if (changes->overflow)
+    {
+        printf("Warning: change tracking ran out of memory, a full save is required.\n");
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef DELTA_H
+#define DELTA_H
+
+#include "goods.h"
+
+// 增量文件
+// 只包含上一个检查点之后有净变化的商品，大小与变更量成正比而与商品总数无关。
+// 文本格式：首行"#GOODS-DELTA 1 记录数"，之后每行一条记录：
+//   U 编号 名称 类别 品牌 单价 库存 补货点   新增或修改(整条记录，与goods.txt的列相同)
+//   D 编号                                   删除
+// 二进制格式：uint32魔数"GDLT" + uint32格式版本 + uint32记录数，之后每条记录为
+//   uint8操作('U'/'D') + 字符串编号；'U'记录再跟名称、品牌(字符串) + uint8类别 + int64单价 + int32库存 + int32补货点，
+//   最后是之前全部内容的uint32校验和(CRC32C)
+// 整数均为小端序，字符串编码与查询协议相同(1字节长度加字符内容)
+#define DELTA_TEXT_HEADER "#GOODS-DELTA"   // 文本格式首行标识
+#define DELTA_MAGIC 0x544C4447u            // 二进制格式魔数"GDLT"
+#define DELTA_FORMAT 2                     // 格式版本(2起二进制格式带校验和)
+
+// 增量文件格式
+typedef enum
+{
+    DELTA_TEXT,  // 文本格式
+    DELTA_BINARY // 二进制格式
+} DeltaFormat;
+
+// 增量函数声明
+int exportDelta(GoodsManager *manager, const char *filename, DeltaFormat format); // 导出检查点之后的变更，返回记录数，失败返回-1
+int applyDelta(GoodsManager *manager, const char *filename);    // 将增量文件合并到管理器(自动识别格式)，返回应用的记录数，失败返回-1
+int mergeDeltaFile(const char *baseFile, const char *deltaFile, const char *outFile); // 将增量合并到已有的数据文件并另存，成功返回1
+void displayChangeSummary(GoodsManager *manager);               // 显示检查点之后的变更统计
+
+#endif
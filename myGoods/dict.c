@@ -0,0 +1,301 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "dict.h"
+#include <stdlib.h>
+#include <string.h>
+
+//计算字符串的FNV-1a哈希值
+static unsigned int hashString(const char* str)
+{
+    unsigned int hash = 2166136261u;
+    while (*str)
+    {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//初始化字符串池
+void initStringArena(StringArena* arena)
+{
+    arena->chunks = NULL;
+    arena->chunkCount = 0;
+    arena->chunkCapacity = 0;
+    arena->used = ARENA_CHUNK_SIZE;  //标记为已满，首次存入时分配第一块
+    arena->liveBytes = 0;
+    arena->wastedBytes = 0;
+}
+
+//释放字符串池
+//功能：释放所有块，之前返回的字符串指针全部失效
+void freeStringArena(StringArena* arena)
+{
+    for (int i = 0; i < arena->chunkCount; i++)
+    {
+        free(arena->chunks[i]);
+    }
+    free(arena->chunks);
+    initStringArena(arena);
+}
+
+//存入字符串
+//功能：将字符串复制到池的末尾，当前块剩余空间不足时分配新块
+//参数：arena - 字符串池，str - 要存入的字符串，ref - 输出字符串引用
+//返回：成功返回1，失败返回0
+int arenaAdd(StringArena* arena, const char* str, StrRef* ref)
+{
+    size_t len = strlen(str) + 1;
+    if (len > ARENA_CHUNK_SIZE)
+    {
+        return 0;  //单个字符串不能超过一块
+    }
+
+    //当前块放不下时分配新块
+    if (arena->used + len > ARENA_CHUNK_SIZE)
+    {
+        if (arena->chunkCount >= 65536)
+        {
+            return 0;  //块号已用尽
+        }
+        if (arena->chunkCount == arena->chunkCapacity)
+        {
+            int newCapacity = arena->chunkCapacity == 0 ? 4 : arena->chunkCapacity * 2;
+            char** newChunks = (char**)realloc(arena->chunks, newCapacity * sizeof(char*));
+            if (newChunks == NULL)
+            {
+                return 0;
+            }
+            arena->chunks = newChunks;
+            arena->chunkCapacity = newCapacity;
+        }
+        char* chunk = (char*)malloc(ARENA_CHUNK_SIZE);
+        if (chunk == NULL)
+        {
+            return 0;
+        }
+        arena->chunks[arena->chunkCount++] = chunk;
+        arena->used = 0;
+    }
+
+    //复制字符串并生成引用
+    unsigned int chunkIndex = (unsigned int)(arena->chunkCount - 1);
+    memcpy(arena->chunks[chunkIndex] + arena->used, str, len);
+    *ref = (chunkIndex << 16) | arena->used;
+    arena->used += (unsigned int)len;
+    arena->liveBytes += len;
+    return 1;
+}
+
+//为字符串预留空间
+//功能：当前块放不下长度为len的字符串时提前分配新块，保证随后的arenaAdd不会失败
+//返回：成功返回1，失败返回0
+static int arenaReserve(StringArena* arena, size_t len)
+{
+    if (len > ARENA_CHUNK_SIZE || (arena->used + len > ARENA_CHUNK_SIZE && arena->chunkCount >= 65536))
+    {
+        return 0;
+    }
+    if (arena->used + len <= ARENA_CHUNK_SIZE)
+    {
+        return 1;
+    }
+    if (arena->chunkCount == arena->chunkCapacity)
+    {
+        int newCapacity = arena->chunkCapacity == 0 ? 4 : arena->chunkCapacity * 2;
+        char** newChunks = (char**)realloc(arena->chunks, newCapacity * sizeof(char*));
+        if (newChunks == NULL)
+        {
+            return 0;
+        }
+        arena->chunks = newChunks;
+        arena->chunkCapacity = newCapacity;
+    }
+    char* chunk = (char*)malloc(ARENA_CHUNK_SIZE);
+    if (chunk == NULL)
+    {
+        return 0;
+    }
+    arena->chunks[arena->chunkCount++] = chunk;
+    arena->used = 0;
+    return 1;
+}
+
+//获取字符串
+//功能：根据引用返回池中字符串的地址
+const char* arenaGet(const StringArena* arena, StrRef ref)
+{
+    return arena->chunks[ref >> 16] + (ref & 0xFFFF);
+}
+
+//标记字符串不再被引用
+//功能：池只追加不回收，这里仅记录废弃字节数以便内存报告
+void arenaRelease(StringArena* arena, StrRef ref)
+{
+    size_t len = strlen(arenaGet(arena, ref)) + 1;
+    arena->liveBytes -= len;
+    arena->wastedBytes += len;
+}
+
+//字符串池已分配的总字节数
+size_t arenaAllocatedBytes(const StringArena* arena)
+{
+    return (size_t)arena->chunkCount * ARENA_CHUNK_SIZE + (size_t)arena->chunkCapacity * sizeof(char*);
+}
+
+//初始化品牌字典
+void initBrandDict(BrandDict* dict)
+{
+    initStringArena(&dict->strings);
+    dict->names = NULL;
+    dict->count = 0;
+    dict->capacity = 0;
+    dict->slots = NULL;
+    dict->slotCount = 0;
+}
+
+//释放品牌字典
+void freeBrandDict(BrandDict* dict)
+{
+    freeStringArena(&dict->strings);
+    free(dict->names);
+    free(dict->slots);
+    initBrandDict(dict);
+}
+
+//在哈希表中查找品牌所在的槽
+//返回：命中时返回存放该品牌的槽下标，未命中时返回可插入的空槽下标
+static int findSlot(const BrandDict* dict, const char* brand)
+{
+    unsigned int mask = (unsigned int)dict->slotCount - 1;
+    unsigned int index = hashString(brand) & mask;
+    while (dict->slots[index] != 0)
+    {
+        int brandId = dict->slots[index] - 1;
+        if (strcmp(arenaGet(&dict->strings, dict->names[brandId]), brand) == 0)
+        {
+            return (int)index;
+        }
+        index = (index + 1) & mask;  //线性探测
+    }
+    return (int)index;
+}
+
+//扩大哈希表
+//功能：哈希表容量翻倍并重新插入所有品牌，保持装载因子不超过1/2
+static int growSlots(BrandDict* dict)
+{
+    int newSlotCount = dict->slotCount == 0 ? 64 : dict->slotCount * 2;
+    unsigned short* newSlots = (unsigned short*)calloc(newSlotCount, sizeof(unsigned short));
+    if (newSlots == NULL)
+    {
+        return 0;
+    }
+
+    unsigned int mask = (unsigned int)newSlotCount - 1;
+    for (int brandId = 0; brandId < dict->count; brandId++)
+    {
+        unsigned int index = hashString(arenaGet(&dict->strings, dict->names[brandId])) & mask;
+        while (newSlots[index] != 0)
+        {
+            index = (index + 1) & mask;
+        }
+        newSlots[index] = (unsigned short)(brandId + 1);
+    }
+
+    free(dict->slots);
+    dict->slots = newSlots;
+    dict->slotCount = newSlotCount;
+    return 1;
+}
+
+//登记品牌
+//功能：返回品牌对应的ID，品牌尚未登记时为其分配新ID
+//返回：品牌ID，失败返回-1
+int internBrand(BrandDict* dict, const char* brand)
+{
+    int existing = findBrand(dict, brand);
+    if (existing >= 0)
+    {
+        return existing;
+    }
+    if (!reserveBrand(dict, brand))
+    {
+        return -1;  //品牌ID已用尽或内存不足
+    }
+
+    //存入品牌名并登记到哈希表
+    StrRef ref;
+    if (!arenaAdd(&dict->strings, brand, &ref))
+    {
+        return -1;
+    }
+    int brandId = dict->count++;
+    dict->names[brandId] = ref;
+    dict->slots[findSlot(dict, brand)] = (unsigned short)(brandId + 1);
+    return brandId;
+}
+
+//为品牌预留空间
+//功能：品牌尚未登记时提前扩充哈希表、ID数组和字符串池，但不登记品牌，
+//      保证随后对同一品牌的internBrand不会失败，编辑失败时也不会留下无用的品牌
+//返回：成功返回1，品牌ID已用尽或内存不足返回0
+int reserveBrand(BrandDict* dict, const char* brand)
+{
+    if (findBrand(dict, brand) >= 0)
+    {
+        return 1;
+    }
+    if (dict->count >= MAX_BRANDS)
+    {
+        return 0;  //品牌ID已用尽
+    }
+
+    //保证装载因子不超过1/2
+    if ((dict->count + 1) * 2 > dict->slotCount && !growSlots(dict))
+    {
+        return 0;
+    }
+    if (dict->count == dict->capacity)
+    {
+        int newCapacity = dict->capacity == 0 ? 32 : dict->capacity * 2;
+        StrRef* newNames = (StrRef*)realloc(dict->names, newCapacity * sizeof(StrRef));
+        if (newNames == NULL)
+        {
+            return 0;
+        }
+        dict->names = newNames;
+        dict->capacity = newCapacity;
+    }
+    return arenaReserve(&dict->strings, strlen(brand) + 1);
+}
+
+//查找品牌ID
+//返回：已登记返回品牌ID，否则返回-1
+int findBrand(const BrandDict* dict, const char* brand)
+{
+    if (dict->slotCount == 0)
+    {
+        return -1;
+    }
+    int slot = findSlot(dict, brand);
+    return dict->slots[slot] != 0 ? dict->slots[slot] - 1 : -1;
+}
+
+//按ID获取品牌名
+const char* brandName(const BrandDict* dict, int brandId)
+{
+    if (brandId < 0 || brandId >= dict->count)
+    {
+        return "";
+    }
+    return arenaGet(&dict->strings, dict->names[brandId]);
+}
+
+//品牌字典占用的总字节数
+size_t brandDictBytes(const BrandDict* dict)
+{
+    return arenaAllocatedBytes(&dict->strings)
+         + (size_t)dict->capacity * sizeof(StrRef)
+         + (size_t)dict->slotCount * sizeof(unsigned short);
+}
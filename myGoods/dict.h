@@ -0,0 +1,54 @@
+#ifndef DICT_H
+#define DICT_H
+
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE 65536 // 字符串池每块大小(字节)，块内偏移用16位表示
+#define MAX_BRANDS 65535       // 品牌字典最多容纳的品牌数，品牌ID用16位表示
+
+// 字符串引用
+// 高16位为字符串池中的块号，低16位为块内偏移
+typedef unsigned int StrRef;
+
+// 字符串池结构体
+// 以64KB为单位分块追加存储以'\0'结尾的字符串，已存入的字符串地址不会移动
+typedef struct
+{
+    char **chunks;       // 块指针数组
+    int chunkCount;      // 已分配的块数
+    int chunkCapacity;   // 块指针数组容量
+    unsigned int used;   // 最后一块已使用的字节数
+    size_t liveBytes;    // 仍被引用的字符串字节数(含'\0')
+    size_t wastedBytes;  // 已释放但未回收的字符串字节数
+} StringArena;
+
+// 品牌字典结构体
+// 将品牌名映射为16位整数ID，每个不同的品牌只存储一次
+typedef struct
+{
+    StringArena strings;   // 品牌名存储区
+    StrRef *names;         // 按品牌ID索引的品牌名引用
+    int count;             // 已登记的品牌数
+    int capacity;          // names数组容量
+    unsigned short *slots; // 开放寻址哈希表，存放品牌ID+1，0表示空槽
+    int slotCount;         // 哈希表槽数(2的幂)
+} BrandDict;
+
+// 字符串池函数声明
+void initStringArena(StringArena *arena);                             // 初始化字符串池
+void freeStringArena(StringArena *arena);                             // 释放字符串池
+int arenaAdd(StringArena *arena, const char *str, StrRef *ref);       // 存入字符串
+const char *arenaGet(const StringArena *arena, StrRef ref);           // 获取字符串
+void arenaRelease(StringArena *arena, StrRef ref);                    // 标记字符串不再被引用
+size_t arenaAllocatedBytes(const StringArena *arena);                 // 字符串池已分配的总字节数
+
+// 品牌字典函数声明
+void initBrandDict(BrandDict *dict);                       // 初始化品牌字典
+void freeBrandDict(BrandDict *dict);                       // 释放品牌字典
+int internBrand(BrandDict *dict, const char *brand);       // 登记品牌，返回品牌ID，失败返回-1
+int findBrand(const BrandDict *dict, const char *brand);   // 查找品牌ID，未登记返回-1
+int reserveBrand(BrandDict *dict, const char *brand);      // 为品牌预留空间，不登记品牌
+const char *brandName(const BrandDict *dict, int brandId); // 按ID获取品牌名
+size_t brandDictBytes(const BrandDict *dict);              // 品牌字典占用的总字节数
+
+#endif
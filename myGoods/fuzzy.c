@@ -0,0 +1,249 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "fuzzy.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FUZZY_FIELD_WORDS 32 // 单个字段最多切出的词数(名称和品牌都短于64字符)
+
+// 模糊查找的状态
+// stamp[slot]记录商品已匹配到第几个查询词，只有匹配了前面全部词的商品才继续参与后面的词
+typedef struct
+{
+    unsigned char *stamp;  // 每个槽位已匹配的词数
+    unsigned char *cost;   // 每个槽位在当前词上的最好得分
+    int *total;            // 每个槽位的累计得分
+    int *candidates;       // 匹配了第一个词的槽位
+    int count;             // 候选槽位数
+    int word;              // 当前查询词的序号
+} FuzzySearch;
+
+//切词
+//功能：按非字母数字字符切分文本，ASCII字母转为小写，非ASCII字节(中文等)保留在词中，
+//      丢弃短于FUZZY_WORD_MIN的词，过长的词截断
+//返回：词数
+static int splitWords(const char* text, char (*words)[PREFIX_KEY_MAX], int maxWords)
+{
+    int count = 0;
+    int length = 0;
+    for (const unsigned char* p = (const unsigned char*)text; ; p++)
+    {
+        unsigned char c = *p;
+        int wordChar = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+        if (wordChar)
+        {
+            if (length < PREFIX_KEY_MAX - 1 && count < maxWords)
+            {
+                words[count][length++] = (char)(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+            }
+            continue;
+        }
+        if (length >= FUZZY_WORD_MIN)
+        {
+            words[count++][length] = '\0';
+        }
+        length = 0;
+        if (c == '\0')
+        {
+            return count;
+        }
+    }
+}
+
+//预留登记一件商品的词所需的空间
+int reserveGoodsWords(PrefixIndex* words, const char* name, const char* brand)
+{
+    char split[FUZZY_FIELD_WORDS][PREFIX_KEY_MAX];
+    int count = splitWords(name, split, FUZZY_FIELD_WORDS);
+    int bytes = 0;
+    for (int i = 0; i < count; i++)
+    {
+        bytes += (int)strlen(split[i]);
+    }
+    int brandCount = splitWords(brand, split, FUZZY_FIELD_WORDS);
+    for (int i = 0; i < brandCount; i++)
+    {
+        bytes += (int)strlen(split[i]);
+    }
+    return reservePrefixIndex(words, count + brandCount, bytes);
+}
+
+//登记商品名称和品牌中的词
+void insertGoodsWords(PrefixIndex* words, const char* name, const char* brand, int slot)
+{
+    char split[FUZZY_FIELD_WORDS][PREFIX_KEY_MAX];
+    int count = splitWords(name, split, FUZZY_FIELD_WORDS);
+    for (int i = 0; i < count; i++)
+    {
+        prefixInsert(words, split[i], slot * 2);
+    }
+    count = splitWords(brand, split, FUZZY_FIELD_WORDS);
+    for (int i = 0; i < count; i++)
+    {
+        prefixInsert(words, split[i], slot * 2 + 1);
+    }
+}
+
+//删除商品名称和品牌中的词
+void removeGoodsWords(PrefixIndex* words, const char* name, const char* brand, int slot)
+{
+    char split[FUZZY_FIELD_WORDS][PREFIX_KEY_MAX];
+    int count = splitWords(name, split, FUZZY_FIELD_WORDS);
+    for (int i = 0; i < count; i++)
+    {
+        prefixRemove(words, split[i], slot * 2);
+    }
+    count = splitWords(brand, split, FUZZY_FIELD_WORDS);
+    for (int i = 0; i < count; i++)
+    {
+        prefixRemove(words, split[i], slot * 2 + 1);
+    }
+}
+
+//词索引查找的回调：记录每个候选槽位在当前词上的最好得分
+static void visitFuzzyWord(void* context, int value, int distance, int partial)
+{
+    FuzzySearch* search = (FuzzySearch*)context;
+    int slot = value >> 1;
+    int cost = 2 * distance + partial + (value & 1);
+    int word = search->word;
+    if (search->stamp[slot] == word)
+    {
+        search->stamp[slot] = (unsigned char)(word + 1);
+        search->cost[slot] = (unsigned char)cost;
+        if (word == 0)
+        {
+            search->candidates[search->count++] = slot;
+        }
+    }
+    else if (search->stamp[slot] == word + 1 && cost < search->cost[slot])
+    {
+        search->cost[slot] = (unsigned char)cost;
+    }
+}
+
+//得分比较：得分小的在前，相同时槽位号小的在前
+static int fuzzyHitBefore(const FuzzyHit* a, const FuzzyHit* b)
+{
+    return a->score != b->score ? a->score < b->score : a->slot < b->slot;
+}
+
+//比较函数：供qsort使用
+static int compareFuzzyHits(const void* a, const void* b)
+{
+    return fuzzyHitBefore((const FuzzyHit*)a, (const FuzzyHit*)b) ? -1 : 1;
+}
+
+//将堆顶(最差的结果)下沉到合适位置
+static void siftFuzzyHeap(FuzzyHit* heap, int count)
+{
+    int i = 0;
+    while (1)
+    {
+        int worst = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < count && fuzzyHitBefore(&heap[worst], &heap[left]))
+        {
+            worst = left;
+        }
+        if (right < count && fuzzyHitBefore(&heap[worst], &heap[right]))
+        {
+            worst = right;
+        }
+        if (worst == i)
+        {
+            return;
+        }
+        FuzzyHit swap = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = swap;
+        i = worst;
+    }
+}
+
+//模糊查找
+//功能：对查询中的每个词在词索引上做有界编辑距离查找(长度2~3的词须完全相同，4~7允许1处编辑，
+//      更长允许2处；长度不小于3的词还可以只匹配索引词的前缀)。候选集合由第一个词产生，
+//      之后每个词只保留也匹配该词的商品，最后用大小为limit的堆选出得分最好的商品
+//参数：words - 词索引，slotLimit - 槽位号上限，query - 查询文本，hits - 输出结果，
+//      visited - 输出访问的索引节点数(可为NULL)
+//返回：结果数，查询中没有可用的词或内存不足返回0
+int fuzzySearchWords(const PrefixIndex* words, int slotLimit, const char* query, FuzzyHit* hits, int limit, int* visited)
+{
+    char split[FUZZY_QUERY_WORDS][PREFIX_KEY_MAX];
+    int wordCount = splitWords(query, split, FUZZY_QUERY_WORDS);
+    if (visited != NULL)
+    {
+        *visited = 0;
+    }
+    if (wordCount == 0 || limit <= 0 || slotLimit <= 0)
+    {
+        return 0;
+    }
+
+    FuzzySearch search;
+    search.stamp = (unsigned char*)calloc((size_t)slotLimit, 1);
+    search.cost = (unsigned char*)malloc((size_t)slotLimit);
+    search.total = (int*)malloc((size_t)slotLimit * sizeof(int));
+    search.candidates = (int*)malloc((size_t)slotLimit * sizeof(int));
+    search.count = 0;
+    int found = 0;
+    if (search.stamp != NULL && search.cost != NULL && search.total != NULL && search.candidates != NULL)
+    {
+        for (int w = 0; w < wordCount && (w == 0 || search.count > 0); w++)
+        {
+            int length = (int)strlen(split[w]);
+            int maxDistance = length <= 3 ? 0 : length <= 7 ? 1 : 2;
+            int maxPrefix = length < 3 ? -1 : length < 6 ? 0 : 1;
+            search.word = w;
+            int nodes = prefixFuzzySearch(words, split[w], maxDistance, maxPrefix, visitFuzzyWord, &search);
+            if (visited != NULL)
+            {
+                *visited += nodes;
+            }
+
+            //累计得分，去掉没有匹配当前词的候选
+            int kept = 0;
+            for (int i = 0; i < search.count; i++)
+            {
+                int slot = search.candidates[i];
+                if (search.stamp[slot] == w + 1)
+                {
+                    search.total[slot] = (w == 0 ? 0 : search.total[slot]) + search.cost[slot];
+                    search.candidates[kept++] = slot;
+                }
+            }
+            search.count = kept;
+        }
+
+        //用最大堆保留最好的limit个
+        for (int i = 0; i < search.count; i++)
+        {
+            FuzzyHit hit = { search.candidates[i], search.total[search.candidates[i]] };
+            if (found < limit)
+            {
+                int child = found++;
+                hits[child] = hit;
+                while (child > 0 && fuzzyHitBefore(&hits[(child - 1) / 2], &hits[child]))
+                {
+                    FuzzyHit swap = hits[child];
+                    hits[child] = hits[(child - 1) / 2];
+                    hits[(child - 1) / 2] = swap;
+                    child = (child - 1) / 2;
+                }
+            }
+            else if (fuzzyHitBefore(&hit, &hits[0]))
+            {
+                hits[0] = hit;
+                siftFuzzyHeap(hits, found);
+            }
+        }
+        qsort(hits, (size_t)found, sizeof(FuzzyHit), compareFuzzyHits);
+    }
+    free(search.stamp);
+    free(search.cost);
+    free(search.total);
+    free(search.candidates);
+    return found;
+}
@@ -0,0 +1,28 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include "prefix.h"
+
+// 模糊查找
+// 商品名称和品牌按非字母数字字符切分为词，转为小写后登记到词索引(基数树，见prefix.h)，
+// 值为槽位号*2，品牌中的词再加1。查询同样切词，每个词在词索引上做有界编辑距离查找，
+// 允许的距离随词长增加；商品须匹配查询中的每个词，按得分升序排列，得分相同按槽位号。
+// 每个词的得分为：编辑距离*2，只匹配到词的前缀时加1，只在品牌中匹配时再加1；商品得分为各词得分之和。
+#define FUZZY_WORD_MIN 2      // 参与索引和查询的词的最小长度，单个字符不登记
+#define FUZZY_QUERY_WORDS 8   // 查询中最多使用的词数
+
+// 模糊查找结果
+typedef struct
+{
+    int slot;  // 槽位号
+    int score; // 得分，越小越接近，0为每个词都完全相同
+} FuzzyHit;
+
+// 模糊查找函数声明
+int reserveGoodsWords(PrefixIndex *words, const char *name, const char *brand);            // 预留登记一件商品的词所需的空间，失败返回0
+void insertGoodsWords(PrefixIndex *words, const char *name, const char *brand, int slot);  // 登记商品名称和品牌中的词(须先预留)
+void removeGoodsWords(PrefixIndex *words, const char *name, const char *brand, int slot);  // 删除商品名称和品牌中的词
+int fuzzySearchWords(const PrefixIndex *words, int slotLimit, const char *query,
+                     FuzzyHit *hits, int limit, int *visited); // 按得分列出最多limit个商品，返回数量
+
+#endif
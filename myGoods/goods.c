@@ -1,7 +1,17 @@
 #pragma warning(disable:4819)  // 禁用代码页警告
 #define _CRT_SECURE_NO_WARNINGS
 #include "goods.h"
+#include "stats.h"
+#include "snapshot.h"
+#include "pack.h"
+#include "parallel.h"
+#include "sortkey.h"
+#include "crc32c.h"
+#include "loadindex.h"
 #include <stdlib.h>
+#include <limits.h>
+#include <ctype.h>
+#include <windows.h>
 
 //初始化商品管理系统
 //功能：分配并初始化一个新的商品管理系统结构体
@@ -15,13 +25,24 @@ GoodsManager* initGoodsManager()
         return NULL;  //内存分配失败
     }
     //初始化成员
-    manager->head = NULL;  //链表初始为空
-    manager->count = 0;    //初始商品数量为0
+    initGoodsStore(&manager->store);  //存储初始为空
+    manager->count = 0;               //初始商品数量为0
+    initStringArena(&manager->names);
+    initBrandDict(&manager->brands);
+    initReorderSet(&manager->reorder);
+    initChangeSet(&manager->changes);
+    initPrefixIndex(&manager->idPrefix);
+    initPrefixIndex(&manager->namePrefix);
+    initPrefixIndex(&manager->words);
+    initGroupTable(&manager->groups);
+    manager->moves = NULL;
+    manager->packed = 0;
+    InitializeSRWLock((PSRWLOCK)&manager->lock);
     return manager;
 }
 
 //释放商品管理系统内存
-//功能：释放链表中所有节点和管理器本身的内存
+//功能：释放所有记录页、索引、字符串池和管理器本身的内存
 //参数：manager - 要释放的管理器指针
 void freeGoodsManager(GoodsManager* manager) 
 {
@@ -30,15 +51,15 @@ void freeGoodsManager(GoodsManager* manager)
         return;
     }
     
-    // 遍历释放所有节点
-    GoodsNode* current = manager->head;
-    while (current != NULL) 
-    {
-        GoodsNode* next = current->next;  //保存下一个节点
-        free(current);                    //释放当前节点
-        current = next;
-    }
-    
+    freeGoodsStore(&manager->store);
+    freeStringArena(&manager->names);
+    freeBrandDict(&manager->brands);
+    freeReorderSet(&manager->reorder);
+    freeChangeSet(&manager->changes);
+    freePrefixIndex(&manager->idPrefix);
+    freePrefixIndex(&manager->namePrefix);
+    freePrefixIndex(&manager->words);
+    freeGroupTable(&manager->groups);
     free(manager);  //释放管理器本身
 }
 
@@ -80,199 +101,705 @@ int isValidGoods(Goods goods)
     return 1;
 }
 
-//从文件加载商品数据
-//功能：从指定文件读取商品信息并构建链表
+//解析金额字符串
+//功能：将"12"、"12.3"、"12.34"形式的十进制字符串精确转换为以分为单位的整数，
+//      不经过浮点运算；小数超过两位、含非法字符或超出范围时解析失败
 //返回：成功返回1，失败返回0
-int loadFromFile(GoodsManager* manager, const char* filename) 
+int parseMoney(const char* str, Money* value)
 {
-    if (manager == NULL) {
+    if (str == NULL || value == NULL)
+    {
         return 0;
     }
 
+    const char* p = str;
+    int negative = 0;
+    if (*p == '+' || *p == '-')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    //整数部分，最多15位以保证乘以100后不溢出
+    Money yuan = 0;
+    int intDigits = 0;
+    while (*p >= '0' && *p <= '9')
+    {
+        if (++intDigits > 15)
+        {
+            return 0;
+        }
+        yuan = yuan * 10 + (*p - '0');
+        p++;
+    }
+
+    //小数部分，最多两位
+    Money cents = 0;
+    int fracDigits = 0;
+    if (*p == '.')
+    {
+        p++;
+        while (*p >= '0' && *p <= '9')
+        {
+            if (++fracDigits > 2)
+            {
+                return 0;
+            }
+            cents = cents * 10 + (*p - '0');
+            p++;
+        }
+        if (fracDigits == 1)
+        {
+            cents *= 10;  //"12.3"表示12.30
+        }
+    }
+
+    //必须至少有一位数字且不能有多余字符
+    if ((intDigits == 0 && fracDigits == 0) || *p != '\0')
+    {
+        return 0;
+    }
+
+    Money result = yuan * MONEY_SCALE + cents;
+    *value = negative ? -result : result;
+    return 1;
+}
+
+//格式化金额
+//功能：将以分为单位的金额格式化为"元.角分"形式的字符串
+//返回：buf本身，便于直接用于printf
+char* formatMoney(Money value, char* buf, size_t size)
+{
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value
+                                             : (unsigned long long)value;
+    snprintf(buf, size, "%s%llu.%02llu",
+             value < 0 ? "-" : "",
+             magnitude / MONEY_SCALE,
+             magnitude % MONEY_SCALE);
+    return buf;
+}
+
+//读取整个文件
+//返回：以'\0'结尾的缓冲区，失败返回NULL
+unsigned char* readWholeFile(const char* filename, size_t* size)
+{
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "rb") != 0 || file == NULL)
+    {
+        return NULL;
+    }
+    unsigned char* data = NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        data = (unsigned char*)malloc((size_t)length + 1);
+    }
+    if (data != NULL && fread(data, 1, (size_t)length, file) != (size_t)length)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    if (data != NULL)
+    {
+        data[length] = '\0';
+        *size = (size_t)length;
+    }
+    return data;
+}
+
+//解析一行商品数据
+//功能：按"编号 名称 类别 品牌 单价 库存 [补货点]"解析并逐项校验，第7列补货点可省略
+//参数：line - 一行文本，lineNumber - 行号(用于警告信息，0表示不打印警告)，goods - 输出商品信息，reorderPoint - 输出补货点
+//返回：有效返回1，无效时打印警告并返回0
+int parseGoodsLine(const char* line, int lineNumber, Goods* goods, int* reorderPoint)
+{
+    char id[20], name[50], brand[50], category_str[20], price_str[32];
+    Money price;
+    int stock;
+    int reorder_point = 0;
+
+    if (sscanf_s(line, "%19s %49s %19s %49s %31s %d %d",
+               id, (unsigned)sizeof(id),
+               name, (unsigned)sizeof(name),
+               category_str, (unsigned)sizeof(category_str),
+               brand, (unsigned)sizeof(brand),
+               price_str, (unsigned)sizeof(price_str),
+               &stock, &reorder_point) < 6) 
+    {
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Invalid format, skipping...\n", lineNumber);
+        }
+        return 0;
+    }
+
+    //预检查数据长度 -检查条件为严格限制
+    if (strlen(id) >= 19) 
+    {  //ID最多18个字符
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - ID '%s' exceeds length limit (max 18 chars), skipping...\n", 
+                   lineNumber, id);
+        }
+        return 0;
+    }
+    if (strlen(name) >= 49) 
+    {  //名称最多48个字符
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Name '%s' exceeds length limit (max 48 chars), skipping...\n", 
+                   lineNumber, name);
+        }
+        return 0;
+    }
+    if (strlen(brand) >= 49) 
+    {  //品牌最多48个字符
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Brand '%s' exceeds length limit (max 48 chars), skipping...\n", 
+                   lineNumber, brand);
+        }
+        return 0;
+    }
+
+    //预检查数值有效性
+    if (!parseMoney(price_str, &price))
+    {
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Invalid price '%s' (at most 2 decimal places), skipping...\n",
+                   lineNumber, price_str);
+        }
+        return 0;
+    }
+    if (price <= 0) 
+    {
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Invalid price value (must be > 0), skipping...\n", lineNumber);
+        }
+        return 0;
+    }
+    if (stock < 0) 
+    {
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Invalid stock value (must be >= 0), skipping...\n", lineNumber);
+        }
+        return 0;
+    }
+    if (reorder_point < 0) 
+    {
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Invalid reorder point (must be >= 0), skipping...\n", lineNumber);
+        }
+        return 0;
+    }
+
+    //检查类别是否有效
+    GoodsCategory category = stringToCategory(category_str);
+    if (category == OTHER && strcmp(category_str, "Other") != 0) 
+    {
+        if (lineNumber > 0)
+        {
+            printf("Warning: Line %d - Invalid category '%s', skipping...\n", 
+                   lineNumber, category_str);
+        }
+        return 0;
+    }
+
+    //所有检查通过后才构造商品对象
+    strncpy_s(goods->id, sizeof(goods->id), id, _TRUNCATE);
+    strncpy_s(goods->name, sizeof(goods->name), name, _TRUNCATE);
+    strncpy_s(goods->brand, sizeof(goods->brand), brand, _TRUNCATE);
+    goods->category = category;
+    goods->price = price;
+    goods->stock = stock;
+    *reorderPoint = reorder_point;
+    return 1;
+}
+
+//累计文本数据文件一行的校验和
+//功能：去掉行尾的"\r\n"或"\n"后按以"\n"结尾计算，因此按文本方式还是二进制方式读写文件结果都相同
+//返回：累计后的校验和
+unsigned int crc32cGoodsLine(unsigned int crc, const char* line)
+{
+    size_t length = strlen(line);
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+    {
+        length--;
+    }
+    return crc32c(crc32c(crc, line, length), "\n", 1);
+}
+
+//识别校验和尾行
+//功能：文本保存时在最后写一行GOODS_CHECKSUM_PREFIX加8位十六进制数，是之前全部行的校验和(见crc32cGoodsLine)
+//返回：不是校验和行返回0，是则返回1并输出校验和，以GOODS_CHECKSUM_PREFIX开头但格式错误返回-1
+int parseChecksumLine(const char* line, unsigned int* crc)
+{
+    if (strncmp(line, GOODS_CHECKSUM_PREFIX, GOODS_CHECKSUM_PREFIX_LEN) != 0)
+    {
+        return 0;
+    }
+    const char* digits = line + GOODS_CHECKSUM_PREFIX_LEN;
+    unsigned int value = 0;
+    int count = 0;
+    for (; isxdigit((unsigned char)digits[count]); count++)
+    {
+        value = value << 4 | (unsigned int)(isdigit((unsigned char)digits[count]) ? digits[count] - '0'
+                                                                                   : (digits[count] | 0x20) - 'a' + 10);
+    }
+    const char* rest = digits + count;
+    while (*rest == '\r' || *rest == '\n')
+    {
+        rest++;
+    }
+    if (count != 8 || *rest != '\0')
+    {
+        return -1;
+    }
+    *crc = value;
+    return 1;
+}
+
+//核对文本数据文件的校验和
+//功能：顺序读一遍文件，有校验和尾行时与之前全部行的校验和比较；校验和行必须是最后一行。
+//      没有校验和行(手工编写或旧版本保存的文件)时不做检查；读完后回到文件开头。
+//      同时把全部行的校验和与行数记入stamp，用于判断加载索引是否过期(见loadindex.h)
+//返回：一致或没有校验和返回1，不一致时打印提示并返回0
+static int checkGoodsFileChecksum(FILE* file, const char* filename, LoadStamp* stamp)
+{
+    char line[GOODS_LINE_MAX];
+    unsigned int crc = 0;
+    unsigned int expected = 0;
+    int found = 0;
+    int valid = 1;
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line_number++;
+        if (found)
+        {
+            valid = 0;  //校验和行之后还有内容
+            break;
+        }
+        found = parseChecksumLine(line, &expected);
+        if (found < 0)
+        {
+            valid = 0;
+            break;
+        }
+        if (!found)
+        {
+            crc = crc32cGoodsLine(crc, line);
+        }
+    }
+    rewind(file);
+    stamp->crc = crc;
+    stamp->lineCount = line_number;
+    if (valid && (!found || crc == expected))
+    {
+        return 1;
+    }
+    printf("%s: checksum mismatch at line %d, the file is damaged or was edited without removing its last line.\n",
+           filename, line_number);
+    return 0;
+}
+
+//整理查找索引
+//功能：批量加入商品后重排前缀索引和词索引的值数组，使每个键的槽位连续存放(见compactPrefixIndex)
+static void compactSearchIndexes(GoodsManager* manager)
+{
+    compactPrefixIndex(&manager->idPrefix);
+    compactPrefixIndex(&manager->namePrefix);
+    compactPrefixIndex(&manager->words);
+}
+
+//清空新建的管理器
+//功能：按加载索引加载失败时，丢弃已经存放的商品，回到新建时的状态后改用普通加载；
+//      品牌字典保留(没有商品引用多余的品牌)，分组统计表保留增量维护的开关
+static void resetGoodsManager(GoodsManager* manager)
+{
+    int live = manager->groups.live;
+    freeGoodsStore(&manager->store);
+    freeStringArena(&manager->names);
+    freeReorderSet(&manager->reorder);
+    freePrefixIndex(&manager->idPrefix);
+    freePrefixIndex(&manager->namePrefix);
+    freePrefixIndex(&manager->words);
+    freeGroupTable(&manager->groups);
+    manager->groups.live = live;
+    manager->count = 0;
+}
+
+//按加载索引存放一件商品
+//功能：与addGoods相同地分配槽位、填充记录并插入链表头部，但不查重，也不登记编号索引和前缀索引，
+//      这些索引最后整体装入；补货点直接写入冷数据并更新补货集合。只用于新建的管理器，没有快照共享页
+//返回：成功返回1，内存不足返回0
+static int placeIndexedGoods(GoodsManager* manager, const Goods* goods, int reorderPoint)
+{
+    GoodsStore* store = &manager->store;
+    if (!reserveLiveGroup(&manager->groups) || !reserveBrand(&manager->brands, goods->brand))
+    {
+        return 0;
+    }
+    int slot = allocGoodsSlot(store);
+    if (slot == GOODS_NIL)
+    {
+        return 0;
+    }
+    GoodsCold* cold = STORE_COLD_W(store, slot);
+    strcpy_s(cold->id, sizeof(cold->id), goods->id);
+    if (!setGoodsName(&cold->name, &manager->names, goods->name))
+    {
+        freeGoodsSlot(store, slot);
+        return 0;
+    }
+    GoodsHot* hot = STORE_HOT_W(store, slot);
+    hot->idHash = hashGoodsId(goods->id);
+    hot->category = (unsigned char)goods->category;
+    hot->price = goods->price;
+    hot->stock = goods->stock;
+    hot->brandId = (unsigned short)internBrand(&manager->brands, goods->brand);  //空间已预留，不会失败
+    cold->reorderPoint = reorderPoint;
+    linkGoodsSlotAfter(store, slot, GOODS_NIL);
+    applyLiveGroup(&manager->groups, hot, 1);
+    manager->count++;
+    //低于补货点时reorderRefresh返回1，返回0说明集合扩容失败
+    return goods->stock >= reorderPoint || reorderRefresh(&manager->reorder, store, slot);
+}
+
+//按加载索引加载
+//功能：逐行解析，按保存的处理结果存放加入的行、对重复的行打印警告，不查重也不逐条登记索引；
+//      解析结果必须与处理结果一致(无效的行照常打印警告)，最后核对并装入保存的索引
+//参数：parsed - 累计读取的字节数(用于操作统计)
+//返回：成功返回1，任何不一致或内存不足返回0，此时管理器中可能已有部分商品，需用resetGoodsManager清空
+static int loadIndexedGoods(GoodsManager* manager, FILE* file, LoadIndex* saved, long long* parsed,
+                            int* successCount, int* duplicateCount, int* invalidCount)
+{
+    char line[GOODS_LINE_MAX];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line_number++;
+        *parsed += (long long)strlen(line);
+        if (line_number > saved->lineCount)
+        {
+            return 0;  //两遍读取之间文件被改动
+        }
+        unsigned int crc;
+        if (parseChecksumLine(line, &crc) > 0)
+        {
+            continue;
+        }
+        Goods goods;
+        int reorder_point = 0;
+        int state = saved->lines[line_number - 1];
+        if (state == LOAD_LINE_SKIPPED)
+        {
+            if (parseGoodsLine(line, line_number, &goods, &reorder_point))
+            {
+                return 0;
+            }
+            (*invalidCount)++;
+        }
+        else if (!parseGoodsLine(line, 0, &goods, &reorder_point))
+        {
+            return 0;
+        }
+        else if (state == LOAD_LINE_DUPLICATE)
+        {
+            printf("Warning: Line %d - Duplicate product ID '%s', skipping...\n",
+                   line_number, goods.id);
+            (*duplicateCount)++;
+        }
+        else if (placeIndexedGoods(manager, &goods, reorder_point))
+        {
+            (*successCount)++;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return line_number == saved->lineCount && installLoadIndex(manager, saved);
+}
+
+//从文件加载商品数据
+//功能：从指定文件读取商品信息并构建链表，自动识别压缩格式(见pack.h)；加载完成后作为新的检查点，清空变更记录。
+//      新建的管理器加载文本文件时优先使用与文件相符的加载索引，没有时按普通方式加载后写出加载索引(见loadindex.h)
+//返回：成功返回1，失败返回0
+static int loadGoodsFile(GoodsManager* manager, const char* filename)
+{
+    STATS_BEGIN(STAT_LOAD);
+    if (isPackedFile(filename))
+    {
+        int loaded = loadPackedFile(manager, filename);
+        compactSearchIndexes(manager);
+        clearChangeSet(&manager->changes);
+        manager->packed = 1;
+        STATS_END();
+        return loaded;
+    }
+
+    //先取文件标记再读内容，读取期间文件被改动时标记偏旧，下次加载时索引按过期处理
+    LoadStamp stamp;
+    int fresh = manager->count == 0 && manager->store.slotLimit == 0 && stampDataFile(filename, &stamp);
     FILE* file = NULL;
     errno_t err = fopen_s(&file, filename, "r");
     if (err != 0 || file == NULL) 
     {
+        STATS_END();
         return 0;  //文件打开失败
     }
+    if (!checkGoodsFileChecksum(file, filename, &stamp))
+    {
+        fclose(file);
+        STATS_END();
+        return 0;  //校验和不符时不加入任何商品
+    }
 
-    char line[256];
-    char id[20], name[50], brand[50], category_str[20];
-    float price;
-    int stock;
+    char line[GOODS_LINE_MAX];
+    int reorder_point;
     int success_count = 0;
     int invalid_count = 0;
     int duplicate_count = 0;
 
+    LoadIndex saved;
+    if (fresh && readLoadIndex(filename, &stamp, &saved))
+    {
+        long long parsed = 0;
+        int indexed = loadIndexedGoods(manager, file, &saved, &parsed, &success_count, &duplicate_count, &invalid_count);
+        freeLoadIndex(&saved);
+        STATS_PARSED(parsed);
+        if (indexed)
+        {
+            fclose(file);
+            clearChangeSet(&manager->changes);
+            manager->packed = 0;
+            displayImportSummary(success_count, duplicate_count, invalid_count);
+            STATS_END();
+            return success_count > 0;
+        }
+        resetGoodsManager(manager);
+        rewind(file);
+        success_count = invalid_count = duplicate_count = 0;
+    }
+
+    //记录每行的处理结果，全部加入成功时写出加载索引
+    unsigned char* states = fresh ? (unsigned char*)calloc((size_t)stamp.lineCount + 1, 1) : NULL;
+    int complete = states != NULL;
+
     //逐行读取文件内容
     int line_number = 0;  //行号计数
     while (fgets(line, sizeof(line), file)) 
     {
         line_number++;
-        //解析每行数据
-        if (sscanf_s(line, "%19s %49s %19s %49s %f %d",
-                   id, (unsigned)sizeof(id),
-                   name, (unsigned)sizeof(name),
-                   category_str, (unsigned)sizeof(category_str),
-                   brand, (unsigned)sizeof(brand),
-                   &price, &stock) == 6) {
-            
-            //预检查数据长度 -检查条件为严格限制
-            if (strlen(id) >= 19) 
-            {  //ID最多18个字符
-                printf("Warning: Line %d - ID '%s' exceeds length limit (max 18 chars), skipping...\n", 
-                       line_number, id);
-                invalid_count++;
-                continue;
-            }
-            if (strlen(name) >= 49) 
-            {  //名称最多48个字符
-                printf("Warning: Line %d - Name '%s' exceeds length limit (max 48 chars), skipping...\n", 
-                       line_number, name);
-                invalid_count++;
-                continue;
-            }
-            if (strlen(brand) >= 49) 
-            {  //品牌最多48个字符
-                printf("Warning: Line %d - Brand '%s' exceeds length limit (max 48 chars), skipping...\n", 
-                       line_number, brand);
-                invalid_count++;
-                continue;
-            }
-
-            //预检查数值有效性
-            if (price <= 0) 
-            {
-                printf("Warning: Line %d - Invalid price value (must be > 0), skipping...\n", line_number);
-                invalid_count++;
-                continue;
-            }
-            if (stock < 0) 
-            {
-                printf("Warning: Line %d - Invalid stock value (must be >= 0), skipping...\n", line_number);
-                invalid_count++;
-                continue;
-            }
+        STATS_PARSED(strlen(line));
+        if (line_number > stamp.lineCount)
+        {
+            complete = 0;  //两遍读取之间文件被改动
+        }
+        unsigned int crc;
+        if (parseChecksumLine(line, &crc) > 0)
+        {
+            continue;  //已核对过的校验和尾行
+        }
+        Goods goods;
+        if (!parseGoodsLine(line, line_number, &goods, &reorder_point))
+        {
+            invalid_count++;
+            continue;
+        }
 
-            //检查类别是否有效
-            GoodsCategory category = stringToCategory(category_str);
-            if (category == OTHER && strcmp(category_str, "Other") != 0) 
+        //添加商品
+        if (findGoodsById(manager, goods.id, NULL)) 
+        {
+            printf("Warning: Line %d - Duplicate product ID '%s', skipping...\n", 
+                   line_number, goods.id);
+            duplicate_count++;
+            if (complete)
             {
-                printf("Warning: Line %d - Invalid category '%s', skipping...\n", 
-                       line_number, category_str);
-                invalid_count++;
-                continue;
+                states[line_number - 1] = LOAD_LINE_DUPLICATE;
             }
-
-            //所有检查通过后才构造商品对象
-            Goods goods;
-            strncpy_s(goods.id, sizeof(goods.id), id, _TRUNCATE);
-            strncpy_s(goods.name, sizeof(goods.name), name, _TRUNCATE);
-            strncpy_s(goods.brand, sizeof(goods.brand), brand, _TRUNCATE);
-            goods.category = category;
-            goods.price = price;
-            goods.stock = stock;
-
-            //添加商品
-            if (findGoodsById(manager, goods.id) != NULL) 
+            continue;
+        }
+        if (addGoods(manager, goods)) 
+        {
+            if (reorder_point > 0)
             {
-                printf("Warning: Line %d - Duplicate product ID '%s', skipping...\n", 
-                       line_number, goods.id);
-                duplicate_count++;
-                continue;
+                setReorderPoint(manager, goods.id, reorder_point);
             }
-            if (addGoods(manager, goods)) 
+            success_count++;
+            if (complete)
             {
-                success_count++;
+                states[line_number - 1] = LOAD_LINE_ADDED;
             }
-        } 
+        }
         else
         {
-            printf("Warning: Line %d - Invalid format, skipping...\n", line_number);
-            invalid_count++;
+            complete = 0;
         }
     }
 
     fclose(file);
+    compactSearchIndexes(manager);
+    clearChangeSet(&manager->changes);
+    manager->packed = 0;
+    if (complete && line_number == stamp.lineCount)
+    {
+        saveLoadIndex(filename, &stamp, manager, states);  //失败时下次加载再写
+    }
+    free(states);
+    displayImportSummary(success_count, duplicate_count, invalid_count);
     
-    //显示导入结果
+    STATS_END();
+    return success_count > 0;
+}
+
+//从文件加载商品数据
+//功能：见loadGoodsFile；加载的是已有的库存，加载期间不记录库存变动
+//返回：成功返回1，失败返回0
+int loadFromFile(GoodsManager* manager, const char* filename) 
+{
+    if (manager == NULL) {
+        return 0;
+    }
+
+    MoveLog* moves = manager->moves;
+    manager->moves = NULL;
+    int loaded = loadGoodsFile(manager, filename);
+    manager->moves = moves;
+    return loaded;
+}
+
+//显示导入结果
+void displayImportSummary(int successCount, int duplicateCount, int invalidCount)
+{
     printf("\nImport summary:\n");
-    printf("Successfully imported: %d products\n", success_count);
-    if (duplicate_count > 0) 
+    printf("Successfully imported: %d products\n", successCount);
+    if (duplicateCount > 0) 
     {
-        printf("Skipped %d duplicate products\n", duplicate_count);
+        printf("Skipped %d duplicate products\n", duplicateCount);
     }
-    if (invalid_count > 0) 
+    if (invalidCount > 0) 
     {
-        printf("Skipped %d invalid records\n", invalid_count);
+        printf("Skipped %d invalid records\n", invalidCount);
     }
-    
-    return success_count > 0;
 }
 
 //保存商品数据到文件
-//功能：将当前链表中的所有商品信息写入文件
+//功能：创建快照后按链表顺序写出，调用者只需在创建快照期间持有读锁，写文件期间不阻塞写入者
 int saveToFile(GoodsManager* manager, const char* filename) 
 {
-    if (manager == NULL) 
+    GoodsSnapshot* snapshot = createGoodsSnapshot(manager);
+    if (snapshot == NULL) 
     {
         return 0;
     }
+    int saved = saveSnapshotToFile(snapshot, filename);
+    releaseGoodsSnapshot(snapshot);
+    return saved;
+}
 
-    FILE* file = NULL;
-    errno_t err = fopen_s(&file, filename, "w");
-    if (err != 0 || file == NULL) 
+//将槽位中的记录还原为完整的商品信息
+//功能：合并热/冷数据，并从品牌字典和字符串池中取回字符串，填充Goods结构体
+void slotToGoods(GoodsManager* manager, int slot, Goods* goods)
+{
+    const GoodsHot* hot = STORE_HOT(&manager->store, slot);
+    const GoodsCold* cold = STORE_COLD(&manager->store, slot);
+    strcpy_s(goods->id, sizeof(goods->id), cold->id);
+    strcpy_s(goods->name, sizeof(goods->name), getGoodsName(&cold->name, &manager->names));
+    strcpy_s(goods->brand, sizeof(goods->brand), brandName(&manager->brands, hot->brandId));
+    goods->category = (GoodsCategory)hot->category;
+    goods->price = hot->price;
+    goods->stock = hot->stock;
+}
+
+//按ID查找槽位
+//功能：通过编号哈希索引查找记录所在的槽位
+//返回：找到返回槽位号，未找到返回GOODS_NIL
+static int findSlotById(GoodsManager* manager, const char* id)
+{
+    STATS_BEGIN(STAT_FIND_BY_ID);
+    int probes = 0;
+    int slot = indexFindGoods(&manager->store, id, &probes);
+    STATS_VISIT_N(probes);
+    STATS_END();
+    return slot;
+}
+
+//按ID查找商品
+//功能：查找指定ID的商品
+//参数：manager - 管理器指针，id - 要查找的商品ID，result - 输出商品信息(可为NULL)
+//返回：找到返回1，未找到返回0
+int findGoodsById(GoodsManager* manager, const char* id, Goods* result) 
+{
+    if (manager == NULL || id == NULL) 
     {
         return 0;
     }
 
-    // 遍历链表写入数据
-    GoodsNode* current = manager->head;
-    while (current != NULL) 
+    int slot = findSlotById(manager, id);
+    if (slot == GOODS_NIL)
     {
-        fprintf(file, "%s %s %s %s %.2f %d\n",
-                current->data.id,
-                current->data.name,
-                categoryToString(current->data.category),
-                current->data.brand,
-                current->data.price,
-                current->data.stock);
-        current = current->next;
+        return 0;
+    }
+    if (result != NULL)
+    {
+        slotToGoods(manager, slot, result);
     }
-
-    fclose(file);
     return 1;
 }
 
-//按ID查找商品
-//功能：在链表中查找指定ID的商品
-//参数：manager - 管理器指针，id - 要查找的商品ID
-//返回：找到返回节点指针，未找到返回NULL
-GoodsNode* findGoodsById(GoodsManager* manager, const char* id) 
+//修改一条记录前把涉及的页变为私有
+//功能：包括槽位本身、补货集合的最后一个成员(移出集合时被移到空位)，以及unlink为1时链表中的前后槽位；
+//      页被快照共享时复制，任何一页复制失败都在修改之前返回，快照看到的内容不会被改动
+//返回：成功返回1，内存不足返回0
+static int ownGoodsWrite(GoodsManager* manager, int slot, int unlink)
 {
-    if (manager == NULL || id == NULL) 
+    GoodsStore* store = &manager->store;
+    int slots[4];
+    int count = 0;
+    slots[count++] = slot;
+    if (manager->reorder.count > 0)
     {
-        return NULL;
+        slots[count++] = manager->reorder.slots[manager->reorder.count - 1];
+    }
+    if (unlink)
+    {
+        slots[count++] = STORE_COLD(store, slot)->prev;
+        slots[count++] = STORE_HOT(store, slot)->next;
     }
+    return ownGoodsSlots(store, slots, count);
+}
 
-    //遍历链表查找匹配的ID
-    GoodsNode* current = manager->head;
-    while (current != NULL) 
+//记录库存变动
+//功能：管理器关联了变动日志时追加一条记录，日志写入失败不影响修改本身(失败次数记在日志中)
+static void logStockMove(GoodsManager* manager, const char* id, int delta, MoveReason reason)
+{
+    if (manager->moves != NULL)
     {
-        if (strcmp(current->data.id, id) == 0) 
-        {
-            return current;
-        }
-        current = current->next;
+        appendMovement(manager->moves, id, delta, reason, 0);
     }
-    return NULL;
 }
 
 //添加商品
-//功能：向链表头部添加新商品
+//功能：分配槽位存入新商品，登记到编号索引并插入链表头部
 //参数：manager - 管理器指针，goods - 要添加的商品信息
 //返回：成功返回1，失败返回0
 int addGoods(GoodsManager* manager, Goods goods) 
+{
+    return insertGoodsAfter(manager, goods, NULL);
+}
+
+//添加商品并插入到指定商品之后
+//功能：与addGoods相同，只是链表位置由prevId指定，用于撤销删除时放回原来的位置
+//参数：prevId - 前一件商品的ID，NULL表示插入链表头部
+//返回：成功返回1，重复ID、前一件商品不存在或内存不足返回0
+int insertGoodsAfter(GoodsManager* manager, Goods goods, const char* prevId)
 {
     if (manager == NULL || !isValidGoods(goods)) 
     {
@@ -280,64 +807,116 @@ int addGoods(GoodsManager* manager, Goods goods)
     }
 
     //检查是否存在重复ID
-    if (findGoodsById(manager, goods.id) != NULL) 
+    STATS_BEGIN(STAT_ADD);
+    if (findSlotById(manager, goods.id) != GOODS_NIL) 
+    {
+        STATS_END();
+        return 0;
+    }
+
+    //先为槽位、前缀索引和品牌预留空间，品牌在所有可能失败的步骤之后才登记
+    GoodsStore* store = &manager->store;
+    int prev = prevId != NULL ? findSlotById(manager, prevId) : GOODS_NIL;
+    int neighbours[2] = { prev != GOODS_NIL ? prev : store->head, prev != GOODS_NIL ? STORE_HOT(store, prev)->next : GOODS_NIL };
+    if ((prevId != NULL && prev == GOODS_NIL)
+        || !reserveGoodsPages(store, GOODS_WRITE_PAGES) || !ownGoodsSlots(store, neighbours, 2)
+        || !reservePrefixIndex(&manager->idPrefix, 1, (int)strlen(goods.id))
+        || !reservePrefixIndex(&manager->namePrefix, 1, (int)strlen(goods.name))
+        || !reserveGoodsWords(&manager->words, goods.name, goods.brand)
+        || !reserveLiveGroup(&manager->groups)
+        || !reserveBrand(&manager->brands, goods.brand))
+    {
+        STATS_END();
+        return 0;  //品牌字典已满或内存分配失败(含复制共享页)
+    }
+    int slot = allocGoodsSlot(store);
+    if (slot == GOODS_NIL) 
     {
+        STATS_END();
         return 0;
     }
 
-    //创建新节点
-    GoodsNode* newNode = (GoodsNode*)malloc(sizeof(GoodsNode));
-    if (newNode == NULL) 
+    //填充冷数据
+    GoodsCold* cold = STORE_COLD_W(store, slot);
+    strcpy_s(cold->id, sizeof(cold->id), goods.id);
+    if (!setGoodsName(&cold->name, &manager->names, goods.name))
     {
-        return 0;  //内存分配失败
+        freeGoodsSlot(store, slot);
+        STATS_END();
+        return 0;
     }
 
-    //初始化新节点并插入到链表头部
-    newNode->data = goods;
-    newNode->next = manager->head;
-    manager->head = newNode;
+    //填充热数据并登记索引
+    GoodsHot* hot = STORE_HOT_W(store, slot);
+    hot->idHash = hashGoodsId(goods.id);
+    hot->category = (unsigned char)goods.category;
+    hot->price = goods.price;
+    hot->stock = goods.stock;
+    if (!indexInsertGoods(store, slot))
+    {
+        releaseGoodsName(&cold->name, &manager->names);
+        freeGoodsSlot(store, slot);
+        STATS_END();
+        return 0;
+    }
+    hot->brandId = (unsigned short)internBrand(&manager->brands, goods.brand);  //空间已预留，不会失败
+
+    //插入到链表头部或指定位置
+    linkGoodsSlotAfter(store, slot, prev);
+    prefixInsert(&manager->idPrefix, goods.id, slot);
+    prefixInsert(&manager->namePrefix, goods.name, slot);
+    insertGoodsWords(&manager->words, goods.name, goods.brand, slot);
+    applyLiveGroup(&manager->groups, hot, 1);
     manager->count++;
+    recordChange(&manager->changes, goods.id, CHANGE_INSERTED);
+    logStockMove(manager, goods.id, goods.stock, MOVE_ADD);
 
+    STATS_END();
     return 1;
 }
 
 //删除商品
-//功能：从链表中除指定ID的商品
+//功能：从链表和编号索引中删除指定ID的商品，并归还其槽位
 //参数：manager - 管理器指针，id - 要删除的商品ID
 //返回：成功返回1，失败返回0
 int deleteGoods(GoodsManager* manager, const char* id) 
 {
-    if (manager == NULL || id == NULL || manager->head == NULL) 
+    if (manager == NULL || id == NULL || manager->count == 0) 
     {
         return 0;
     }
 
-    GoodsNode* current = manager->head;
-    GoodsNode* prev = NULL;
-
-    //遍历查找删除的节点
-    while (current != NULL) 
+    STATS_BEGIN(STAT_DELETE);
+    GoodsStore* store = &manager->store;
+    int slot = findSlotById(manager, id);
+    if (slot == GOODS_NIL)
     {
-        if (strcmp(current->data.id, id) == 0) 
-        {
-            //处理删除节点的链表连接
-            if (prev == NULL) 
-            {
-                manager->head = current->next;  //删除头节点
-            } 
-            else 
-            {
-                prev->next = current->next;     //删除中间节点
-            }
-            free(current);  //释放节点内存
-            manager->count--;
-            return 1;
-        }
-        prev = current;
-        current = current->next;
+        STATS_END();
+        return 0;  //未找到指定ID的商品
+    }
+    if (!reserveGoodsPages(store, GOODS_WRITE_PAGES) || !ownGoodsWrite(manager, slot, 1))
+    {
+        STATS_END();
+        return 0;  //内存不足
     }
 
-    return 0;  //未找到指定ID的商品
+    //摘除链表连接、索引项和补货集合成员，再释放槽位
+    reorderRemove(&manager->reorder, store, slot);
+    unlinkGoodsSlot(store, slot);
+    indexRemoveGoods(store, slot);
+    prefixRemove(&manager->idPrefix, id, slot);
+    const char* name = getGoodsName(&STORE_COLD(store, slot)->name, &manager->names);
+    prefixRemove(&manager->namePrefix, name, slot);
+    removeGoodsWords(&manager->words, name, brandName(&manager->brands, STORE_HOT(store, slot)->brandId), slot);
+    applyLiveGroup(&manager->groups, STORE_HOT(store, slot), -1);
+    int stock = STORE_HOT(store, slot)->stock;
+    releaseGoodsName(&STORE_COLD_W(store, slot)->name, &manager->names);
+    freeGoodsSlot(store, slot);
+    manager->count--;
+    recordChange(&manager->changes, id, CHANGE_DELETED);
+    logStockMove(manager, id, -stock, MOVE_REMOVE);
+    STATS_END();
+    return 1;
 }
 
 //更新商品信息
@@ -351,15 +930,98 @@ int updateGoods(GoodsManager* manager, const char* id, Goods newData)
         return 0;
     }
 
-    //查找要更新的节点
-    GoodsNode* node = findGoodsById(manager, id);
-    if (node == NULL) {
+    //查找要更新的记录
+    STATS_BEGIN(STAT_UPDATE);
+    int slot = findSlotById(manager, id);
+    if (slot == GOODS_NIL) {
+        STATS_END();
         return 0;  //未找到指定ID的商品
     }
 
+    //先预留空间，名称变化时才替换，新品牌在所有可能失败的步骤之后才登记
+    if (!reserveGoodsPages(&manager->store, GOODS_WRITE_PAGES) || !ownGoodsWrite(manager, slot, 0)
+        || !reservePrefixIndex(&manager->namePrefix, 1, (int)strlen(newData.name))
+        || !reserveGoodsWords(&manager->words, newData.name, newData.brand)
+        || !reserveLiveGroup(&manager->groups)
+        || !reserveBrand(&manager->brands, newData.brand))
+    {
+        STATS_END();
+        return 0;
+    }
+    GoodsCold* cold = STORE_COLD_W(&manager->store, slot);
+    const char* oldName = getGoodsName(&cold->name, &manager->names);
+    int oldBrandId = STORE_HOT(&manager->store, slot)->brandId;
+    int renamed = strcmp(oldName, newData.name) != 0;
+    GoodsName name;
+    if (renamed && !setGoodsName(&name, &manager->names, newData.name))
+    {
+        STATS_END();
+        return 0;
+    }
+    int brandId = internBrand(&manager->brands, newData.brand);  //空间已预留，不会失败
+    if (renamed || oldBrandId != brandId)
+    {
+        removeGoodsWords(&manager->words, oldName, brandName(&manager->brands, oldBrandId), slot);
+        insertGoodsWords(&manager->words, newData.name, newData.brand, slot);
+    }
+    if (renamed)
+    {
+        prefixRemove(&manager->namePrefix, oldName, slot);
+        prefixInsert(&manager->namePrefix, newData.name, slot);
+        releaseGoodsName(&cold->name, &manager->names);
+        cold->name = name;
+    }
+
     //保持原ID不变，更新其他信息
-    strcpy_s(newData.id, sizeof(newData.id), id);
-    node->data = newData;
+    GoodsHot* hot = STORE_HOT_W(&manager->store, slot);
+    applyLiveGroup(&manager->groups, hot, -1);
+    hot->brandId = (unsigned short)brandId;
+    hot->category = (unsigned char)newData.category;
+    hot->price = newData.price;
+    int oldStock = hot->stock;
+    hot->stock = newData.stock;
+    applyLiveGroup(&manager->groups, hot, 1);
+    reorderRefresh(&manager->reorder, &manager->store, slot);
+    recordChange(&manager->changes, id, CHANGE_UPDATED);
+    logStockMove(manager, id, newData.stock - oldStock, MOVE_CORRECTION);
+    STATS_END();
+    return 1;
+}
+
+//调整库存
+//功能：按增量修改指定商品的库存，只访问热数据中的库存字段，并同步更新补货集合
+//参数：manager - 管理器指针，id - 商品ID，delta - 库存增量(入库为正，出库为负)
+//返回：成功返回1，未找到商品或调整后库存为负返回0
+int adjustStock(GoodsManager* manager, const char* id, int delta)
+{
+    if (manager == NULL || id == NULL)
+    {
+        return 0;
+    }
+
+    STATS_BEGIN(STAT_ADJUST);
+    int slot = findSlotById(manager, id);
+    if (slot == GOODS_NIL)
+    {
+        STATS_END();
+        return 0;  //未找到指定ID的商品
+    }
+
+    long long stock = (long long)STORE_HOT(&manager->store, slot)->stock + delta;
+    if (stock < 0 || stock > INT_MAX || !reserveGoodsPages(&manager->store, GOODS_WRITE_PAGES)
+        || !ownGoodsWrite(manager, slot, 0))
+    {
+        STATS_END();
+        return 0;  //库存不能为负或溢出，或内存不足
+    }
+    GoodsHot* hot = STORE_HOT_W(&manager->store, slot);
+    applyLiveGroup(&manager->groups, hot, -1);
+    hot->stock = (int)stock;
+    applyLiveGroup(&manager->groups, hot, 1);
+    reorderRefresh(&manager->reorder, &manager->store, slot);
+    recordChange(&manager->changes, id, CHANGE_UPDATED);
+    logStockMove(manager, id, delta, delta > 0 ? MOVE_RECEIVE : MOVE_SALE);
+    STATS_END();
     return 1;
 }
 
@@ -387,7 +1049,7 @@ void displayAllGoods(GoodsManager* manager)
         return;
     }
 
-    if (manager->head == NULL) 
+    if (manager->count == 0) 
     {
         printf("No products found.\n");
         return;
@@ -411,24 +1073,28 @@ void displayAllGoods(GoodsManager* manager)
     printf("--------\n");                 //8字符
 
     //遍历打印每个商品的信息
-    GoodsNode* current = manager->head;
-    while (current != NULL) 
+    GoodsStore* store = &manager->store;
+    int current = store->head;
+    while (current != GOODS_NIL) 
     {
+        const GoodsHot* hot = STORE_HOT(store, current);
+        const GoodsCold* cold = STORE_COLD(store, current);
         char truncated_id[17] = {0};
         char truncated_name[26] = {0};
         char truncated_brand[21] = {0};
+        char price_text[MONEY_TEXT_SIZE];
 
-        truncateString(truncated_id, current->data.id, 16);
-        truncateString(truncated_name, current->data.name, 25);
-        truncateString(truncated_brand, current->data.brand, 20);
+        truncateString(truncated_id, cold->id, 16);
+        truncateString(truncated_name, getGoodsName(&cold->name, &manager->names), 25);
+        truncateString(truncated_brand, brandName(&manager->brands, hot->brandId), 20);
 
         printf("%-16s  ", truncated_id);
         printf("%-25s  ", truncated_name);
-        printf("%-12s  ", categoryToString(current->data.category));
+        printf("%-12s  ", categoryToString((GoodsCategory)hot->category));
         printf("%-20s  ", truncated_brand);
-        printf("%10.2f  ", current->data.price);
-        printf("%8d\n", current->data.stock);
-        current = current->next;
+        printf("%10s  ", formatMoney(hot->price, price_text, sizeof(price_text)));
+        printf("%8d\n", hot->stock);
+        current = hot->next;
     }
 
     //打印底部分隔线
@@ -440,6 +1106,12 @@ void displayAllGoods(GoodsManager* manager)
     printf("--------\n");
 }
 
+//是否使用并行排序和统计：商品数达到PARALLEL_MIN_GOODS且共享线程池有多个线程
+static int useParallel(GoodsManager* manager)
+{
+    return manager->count >= PARALLEL_MIN_GOODS && poolThreadCount(getTaskPool()) > 1;
+}
+
 //类别统计商品数量
 //功能：统计指定类别的商品数量
 //参数：manager - 管理器指针，category - 要统计的商品类别
@@ -451,17 +1123,28 @@ int countGoodsByCategory(GoodsManager* manager, GoodsCategory category)
         return 0;
     }
 
-    //遍历链表统计指定类别的商品数量
+    //按页顺序扫描热数据统计指定类别的商品数量，空闲槽位的类别值不会与任何类别相等；
+    //商品较多且有多个处理器时各线程分区扫描
+    STATS_BEGIN(STAT_COUNT_BY_CATEGORY);
+    if (useParallel(manager))
+    {
+        int total = parallelCountByCategory(manager, getTaskPool(), category);
+        STATS_VISIT_N(manager->store.pageCount * GOODS_PAGE_SIZE);
+        STATS_END();
+        return total;
+    }
     int count = 0;
-    GoodsNode* current = manager->head;
-    while (current != NULL) 
+    GoodsStore* store = &manager->store;
+    for (int page = 0; page < store->pageCount; page++) 
     {
-        if (current->data.category == category) 
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
         {
-            count++;
+            count += hot[i].category == (unsigned char)category;
         }
-        current = current->next;
+        STATS_VISIT_N(GOODS_PAGE_SIZE);
     }
+    STATS_END();
     return count;
 }
 
@@ -492,29 +1175,36 @@ void displayGoodsByCategory(GoodsManager* manager, GoodsCategory category)
     printf("--------\n");                 //8字符
 
     //遍历打印符合类别的商品
+    STATS_BEGIN(STAT_SHOW_BY_CATEGORY);
     int count = 0;
-    GoodsNode* current = manager->head;
-    while (current != NULL)
+    GoodsStore* store = &manager->store;
+    int current = store->head;
+    while (current != GOODS_NIL)
     {
-        if (current->data.category == category) 
+        STATS_VISIT();
+        const GoodsHot* hot = STORE_HOT(store, current);
+        if (hot->category == (unsigned char)category) 
         {
+            const GoodsCold* cold = STORE_COLD(store, current);
             char truncated_id[17] = {0};
             char truncated_name[26] = {0};
             char truncated_brand[21] = {0};
+            char price_text[MONEY_TEXT_SIZE];
 
-            truncateString(truncated_id, current->data.id, 16);
-            truncateString(truncated_name, current->data.name, 25);
-            truncateString(truncated_brand, current->data.brand, 20);
+            truncateString(truncated_id, cold->id, 16);
+            truncateString(truncated_name, getGoodsName(&cold->name, &manager->names), 25);
+            truncateString(truncated_brand, brandName(&manager->brands, hot->brandId), 20);
 
             printf("%-16s  ", truncated_id);
             printf("%-25s  ", truncated_name);
             printf("%-20s  ", truncated_brand);
-            printf("%10.2f  ", current->data.price);
-            printf("%8d\n", current->data.stock);
+            printf("%10s  ", formatMoney(hot->price, price_text, sizeof(price_text)));
+            printf("%8d\n", hot->stock);
             count++;
         }
-        current = current->next;
+        current = hot->next;
     }
+    STATS_END();
 
     //打印底部分隔线
     printf("----------------  ");
@@ -534,197 +1224,221 @@ void displayGoodsByCategory(GoodsManager* manager, GoodsCategory category)
     }
 }
 
-//链表排序辅助函数：合并两个有序链表
-//功能：将两个有序链表合并为一个新的有序链表
-//参数：a,b - 要合并的两个链表头指针，ascending - 是否升序
-//返回：合并后的链表头指针
-GoodsNode* mergeSortedLists(GoodsNode* a, GoodsNode* b, int ascending) 
+//按单价对商品排序
+//功能：商品较多且有多个处理器时并行排序，否则按单价一个字段使用规范化键排序(见sortkey.h)；
+//      单价相同时按ID升序
+//参数：manager - 管理器指针，ascending - 是否升序
+void sortGoodsByPrice(GoodsManager* manager, int ascending) 
 {
-    if (a == NULL) return b;  //如果a为空，直接返回b
-    if (b == NULL) return a;  //如果b为空，直接返回a
-
-    GoodsNode* result = NULL;
-
-    //根据排序方式选择较规则
-    if (ascending) 
+    if (manager == NULL || manager->count == 0) 
     {
-        //升序排序：价格小的在前，价格相同时按ID升序
-        if (a->data.price < b->data.price || 
-            (a->data.price == b->data.price && strcmp(a->data.id, b->data.id) < 0)) 
-        {
-            result = a;
-            result->next = mergeSortedLists(a->next, b, ascending);
-        } 
-        else 
-        {
-            result = b;
-            result->next = mergeSortedLists(a, b->next, ascending);
-        }
-    } 
-    else 
+        return;
+    }
+
+    if (useParallel(manager))
     {
-        //降序排序：价格大的在前，价格相同时按ID升序
-        if (a->data.price > b->data.price || 
-            (a->data.price == b->data.price && strcmp(a->data.id, b->data.id) < 0)) 
-        {
-            result = a;
-            result->next = mergeSortedLists(a->next, b, ascending);
-        } 
-        else 
+        STATS_BEGIN(STAT_SORT);
+        int sorted = parallelSortGoodsByPrice(manager, getTaskPool(), ascending);
+        STATS_VISIT_N(manager->count);
+        STATS_END();
+        if (sorted)
         {
-            result = b;
-            result->next = mergeSortedLists(a, b->next, ascending);
+            return;
         }
     }
-
-    return result;
+    SortKey key = { SORT_BY_PRICE, !ascending };
+    sortGoods(manager, &key, 1);
 }
 
-//链表排序辅助函数：分割链表
-//功能：使用快慢指针法将链表分割为两个大致相等的部分
-//参数：source - 源链表，frontRef,backRef - 用于存储分割结果的指针
-void splitList(GoodsNode* source, GoodsNode** frontRef, GoodsNode** backRef) 
+//计算当前库存商品的总价值
+//功能：计算所有商品的库存总价值
+//参数：manager - 管理器指针
+//返回：库存总价值，单位为分
+Money calculateTotalValue(GoodsManager* manager)
 {
-    //处理特殊情况
-    if (source == NULL || source->next == NULL) {
-        *frontRef = source;
-        *backRef = NULL;
-        return;
+    if (manager == NULL) 
+    {
+        return 0;
     }
 
-    //使用快慢指针法找到中点
-    GoodsNode* slow = source;
-    GoodsNode* fast = source->next;
-
-    while (fast != NULL) 
+    //按页顺序扫描热数据计算总价值，全程使用整数运算保证结果精确；
+    //空闲槽位的单价和库存均为0，循环体无分支，便于编译器向量化；商品较多时各线程分区求和
+    STATS_BEGIN(STAT_TOTAL_VALUE);
+    if (useParallel(manager))
+    {
+        Money total = parallelTotalValue(manager, getTaskPool());
+        STATS_VISIT_N(manager->store.pageCount * GOODS_PAGE_SIZE);
+        STATS_END();
+        return total;
+    }
+    Money totalValue = 0;
+    GoodsStore* store = &manager->store;
+    for (int page = 0; page < store->pageCount; page++)
     {
-        fast = fast->next;
-        if (fast != NULL) 
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
         {
-            fast = fast->next;
-            slow = slow->next;
+            totalValue += hot[i].price * (Money)hot[i].stock;
         }
+        STATS_VISIT_N(GOODS_PAGE_SIZE);
     }
-
-    //在中点分割链表
-    *frontRef = source;
-    *backRef = slow->next;
-    slow->next = NULL;
+    STATS_END();
+    return totalValue;
 }
 
-//链表归并排序
-//功能：对链表进行归并排序
-//参数：headRef - 链表头指针的指针，ascending - 是否升序
-void mergeSort(GoodsNode** headRef, int ascending) 
+//按名称查找商品
+//功能：查找名称中包含指定字符串的商品
+//参数：manager - 管理器指针，name - 要查找的商品名称，result - 输出商品信息(可为NULL)
+//返回：找到返回1，未找到返回0
+int findGoodsByName(GoodsManager* manager, const char* name, Goods* result) 
 {
-    GoodsNode* head = *headRef;
-    //处理基本情况
-    if (head == NULL || head->next == NULL) 
+    if (manager == NULL || name == NULL) 
     {
-        return;
+        return 0;
     }
 
-    //分割链表
-    GoodsNode* a;
-    GoodsNode* b;
-    splitList(head, &a, &b);
-
-    //递归排序两个子链表
-    mergeSort(&a, ascending);
-    mergeSort(&b, ascending);
-
-    //合并排序后的子链表
-    *headRef = mergeSortedLists(a, b, ascending);
-}
-
-//按单价对商品排序
-//功能：对商品链表按价格进行排序
-//参数：manager - 管理器指针，ascending - 是否升序
-void sortGoodsByPrice(GoodsManager* manager, int ascending) 
-{
-    if (manager == NULL || manager->head == NULL) 
+    //遍历查找匹配的商品名称
+    STATS_BEGIN(STAT_FIND_BY_NAME);
+    GoodsStore* store = &manager->store;
+    int current = store->head;
+    while (current != GOODS_NIL)
     {
-        return;
+        STATS_VISIT();
+        if (strstr(getGoodsName(&STORE_COLD(store, current)->name, &manager->names), name) != NULL) 
+        {
+            if (result != NULL)
+            {
+                slotToGoods(manager, current, result);
+            }
+            STATS_END();
+            return 1;
+        }
+        current = STORE_HOT(store, current)->next;
     }
-
-    //使用归并排序对链表进行排序
-    mergeSort(&(manager->head), ascending);
+    STATS_END();
+    return 0;
 }
 
-//计算当前库存商品的总价值
-//功能：计算所有商品的库存总价值
-//参数：manager - 管理器指针
-//返回：库存总价值
-float calculateTotalValue(GoodsManager* manager)
+//按编号或名称前缀列出商品
+//功能：在前缀索引中找到前缀对应的子树，按字典序取出最多limit个商品，代价只与前缀长度和结果数有关
+//参数：field - 按编号还是名称，prefix - 前缀(空串匹配全部)，results - 输出数组(至少limit项)
+//返回：找到的商品数(不超过limit)
+int suggestGoods(GoodsManager* manager, PrefixField field, const char* prefix, Goods* results, int limit)
 {
-    if (manager == NULL) 
+    if (manager == NULL || prefix == NULL || limit <= 0)
+    {
+        return 0;
+    }
+    int* slots = (int*)malloc((size_t)limit * sizeof(int));
+    if (slots == NULL)
     {
-        return 0.0f;
+        return 0;
     }
 
-    //遍历计算总价值
-    float totalValue = 0.0f;
-    GoodsNode* current = manager->head;
-    while (current != NULL)
+    STATS_BEGIN(STAT_SUGGEST);
+    const PrefixIndex* index = field == PREFIX_BY_ID ? &manager->idPrefix : &manager->namePrefix;
+    int count = prefixSearch(index, prefix, slots, limit);
+    STATS_VISIT_N(count);
+    for (int i = 0; i < count; i++)
     {
-        totalValue += current->data.price * current->data.stock;
-        current = current->next;
+        slotToGoods(manager, slots[i], &results[i]);
     }
-    return totalValue;
+    free(slots);
+    STATS_END();
+    return count;
 }
 
-//按名称查找商品
-//功能：查找名称中包含指定字符串的商品
-//参数：manager - 管理器指针，name - 要查找的商品名称
-//返回：找到的第一个匹配商品节点，未找到返回NULL
-GoodsNode* findGoodsByName(GoodsManager* manager, const char* name) 
+//模糊查找商品
+//功能：不区分大小写、容许拼写错误地按名称和品牌中的词查找，结果按得分排列(见fuzzy.h)。
+//      查找只访问词索引中与查询词足够接近的分支，不逐个比较商品
+//参数：query - 查询文本，results - 输出数组(至少limit项)，scores - 输出每个结果的得分(可为NULL)
+//返回：找到的商品数(不超过limit)
+int fuzzySearchGoods(GoodsManager* manager, const char* query, Goods* results, int* scores, int limit)
 {
-    if (manager == NULL || name == NULL) 
+    if (manager == NULL || query == NULL || limit <= 0)
     {
-        return NULL;
+        return 0;
+    }
+    FuzzyHit* hits = (FuzzyHit*)malloc((size_t)limit * sizeof(FuzzyHit));
+    if (hits == NULL)
+    {
+        return 0;
     }
 
-    //遍历查找匹配的商品名称
-    GoodsNode* current = manager->head;
-    while (current != NULL)
+    STATS_BEGIN(STAT_FUZZY);
+    int visited;
+    int count = fuzzySearchWords(&manager->words, manager->store.slotLimit, query, hits, limit, &visited);
+    STATS_VISIT_N(visited);
+    for (int i = 0; i < count; i++)
     {
-        if (strstr(current->data.name, name) != NULL) 
+        slotToGoods(manager, hits[i].slot, &results[i]);
+        if (scores != NULL)
         {
-            return current;
+            scores[i] = hits[i].score;
         }
-        current = current->next;
     }
-    return NULL;
+    free(hits);
+    STATS_END();
+    return count;
 }
 
 //按品牌查找商品
-//功能：查找指定品牌的商品
-//参数：manager - 管理器指针，brand - 要查找的品牌名称
-//返回：找到的第一个匹配商品节点，未找到返回NULL
-GoodsNode* findGoodsByBrand(GoodsManager* manager, const char* brand) 
+//功能：查找品牌名中包含指定字符串的商品。先在品牌字典中筛选出匹配的品牌ID，
+//      遍历链表时只需比较整数ID，不再对每个节点做字符串匹配
+//参数：manager - 管理器指针，brand - 要查找的品牌名称，result - 输出商品信息(可为NULL)
+//返回：找到返回1，未找到返回0
+int findGoodsByBrand(GoodsManager* manager, const char* brand, Goods* result) 
 {
-    if (manager == NULL || brand == NULL) 
+    if (manager == NULL || brand == NULL || manager->brands.count == 0) 
     {
-        return NULL;
+        return 0;
+    }
+
+    //在品牌字典中标记所有匹配的品牌ID
+    unsigned char* matched = (unsigned char*)calloc(manager->brands.count, 1);
+    if (matched == NULL)
+    {
+        return 0;
+    }
+    int matchedCount = 0;
+    for (int brandId = 0; brandId < manager->brands.count; brandId++)
+    {
+        if (strstr(brandName(&manager->brands, brandId), brand) != NULL)
+        {
+            matched[brandId] = 1;
+            matchedCount++;
+        }
     }
 
     // 遍历查找匹配的品牌
-    GoodsNode* current = manager->head;
-    while (current != NULL) 
+    STATS_BEGIN(STAT_FIND_BY_BRAND);
+    int found = 0;
+    GoodsStore* store = &manager->store;
+    int current = matchedCount > 0 ? store->head : GOODS_NIL;
+    while (current != GOODS_NIL) 
     {
-        if (strstr(current->data.brand, brand) != NULL) 
+        STATS_VISIT();
+        const GoodsHot* hot = STORE_HOT(store, current);
+        if (matched[hot->brandId]) 
         {
-            return current;
+            if (result != NULL)
+            {
+                slotToGoods(manager, current, result);
+            }
+            found = 1;
+            break;
         }
-        current = current->next;
+        current = hot->next;
     }
-    return NULL;
+    STATS_END();
+    free(matched);
+    return found;
 }
 
 //显示查询结果
 //功能：以表格形式显示查询到的商品信息
-//参数：results - 查询结果节点指针
-void displaySearchResults(GoodsNode* results) 
+//参数：results - 查询结果，NULL表示未找到
+void displaySearchResults(const Goods* results) 
 {
     if (results == NULL) 
     {
@@ -753,17 +1467,74 @@ void displaySearchResults(GoodsNode* results)
     char truncated_id[17] = {0};
     char truncated_name[26] = {0};
     char truncated_brand[21] = {0};
+    char price_text[MONEY_TEXT_SIZE];
 
-    truncateString(truncated_id, results->data.id, 16);
-    truncateString(truncated_name, results->data.name, 25);
-    truncateString(truncated_brand, results->data.brand, 20);
+    truncateString(truncated_id, results->id, 16);
+    truncateString(truncated_name, results->name, 25);
+    truncateString(truncated_brand, results->brand, 20);
 
     printf("%-16s  ", truncated_id);
     printf("%-25s  ", truncated_name);
-    printf("%-12s  ", categoryToString(results->data.category));
+    printf("%-12s  ", categoryToString(results->category));
     printf("%-20s  ", truncated_brand);
-    printf("%10.2f  ", results->data.price);
-    printf("%8d\n", results->data.stock);
+    printf("%10s  ", formatMoney(results->price, price_text, sizeof(price_text)));
+    printf("%8d\n", results->stock);
+
+    //打印底部分隔线
+    printf("----------------  ");
+    printf("-------------------------  ");
+    printf("------------  ");
+    printf("--------------------  ");
+    printf("----------  ");
+    printf("--------\n");
+}
+//显示商品列表
+//功能：以表格形式显示一组商品信息
+//参数：list - 商品数组，count - 商品数量，title - 表格标题
+void displayGoodsList(const Goods* list, int count, const char* title)
+{
+    if (list == NULL || count <= 0)
+    {
+        printf("No matching products found.\n");
+        return;
+    }
+
+    //打印表头
+    printf("\n%s\n", title);
+    printf("%-16s  ", "ID");              //ID列，左对齐，16字符
+    printf("%-25s  ", "Name");            //名称列，左对齐，25字符
+    printf("%-12s  ", "Category");        //类别列，左对齐，12字符
+    printf("%-20s  ", "Brand");           //品牌列，左对齐，20字符
+    printf("%10s  ", "Price");            //价格列，右对齐，10字符
+    printf("%8s\n", "Stock");             //库存列，右对齐，8字符
+
+    //打印分隔线
+    printf("----------------  ");          //16字符
+    printf("-------------------------  "); //25字符
+    printf("------------  ");             //12字符
+    printf("--------------------  ");     //20字符
+    printf("----------  ");               //10字符
+    printf("--------\n");                 //8字符
+
+    //逐行打印商品信息
+    for (int i = 0; i < count; i++)
+    {
+        char truncated_id[17] = {0};
+        char truncated_name[26] = {0};
+        char truncated_brand[21] = {0};
+        char price_text[MONEY_TEXT_SIZE];
+
+        truncateString(truncated_id, list[i].id, 16);
+        truncateString(truncated_name, list[i].name, 25);
+        truncateString(truncated_brand, list[i].brand, 20);
+
+        printf("%-16s  ", truncated_id);
+        printf("%-25s  ", truncated_name);
+        printf("%-12s  ", categoryToString(list[i].category));
+        printf("%-20s  ", truncated_brand);
+        printf("%10s  ", formatMoney(list[i].price, price_text, sizeof(price_text)));
+        printf("%8d\n", list[i].stock);
+    }
 
     //打印底部分隔线
     printf("----------------  ");
@@ -772,4 +1543,264 @@ void displaySearchResults(GoodsNode* results)
     printf("--------------------  ");
     printf("----------  ");
     printf("--------\n");
-}
\ No newline at end of file
+    printf("%d products listed.\n", count);
+}
+
+//补货提醒项
+typedef struct
+{
+    int shortfall;  // 缺货数量(补货点-库存)
+    int slot;       // 记录槽位号
+    const char* id; // 商品编号(指向冷数据)
+} ReorderEntry;
+
+//补货提醒项比较函数：缺货数量降序，相同时按ID升序
+static int compareReorderEntries(const void* a, const void* b)
+{
+    const ReorderEntry* x = (const ReorderEntry*)a;
+    const ReorderEntry* y = (const ReorderEntry*)b;
+    if (x->shortfall != y->shortfall)
+    {
+        return x->shortfall > y->shortfall ? -1 : 1;
+    }
+    return strcmp(x->id, y->id);
+}
+
+//收集补货集合中的商品
+//功能：只遍历补货集合，耗时与需要补货的商品数量成正比，与商品总数无关
+//参数：entries - 输出新分配的提醒项数组，由调用者free
+//返回：提醒项数量，失败返回-1
+static int collectReorderEntries(GoodsManager* manager, ReorderEntry** entries)
+{
+    GoodsStore* store = &manager->store;
+    int count = manager->reorder.count;
+    ReorderEntry* list = (ReorderEntry*)malloc((size_t)(count > 0 ? count : 1) * sizeof(ReorderEntry));
+    if (list == NULL)
+    {
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int slot = manager->reorder.slots[i];
+        const GoodsCold* cold = STORE_COLD(store, slot);
+        list[i].shortfall = cold->reorderPoint - STORE_HOT(store, slot)->stock;
+        list[i].slot = slot;
+        list[i].id = cold->id;
+    }
+    qsort(list, count, sizeof(ReorderEntry), compareReorderEntries);
+    *entries = list;
+    return count;
+}
+
+//设置商品补货点
+//功能：修改补货点后立即按当前库存更新补货集合
+//参数：manager - 管理器指针，id - 商品ID，reorderPoint - 补货点(0表示不监视)
+//返回：成功返回1，失败返回0
+int setReorderPoint(GoodsManager* manager, const char* id, int reorderPoint)
+{
+    if (manager == NULL || id == NULL || reorderPoint < 0)
+    {
+        return 0;
+    }
+
+    int slot = findSlotById(manager, id);
+    if (slot == GOODS_NIL || !reserveGoodsPages(&manager->store, GOODS_WRITE_PAGES) || !ownGoodsWrite(manager, slot, 0))
+    {
+        return 0;
+    }
+    STORE_COLD_W(&manager->store, slot)->reorderPoint = reorderPoint;
+    reorderRefresh(&manager->reorder, &manager->store, slot);
+    recordChange(&manager->changes, id, CHANGE_UPDATED);
+    return 1;
+}
+
+//获取商品补货点
+//返回：补货点，未找到商品返回-1
+int getReorderPoint(GoodsManager* manager, const char* id)
+{
+    if (manager == NULL || id == NULL)
+    {
+        return -1;
+    }
+
+    int slot = findSlotById(manager, id);
+    return slot == GOODS_NIL ? -1 : STORE_COLD(&manager->store, slot)->reorderPoint;
+}
+
+//商品库存是否低于补货点
+//返回：在补货集合中返回1，否则返回0
+int needsReorder(GoodsManager* manager, const char* id)
+{
+    if (manager == NULL || id == NULL)
+    {
+        return 0;
+    }
+
+    int slot = findSlotById(manager, id);
+    return slot != GOODS_NIL && STORE_COLD(&manager->store, slot)->reorderPos != GOODS_NIL;
+}
+
+//列出需要补货的商品
+//功能：按缺货数量从多到少排列，相同时按ID升序
+//参数：results - 输出新分配的商品数组，由调用者free
+//返回：商品数量，失败返回-1
+int listReorderGoods(GoodsManager* manager, Goods** results)
+{
+    if (manager == NULL || results == NULL)
+    {
+        return -1;
+    }
+    *results = NULL;
+
+    ReorderEntry* entries;
+    int count = collectReorderEntries(manager, &entries);
+    if (count < 0)
+    {
+        return -1;
+    }
+    Goods* list = (Goods*)malloc((size_t)(count > 0 ? count : 1) * sizeof(Goods));
+    if (list == NULL)
+    {
+        free(entries);
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        slotToGoods(manager, entries[i].slot, &list[i]);
+    }
+    free(entries);
+    *results = list;
+    return count;
+}
+
+//显示补货提醒列表
+//功能：以表格形式显示需要补货的商品及其库存、补货点和缺货数量
+void displayReorderAlerts(GoodsManager* manager)
+{
+    if (manager == NULL)
+    {
+        printf("Manager not initialized!\n");
+        return;
+    }
+
+    ReorderEntry* entries;
+    int count = collectReorderEntries(manager, &entries);
+    if (count < 0)
+    {
+        printf("Memory allocation failed!\n");
+        return;
+    }
+    if (count == 0)
+    {
+        printf("No products below their reorder point.\n");
+        free(entries);
+        return;
+    }
+
+    printf("\nReorder Alerts\n");
+    printf("%-16s  %-25s  %8s  %8s  %9s\n", "ID", "Name", "Stock", "Reorder", "Shortfall");
+    printf("----------------  -------------------------  --------  --------  ---------\n");
+    for (int i = 0; i < count; i++)
+    {
+        const GoodsCold* cold = STORE_COLD(&manager->store, entries[i].slot);
+        char truncated_id[17] = {0};
+        char truncated_name[26] = {0};
+
+        truncateString(truncated_id, cold->id, 16);
+        truncateString(truncated_name, getGoodsName(&cold->name, &manager->names), 25);
+        printf("%-16s  %-25s  %8d  %8d  %9d\n", truncated_id, truncated_name,
+               STORE_HOT(&manager->store, entries[i].slot)->stock, cold->reorderPoint, entries[i].shortfall);
+    }
+    printf("----------------  -------------------------  --------  --------  ---------\n");
+    printf("%d products need reordering.\n", count);
+    free(entries);
+}
+
+//加共享锁
+//功能：允许多个只读操作同时进行
+void lockGoodsShared(GoodsManager* manager)
+{
+    AcquireSRWLockShared((PSRWLOCK)&manager->lock);
+}
+
+//释放共享锁
+void unlockGoodsShared(GoodsManager* manager)
+{
+    ReleaseSRWLockShared((PSRWLOCK)&manager->lock);
+}
+
+//加独占锁
+//功能：等待所有只读操作结束后独占管理器，用于添加、删除和修改
+void lockGoodsExclusive(GoodsManager* manager)
+{
+    AcquireSRWLockExclusive((PSRWLOCK)&manager->lock);
+}
+
+//释放独占锁
+void unlockGoodsExclusive(GoodsManager* manager)
+{
+    ReleaseSRWLockExclusive((PSRWLOCK)&manager->lock);
+}
+
+//显示内存报告
+//功能：对比原先内联存储全部字段的节点布局与当前热/冷分离布局下每个商品占用的字节数
+//参数：manager - 管理器指针
+void displayMemoryReport(GoodsManager* manager)
+{
+    if (manager == NULL)
+    {
+        printf("Manager not initialized!\n");
+        return;
+    }
+
+    //原布局：每个节点内联完整的Goods结构体
+    typedef struct
+    {
+        Goods data;
+        void* next;
+    } InlineGoodsNode;
+
+    size_t count = (size_t)manager->count;
+    size_t inlineBytes = count * sizeof(InlineGoodsNode);
+    size_t hotBytes = count * sizeof(GoodsHot);
+    size_t coldBytes = count * sizeof(GoodsCold);
+    size_t indexBytes = (size_t)manager->store.indexSize * sizeof(GoodsIndexEntry);
+    size_t nameLive = manager->names.liveBytes;
+    size_t nameAllocated = arenaAllocatedBytes(&manager->names);
+    size_t brandBytes = brandDictBytes(&manager->brands);
+    size_t compactBytes = hotBytes + coldBytes + indexBytes + nameLive + brandBytes;
+
+    printf("\n=== Memory Report ===\n");
+    printf("Products: %zu, distinct brands: %d\n", count, manager->brands.count);
+    printf("%-32s  %12s  %12s\n", "Component", "Bytes", "Bytes/SKU");
+    printf("--------------------------------  ------------  ------------\n");
+    printf("%-32s  %12zu  %12.1f\n", "Before: inline Goods nodes", inlineBytes,
+           count ? (double)inlineBytes / count : 0.0);
+    printf("%-32s  %12zu  %12.1f\n", "After: hot records", hotBytes,
+           count ? (double)hotBytes / count : 0.0);
+    printf("%-32s  %12zu  %12.1f\n", "After: cold records", coldBytes,
+           count ? (double)coldBytes / count : 0.0);
+    printf("%-32s  %12zu  %12.1f\n", "After: ID hash index", indexBytes,
+           count ? (double)indexBytes / count : 0.0);
+    printf("%-32s  %12zu  %12.1f\n", "After: long-name arena (live)", nameLive,
+           count ? (double)nameLive / count : 0.0);
+    printf("%-32s  %12zu  %12.1f\n", "After: brand dictionary", brandBytes,
+           count ? (double)brandBytes / count : 0.0);
+    printf("%-32s  %12zu  %12.1f\n", "After: total", compactBytes,
+           count ? (double)compactBytes / count : 0.0);
+    printf("--------------------------------  ------------  ------------\n");
+    if (compactBytes > 0)
+    {
+        printf("Reduction: %.1fx\n", (double)inlineBytes / compactBytes);
+    }
+    printf("Record pages: %d allocated (%zu bytes), %d slots in use\n",
+           manager->store.pageCount, (size_t)manager->store.pageCount * sizeof(GoodsPage), manager->count);
+    printf("Name arena: %zu bytes allocated, %zu bytes wasted by edits/deletes\n",
+           nameAllocated, manager->names.wastedBytes);
+    size_t prefixBytes = prefixIndexBytes(&manager->idPrefix) + prefixIndexBytes(&manager->namePrefix);
+    printf("Prefix indexes (ID and name): %zu bytes, %.1f bytes/SKU\n",
+           prefixBytes, count ? (double)prefixBytes / count : 0.0);
+    size_t wordBytes = prefixIndexBytes(&manager->words);
+    printf("Word index (fuzzy search): %zu bytes, %.1f bytes/SKU\n",
+           wordBytes, count ? (double)wordBytes / count : 0.0);
+}
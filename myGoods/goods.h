@@ -3,6 +3,14 @@
 
 #include <stdio.h>
 #include <string.h>
+#include "dict.h"
+#include "store.h"
+#include "reorder.h"
+#include "changes.h"
+#include "prefix.h"
+#include "fuzzy.h"
+#include "groups.h"
+#include "movelog.h"
 
 // 商品类别枚举
 // 用于定义商品的基本分类：笔类、本类、颜料类和其他类
@@ -14,6 +22,12 @@ typedef enum
     OTHER     // 其他类商品
 } GoodsCategory;
 
+#define MONEY_SCALE 100       // 1元 = 100分
+#define MONEY_TEXT_SIZE 32    // 格式化金额字符串的缓冲区大小
+#define GOODS_LINE_MAX 256    // 数据文件一行的最大长度
+#define GOODS_CHECKSUM_PREFIX "#CRC32C " // 文本数据文件校验和尾行的开头，之后是8位十六进制的CRC32C
+#define GOODS_CHECKSUM_PREFIX_LEN 8      // 校验和尾行开头的字符数
+
 // 商品基本信息结构体
 // 包含商品的所有基本属性：编号、名称、类别、品牌、单价和库存
 typedef struct
@@ -22,24 +36,35 @@ typedef struct
     char name[50];          // 商品名称，最大48字符+'\0'
     GoodsCategory category; // 商品类别
     char brand[50];         // 商品品牌，最大48字符+'\0'
-    float price;            // 商品单价(>0)
+    Money price;            // 商品单价，单位为分(>0)
     int stock;              // 库存数量(>=0)
 } Goods;
 
-// 商品链表节点结构体
-// 用于构建商品信息的链表，包含商品数据和指向下一个节点的指针
-typedef struct GoodsNode
+// 前缀查询的字段
+typedef enum
 {
-    Goods data;             // 商品数据
-    struct GoodsNode *next; // 指向下一个节点的指针
-} GoodsNode;
+    PREFIX_BY_ID,  // 按编号前缀
+    PREFIX_BY_NAME // 按名称前缀
+} PrefixField;
 
 // 商品管理系统结构体
-// 用于管理整个商品链表，包含头节点指针和商品总数
+// 商品记录按热/冷字段拆分后分页存放(见store.h)，品牌以字典ID表示，长名称存放在字符串池中；
+// 对外接口统一通过Goods结构体传递完整信息
 typedef struct
 {
-    GoodsNode *head; // 链表头节点指针
-    int count;       // 商品总数计数器
+    GoodsStore store;  // 商品记录、链表顺序和编号索引
+    int count;         // 商品总数计数器
+    StringArena names; // 长商品名称字符串池
+    BrandDict brands;  // 品牌字典
+    ReorderSet reorder; // 库存低于补货点的商品集合
+    ChangeSet changes;  // 上一个检查点(加载文件或导出增量)之后的变更
+    PrefixIndex idPrefix;   // 编号前缀索引
+    PrefixIndex namePrefix; // 名称前缀索引
+    PrefixIndex words;      // 名称和品牌的词索引(模糊查找)
+    GroupTable groups;      // 品牌×类别分组统计，开启增量维护时随修改更新(见aggregate.h)
+    MoveLog *moves;         // 库存变动日志(由调用者打开和关闭)，NULL表示不记录
+    int packed;         // 数据文件为压缩格式，保存时保持相同格式
+    void *lock;         // 读写锁(SRWLOCK，与指针同大小)，多线程访问时由调用者加锁
 } GoodsManager;
 
 // 基础功能函数声明
@@ -47,29 +72,62 @@ GoodsManager *initGoodsManager();                              // 初始化商
 void freeGoodsManager(GoodsManager *manager);                  // 释放商品管理系统内存
 int loadFromFile(GoodsManager *manager, const char *filename); // 从文件加载数据
 int saveToFile(GoodsManager *manager, const char *filename);   // 保存数据到文件
+void displayImportSummary(int successCount, int duplicateCount, int invalidCount); // 显示导入结果
+int parseGoodsLine(const char *line, int lineNumber, Goods *goods, int *reorderPoint); // 解析并校验一行商品数据，无效时打印警告并返回0
+unsigned int crc32cGoodsLine(unsigned int crc, const char *line);       // 在crc的基础上累计文本数据文件一行的校验和(与行尾是"\r\n"还是"\n"无关)
+int parseChecksumLine(const char *line, unsigned int *crc);             // 识别校验和尾行：不是返回0，是返回1并输出校验和，格式错误返回-1
 
 // 基本操作函数声明
 int addGoods(GoodsManager *manager, Goods goods);                      // 添加商品
+int insertGoodsAfter(GoodsManager *manager, Goods goods, const char *prevId); // 添加商品并插入到指定商品之后(prevId为NULL时插入头部)
 int deleteGoods(GoodsManager *manager, const char *id);                // 删除商品
 int updateGoods(GoodsManager *manager, const char *id, Goods newData); // 更新商品信息
-GoodsNode *findGoodsById(GoodsManager *manager, const char *id);       // 按ID查找商品
+int findGoodsById(GoodsManager *manager, const char *id, Goods *result); // 按ID查找商品
+int adjustStock(GoodsManager *manager, const char *id, int delta);     // 按增量调整库存(入库为正，出库为负)
 void displayAllGoods(GoodsManager *manager);                           // 显示所有商品
 
 // 辅助函数声明
 const char *categoryToString(GoodsCategory category); // 将商品类别转换为字符串
 GoodsCategory stringToCategory(const char *str);      // 将字符串转换为商品类别
 int isValidGoods(Goods goods);                        // 验证商品信息是否有效
+int parseMoney(const char *str, Money *value);        // 将"12.34"形式的字符串解析为分
+char *formatMoney(Money value, char *buf, size_t size); // 将分格式化为"12.34"形式的字符串
+unsigned char *readWholeFile(const char *filename, size_t *size); // 读取整个文件，返回以'\0'结尾的缓冲区，失败返回NULL
+void truncateString(char *dest, const char *src, size_t maxLen);  // 复制字符串，超过maxLen-1个字符时截断并以"..."结尾
 
 // 高级功能函数声明
 // 统计和查询功能
 int countGoodsByCategory(GoodsManager *manager, GoodsCategory category);    // 按类别统计商品数量
 void displayGoodsByCategory(GoodsManager *manager, GoodsCategory category); // 显示指定类别的商品
 void sortGoodsByPrice(GoodsManager *manager, int ascending);                // 按价格排序
-float calculateTotalValue(GoodsManager *manager);                           // 计算总库存价值
+Money calculateTotalValue(GoodsManager *manager);                           // 计算总库存价值(分)
 
 // 搜索功能
-GoodsNode *findGoodsByName(GoodsManager *manager, const char *name);   // 按名称搜索
-GoodsNode *findGoodsByBrand(GoodsManager *manager, const char *brand); // 按品牌搜索
-void displaySearchResults(GoodsNode *results);                         // 显示搜索结果
+int findGoodsByName(GoodsManager *manager, const char *name, Goods *result);   // 按名称搜索
+int findGoodsByBrand(GoodsManager *manager, const char *brand, Goods *result); // 按品牌搜索
+void displaySearchResults(const Goods *result);                                // 显示搜索结果
+void displayGoodsList(const Goods *list, int count, const char *title);        // 以表格显示一组商品
+int suggestGoods(GoodsManager *manager, PrefixField field, const char *prefix, Goods *results, int limit); // 按编号或名称前缀列出商品，返回数量
+int fuzzySearchGoods(GoodsManager *manager, const char *query, Goods *results, int *scores, int limit); // 按名称和品牌模糊查找，按得分排列，返回数量
+
+// 存储访问
+void slotToGoods(GoodsManager *manager, int slot, Goods *goods); // 将槽位中的记录还原为完整商品信息
+
+// 补货提醒功能
+int setReorderPoint(GoodsManager *manager, const char *id, int reorderPoint); // 设置商品补货点(0表示不监视)
+int getReorderPoint(GoodsManager *manager, const char *id);                   // 获取商品补货点，未找到返回-1
+int needsReorder(GoodsManager *manager, const char *id);                      // 商品库存是否低于补货点
+int listReorderGoods(GoodsManager *manager, Goods **results);                 // 列出需要补货的商品，返回数量
+void displayReorderAlerts(GoodsManager *manager);                             // 显示补货提醒列表
+
+// 多线程访问
+// 管理器函数本身不加锁；服务器等多线程调用者在只读操作外加共享锁，在修改操作外加独占锁
+void lockGoodsShared(GoodsManager *manager);      // 加共享锁(只读操作)
+void unlockGoodsShared(GoodsManager *manager);    // 释放共享锁
+void lockGoodsExclusive(GoodsManager *manager);   // 加独占锁(修改操作)
+void unlockGoodsExclusive(GoodsManager *manager); // 释放独占锁
+
+// 内存报告
+void displayMemoryReport(GoodsManager *manager); // 显示每个商品占用的内存字节数
 
 #endif
\ No newline at end of file
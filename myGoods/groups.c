@@ -0,0 +1,158 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "groups.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define GROUP_INITIAL_SIZE 64 // 初始表大小
+
+//初始化分组统计表
+void initGroupTable(GroupTable* table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+//释放分组统计表
+void freeGroupTable(GroupTable* table)
+{
+    free(table->entries);
+    initGroupTable(table);
+}
+
+//计算分组键在表中的起始位置
+static unsigned int groupSlot(unsigned int key, int size)
+{
+    return (key * 0x9E3779B1u) >> 7 & ((unsigned int)size - 1);
+}
+
+//预留新分组的空间
+//功能：装填率保持在1/2以下，放不下extra个新分组时容量翻倍并重新放入所有项
+//返回：成功返回1，内存不足返回0且表不变
+int reserveGroupTable(GroupTable* table, int extra)
+{
+    if ((long long)(table->used + extra) * 2 <= table->size)
+    {
+        return 1;
+    }
+    int newSize = table->size == 0 ? GROUP_INITIAL_SIZE : table->size;
+    while ((long long)(table->used + extra) * 2 > newSize)
+    {
+        newSize *= 2;
+    }
+    GroupEntry* entries = (GroupEntry*)calloc((size_t)newSize, sizeof(GroupEntry));
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i < table->size; i++)
+    {
+        if (table->entries[i].key != 0)
+        {
+            unsigned int pos = groupSlot(table->entries[i].key, newSize);
+            while (entries[pos].key != 0)
+            {
+                pos = (pos + 1) & ((unsigned int)newSize - 1);
+            }
+            entries[pos] = table->entries[i];
+        }
+    }
+    free(table->entries);
+    table->entries = entries;
+    table->size = newSize;
+    return 1;
+}
+
+//累加到分组
+//功能：查找分组，不存在时新建；调用前需已用reserveGroupTable预留空间
+//返回：分组项指针
+GroupEntry* groupTableAdd(GroupTable* table, unsigned int key, int count, long long stock, Money value)
+{
+    unsigned int stored = key + 1;
+    unsigned int mask = (unsigned int)table->size - 1;
+    unsigned int pos = groupSlot(stored, table->size);
+    while (table->entries[pos].key != stored)
+    {
+        if (table->entries[pos].key == 0)
+        {
+            table->entries[pos].key = stored;
+            table->used++;
+            break;
+        }
+        pos = (pos + 1) & mask;
+    }
+    GroupEntry* entry = &table->entries[pos];
+    entry->count += count;
+    entry->stock += stock;
+    entry->value += value;
+    return entry;
+}
+
+//重建分组统计表
+//功能：按页扫描热数据，每条记录按品牌和类别累加；相邻记录属于同一分组时直接累加，不再查表。
+//      新分组出现时才检查容量，因此整个扫描只对表做很少的写入和扩容
+//返回：成功返回1，内存不足返回0且表为空
+int buildGroupTable(GroupTable* table, const GoodsStore* store)
+{
+    int live = table->live;
+    freeGroupTable(table);
+    table->live = live;
+    if (!reserveGroupTable(table, GROUP_INITIAL_SIZE / 2))
+    {
+        return 0;
+    }
+
+    unsigned int lastKey = 0xFFFFFFFFu;
+    GroupEntry* last = NULL;
+    for (int base = 0; base < store->slotLimit; base += GOODS_PAGE_SIZE)
+    {
+        const GoodsHot* hot = store->pages[base >> GOODS_PAGE_SHIFT]->hot;
+        int n = store->slotLimit - base < GOODS_PAGE_SIZE ? store->slotLimit - base : GOODS_PAGE_SIZE;
+        for (int i = 0; i < n; i++)
+        {
+            if ((hot[i].flags & GOODS_FLAG_USED) == 0)
+            {
+                continue;
+            }
+            unsigned int key = GROUP_KEY(hot[i].brandId, hot[i].category);
+            if (key != lastKey)
+            {
+                if (!reserveGroupTable(table, 1))
+                {
+                    freeGroupTable(table);
+                    table->live = live;
+                    return 0;
+                }
+                last = groupTableAdd(table, key, 0, 0, 0);
+                lastKey = key;
+            }
+            last->count++;
+            last->stock += hot[i].stock;
+            last->value += hot[i].price * hot[i].stock;
+        }
+    }
+    return 1;
+}
+
+//增量维护时预留一个新分组
+//返回：成功或未开启增量维护返回1，内存不足返回0
+int reserveLiveGroup(GroupTable* table)
+{
+    return !table->live || reserveGroupTable(table, 1);
+}
+
+//增量维护时加上或减去一条记录
+//功能：未开启增量维护时不做任何事
+void applyLiveGroup(GroupTable* table, const GoodsHot* hot, int sign)
+{
+    if (!table->live)
+    {
+        return;
+    }
+    groupTableAdd(table, GROUP_KEY(hot->brandId, hot->category), sign, (long long)sign * hot->stock, sign * hot->price * hot->stock);
+}
+
+//分组统计表占用的字节数
+size_t groupTableBytes(const GroupTable* table)
+{
+    return (size_t)table->size * sizeof(GroupEntry);
+}
@@ -0,0 +1,42 @@
+#ifndef GROUPS_H
+#define GROUPS_H
+
+#include "store.h"
+
+// 分组统计表
+// 以"品牌ID*4+类别"为键的开放寻址哈希表，每组累计商品数、总库存和总库存价值；
+// 按品牌或按类别的统计都由该表汇总得到，因此扫描一遍热数据即可得到全部分组。
+// 开启增量维护(live)后随增删改更新：修改前减去旧记录，修改后加上新记录，
+// 新分组所需的空间在修改前用reserveGroupTable预留，之后的更新不会失败；商品数减为0的分组留在表中，输出时跳过。
+#define GROUP_CATEGORY_BITS 2   // 键中类别占用的位数
+#define GROUP_KEY(brandId, category) (((unsigned int)(brandId) << GROUP_CATEGORY_BITS) | (unsigned int)(category))
+
+// 分组项
+typedef struct
+{
+    unsigned int key; // 分组键+1，0表示空项
+    int count;        // 商品数
+    long long stock;  // 总库存
+    Money value;      // 总库存价值(分)
+} GroupEntry;
+
+// 分组统计表
+typedef struct
+{
+    GroupEntry *entries; // 开放寻址哈希表
+    int size;            // 表大小(2的幂)
+    int used;            // 已使用的项数
+    int live;            // 是否随修改增量维护
+} GroupTable;
+
+// 分组统计表函数声明
+void initGroupTable(GroupTable *table);                                  // 初始化分组统计表
+void freeGroupTable(GroupTable *table);                                  // 释放分组统计表(同时关闭增量维护)
+int reserveGroupTable(GroupTable *table, int extra);                     // 预留extra个新分组的空间，失败返回0
+GroupEntry *groupTableAdd(GroupTable *table, unsigned int key, int count, long long stock, Money value); // 累加到分组，需已预留空间
+int buildGroupTable(GroupTable *table, const GoodsStore *store);         // 扫描一遍热数据重建表，失败返回0且表为空
+int reserveLiveGroup(GroupTable *table);                                 // 增量维护时预留一个新分组，未开启时直接返回1
+void applyLiveGroup(GroupTable *table, const GoodsHot *hot, int sign);   // 增量维护时加上(sign=1)或减去(sign=-1)一条记录
+size_t groupTableBytes(const GroupTable *table);                         // 表占用的字节数
+
+#endif
@@ -0,0 +1,697 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "lazy.h"
+#include "pack.h"
+#include "crc32c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stddef.h>
+
+#define LAZY_EMPTY (-1)          // 编号索引中的空项
+#define LAZY_UNDECODED 0         // 行尚未解析
+#define LAZY_VALID 1             // 行已解析且有效
+#define LAZY_INVALID 2           // 行已解析但无效
+#define LAZY_CRC_SPAN 65536      // 数据文件校验和覆盖开头和结尾各这么多字节
+
+// 编号索引项，开放寻址
+typedef struct
+{
+    unsigned int hash; // 编号哈希值
+    int line;          // 行号，LAZY_EMPTY表示空项
+} LazyIndexEntry;
+
+// 索引文件头，其后依次是lineCount+1个行偏移和indexSize个索引项
+typedef struct
+{
+    unsigned int magic;          // 文件标识
+    unsigned int format;         // 格式版本
+    unsigned int offsetSize;     // 行偏移的字节数(sizeof(size_t))，与本程序不同时重建
+    int lineCount;               // 行数
+    int indexSize;               // 索引槽数(2的幂)
+    int indexed;                 // 索引中的行数
+    unsigned long long dataSize; // 建立索引时数据文件的字节数
+    unsigned long long dataTime; // 建立索引时数据文件的最后修改时间(FILETIME)
+    unsigned int dataCrc;        // 建立索引时数据文件开头和结尾的校验和(见lazyDataCrc)
+    unsigned int bodyCrc;        // 行偏移和索引项的校验和
+    unsigned int headerCrc;      // 文件头前面各字段的校验和
+} LazyIndexHeader;
+
+// 延迟加载的目录
+struct LazyCatalog
+{
+    char filename[MAX_PATH];     // 数据文件
+    HANDLE file;                 // 文件句柄，未映射时为INVALID_HANDLE_VALUE
+    HANDLE mapping;              // 文件映射句柄
+    const char *data;            // 映射的文件内容，未映射时为NULL
+    size_t size;                 // 文件字节数
+    unsigned long long dataTime; // 文件最后修改时间
+    unsigned int dataCrc;        // 文件开头和结尾的校验和
+    const size_t *lines;         // 各行在文件中的起始偏移，lines[lineCount]为文件末尾
+    int lineCount;               // 行数
+    const LazyIndexEntry *index; // 编号索引，同一编号的各行按行号先后排在同一条探测链上
+    int indexSize;               // 索引槽数(2的幂)
+    int indexed;                 // 索引中的行数
+    HANDLE indexFile;            // 索引文件句柄，索引从文件映射时有效，否则为INVALID_HANDLE_VALUE
+    HANDLE indexMapping;         // 索引文件映射句柄
+    const char *indexView;       // 映射的索引文件，为NULL时lines和index为本进程分配
+    Goods **cache;               // 解析结果，每页GOODS_PAGE_SIZE行，按需分配
+    unsigned char *state;        // 各行的解析状态
+    int indexLoaded;             // 编号索引是否读取自索引文件
+    HANDLE loader;               // 后台完整加载线程
+    GoodsManager *manager;       // 完整加载的管理器，取走后为NULL
+    int loaded;                  // 完整加载是否成功
+    volatile long ready;         // 后台加载是否已结束
+    double indexMs;              // 建立或读取编号索引的耗时
+    double loadMs;               // 后台完整加载的耗时
+    double ms;                   // 每个计时器刻度的毫秒数
+};
+
+//当前计时器刻度
+static long long lazyNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//读取一行的第一个字段作为编号
+//功能：与parseGoodsLine相同，跳过行首空白，编号最多18个字符；文本保存时最后的校验和行不是商品
+//返回：编号有效返回1
+static int lazyLineId(const char* line, const char* end, char* id)
+{
+    if (end - line >= GOODS_CHECKSUM_PREFIX_LEN && memcmp(line, GOODS_CHECKSUM_PREFIX, GOODS_CHECKSUM_PREFIX_LEN) == 0)
+    {
+        return 0;
+    }
+    while (line < end && (*line == ' ' || *line == '\t' || *line == '\r'))
+    {
+        line++;
+    }
+    int length = 0;
+    while (line + length < end && line[length] != ' ' && line[length] != '\t' && line[length] != '\r' && line[length] != '\n')
+    {
+        if (length >= 18)
+        {
+            return 0;
+        }
+        id[length] = line[length];
+        length++;
+    }
+    id[length] = '\0';
+    return length > 0;
+}
+
+//建立行偏移和编号索引
+//功能：第一遍数换行符，第二遍记录行首并把每行的编号插入索引；不解析其余字段
+//返回：成功返回1，内存不足返回0
+static int buildLazyIndex(LazyCatalog* catalog)
+{
+    const char* data = catalog->data;
+    const char* end = data + catalog->size;
+    int count = 0;
+    for (const char* p = data; p < end; count++)
+    {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        p = newline != NULL ? newline + 1 : end;
+        if (count == INT_MAX / 2 - 1)
+        {
+            return 0;
+        }
+    }
+    int size = 1024;
+    while (size < count * 2)
+    {
+        size *= 2;
+    }
+    size_t* lines = (size_t*)malloc(((size_t)count + 1) * sizeof(size_t));
+    LazyIndexEntry* index = (LazyIndexEntry*)malloc((size_t)size * sizeof(LazyIndexEntry));
+    catalog->lines = lines;
+    catalog->index = index;
+    if (lines == NULL || index == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i < size; i++)
+    {
+        index[i].line = LAZY_EMPTY;
+    }
+    catalog->indexSize = size;
+
+    unsigned int mask = (unsigned int)size - 1;
+    const char* p = data;
+    for (int line = 0; line < count; line++)
+    {
+        const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* next = newline != NULL ? newline + 1 : end;
+        lines[line] = (size_t)(p - data);
+        char id[20];
+        if (lazyLineId(p, next, id))
+        {
+            unsigned int hash = hashGoodsId(id);
+            unsigned int i = hash & mask;
+            while (index[i].line != LAZY_EMPTY)
+            {
+                i = (i + 1) & mask;
+            }
+            index[i].hash = hash;
+            index[i].line = line;
+            catalog->indexed++;
+        }
+        p = next;
+    }
+    lines[count] = catalog->size;
+    catalog->lineCount = count;
+    return 1;
+}
+
+//索引文件名：数据文件名加LAZY_INDEX_SUFFIX
+static void lazyIndexName(const char* filename, char* name, size_t size)
+{
+    sprintf_s(name, size, "%s%s", filename, LAZY_INDEX_SUFFIX);
+}
+
+//解除索引文件的映射
+static void unmapLazyIndex(LazyCatalog* catalog)
+{
+    if (catalog->indexView != NULL)
+    {
+        UnmapViewOfFile(catalog->indexView);
+        catalog->indexView = NULL;
+    }
+    if (catalog->indexMapping != NULL)
+    {
+        CloseHandle(catalog->indexMapping);
+        catalog->indexMapping = NULL;
+    }
+    if (catalog->indexFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(catalog->indexFile);
+        catalog->indexFile = INVALID_HANDLE_VALUE;
+    }
+}
+
+//检查索引文件内容与数据文件是否一致
+//功能：校验和只能发现意外损坏，不能发现写入者本身的错误，因此查找前再核对一遍：
+//      行偏移从0开始严格递增且都小于数据文件大小，最后一项等于数据文件大小；
+//      索引项的行号都小于行数，非空项数等于indexed(小于槽数，保证探测链会遇到空项而结束)
+//返回：一致返回1，否则返回0
+static int checkLazyIndex(const size_t* lines, int lineCount, const LazyIndexEntry* index, int indexSize, int indexed, size_t size)
+{
+    if (lines[lineCount] != size || (lineCount > 0 && lines[0] != 0))
+    {
+        return 0;
+    }
+    for (int line = 0; line < lineCount; line++)
+    {
+        if (lines[line] >= lines[line + 1])
+        {
+            return 0;
+        }
+    }
+    int used = 0;
+    for (int i = 0; i < indexSize; i++)
+    {
+        if (index[i].line != LAZY_EMPTY)
+        {
+            if (index[i].line < 0 || index[i].line >= lineCount)
+            {
+                return 0;
+            }
+            used++;
+        }
+    }
+    return used == indexed;
+}
+
+//计算数据文件开头和结尾的校验和
+//功能：大小和修改时间都不变的改写(同一时刻内保存两次、复制时保留了修改时间)只看文件头查不出来；
+//      只算开头和结尾各LAZY_CRC_SPAN字节，代价与文件大小无关。文本保存的文件最后一行是全部内容的校验和，
+//      因此结尾实际上覆盖了整个文件；没有校验和行的文件只能发现开头或结尾的改动
+static unsigned int lazyDataCrc(const char* data, size_t size)
+{
+    if (size <= 2 * (size_t)LAZY_CRC_SPAN)
+    {
+        return crc32c(0, data, size);
+    }
+    return crc32c(crc32c(0, data, LAZY_CRC_SPAN), data + size - LAZY_CRC_SPAN, LAZY_CRC_SPAN);
+}
+
+//读取索引文件
+//功能：只读映射索引文件，检查标识、格式版本、文件头和数据的校验和，建立索引时数据文件的大小、修改时间
+//      和开头结尾的校验和，以及各行偏移和索引项是否在范围内；全部相符时行偏移和索引直接使用映射的内容，不复制
+//返回：索引有效返回1；文件不存在、损坏或已过期返回0，此时需要重建
+static int loadLazyIndex(LazyCatalog* catalog)
+{
+    char name[MAX_PATH + 8];
+    lazyIndexName(catalog->filename, name, sizeof(name));
+    catalog->indexFile = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (catalog->indexFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(catalog->indexFile, &size)
+        || size.QuadPart < (long long)sizeof(LazyIndexHeader))
+    {
+        unmapLazyIndex(catalog);
+        return 0;
+    }
+    catalog->indexMapping = CreateFileMappingA(catalog->indexFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    catalog->indexView = catalog->indexMapping != NULL
+                       ? (const char*)MapViewOfFile(catalog->indexMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (catalog->indexView == NULL)
+    {
+        unmapLazyIndex(catalog);
+        return 0;
+    }
+
+    const LazyIndexHeader* header = (const LazyIndexHeader*)catalog->indexView;
+    int valid = header->magic == LAZY_INDEX_MAGIC && header->format == LAZY_INDEX_FORMAT
+             && header->offsetSize == sizeof(size_t)
+             && header->headerCrc == crc32c(0, header, offsetof(LazyIndexHeader, headerCrc))
+             && header->dataSize == (unsigned long long)catalog->size && header->dataTime == catalog->dataTime
+             && header->dataCrc == catalog->dataCrc
+             && header->lineCount >= 0 && header->lineCount < INT_MAX / 2
+             && header->indexSize >= 1024 && (header->indexSize & (header->indexSize - 1)) == 0
+             && header->indexed >= 0 && header->indexed <= header->lineCount && header->indexed < header->indexSize;
+    size_t linesBytes = valid ? ((size_t)header->lineCount + 1) * sizeof(size_t) : 0;
+    size_t indexBytes = valid ? (size_t)header->indexSize * sizeof(LazyIndexEntry) : 0;
+    valid = valid && (unsigned long long)size.QuadPart == sizeof(LazyIndexHeader) + linesBytes + indexBytes
+                  && crc32c(0, catalog->indexView + sizeof(LazyIndexHeader), linesBytes + indexBytes) == header->bodyCrc;
+    const size_t* lines = (const size_t*)(catalog->indexView + sizeof(LazyIndexHeader));
+    const LazyIndexEntry* index = (const LazyIndexEntry*)(catalog->indexView + sizeof(LazyIndexHeader) + linesBytes);
+    if (!valid || !checkLazyIndex(lines, header->lineCount, index, header->indexSize, header->indexed, catalog->size))
+    {
+        unmapLazyIndex(catalog);
+        return 0;
+    }
+    catalog->lines = lines;
+    catalog->index = index;
+    catalog->lineCount = header->lineCount;
+    catalog->indexSize = header->indexSize;
+    catalog->indexed = header->indexed;
+    return 1;
+}
+
+//保存索引文件
+//功能：写入临时文件后替换索引文件，中途失败不会留下半个文件；失败不影响本次使用，下次启动时重建
+//返回：成功返回1，失败返回0
+static int saveLazyIndex(const LazyCatalog* catalog)
+{
+    LazyIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LAZY_INDEX_MAGIC;
+    header.format = LAZY_INDEX_FORMAT;
+    header.offsetSize = sizeof(size_t);
+    header.lineCount = catalog->lineCount;
+    header.indexSize = catalog->indexSize;
+    header.indexed = catalog->indexed;
+    header.dataSize = catalog->size;
+    header.dataTime = catalog->dataTime;
+    header.dataCrc = catalog->dataCrc;
+    size_t linesBytes = ((size_t)catalog->lineCount + 1) * sizeof(size_t);
+    size_t indexBytes = (size_t)catalog->indexSize * sizeof(LazyIndexEntry);
+    header.bodyCrc = crc32c(crc32c(0, catalog->lines, linesBytes), catalog->index, indexBytes);
+    header.headerCrc = crc32c(0, &header, offsetof(LazyIndexHeader, headerCrc));
+
+    char name[MAX_PATH + 8];
+    char tempName[MAX_PATH + 16];
+    lazyIndexName(catalog->filename, name, sizeof(name));
+    sprintf_s(tempName, sizeof(tempName), "%s.tmp", name);
+    FILE* fp = NULL;
+    if (fopen_s(&fp, tempName, "wb") != 0 || fp == NULL)
+    {
+        return 0;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1
+          && fwrite(catalog->lines, 1, linesBytes, fp) == linesBytes
+          && fwrite(catalog->index, 1, indexBytes, fp) == indexBytes;
+    ok = fclose(fp) == 0 && ok;
+    ok = ok && MoveFileExA(tempName, name, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    if (!ok)
+    {
+        remove(tempName);
+    }
+    return ok;
+}
+
+//后台线程：完整加载数据文件
+static DWORD WINAPI lazyLoaderMain(LPVOID param)
+{
+    LazyCatalog* catalog = (LazyCatalog*)param;
+    long long start = lazyNow();
+    catalog->manager = initGoodsManager();
+    catalog->loaded = catalog->manager != NULL && loadFromFile(catalog->manager, catalog->filename);
+    catalog->loadMs = (double)(lazyNow() - start) * catalog->ms;
+    InterlockedExchange(&catalog->ready, 1);
+    return 0;
+}
+
+//打开延迟加载的目录
+//功能：只读映射文本数据文件并建立编号索引，然后启动后台完整加载；压缩格式的文件只启动后台加载
+//返回：成功返回目录指针，文件无法打开、内存不足或无法创建线程返回NULL
+LazyCatalog* openLazyCatalog(const char* filename)
+{
+    LazyCatalog* catalog = (LazyCatalog*)calloc(1, sizeof(LazyCatalog));
+    if (catalog == NULL || strlen(filename) >= sizeof(catalog->filename))
+    {
+        free(catalog);
+        return NULL;
+    }
+    strcpy_s(catalog->filename, sizeof(catalog->filename), filename);
+    catalog->file = INVALID_HANDLE_VALUE;
+    catalog->indexFile = INVALID_HANDLE_VALUE;
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    catalog->ms = 1000.0 / (double)frequency.QuadPart;
+
+    long long start = lazyNow();
+    catalog->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+    if (catalog->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(catalog->file, &size))
+    {
+        closeLazyCatalog(catalog);
+        return NULL;
+    }
+    catalog->size = (size_t)size.QuadPart;
+    if (catalog->size > 0 && !isPackedFile(filename))
+    {
+        catalog->mapping = CreateFileMappingA(catalog->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        catalog->data = catalog->mapping != NULL ? (const char*)MapViewOfFile(catalog->mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+        FILETIME written;
+        if (catalog->data == NULL || !GetFileTime(catalog->file, NULL, NULL, &written))
+        {
+            closeLazyCatalog(catalog);
+            return NULL;
+        }
+        catalog->dataTime = ((unsigned long long)written.dwHighDateTime << 32) | written.dwLowDateTime;
+        catalog->dataCrc = lazyDataCrc(catalog->data, catalog->size);
+        catalog->indexLoaded = loadLazyIndex(catalog);
+        if (!catalog->indexLoaded)
+        {
+            if (!buildLazyIndex(catalog))
+            {
+                closeLazyCatalog(catalog);
+                return NULL;
+            }
+            saveLazyIndex(catalog);
+        }
+        catalog->state = (unsigned char*)calloc((size_t)catalog->lineCount + 1, 1);
+        catalog->cache = (Goods**)calloc((size_t)catalog->lineCount / GOODS_PAGE_SIZE + 1, sizeof(Goods*));
+        if (catalog->state == NULL || catalog->cache == NULL)
+        {
+            closeLazyCatalog(catalog);
+            return NULL;
+        }
+    }
+    catalog->indexMs = (double)(lazyNow() - start) * catalog->ms;
+
+    catalog->loader = CreateThread(NULL, 0, lazyLoaderMain, catalog, 0, NULL);
+    if (catalog->loader == NULL)
+    {
+        closeLazyCatalog(catalog);
+        return NULL;
+    }
+    return catalog;
+}
+
+//解析一行并缓存
+//功能：与loadFromFile相同，一行最多读取GOODS_LINE_MAX-1个字符；无效的行只记录状态，不打印警告
+//返回：行有效返回缓存中的商品，否则返回NULL
+static const Goods* decodeLazyLine(LazyCatalog* catalog, int line)
+{
+    if (catalog->state[line] == LAZY_UNDECODED)
+    {
+        Goods** page = &catalog->cache[line / GOODS_PAGE_SIZE];
+        if (*page == NULL)
+        {
+            *page = (Goods*)malloc(GOODS_PAGE_SIZE * sizeof(Goods));
+            if (*page == NULL)
+            {
+                return NULL;  //内存不足，下次访问再试
+            }
+        }
+        char text[GOODS_LINE_MAX];
+        size_t length = catalog->lines[line + 1] - catalog->lines[line];
+        length = length < sizeof(text) - 1 ? length : sizeof(text) - 1;
+        memcpy(text, catalog->data + catalog->lines[line], length);
+        text[length] = '\0';
+        int reorderPoint;
+        catalog->state[line] = parseGoodsLine(text, 0, &(*page)[line % GOODS_PAGE_SIZE], &reorderPoint)
+                             ? LAZY_VALID : LAZY_INVALID;
+    }
+    return catalog->state[line] == LAZY_VALID ? &catalog->cache[line / GOODS_PAGE_SIZE][line % GOODS_PAGE_SIZE] : NULL;
+}
+
+//按编号查找
+//功能：沿探测链按行号先后检查编号相同的行，取第一条有效的行；首次访问时解析，之后读缓存。
+//      未映射(压缩格式)时等待后台加载完成后在完整的管理器中查找
+//返回：找到返回1，否则返回0
+int lazyFindGoods(LazyCatalog* catalog, const char* id, Goods* result)
+{
+    if (catalog->data == NULL)
+    {
+        WaitForSingleObject(catalog->loader, INFINITE);
+        return catalog->manager != NULL && findGoodsById(catalog->manager, id, result);
+    }
+    unsigned int hash = hashGoodsId(id);
+    unsigned int mask = (unsigned int)catalog->indexSize - 1;
+    size_t idLength = strlen(id);
+    for (unsigned int i = hash & mask; catalog->index[i].line != LAZY_EMPTY; i = (i + 1) & mask)
+    {
+        if (catalog->index[i].hash != hash)
+        {
+            continue;
+        }
+        int line = catalog->index[i].line;
+        char lineId[20];
+        lazyLineId(catalog->data + catalog->lines[line], catalog->data + catalog->lines[line + 1], lineId);
+        if (strlen(lineId) != idLength || strcmp(lineId, id) != 0)
+        {
+            continue;
+        }
+        const Goods* goods = decodeLazyLine(catalog, line);
+        if (goods != NULL)
+        {
+            if (result != NULL)
+            {
+                *result = *goods;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//后台完整加载是否已结束
+int lazyCatalogReady(LazyCatalog* catalog)
+{
+    return catalog->ready != 0;
+}
+
+//等待后台加载结束并取走完整的管理器
+//返回：加载成功返回管理器(由调用者释放)，失败或已取走返回NULL
+GoodsManager* takeLazyManager(LazyCatalog* catalog)
+{
+    WaitForSingleObject(catalog->loader, INFINITE);
+    if (!catalog->loaded)
+    {
+        return NULL;
+    }
+    GoodsManager* manager = catalog->manager;
+    catalog->manager = NULL;
+    catalog->loaded = 0;
+    return manager;
+}
+
+//关闭延迟加载的目录
+void closeLazyCatalog(LazyCatalog* catalog)
+{
+    if (catalog == NULL)
+    {
+        return;
+    }
+    if (catalog->loader != NULL)
+    {
+        WaitForSingleObject(catalog->loader, INFINITE);
+        CloseHandle(catalog->loader);
+    }
+    freeGoodsManager(catalog->manager);
+    if (catalog->data != NULL)
+    {
+        UnmapViewOfFile(catalog->data);
+    }
+    if (catalog->mapping != NULL)
+    {
+        CloseHandle(catalog->mapping);
+    }
+    if (catalog->file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(catalog->file);
+    }
+    for (int page = 0; catalog->cache != NULL && page <= catalog->lineCount / GOODS_PAGE_SIZE; page++)
+    {
+        free(catalog->cache[page]);
+    }
+    free(catalog->cache);
+    free(catalog->state);
+    if (catalog->indexView == NULL)
+    {
+        free((void*)catalog->lines);
+        free((void*)catalog->index);
+    }
+    unmapLazyIndex(catalog);
+    free(catalog);
+}
+
+//编号索引中的行数
+int lazyIndexedCount(const LazyCatalog* catalog)
+{
+    return catalog->indexed;
+}
+
+//编号索引是否读取自索引文件
+int lazyIndexLoaded(const LazyCatalog* catalog)
+{
+    return catalog->indexLoaded;
+}
+
+//映射文件和建立或读取编号索引的耗时
+double lazyIndexMs(const LazyCatalog* catalog)
+{
+    return catalog->indexMs;
+}
+
+//后台完整加载的耗时
+double lazyLoadMs(const LazyCatalog* catalog)
+{
+    return catalog->ready ? catalog->loadMs : 0;
+}
+
+//比较两件商品的各字段
+static int sameLazyGoods(const Goods* a, const Goods* b)
+{
+    return strcmp(a->id, b->id) == 0 && strcmp(a->name, b->name) == 0 && strcmp(a->brand, b->brand) == 0
+        && a->category == b->category && a->price == b->price && a->stock == b->stock;
+}
+
+//核对全部编号和一个不存在的编号在延迟目录和完整加载的管理器中的查找结果
+static int checkLazyLookups(LazyCatalog* catalog, GoodsManager* manager, const int* slots, int count)
+{
+    int identical = 1;
+    for (int i = 0; i < count && identical; i++)
+    {
+        const char* id = STORE_COLD(&manager->store, slots[i])->id;
+        Goods lazyGoods, expected;
+        identical = findGoodsById(manager, id, &expected) && lazyFindGoods(catalog, id, &lazyGoods)
+                 && sameLazyGoods(&lazyGoods, &expected);
+    }
+    Goods goods;
+    return identical && !lazyFindGoods(catalog, "#no-such-id", &goods);
+}
+
+//测量到第一次查询的耗时
+//功能：先完整加载一次作为对照(加载+一次查找)，再删除索引文件后延迟加载(扫描建立编号索引并保存+一次查找)；
+//      之后测量lookups次随机查找首次访问和再次访问的耗时，等待后台加载结束，
+//      然后再次延迟加载，这次读取上一步保存的索引文件；
+//      核对全部编号和一个不存在的编号在各种方式下的查找结果
+//返回：结果一致返回1，否则返回0
+int runLazyBenchmark(const char* filename, int lookups)
+{
+    if (lookups <= 0)
+    {
+        lookups = 100000;
+    }
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ms = 1000.0 / (double)frequency.QuadPart;
+
+    //完整加载
+    long long start = lazyNow();
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL || !loadFromFile(manager, filename))
+    {
+        printf("Failed to load %s.\n", filename);
+        freeGoodsManager(manager);
+        return 0;
+    }
+    int* slots = (int*)malloc((size_t)manager->count * sizeof(int));
+    int count = slots != NULL ? prefixSearch(&manager->idPrefix, "", slots, manager->count) : 0;
+    const char* firstId = count > 0 ? STORE_COLD(&manager->store, slots[count / 2])->id : "";
+    Goods expected;
+    findGoodsById(manager, firstId, &expected);
+    long long eagerTicks = lazyNow() - start;
+
+    //延迟加载，删除索引文件以测量重建
+    char indexName[MAX_PATH + 8];
+    lazyIndexName(filename, indexName, sizeof(indexName));
+    remove(indexName);
+    start = lazyNow();
+    LazyCatalog* catalog = openLazyCatalog(filename);
+    Goods goods;
+    int identical = catalog != NULL && lazyFindGoods(catalog, firstId, &goods) && sameLazyGoods(&goods, &expected);
+    long long lazyTicks = lazyNow() - start;
+    if (catalog == NULL || count == 0)
+    {
+        printf("Failed to open %s lazily.\n", filename);
+        closeLazyCatalog(catalog);
+        free(slots);
+        freeGoodsManager(manager);
+        return 0;
+    }
+
+    //随机查找：首次访问需要解析，再次访问读缓存
+    long long ticks[2];
+    for (int pass = 0; pass < 2; pass++)
+    {
+        unsigned int seed = 2024;
+        start = lazyNow();
+        for (int i = 0; i < lookups; i++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            identical &= lazyFindGoods(catalog, STORE_COLD(&manager->store, slots[(seed >> 8) % (unsigned int)count])->id, &goods);
+        }
+        ticks[pass] = lazyNow() - start;
+    }
+    start = lazyNow();
+    GoodsManager* full = takeLazyManager(catalog);
+    long long waitTicks = lazyNow() - start;
+
+    printf("\n=== Lazy Loading Benchmark (%d products) ===\n", manager->count);
+    printf("Time to first query, full load:  %8.2f ms\n", eagerTicks * ms);
+    printf("Time to first query, lazy load:  %8.2f ms (ID index over %d lines built and saved in %.2f ms)\n",
+           lazyTicks * ms, lazyIndexedCount(catalog), lazyIndexMs(catalog));
+    printf("Lookup, first access (decode):   %8.0f ns\n", ticks[0] * ms * 1e6 / lookups);
+    printf("Lookup, cached:                  %8.0f ns\n", ticks[1] * ms * 1e6 / lookups);
+    printf("Background full load: %.0f ms (%.0f ms still to wait after the lookups)\n", lazyLoadMs(catalog), waitTicks * ms);
+
+    //核对：全部编号在延迟目录、后台加载的管理器和完整加载的管理器中结果相同
+    identical &= full != NULL && full->count == manager->count && checkLazyLookups(catalog, manager, slots, count);
+    for (int i = 0; i < count && identical; i++)
+    {
+        const char* id = STORE_COLD(&manager->store, slots[i])->id;
+        Goods fullGoods;
+        findGoodsById(manager, id, &expected);
+        identical &= findGoodsById(full, id, &fullGoods) && sameLazyGoods(&fullGoods, &expected);
+    }
+    freeGoodsManager(full);
+    closeLazyCatalog(catalog);
+
+    //再次延迟加载：读取刚保存的索引文件
+    findGoodsById(manager, firstId, &expected);
+    start = lazyNow();
+    catalog = openLazyCatalog(filename);
+    identical &= catalog != NULL && lazyIndexLoaded(catalog) && lazyFindGoods(catalog, firstId, &goods)
+              && sameLazyGoods(&goods, &expected);
+    long long savedTicks = lazyNow() - start;
+    if (catalog != NULL)
+    {
+        printf("Time to first query, saved index:%8.2f ms (index file %s in %.2f ms)\n", savedTicks * ms,
+               lazyIndexLoaded(catalog) ? "mapped and checked" : "was not usable, rebuilt", lazyIndexMs(catalog));
+        identical &= checkLazyLookups(catalog, manager, slots, count);
+    }
+    closeLazyCatalog(catalog);
+    free(slots);
+    freeGoodsManager(manager);
+    printf(identical ? "Lazy lookups match the fully loaded catalog.\n" : "MISMATCH: lazy lookups differ from the full load!\n");
+    return identical;
+}
@@ -0,0 +1,34 @@
+#ifndef LAZY_H
+#define LAZY_H
+
+#include "goods.h"
+
+// 延迟加载(快速启动)
+// 打开时只读映射文本数据文件，扫描一遍每行的第一个字段建立编号索引(编号哈希值 + 行号)，不解析其余字段，
+// 因此第一次查询之前的等待只有一遍按行扫描。按编号查找时才解析命中的行，解析结果按页缓存，再次访问直接返回。
+// 同一编号出现在多行时与loadFromFile相同：取第一条有效的行。
+// 打开的同时后台线程用loadFromFile完整加载一个管理器(名称前缀、词索引、补货集合等全部索引)，
+// 完成后由调用者取走，之后全部功能改用完整的管理器。压缩格式的文件没有可以直接定位的行，只做后台完整加载，
+// 查找等待加载完成。延迟目录只读，查找和取走管理器由同一个线程调用。
+// 编号索引(行偏移和哈希表)保存在数据文件旁的索引文件中，文件中只有偏移和行号，不含指针。下次打开时直接只读映射，
+// 检查格式版本、校验和以及建立索引时数据文件的大小、最后修改时间和开头结尾各64KB的校验和，全部相符就不再扫描数据文件；
+// 数据文件保存后其中任何一项改变，索引即过期，下次打开时自动重建并覆盖索引文件。
+#define LAZY_INDEX_SUFFIX ".idx"       // 索引文件名为数据文件名加此后缀
+#define LAZY_INDEX_MAGIC 0x58444947u   // 索引文件标识"GIDX"
+#define LAZY_INDEX_FORMAT 2            // 索引文件格式版本
+
+typedef struct LazyCatalog LazyCatalog; // 延迟加载的目录(内部结构)
+
+// 延迟加载函数声明
+LazyCatalog *openLazyCatalog(const char *filename);                         // 映射数据文件、建立编号索引并开始后台完整加载，文件无法打开返回NULL
+int lazyFindGoods(LazyCatalog *catalog, const char *id, Goods *result);     // 按编号查找，首次访问时解析该行，找到返回1
+int lazyCatalogReady(LazyCatalog *catalog);                                 // 后台完整加载是否已结束(不等待)
+GoodsManager *takeLazyManager(LazyCatalog *catalog);                        // 等待后台加载结束并取走完整的管理器，加载失败返回NULL
+void closeLazyCatalog(LazyCatalog *catalog);                                // 等待后台线程结束，释放未取走的管理器并解除映射
+int lazyIndexedCount(const LazyCatalog *catalog);                           // 编号索引中的行数
+int lazyIndexLoaded(const LazyCatalog *catalog);                            // 编号索引是否读取自索引文件(否则为本次扫描建立)
+double lazyIndexMs(const LazyCatalog *catalog);                             // 映射文件和建立或读取编号索引的耗时(毫秒)
+double lazyLoadMs(const LazyCatalog *catalog);                              // 后台完整加载的耗时(毫秒)，尚未结束时返回0
+int runLazyBenchmark(const char *filename, int lookups);                    // 对比完整加载、重建索引和读取索引文件到第一次查询的耗时，并核对查找结果
+
+#endif
@@ -0,0 +1,599 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#include "loadgen.h"
+#include "protocol.h"
+#include <stdlib.h>
+
+#pragma comment(lib, "ws2_32.lib")
+
+#define BATCH_ITEM_MAX 26          // 批量请求中单个条目的最大字节数(长度1 + ID 19 + 增量4，留有余量)
+#define PIPELINE_BYTES_MAX 65536   // 每轮连续发送的请求字节数上限，保证发送能完整放入套接字缓冲区，
+                                   // 否则客户端阻塞在发送而服务端阻塞在回复时会互相等待
+
+// 单个压力测试线程的状态和结果
+typedef struct
+{
+    const LoadConfig *config;   // 测试配置
+    char (*ids)[20];            // 可选的商品ID
+    int idCount;                // 商品ID数量
+    unsigned int seed;          // 随机数种子
+    long long *latencies;       // 每帧的往返时间(计时器刻度)
+    int frames;                 // 完成的帧数
+    int operations;             // 完成的操作数
+    int notFound;               // 返回未找到的操作数
+    int rejected;               // 被拒绝的调整操作数
+    int failed;                 // 连接或协议错误数
+} LoadWorker;
+
+// 压力测试汇总结果
+typedef struct
+{
+    int operations;     // 完成的操作数
+    int frames;         // 完成的帧数
+    int notFound;       // 未找到的操作数
+    int rejected;       // 被拒绝的操作数
+    int failed;         // 错误数
+    double seconds;     // 总耗时(秒)
+    double p50;         // 帧延迟百分位数(微秒)
+    double p90;
+    double p99;
+    double p999;
+    double max;
+} LoadSummary;
+
+//读取高精度计时器
+static long long loadNow()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+//线程内的伪随机数(xorshift)
+static unsigned int nextRandom(unsigned int* state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+//读取数据文件中的商品ID
+//返回：ID数量，失败返回0
+static int loadIds(const char* filename, char (**ids)[20])
+{
+    FILE* file;
+    if (fopen_s(&file, filename, "r") != 0 || file == NULL)
+    {
+        return 0;
+    }
+
+    char line[512];
+    int count = 0;
+    int capacity = 0;
+    char (*list)[20] = NULL;
+    while (fgets(line, sizeof(line), file))
+    {
+        char id[20];
+        unsigned int crc;
+        if (parseChecksumLine(line, &crc) != 0 || sscanf_s(line, "%19s", id, (unsigned)sizeof(id)) != 1)
+        {
+            continue;  //空行或最后的校验和行
+        }
+        if (count == capacity)
+        {
+            capacity = capacity == 0 ? 1024 : capacity * 2;
+            char (*grown)[20] = (char (*)[20])realloc(list, (size_t)capacity * sizeof(*list));
+            if (grown == NULL)
+            {
+                break;
+            }
+            list = grown;
+        }
+        strcpy_s(list[count], sizeof(list[count]), id);
+        count++;
+    }
+    fclose(file);
+    *ids = list;
+    return count;
+}
+
+//连接服务
+static SOCKET connectServer(const char* path)
+{
+    SOCKADDR_UN address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy_s(address.sun_path, sizeof(address.sun_path), path, _TRUNCATE);
+
+    SOCKET client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client == INVALID_SOCKET)
+    {
+        return INVALID_SOCKET;
+    }
+    if (connect(client, (const struct sockaddr*)&address, sizeof(address)) == SOCKET_ERROR)
+    {
+        closesocket(client);
+        return INVALID_SOCKET;
+    }
+    return client;
+}
+
+//发送全部数据
+static int sendAll(SOCKET socket, const unsigned char* data, size_t length)
+{
+    while (length > 0)
+    {
+        int sent = send(socket, (const char*)data, (int)length, 0);
+        if (sent <= 0)
+        {
+            return 0;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 1;
+}
+
+//接收指定字节数
+static int recvAll(SOCKET socket, unsigned char* data, size_t length)
+{
+    while (length > 0)
+    {
+        int received = recv(socket, (char*)data, (int)length, 0);
+        if (received <= 0)
+        {
+            return 0;
+        }
+        data += received;
+        length -= (size_t)received;
+    }
+    return 1;
+}
+
+//构造一个请求帧
+//功能：items为1且未启用批量时发送单条查找/调整请求，否则发送批量请求；同一帧内的操作类型相同
+//参数：out - 输出缓冲区，items - 本帧操作数，requestId - 请求编号，delta - 调整增量(正负交替)
+//返回：帧的总字节数
+static size_t buildFrame(LoadWorker* worker, unsigned char* out, int items, unsigned int requestId, int* delta)
+{
+    const LoadConfig* config = worker->config;
+    int batched = config->batchSize > 1;
+    int adjust = (int)(nextRandom(&worker->seed) % 100) < config->adjustPercent;
+    ProtoBuffer payload;
+    ProtoHeader header;
+
+    protoBufferInit(&payload, out + PROTO_HEADER_SIZE, (size_t)items * BATCH_ITEM_MAX);
+    for (int i = 0; i < items; i++)
+    {
+        protoPutString(&payload, worker->ids[nextRandom(&worker->seed) % (unsigned int)worker->idCount]);
+        if (adjust)
+        {
+            protoPutI32(&payload, *delta);
+            *delta = -*delta;
+        }
+    }
+    if (batched)
+    {
+        header.op = (unsigned char)(adjust ? PROTO_OP_BATCH_ADJUST : PROTO_OP_BATCH_FIND);
+    }
+    else
+    {
+        header.op = (unsigned char)(adjust ? PROTO_OP_ADJUST_STOCK : PROTO_OP_FIND_BY_ID);
+    }
+    header.length = (unsigned int)payload.pos;
+    header.status = 0;
+    header.count = (unsigned short)(batched ? items : 0);
+    header.requestId = requestId;
+    protoEncodeHeader(out, &header);
+    return PROTO_HEADER_SIZE + payload.pos;
+}
+
+//统计一个响应帧中各操作的结果
+//返回：响应格式正确返回1，否则返回0
+static int countReply(LoadWorker* worker, const ProtoHeader* reply, unsigned char* payload)
+{
+    if (reply->op != PROTO_OP_BATCH_FIND && reply->op != PROTO_OP_BATCH_ADJUST)
+    {
+        worker->operations++;
+        worker->notFound += reply->status == PROTO_NOT_FOUND;
+        worker->rejected += reply->status == PROTO_REJECTED;
+        return reply->status == PROTO_OK || reply->status == PROTO_NOT_FOUND || reply->status == PROTO_REJECTED;
+    }
+    if (reply->status != PROTO_OK)
+    {
+        return 0;
+    }
+
+    ProtoBuffer in;
+    Goods goods;
+    protoBufferInit(&in, payload, reply->length);
+    for (int i = 0; i < reply->count; i++)
+    {
+        unsigned char status = protoGetU8(&in);
+        if (reply->op == PROTO_OP_BATCH_ADJUST)
+        {
+            protoGetI32(&in);
+        }
+        else if (status == PROTO_OK)
+        {
+            protoGetGoods(&in, &goods);
+        }
+        worker->notFound += status == PROTO_NOT_FOUND;
+        worker->rejected += status == PROTO_REJECTED;
+    }
+    worker->operations += reply->count;
+    return !in.overflow && in.pos == in.size;
+}
+
+//压力测试线程
+//功能：每轮连续发送pipelineDepth帧后依次读取响应，每帧的延迟从本轮发送开始计算；
+//      调整请求的增量正负交替，使总库存基本不变
+static DWORD WINAPI loadWorkerMain(LPVOID param)
+{
+    LoadWorker* worker = (LoadWorker*)param;
+    const LoadConfig* config = worker->config;
+    int batch = config->batchSize;
+    int depth = config->pipelineDepth;
+    size_t frameMax = PROTO_HEADER_SIZE + (size_t)batch * BATCH_ITEM_MAX;
+    unsigned char* request = (unsigned char*)malloc((size_t)depth * frameMax);
+    unsigned char* response = (unsigned char*)malloc(PROTO_HEADER_SIZE + PROTO_MAX_PAYLOAD);
+    SOCKET client = connectServer(config->socketPath);
+    if (client == INVALID_SOCKET || request == NULL || response == NULL)
+    {
+        worker->failed++;
+        free(request);
+        free(response);
+        if (client != INVALID_SOCKET)
+        {
+            closesocket(client);
+        }
+        return 1;
+    }
+
+    int delta = 1;
+    int remaining = config->requests;
+    unsigned int nextId = 0;
+    while (remaining > 0 && worker->failed == 0)
+    {
+        //构造本轮的所有帧
+        size_t length = 0;
+        int frames = 0;
+        while (frames < depth && remaining > 0)
+        {
+            int items = remaining < batch ? remaining : batch;
+            length += buildFrame(worker, request + length, items, nextId + (unsigned int)frames, &delta);
+            remaining -= items;
+            frames++;
+        }
+
+        //一次发送后按顺序读取响应
+        long long start = loadNow();
+        if (!sendAll(client, request, length))
+        {
+            worker->failed++;
+            break;
+        }
+        for (int f = 0; f < frames; f++)
+        {
+            ProtoHeader reply;
+            if (!recvAll(client, response, PROTO_HEADER_SIZE))
+            {
+                worker->failed++;
+                break;
+            }
+            protoDecodeHeader(response, &reply);
+            if (reply.length > PROTO_MAX_PAYLOAD ||
+                !recvAll(client, response + PROTO_HEADER_SIZE, reply.length) ||
+                reply.requestId != nextId + (unsigned int)f ||
+                !countReply(worker, &reply, response + PROTO_HEADER_SIZE))
+            {
+                worker->failed++;
+                break;
+            }
+            worker->latencies[worker->frames++] = loadNow() - start;
+        }
+        nextId += (unsigned int)frames;
+    }
+
+    closesocket(client);
+    free(request);
+    free(response);
+    return 0;
+}
+
+//延迟比较函数
+static int compareLatency(const void* a, const void* b)
+{
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+//取已排序数组的百分位数(微秒)
+static double percentileMicros(const long long* sorted, int count, double percent, double ticksPerMicro)
+{
+    int index = (int)(percent / 100.0 * (count - 1) + 0.5);
+    return (double)sorted[index] / ticksPerMicro;
+}
+
+//执行一次压力测试
+//功能：启动config->connections个线程并发发送请求，等待全部完成后汇总结果
+//参数：ids,idCount - 可选的商品ID，summary - 输出汇总结果
+//返回：全部线程启动且无错误返回1，否则返回0
+static int runLoad(const LoadConfig* config, char (*ids)[20], int idCount, LoadSummary* summary)
+{
+    int threadCount = config->connections;
+    int framesPerConnection = (config->requests + config->batchSize - 1) / config->batchSize;
+    LoadWorker* workers = (LoadWorker*)calloc((size_t)threadCount, sizeof(LoadWorker));
+    HANDLE* threads = (HANDLE*)calloc((size_t)threadCount, sizeof(HANDLE));
+    long long* latencies = (long long*)malloc((size_t)threadCount * framesPerConnection * sizeof(long long));
+    memset(summary, 0, sizeof(*summary));
+    if (workers == NULL || threads == NULL || latencies == NULL)
+    {
+        printf("Memory allocation failed!\n");
+        free(workers);
+        free(threads);
+        free(latencies);
+        return 0;
+    }
+
+    long long start = loadNow();
+    int started = 0;
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers[i].config = config;
+        workers[i].ids = ids;
+        workers[i].idCount = idCount;
+        workers[i].seed = 2463534242u + 7919u * (unsigned int)i;
+        workers[i].latencies = latencies + (size_t)i * framesPerConnection;
+        threads[i] = CreateThread(NULL, 0, loadWorkerMain, &workers[i], 0, NULL);
+        if (threads[i] == NULL)
+        {
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; i++)
+    {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+    long long elapsed = loadNow() - start;
+
+    //汇总：把各线程的延迟压缩到数组前部后统一排序
+    for (int i = 0; i < started; i++)
+    {
+        memmove(latencies + summary->frames, workers[i].latencies, (size_t)workers[i].frames * sizeof(long long));
+        summary->frames += workers[i].frames;
+        summary->operations += workers[i].operations;
+        summary->notFound += workers[i].notFound;
+        summary->rejected += workers[i].rejected;
+        summary->failed += workers[i].failed;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ticksPerMicro = (double)frequency.QuadPart / 1000000.0;
+    summary->seconds = (double)elapsed / (double)frequency.QuadPart;
+    if (summary->frames > 0)
+    {
+        qsort(latencies, summary->frames, sizeof(long long), compareLatency);
+        summary->p50 = percentileMicros(latencies, summary->frames, 50.0, ticksPerMicro);
+        summary->p90 = percentileMicros(latencies, summary->frames, 90.0, ticksPerMicro);
+        summary->p99 = percentileMicros(latencies, summary->frames, 99.0, ticksPerMicro);
+        summary->p999 = percentileMicros(latencies, summary->frames, 99.9, ticksPerMicro);
+        summary->max = (double)latencies[summary->frames - 1] / ticksPerMicro;
+    }
+
+    free(workers);
+    free(threads);
+    free(latencies);
+    return started == threadCount && summary->failed == 0;
+}
+
+//检查配置并读取商品ID、初始化Winsock
+//返回：商品ID数量，失败返回0
+static int prepareLoad(const LoadConfig* config, char (**ids)[20])
+{
+    *ids = NULL;
+    if (config == NULL || config->connections <= 0 || config->requests <= 0 ||
+        config->batchSize <= 0 || config->batchSize > PROTO_MAX_BATCH || config->pipelineDepth <= 0)
+    {
+        printf("Invalid load configuration.\n");
+        return 0;
+    }
+    if ((size_t)config->pipelineDepth * (PROTO_HEADER_SIZE + (size_t)config->batchSize * BATCH_ITEM_MAX) > PIPELINE_BYTES_MAX)
+    {
+        printf("Pipeline depth x batch size is too large (at most %d request bytes per round).\n", PIPELINE_BYTES_MAX);
+        return 0;
+    }
+
+    int idCount = loadIds(config->idFile, ids);
+    if (idCount == 0)
+    {
+        printf("No product IDs found in %s.\n", config->idFile);
+        free(*ids);
+        *ids = NULL;
+        return 0;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        printf("Failed to initialize Winsock.\n");
+        free(*ids);
+        *ids = NULL;
+        return 0;
+    }
+    return idCount;
+}
+
+//运行压力测试
+//功能：按配置并发发送请求，完成后显示吞吐量和每帧延迟分布
+//返回：成功返回1，失败返回0
+int runLoadGenerator(const LoadConfig* config)
+{
+    char (*ids)[20];
+    int idCount = prepareLoad(config, &ids);
+    if (idCount == 0)
+    {
+        return 0;
+    }
+
+    printf("Running %d connections x %d operations against %s (%d IDs, %d%% adjustments, batch %d, pipeline %d)...\n",
+           config->connections, config->requests, config->socketPath, idCount,
+           config->adjustPercent, config->batchSize, config->pipelineDepth);
+
+    LoadSummary summary;
+    int ok = runLoad(config, ids, idCount, &summary);
+    printf("\nOperations: %d  Frames: %d  Not found: %d  Rejected: %d  Errors: %d\n",
+           summary.operations, summary.frames, summary.notFound, summary.rejected, summary.failed);
+    if (summary.frames > 0)
+    {
+        printf("Elapsed: %.3f s  Throughput: %.0f operations/s (%.0f frames/s)\n",
+               summary.seconds, summary.operations / summary.seconds, summary.frames / summary.seconds);
+        printf("Frame latency (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+               summary.p50, summary.p90, summary.p99, summary.p999, summary.max);
+    }
+
+    free(ids);
+    WSACleanup();
+    return ok;
+}
+
+//对比逐条请求与批量请求
+//功能：在单个连接上分别以一问一答的逐条请求和config->batchSize条的批量请求执行相同数量的操作，
+//      显示两者的吞吐量和加速比
+//返回：成功返回1，失败返回0
+int runBatchBenchmark(const LoadConfig* config)
+{
+    char (*ids)[20];
+    int idCount = prepareLoad(config, &ids);
+    if (idCount == 0)
+    {
+        return 0;
+    }
+
+    LoadConfig single = *config;
+    LoadConfig batched = *config;
+    single.connections = 1;
+    single.batchSize = 1;
+    single.pipelineDepth = 1;
+    batched.connections = 1;
+
+    printf("Batch benchmark: %d operations, %d%% adjustments, batch %d, pipeline %d\n",
+           config->requests, config->adjustPercent, config->batchSize, config->pipelineDepth);
+
+    LoadSummary singleSummary;
+    LoadSummary batchedSummary;
+    int ok = runLoad(&single, ids, idCount, &singleSummary) &&
+             runLoad(&batched, ids, idCount, &batchedSummary);
+    if (ok)
+    {
+        double singleRate = singleSummary.operations / singleSummary.seconds;
+        double batchedRate = batchedSummary.operations / batchedSummary.seconds;
+        printf("\n%-10s  %10s  %14s  %12s  %12s\n", "Mode", "Frames", "Operations/s", "p50 (us)", "p99 (us)");
+        printf("----------  ----------  --------------  ------------  ------------\n");
+        printf("%-10s  %10d  %14.0f  %12.1f  %12.1f\n", "Unbatched", singleSummary.frames, singleRate,
+               singleSummary.p50, singleSummary.p99);
+        printf("%-10s  %10d  %14.0f  %12.1f  %12.1f\n", "Batched", batchedSummary.frames, batchedRate,
+               batchedSummary.p50, batchedSummary.p99);
+        printf("Speedup: %.1fx\n", batchedRate / singleRate);
+    }
+    else
+    {
+        printf("Benchmark failed: server unreachable or protocol error.\n");
+    }
+
+    free(ids);
+    WSACleanup();
+    return ok;
+}
+
+//发送一次前缀查询
+//功能：按编号或名称前缀向查询服务请求最多limit条商品，显示结果和往返时间
+//返回：成功返回1，失败返回0
+int runSuggestQuery(const char* socketPath, int byName, const char* prefix, int limit)
+{
+    if (limit < 1 || limit > PROTO_MAX_SUGGEST)
+    {
+        limit = 10;
+    }
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        printf("Failed to initialize Winsock.\n");
+        return 0;
+    }
+    SOCKET client = connectServer(socketPath);
+    if (client == INVALID_SOCKET)
+    {
+        printf("Cannot connect to %s.\n", socketPath);
+        WSACleanup();
+        return 0;
+    }
+
+    unsigned char request[PROTO_HEADER_SIZE + 256];
+    ProtoBuffer out;
+    protoBufferInit(&out, request + PROTO_HEADER_SIZE, sizeof(request) - PROTO_HEADER_SIZE);
+    protoPutU8(&out, (unsigned char)(byName ? PREFIX_BY_NAME : PREFIX_BY_ID));
+    protoPutU8(&out, (unsigned char)limit);
+    protoPutString(&out, prefix);
+    ProtoHeader header = { (unsigned int)out.pos, PROTO_OP_SUGGEST, PROTO_OK, 0, 1 };
+    protoEncodeHeader(request, &header);
+
+    unsigned char* payload = (unsigned char*)malloc(PROTO_MAX_PAYLOAD);
+    unsigned char replyHeader[PROTO_HEADER_SIZE];
+    ProtoHeader reply;
+    long long start = loadNow();
+    int ok = payload != NULL && !out.overflow
+          && sendAll(client, request, PROTO_HEADER_SIZE + out.pos)
+          && recvAll(client, replyHeader, sizeof(replyHeader));
+    if (ok)
+    {
+        protoDecodeHeader(replyHeader, &reply);
+        ok = reply.length <= PROTO_MAX_PAYLOAD && recvAll(client, payload, reply.length);
+    }
+    long long elapsed = loadNow() - start;
+    closesocket(client);
+
+    if (ok && reply.status != PROTO_OK)
+    {
+        printf("Server replied: %s\n", protoStatusToString((ProtoStatus)reply.status));
+        ok = 0;
+    }
+    else if (ok)
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        Goods* results = (Goods*)malloc((reply.count > 0 ? reply.count : 1) * sizeof(Goods));
+        ProtoBuffer in;
+        protoBufferInit(&in, payload, reply.length);
+        for (int i = 0; results != NULL && i < reply.count; i++)
+        {
+            protoGetGoods(&in, &results[i]);
+        }
+        ok = results != NULL && !in.overflow;
+        if (ok)
+        {
+            char title[128];
+            sprintf_s(title, sizeof(title), "%s prefix \"%s\"", byName ? "Name" : "ID", prefix);
+            displayGoodsList(results, reply.count, title);
+            printf("%d matches in %.1f us\n", reply.count, (double)elapsed * 1000000.0 / (double)frequency.QuadPart);
+        }
+        free(results);
+    }
+    else
+    {
+        printf("Request failed: connection lost.\n");
+    }
+    free(payload);
+    WSACleanup();
+    return ok;
+}
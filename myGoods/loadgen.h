@@ -0,0 +1,23 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+// 压力测试配置
+typedef struct
+{
+    const char *socketPath; // 服务套接字路径
+    const char *idFile;     // 从中读取商品ID的数据文件(每行第一列)
+    int connections;        // 并发连接数，每个连接一个线程
+    int requests;           // 每个连接执行的操作数
+    int adjustPercent;      // 调整库存请求所占百分比，其余为按ID查找
+    int batchSize;          // 每帧携带的操作数，1表示逐条请求，大于1时使用批量操作码
+    int pipelineDepth;      // 每个连接连续发送后再等待响应的帧数，1表示一问一答
+} LoadConfig;
+
+// 压力测试函数声明
+// 每个线程在自己的连接上发送请求并等待响应，记录每帧的往返时间，
+// 结束后汇总吞吐量和延迟百分位数
+int runLoadGenerator(const LoadConfig *config);  // 运行压力测试，成功返回1
+int runBatchBenchmark(const LoadConfig *config); // 在单个连接上对比逐条请求与批量请求，成功返回1
+int runSuggestQuery(const char *socketPath, int byName, const char *prefix, int limit); // 发送一次前缀查询并显示结果，成功返回1
+
+#endif
@@ -0,0 +1,350 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "loadindex.h"
+#include "crc32c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+
+// 前缀索引在文件头中的记录，之后依次是nodeCount个节点、valueCount个值和labelSize字节的标签
+typedef struct
+{
+    int nodeCount;    // 节点数(含空闲节点)
+    int valueCount;   // 值数(含空闲项)
+    int labelSize;    // 标签池字节数
+    int freeNodes;    // 空闲节点链表
+    int freeValues;   // 空闲值链表
+    int labelGarbage; // 标签池中已废弃的字节数
+    int keyCount;     // 键值对数
+} LoadPrefixHeader;
+
+// 索引文件头，其后依次是lineCount字节的处理结果、indexSize个编号索引项和三个前缀索引的数组
+typedef struct
+{
+    unsigned int magic;          // 文件标识
+    unsigned int format;         // 格式版本
+    int lineCount;               // 数据文件的行数
+    int count;                   // 加入的商品数
+    int indexSize;               // 编号索引槽数(0或2的幂)
+    int indexUsed;               // 编号索引中已使用的项数
+    LoadPrefixHeader prefix[3];  // 编号、名称和词前缀索引
+    unsigned int dataCrc;        // 建立索引时数据文件全部行的校验和
+    unsigned long long dataSize; // 建立索引时数据文件的字节数
+    unsigned long long dataTime; // 建立索引时数据文件的最后修改时间(FILETIME)
+    unsigned int bodyCrc;        // 文件头之后全部内容的校验和
+    unsigned int headerCrc;      // 文件头前面各字段的校验和
+} LoadIndexHeader;
+
+//生成索引文件名
+static void loadIndexName(const char* filename, char* name, size_t size)
+{
+    sprintf_s(name, size, "%s%s", filename, LOAD_INDEX_SUFFIX);
+}
+
+//取得数据文件的大小和修改时间
+//返回：成功返回1，文件无法打开返回0
+int stampDataFile(const char* filename, LoadStamp* stamp)
+{
+    memset(stamp, 0, sizeof(*stamp));
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return 0;
+    }
+    LARGE_INTEGER size;
+    FILETIME written;
+    int ok = GetFileSizeEx(file, &size) && GetFileTime(file, NULL, NULL, &written);
+    CloseHandle(file);
+    if (ok)
+    {
+        stamp->size = (unsigned long long)size.QuadPart;
+        stamp->time = ((unsigned long long)written.dwHighDateTime << 32) | written.dwLowDateTime;
+    }
+    return ok;
+}
+
+//读取一个数组并累计校验和
+//返回：读满返回1，文件过短返回0
+static int readLoadArray(FILE* file, void* data, size_t bytes, unsigned int* crc)
+{
+    if (bytes == 0)
+    {
+        return 1;
+    }
+    if (fread(data, 1, bytes, file) != bytes)
+    {
+        return 0;
+    }
+    *crc = crc32c(*crc, data, bytes);
+    return 1;
+}
+
+//读取一个前缀索引
+//功能：数组按实际长度分配，容量等于长度，之后插入时按需扩大；读完后检查结构
+//返回：成功返回1，失败返回0(已分配的数组留在index中，由调用者释放)
+static int readLoadPrefix(FILE* file, const LoadPrefixHeader* header, PrefixIndex* index, int slotLimit, unsigned int* crc)
+{
+    if (header->nodeCount < 0 || header->valueCount < 0 || header->labelSize < 0)
+    {
+        return 0;
+    }
+    size_t nodeBytes = (size_t)header->nodeCount * sizeof(PrefixNode);
+    size_t valueBytes = (size_t)header->valueCount * sizeof(PrefixValue);
+    index->nodes = (PrefixNode*)malloc(nodeBytes > 0 ? nodeBytes : 1);
+    index->values = (PrefixValue*)malloc(valueBytes > 0 ? valueBytes : 1);
+    index->labels = (char*)malloc(header->labelSize > 0 ? (size_t)header->labelSize : 1);
+    if (index->nodes == NULL || index->values == NULL || index->labels == NULL)
+    {
+        return 0;
+    }
+    index->nodeCount = index->nodeCapacity = header->nodeCount;
+    index->valueCount = index->valueCapacity = header->valueCount;
+    index->labelSize = index->labelCapacity = header->labelSize;
+    index->freeNodes = header->freeNodes;
+    index->freeValues = header->freeValues;
+    index->labelGarbage = header->labelGarbage;
+    index->keyCount = header->keyCount;
+    return readLoadArray(file, index->nodes, nodeBytes, crc)
+        && readLoadArray(file, index->values, valueBytes, crc)
+        && readLoadArray(file, index->labels, (size_t)header->labelSize, crc)
+        && checkPrefixIndex(index, slotLimit);
+}
+
+//读取索引文件
+//功能：检查标识、格式版本、文件头校验和，以及建立索引时数据文件的大小、修改时间、全部行的校验和与行数，
+//      全部相符才读入各数组；读完后核对数据部分的校验和和文件长度，前缀索引另外检查结构
+//返回：索引有效返回1；文件不存在、损坏或已过期返回0，saved保持为空
+int readLoadIndex(const char* filename, const LoadStamp* stamp, LoadIndex* saved)
+{
+    memset(saved, 0, sizeof(*saved));
+    initPrefixIndex(&saved->idPrefix);
+    initPrefixIndex(&saved->namePrefix);
+    initPrefixIndex(&saved->words);
+
+    char name[MAX_PATH + 8];
+    loadIndexName(filename, name, sizeof(name));
+    FILE* file = NULL;
+    if (fopen_s(&file, name, "rb") != 0 || file == NULL)
+    {
+        return 0;
+    }
+    LoadIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    int valid = fread(&header, sizeof(header), 1, file) == 1
+             && header.magic == LOAD_INDEX_MAGIC && header.format == LOAD_INDEX_FORMAT
+             && header.headerCrc == crc32c(0, &header, offsetof(LoadIndexHeader, headerCrc))
+             && header.dataSize == stamp->size && header.dataTime == stamp->time
+             && header.dataCrc == stamp->crc && header.lineCount == stamp->lineCount
+             && header.count >= 0 && header.count <= header.lineCount && header.count < INT_MAX / 2
+             && header.indexUsed == header.count
+             && (header.indexSize == 0 ? header.count == 0
+                                       : header.indexSize > 0 && (header.indexSize & (header.indexSize - 1)) == 0
+                                         && header.indexUsed < header.indexSize);
+    if (valid)
+    {
+        saved->lineCount = header.lineCount;
+        saved->count = header.count;
+        saved->indexSize = header.indexSize;
+        saved->indexUsed = header.indexUsed;
+        saved->lines = (unsigned char*)malloc((size_t)header.lineCount + 1);
+        saved->index = (GoodsIndexEntry*)malloc((size_t)header.indexSize * sizeof(GoodsIndexEntry) + 1);
+        unsigned int crc = 0;
+        valid = saved->lines != NULL && saved->index != NULL
+             && readLoadArray(file, saved->lines, (size_t)header.lineCount, &crc)
+             && readLoadArray(file, saved->index, (size_t)header.indexSize * sizeof(GoodsIndexEntry), &crc)
+             && readLoadPrefix(file, &header.prefix[0], &saved->idPrefix, header.count, &crc)
+             && readLoadPrefix(file, &header.prefix[1], &saved->namePrefix, header.count, &crc)
+             && readLoadPrefix(file, &header.prefix[2], &saved->words, header.count * 2, &crc)  //词索引的值为槽位号*2+字段
+             && fgetc(file) == EOF && crc == header.bodyCrc;
+    }
+    fclose(file);
+
+    //处理结果中加入的行数必须等于商品数
+    int added = 0;
+    for (int i = 0; valid && i < header.lineCount; i++)
+    {
+        valid = saved->lines[i] <= LOAD_LINE_DUPLICATE;
+        added += saved->lines[i] == LOAD_LINE_ADDED;
+    }
+    if (!valid || added != saved->count)
+    {
+        freeLoadIndex(saved);
+        return 0;
+    }
+    return 1;
+}
+
+//核对编号索引
+//功能：每个已用项的槽位在范围内且只出现一次，哈希值与存放的商品相同，并且从哈希值对应的起始位置
+//      到所在位置之间没有空项(否则查找时在空项处停止，找不到该商品)
+//返回：一致返回1，否则返回0
+static int checkLoadIndex(const GoodsStore* store, const LoadIndex* saved)
+{
+    if (saved->indexSize == 0)
+    {
+        return saved->count == 0;
+    }
+    unsigned int mask = (unsigned int)saved->indexSize - 1;
+    unsigned int empty = 0;
+    while (empty <= mask && saved->index[empty].slot != GOODS_NIL)
+    {
+        empty++;
+    }
+    unsigned char* seen = (unsigned char*)calloc((size_t)saved->count + 1, 1);
+    int valid = seen != NULL && empty <= mask;
+    int used = 0;
+    unsigned int runStart = (empty + 1) & mask;  //当前连续已用段的起点
+    for (unsigned int step = 1; valid && step <= mask + 1; step++)
+    {
+        unsigned int pos = (empty + step) & mask;
+        const GoodsIndexEntry* entry = &saved->index[pos];
+        if (entry->slot == GOODS_NIL)
+        {
+            runStart = (pos + 1) & mask;
+            continue;
+        }
+        valid = entry->slot >= 0 && entry->slot < saved->count && !seen[entry->slot]
+             && entry->hash == STORE_HOT(store, entry->slot)->idHash
+             && ((pos - (entry->hash & mask)) & mask) <= ((pos - runStart) & mask);
+        if (valid)
+        {
+            seen[entry->slot] = 1;
+            used++;
+        }
+    }
+    free(seen);
+    return valid && used == saved->count;
+}
+
+//装入索引
+//功能：管理器中的商品必须是按处理结果依次存放的(槽位号0到count-1)；核对编号索引后用读入的数组替换
+//      管理器中的编号索引和三个前缀索引，数组的所有权转移给管理器，saved中对应的成员清空
+//返回：成功返回1，不符返回0且管理器不变
+int installLoadIndex(GoodsManager* manager, LoadIndex* saved)
+{
+    GoodsStore* store = &manager->store;
+    if (manager->count != saved->count || store->slotLimit != saved->count || !checkLoadIndex(store, saved))
+    {
+        return 0;
+    }
+    free(store->index);
+    store->index = saved->index;
+    store->indexSize = saved->indexSize;
+    store->indexUsed = saved->indexUsed;
+    saved->index = NULL;
+    freePrefixIndex(&manager->idPrefix);
+    freePrefixIndex(&manager->namePrefix);
+    freePrefixIndex(&manager->words);
+    manager->idPrefix = saved->idPrefix;
+    manager->namePrefix = saved->namePrefix;
+    manager->words = saved->words;
+    initPrefixIndex(&saved->idPrefix);
+    initPrefixIndex(&saved->namePrefix);
+    initPrefixIndex(&saved->words);
+    return 1;
+}
+
+//释放读入的索引
+void freeLoadIndex(LoadIndex* saved)
+{
+    free(saved->lines);
+    free(saved->index);
+    freePrefixIndex(&saved->idPrefix);
+    freePrefixIndex(&saved->namePrefix);
+    freePrefixIndex(&saved->words);
+    saved->lines = NULL;
+    saved->index = NULL;
+}
+
+//记录前缀索引的长度
+static void fillLoadPrefix(LoadPrefixHeader* header, const PrefixIndex* index)
+{
+    header->nodeCount = index->nodeCount;
+    header->valueCount = index->valueCount;
+    header->labelSize = index->labelSize;
+    header->freeNodes = index->freeNodes;
+    header->freeValues = index->freeValues;
+    header->labelGarbage = index->labelGarbage;
+    header->keyCount = index->keyCount;
+}
+
+//写入一个数组并累计校验和
+//返回：成功返回1，失败返回0
+static int writeLoadArray(FILE* file, const void* data, size_t bytes, unsigned int* crc)
+{
+    if (bytes == 0)
+    {
+        return 1;
+    }
+    *crc = crc32c(*crc, data, bytes);
+    return fwrite(data, 1, bytes, file) == bytes;
+}
+
+//写入一个前缀索引的节点、值和标签数组
+static int writeLoadPrefix(FILE* file, const PrefixIndex* index, unsigned int* crc)
+{
+    return writeLoadArray(file, index->nodes, (size_t)index->nodeCount * sizeof(PrefixNode), crc)
+        && writeLoadArray(file, index->values, (size_t)index->valueCount * sizeof(PrefixValue), crc)
+        && writeLoadArray(file, index->labels, (size_t)index->labelSize, crc);
+}
+
+//保存索引文件
+//功能：文件头留到最后写，数据部分的校验和边写边算；写入临时文件后替换索引文件，中途失败不会留下半个文件
+//参数：stamp - 加载前取得的数据文件标记，lines - 每行的处理结果，共stamp->lineCount项
+//返回：成功返回1，失败返回0(不影响本次加载，下次加载时重建)
+int saveLoadIndex(const char* filename, const LoadStamp* stamp, const GoodsManager* manager, const unsigned char* lines)
+{
+    LoadIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LOAD_INDEX_MAGIC;
+    header.format = LOAD_INDEX_FORMAT;
+    header.lineCount = stamp->lineCount;
+    header.count = manager->count;
+    header.indexSize = manager->store.indexSize;
+    header.indexUsed = manager->store.indexUsed;
+    fillLoadPrefix(&header.prefix[0], &manager->idPrefix);
+    fillLoadPrefix(&header.prefix[1], &manager->namePrefix);
+    fillLoadPrefix(&header.prefix[2], &manager->words);
+    header.dataCrc = stamp->crc;
+    header.dataSize = stamp->size;
+    header.dataTime = stamp->time;
+
+    char name[MAX_PATH + 8];
+    char tempName[MAX_PATH + 16];
+    loadIndexName(filename, name, sizeof(name));
+    sprintf_s(tempName, sizeof(tempName), "%s.tmp", name);
+    FILE* file = NULL;
+    if (fopen_s(&file, tempName, "wb") != 0 || file == NULL)
+    {
+        return 0;
+    }
+    unsigned int crc = 0;
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1
+          && writeLoadArray(file, lines, (size_t)stamp->lineCount, &crc)
+          && writeLoadArray(file, manager->store.index, (size_t)manager->store.indexSize * sizeof(GoodsIndexEntry), &crc)
+          && writeLoadPrefix(file, &manager->idPrefix, &crc)
+          && writeLoadPrefix(file, &manager->namePrefix, &crc)
+          && writeLoadPrefix(file, &manager->words, &crc);
+    header.bodyCrc = crc;
+    header.headerCrc = crc32c(0, &header, offsetof(LoadIndexHeader, headerCrc));
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    ok = ok && MoveFileExA(tempName, name, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    if (!ok)
+    {
+        remove(tempName);
+    }
+    return ok;
+}
+
+//删除索引文件
+void removeLoadIndex(const char* filename)
+{
+    char name[MAX_PATH + 8];
+    loadIndexName(filename, name, sizeof(name));
+    remove(name);
+}
@@ -0,0 +1,57 @@
+#ifndef LOADINDEX_H
+#define LOADINDEX_H
+
+#include "goods.h"
+
+// 加载索引文件
+// loadFromFile从文本文件完整加载时，除了解析各行，还要逐条登记编号哈希索引、编号和名称前缀索引以及词索引，
+// 并为查重逐行查找编号。新建的管理器加载完成后，把这些索引连同每行的处理结果(加入、重复或跳过)写到数据文件旁的
+// 索引文件中；下次用新建的管理器加载同一个文件时，按保存的结果只解析和存放商品，索引整体读入后直接装入管理器，
+// 不再逐条插入和查重。
+// 文件格式：文件头(标识、格式版本、各数组的长度、建立索引时数据文件的大小、修改时间和全部行的校验和、
+// 数据部分和文件头的校验和)，之后依次是每行一字节的处理结果、编号索引项，以及编号、名称和词三个前缀索引的
+// 节点、值和标签数组，全部以下标互相引用，不含指针。
+// 数据文件的大小、修改时间或内容任何一项与文件头不符时索引过期，按普通方式加载后重写；读入的数组还要检查结构
+// (见checkPrefixIndex)，装入前核对编号索引与存放的商品一致，任何不符都退回普通加载。
+// 只用于文本格式；压缩格式按块并行解析，不使用索引文件。
+#define LOAD_INDEX_SUFFIX ".ldx"      // 索引文件名为数据文件名加此后缀
+#define LOAD_INDEX_MAGIC 0x58444C47u  // 索引文件标识"GLDX"
+#define LOAD_INDEX_FORMAT 1           // 索引文件格式版本
+
+#define LOAD_LINE_SKIPPED 0    // 无效行或校验和行
+#define LOAD_LINE_ADDED 1      // 加入了管理器
+#define LOAD_LINE_DUPLICATE 2  // 编号重复，跳过
+
+// 数据文件的标记，与索引文件头中的记录比较以判断索引是否过期
+typedef struct
+{
+    unsigned long long size; // 字节数
+    unsigned long long time; // 最后修改时间(FILETIME)
+    unsigned int crc;        // 全部行的校验和(见crc32cGoodsLine，不含校验和尾行)
+    int lineCount;           // 行数
+} LoadStamp;
+
+// 从索引文件读入的索引
+typedef struct
+{
+    unsigned char *lines;   // 每行的处理结果，lines[行号-1]
+    int lineCount;          // 行数
+    int count;              // 加入的商品数
+    GoodsIndexEntry *index; // 编号哈希索引
+    int indexSize;          // 索引槽数
+    int indexUsed;          // 索引中已使用的项数
+    PrefixIndex idPrefix;   // 编号前缀索引
+    PrefixIndex namePrefix; // 名称前缀索引
+    PrefixIndex words;      // 词索引
+} LoadIndex;
+
+// 加载索引函数声明
+int stampDataFile(const char *filename, LoadStamp *stamp);                        // 取得数据文件的大小和修改时间(crc和行数由调用者填写)，失败返回0
+int readLoadIndex(const char *filename, const LoadStamp *stamp, LoadIndex *saved); // 读入与数据文件相符的索引，不存在、过期或损坏返回0
+int installLoadIndex(GoodsManager *manager, LoadIndex *saved);                    // 核对编号索引后把索引转移给管理器，不符返回0且管理器不变
+void freeLoadIndex(LoadIndex *saved);                                             // 释放尚未转移的索引
+int saveLoadIndex(const char *filename, const LoadStamp *stamp,
+                  const GoodsManager *manager, const unsigned char *lines);      // 写入索引文件，失败返回0(不影响本次加载)
+void removeLoadIndex(const char *filename);                                       // 删除数据文件旁的索引文件(删除临时数据文件时调用)
+
+#endif
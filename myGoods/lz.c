@@ -0,0 +1,206 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "lz.h"
+#include <string.h>
+
+#define LZ_HASH_BITS 12        // 哈希表大小为2^12项
+#define LZ_MIN_MATCH 4         // 最短匹配长度
+#define LZ_LAST_LITERALS 5     // 块末尾至少保留的字面量字节数
+#define LZ_MATCH_LIMIT 12      // 距块末尾不足此字节数时不再查找匹配
+#define LZ_MAX_OFFSET 65535    // 最大匹配偏移
+#define LZ_SKIP_TRIGGER 6      // 连续未命中2^6次后加大步长，跳过不可压缩的数据
+
+//读取4字节(不要求对齐)
+static unsigned int lzRead32(const unsigned char* p)
+{
+    unsigned int value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+//4字节序列的哈希值
+static unsigned int lzHash(unsigned int sequence)
+{
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+//写出扩展长度(每字节255，最后一字节小于255)
+static unsigned char* lzPutLength(unsigned char* out, int length)
+{
+    while (length >= 255)
+    {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+//读取扩展长度
+//返回：成功返回1，数据不足或长度溢出返回0
+static int lzGetLength(const unsigned char** in, const unsigned char* end, int* length)
+{
+    unsigned char byte;
+    do
+    {
+        if (*in >= end || *length > 0x3FFFFFFF)
+        {
+            return 0;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return 1;
+}
+
+//写出一个序列
+//参数：offset - 匹配偏移，0表示最后一个只有字面量的序列
+static unsigned char* lzPutSequence(unsigned char* out, const unsigned char* literals, int literalLength,
+                                    int offset, int matchLength)
+{
+    unsigned char* token = out++;
+    int extra = matchLength - LZ_MIN_MATCH;
+    *token = (unsigned char)(((literalLength < 15 ? literalLength : 15) << 4) | (extra < 15 ? extra : 15));
+    if (literalLength >= 15)
+    {
+        out = lzPutLength(out, literalLength - 15);
+    }
+    memcpy(out, literals, (size_t)literalLength);
+    out += literalLength;
+    if (offset == 0)
+    {
+        return out;
+    }
+    *out++ = (unsigned char)(offset & 0xFF);
+    *out++ = (unsigned char)(offset >> 8);
+    if (extra >= 15)
+    {
+        out = lzPutLength(out, extra - 15);
+    }
+    return out;
+}
+
+//压缩结果的最大可能长度(全部为字面量时)
+int lzCompressBound(int size)
+{
+    return size + size / 255 + 16;
+}
+
+//压缩一块
+//功能：贪心匹配，命中后向前、向后扩展匹配；长时间未命中时逐渐加大步长
+//返回：压缩后长度，dstCapacity小于lzCompressBound(srcSize)时返回0
+int lzCompress(const unsigned char* src, int srcSize, unsigned char* dst, int dstCapacity)
+{
+    if (srcSize < 0 || dstCapacity < lzCompressBound(srcSize))
+    {
+        return 0;
+    }
+
+    int table[1 << LZ_HASH_BITS];  //序列最近出现的位置+1，0表示没有
+    memset(table, 0, sizeof(table));
+
+    const unsigned char* ip = src;
+    const unsigned char* anchor = src;
+    const unsigned char* end = src + srcSize;
+    const unsigned char* matchLimit = end - LZ_MATCH_LIMIT;
+    const unsigned char* lastLiterals = end - LZ_LAST_LITERALS;
+    unsigned char* op = dst;
+    int misses = 0;
+
+    while (srcSize > LZ_MATCH_LIMIT && ip < matchLimit)
+    {
+        unsigned int sequence = lzRead32(ip);
+        unsigned int hash = lzHash(sequence);
+        int candidate = table[hash] - 1;
+        table[hash] = (int)(ip - src) + 1;
+        if (candidate < 0 || (ip - src) - candidate > LZ_MAX_OFFSET || lzRead32(src + candidate) != sequence)
+        {
+            ip += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+            continue;
+        }
+        misses = 0;
+
+        const unsigned char* match = src + candidate;
+        while (ip > anchor && match > src && ip[-1] == match[-1])
+        {
+            ip--;
+            match--;
+        }
+        int length = LZ_MIN_MATCH;
+        while (ip + length < lastLiterals && ip[length] == match[length])
+        {
+            length++;
+        }
+
+        op = lzPutSequence(op, anchor, (int)(ip - anchor), (int)(ip - match), length);
+        ip += length;
+        anchor = ip;
+    }
+
+    op = lzPutSequence(op, anchor, (int)(end - anchor), 0, LZ_MIN_MATCH);
+    return (int)(op - dst);
+}
+
+//解压一块
+//功能：检查每个长度和偏移，输入被截断或损坏时返回-1而不会越界读写
+//返回：解压后长度，数据损坏返回-1
+int lzDecompress(const unsigned char* src, int srcSize, unsigned char* dst, int dstSize)
+{
+    const unsigned char* ip = src;
+    const unsigned char* ipEnd = src + srcSize;
+    unsigned char* op = dst;
+    unsigned char* opEnd = dst + dstSize;
+
+    while (ip < ipEnd)
+    {
+        unsigned char token = *ip++;
+        int literalLength = token >> 4;
+        if (literalLength == 15 && !lzGetLength(&ip, ipEnd, &literalLength))
+        {
+            return -1;
+        }
+        if (literalLength > ipEnd - ip || literalLength > opEnd - op)
+        {
+            return -1;
+        }
+        memcpy(op, ip, (size_t)literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (ip == ipEnd)
+        {
+            break;  //最后一个序列
+        }
+
+        if (ipEnd - ip < 2)
+        {
+            return -1;
+        }
+        int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        int matchLength = token & 15;
+        if (matchLength == 15 && !lzGetLength(&ip, ipEnd, &matchLength))
+        {
+            return -1;
+        }
+        matchLength += LZ_MIN_MATCH;
+        if (offset == 0 || offset > op - dst || matchLength > opEnd - op)
+        {
+            return -1;
+        }
+
+        const unsigned char* match = op - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(op, match, (size_t)matchLength);
+            op += matchLength;
+        }
+        else
+        {
+            for (int i = 0; i < matchLength; i++)
+            {
+                *op++ = *match++;  //重叠复制，重复最近的offset个字节
+            }
+        }
+    }
+    return (int)(op - dst);
+}
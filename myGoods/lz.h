@@ -0,0 +1,14 @@
+#ifndef LZ_H
+#define LZ_H
+
+// LZ块压缩
+// 与LZ4块格式相同：每个序列为1字节标记(高4位字面量长度，低4位匹配长度-4) + 扩展长度 + 字面量
+// + 2字节小端偏移 + 扩展匹配长度；最后一个序列只有字面量。每块独立压缩，解压时不依赖其他块。
+// 压缩只用一个4字节哈希表查找候选匹配，速度优先于压缩率；解压会检查所有长度和偏移，损坏的数据不会越界。
+
+// 压缩函数声明
+int lzCompressBound(int size); // 压缩结果的最大可能长度
+int lzCompress(const unsigned char *src, int srcSize, unsigned char *dst, int dstCapacity); // 压缩一块，返回压缩后长度，失败返回0
+int lzDecompress(const unsigned char *src, int srcSize, unsigned char *dst, int dstSize);   // 解压一块，返回解压后长度，数据损坏返回-1
+
+#endif
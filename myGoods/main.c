@@ -1,15 +1,39 @@
 #include <windows.h>
 #include <locale.h>
 #include "goods.h"
+#include "stats.h"
+#include "rank.h"
+#include "server.h"
+#include "loadgen.h"
+#include "catalog.h"
+#include "persist.h"
+#include "delta.h"
+#include "pack.h"
+#include "parallel.h"
+#include "sortkey.h"
+#include "query.h"
+#include "aggregate.h"
+#include "txn.h"
+#include "shard.h"
+#include "lazy.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
 
 #define DATA_FILE "goods.txt" // 数据文件路径
+#define STATS_FILE "goods_stats.json" // 性能统计导出文件路径
+#define DELTA_TEXT_FILE "goods_delta.txt" // 文本增量导出文件路径
+#define DELTA_BINARY_FILE "goods_delta.bin" // 二进制增量导出文件路径
 #define MAX_INPUT 256         // 最大输入长度
+#define MAX_TOP_N 1000        // 前N名查询的最大名次数
 #define _CRT_SECURE_NO_WARNINGS
 
+static PersistWriter *g_persist = NULL; // 后台持久化线程，交互修改后由它保存数据文件
+static GoodsTxn g_txn = { 0 };           // 交互菜单中正在暂存的事务
+static MoveLog *g_moves = NULL;          // 库存变动日志，打开失败时不记录
+
 // 清空输入缓冲区
 // 功能：清除输入缓冲区中的剩余字符，防止影响下次输入
 void clearInputBuffer()
@@ -70,10 +94,18 @@ void displayMenu()
     printf("5. Delete Product\n");
     printf("6. Update Product\n");
     printf("7. Count by Category\n");
-    printf("8. Sort Products by Price\n");
+    printf("8. Sort Products\n");
     printf("9. Calculate Total Inventory Value\n");
+    printf("10. Performance Statistics\n");
+    printf("11. Top-N / Range Queries\n");
+    printf("12. Adjust Stock\n");
+    printf("13. Reorder Alerts\n");
+    printf("14. Delta Sync\n");
+    printf("15. Group Reports (Brand/Category)\n");
+    printf("16. Transaction (Stage Several Changes, Commit at Once)\n");
+    printf("17. Stock Movement History\n");
     printf("0. Exit\n");
-    printf("Please select an option (0-9): ");
+    printf("Please select an option (0-17): ");
 }
 
 // 显示查询子菜单
@@ -85,8 +117,11 @@ void displaySearchMenu()
     printf("2. Search by Name\n");
     printf("3. Search by Brand\n");
     printf("4. Search by Category\n");
+    printf("5. Search by ID/Name Prefix\n");
+    printf("6. Fuzzy Search (Name/Brand)\n");
+    printf("7. Query (e.g. category=Pen and price<5 order by stock desc limit 50)\n");
     printf("0. Return to Main Menu\n");
-    printf("Please select search type (0-4): ");
+    printf("Please select search type (0-7): ");
 }
 
 // 输入商品信息
@@ -96,6 +131,7 @@ Goods inputGoodsInfo()
 {
     Goods goods;
     char category_str[MAX_INPUT];
+    char price_str[MAX_INPUT];
 
     printf("Please enter product information:\n");
 
@@ -116,9 +152,13 @@ Goods inputGoodsInfo()
     scanf_s("%49s", goods.brand, (unsigned)sizeof(goods.brand));
     clearInputBuffer();
 
-    printf("Price: ");
-    scanf_s("%f", &goods.price);
+    printf("Price (e.g. 12.50): ");
+    scanf_s("%31s", price_str, (unsigned)sizeof(price_str));
     clearInputBuffer();
+    if (!parseMoney(price_str, &goods.price))
+    {
+        goods.price = 0; // 格式错误时置为无效价格，由isValidGoods拒绝
+    }
 
     printf("Stock Quantity: ");
     scanf_s("%d", &goods.stock);
@@ -127,6 +167,14 @@ Goods inputGoodsInfo()
     return goods;
 }
 
+// 登记一次修改
+// 功能：交给后台线程稍后保存，立即返回
+void queueSave()
+{
+    persistChanged(g_persist);
+    printf("Changes will be saved to file in the background.\n");
+}
+
 // 处理批量导入
 // 功能：从文件导入商品数据或手动输入多条商品信息
 // 参数：manager - 商品管理器指针
@@ -139,14 +187,22 @@ void handleBatchInput(GoodsManager **manager)
     {
         if (getConfirmation("Existing data will be cleared. Continue?"))
         {
-            // 清空现有数据
+            // 先保存未完成的修改，再清空现有数据
+            if (!persistSetManager(g_persist, NULL))
+            {
+                printf("Warning: some earlier changes could not be saved!\n");
+            }
+            int liveGroups = (*manager)->groups.live;
             freeGoodsManager(*manager);
             *manager = initGoodsManager();
+            persistSetManager(g_persist, *manager);
             if (*manager == NULL)
             {
                 printf("System initialization failed!\n");
                 return;
             }
+            setLiveGroups(*manager, liveGroups);  // 新数据加载时随之增量维护
+            (*manager)->moves = g_moves;
         }
         else
         {
@@ -154,7 +210,11 @@ void handleBatchInput(GoodsManager **manager)
         }
     }
 
-    if (loadFromFile(*manager, DATA_FILE))
+    // 加载时会扩充页表和索引，后台保存线程不能同时读取
+    lockGoodsExclusive(*manager);
+    int loaded = loadFromFile(*manager, DATA_FILE);
+    unlockGoodsExclusive(*manager);
+    if (loaded)
     {
         printf("Successfully loaded products from file!\n");
     }
@@ -171,14 +231,18 @@ void handleBatchInput(GoodsManager **manager)
 
             if (isValidGoods(goods))
             {
-                if (addGoods(*manager, goods))
+                lockGoodsExclusive(*manager);
+                int added = addGoods(*manager, goods);
+                unlockGoodsExclusive(*manager);
+                if (added)
                 {
                     count++;
+                    persistChanged(g_persist);
                     printf("Product added successfully!\n");
                 }
                 else
                 {
-                    printf("Product ID already exists, please try again.\n");
+                    printf("Product ID already exists (or out of memory), please try again.\n");
                 }
             }
             else
@@ -187,7 +251,7 @@ void handleBatchInput(GoodsManager **manager)
             }
         }
 
-        if (saveToFile(*manager, DATA_FILE))
+        if (persistFlush(g_persist))
         {
             printf("Products saved to file.\n");
         }
@@ -205,7 +269,7 @@ void handleSearch(GoodsManager *manager)
 {
     int choice;
     char searchTerm[MAX_INPUT];
-    GoodsNode *result;
+    Goods result;
 
     do
     {
@@ -213,14 +277,14 @@ void handleSearch(GoodsManager *manager)
         if (scanf_s("%d", &choice) != 1)
         {
             clearInputBuffer();
-            printf("Invalid input. Please enter a number between 0 and 4.\n");
+            printf("Invalid input. Please enter a number between 0 and 7.\n");
             continue;
         }
         clearInputBuffer();
 
-        if (choice < 0 || choice > 4)
+        if (choice < 0 || choice > 7)
         {
-            printf("Invalid choice. Please enter a number between 0 and 4.\n");
+            printf("Invalid choice. Please enter a number between 0 and 7.\n");
             continue;
         }
 
@@ -233,24 +297,21 @@ void handleSearch(GoodsManager *manager)
             printf("Enter Product ID: ");
             scanf_s("%s", searchTerm, (unsigned)sizeof(searchTerm));
             clearInputBuffer();
-            result = findGoodsById(manager, searchTerm);
-            displaySearchResults(result);
+            displaySearchResults(findGoodsById(manager, searchTerm, &result) ? &result : NULL);
             break;
 
         case 2: // 按名称查询
             printf("Enter Product Name: ");
             scanf_s("%s", searchTerm, (unsigned)sizeof(searchTerm));
             clearInputBuffer();
-            result = findGoodsByName(manager, searchTerm);
-            displaySearchResults(result);
+            displaySearchResults(findGoodsByName(manager, searchTerm, &result) ? &result : NULL);
             break;
 
         case 3: // 按品牌查询
             printf("Enter Brand: ");
             scanf_s("%s", searchTerm, (unsigned)sizeof(searchTerm));
             clearInputBuffer();
-            result = findGoodsByBrand(manager, searchTerm);
-            displaySearchResults(result);
+            displaySearchResults(findGoodsByBrand(manager, searchTerm, &result) ? &result : NULL);
             break;
 
         case 4: // 按类别查询
@@ -260,51 +321,139 @@ void handleSearch(GoodsManager *manager)
             displayGoodsByCategory(manager, stringToCategory(searchTerm));
             break;
 
+        case 5: // 按编号或名称前缀查询
+        {
+            Goods matches[20];
+            printf("Enter ID or Name Prefix: ");
+            scanf_s("%s", searchTerm, (unsigned)sizeof(searchTerm));
+            clearInputBuffer();
+            int count = suggestGoods(manager, PREFIX_BY_ID, searchTerm, matches, 20);
+            displayGoodsList(matches, count, "Products by ID prefix:");
+            count = suggestGoods(manager, PREFIX_BY_NAME, searchTerm, matches, 20);
+            displayGoodsList(matches, count, "Products by name prefix:");
+            break;
+        }
+
+        case 6: // 模糊查找，可输入多个词
+        {
+            Goods matches[20];
+            int scores[20];
+            printf("Enter words to find in name or brand: ");
+            if (fgets(searchTerm, sizeof(searchTerm), stdin) == NULL)
+            {
+                break;
+            }
+            searchTerm[strcspn(searchTerm, "\n")] = 0;
+            int count = fuzzySearchGoods(manager, searchTerm, matches, scores, 20);
+            displayGoodsList(matches, count, "Closest matches (best first):");
+            if (count > 0)
+            {
+                printf("Scores (0 = exact): ");
+                for (int i = 0; i < count; i++)
+                {
+                    printf("%d%s", scores[i], i + 1 < count ? " " : "\n");
+                }
+            }
+            break;
+        }
+
+        case 7: // 查询语言，以explain开头时显示执行计划
+            printf("Fields: id name category brand price stock value; operators: = != < <= > >= ^(prefix) ~(contains)\n");
+            printf("Query: ");
+            if (fgets(searchTerm, sizeof(searchTerm), stdin) == NULL)
+            {
+                break;
+            }
+            searchTerm[strcspn(searchTerm, "\n")] = 0;
+            lockGoodsShared(manager);
+            runQueryText(manager, searchTerm);
+            unlockGoodsShared(manager);
+            break;
+
         default:
             printf("Invalid choice, please try again.\n");
         }
     } while (1);
 }
 
-// 处理商品更新
-// 功能：更新现有商品的信息
-// 参数：manager - 商品管理器指针
-void handleUpdate(GoodsManager *manager)
+// 输入商品编号
+// 功能：读取商品编号；编号不存在时按编号前缀(没有则按名称前缀)列出最多10个候选商品供选择
+// 参数：manager - 商品管理器指针，prompt - 提示文字，current - 输出选中的商品
+// 返回：选中商品返回1，未找到或取消返回0
+int inputProductId(GoodsManager *manager, const char *prompt, Goods *current)
 {
     char id[MAX_INPUT];
-    printf("\n=== Update Product ===\n");
-    printf("Enter Product ID to update: ");
+    printf("%s", prompt);
     scanf_s("%s", id, (unsigned)sizeof(id));
     clearInputBuffer();
+    if (findGoodsById(manager, id, current))
+    {
+        return 1;
+    }
 
-    GoodsNode *node = findGoodsById(manager, id);
-    if (node == NULL)
+    Goods candidates[10];
+    int count = suggestGoods(manager, PREFIX_BY_ID, id, candidates, 10);
+    if (count == 0)
+    {
+        count = suggestGoods(manager, PREFIX_BY_NAME, id, candidates, 10);
+    }
+    if (count == 0)
     {
         printf("Product not found!\n");
+        return 0;
+    }
+
+    printf("No exact match. Did you mean:\n");
+    for (int i = 0; i < count; i++)
+    {
+        printf("%2d. %-16s  %s\n", i + 1, candidates[i].id, candidates[i].name);
+    }
+    printf("Select a product (1-%d, 0 to cancel): ", count);
+    int choice;
+    if (scanf_s("%d", &choice) != 1)
+    {
+        choice = 0;
+    }
+    clearInputBuffer();
+    if (choice < 1 || choice > count)
+    {
+        printf("Cancelled.\n");
+        return 0;
+    }
+    *current = candidates[choice - 1];
+    return 1;
+}
+
+// 处理商品更新
+// 功能：更新现有商品的信息
+// 参数：manager - 商品管理器指针
+void handleUpdate(GoodsManager *manager)
+{
+    printf("\n=== Update Product ===\n");
+    Goods current;
+    if (!inputProductId(manager, "Enter Product ID to update: ", &current))
+    {
         return;
     }
+    const char *id = current.id;
 
     printf("\nCurrent product information:\n");
-    displaySearchResults(node);
+    displaySearchResults(&current);
 
     if (getConfirmation("Confirm update this product?"))
     {
         Goods newData = inputGoodsInfo();
-        if (updateGoods(manager, id, newData))
+        lockGoodsExclusive(manager);
+        int updated = updateGoods(manager, id, newData);
+        unlockGoodsExclusive(manager);
+        if (updated)
         {
             printf("Update successful!\n");
-            if (saveToFile(manager, DATA_FILE))
-            {
-                printf("Changes saved to file.\n");
-            }
-            else
-            {
-                printf("Failed to save file!\n");
-            }
+            queueSave();
         }
         else
         {
-            printf("Update failed!\n");
+            printf("Update failed, brand dictionary full or out of memory!\n");
         }
     }
 }
@@ -314,39 +463,30 @@ void handleUpdate(GoodsManager *manager)
 // 参数：manager - 商品管理器指针
 void handleDelete(GoodsManager *manager)
 {
-    char id[MAX_INPUT];
     printf("\n=== Delete Product ===\n");
-    printf("Enter Product ID to delete: ");
-    scanf_s("%s", id, (unsigned)sizeof(id));
-    clearInputBuffer();
-
-    GoodsNode *node = findGoodsById(manager, id);
-    if (node == NULL)
+    Goods current;
+    if (!inputProductId(manager, "Enter Product ID to delete: ", &current))
     {
-        printf("Product not found!\n");
         return;
     }
+    const char *id = current.id;
 
     printf("\nProduct to delete:\n");
-    displaySearchResults(node);
+    displaySearchResults(&current);
 
     if (getConfirmation("Confirm delete this product?"))
     {
-        if (deleteGoods(manager, id))
+        lockGoodsExclusive(manager);
+        int deleted = deleteGoods(manager, id);
+        unlockGoodsExclusive(manager);
+        if (deleted)
         {
             printf("Delete successful!\n");
-            if (saveToFile(manager, DATA_FILE))
-            {
-                printf("Changes saved to file.\n");
-            }
-            else
-            {
-                printf("Failed to save file!\n");
-            }
+            queueSave();
         }
         else
         {
-            printf("Delete failed!\n");
+            printf("Delete failed, out of memory!\n");
         }
     }
 }
@@ -386,154 +526,1511 @@ void displayCategoryMenu()
     printf("Please select a category (0-4): ");
 }
 
-// 主函数
-// 功能：程序的入口点，实现主要交互逻辑
-int main()
+// 显示性能统计子菜单
+// 功能：显示性能统计的子菜单选项
+void displayStatsMenu()
 {
-    // 初始化商品管理器
-    GoodsManager *manager = initGoodsManager();
-    if (manager == NULL)
-    {
-        printf("System initialization failed!\n");
-        return 1;
-    }
+    printf("\n=== Performance Statistics ===\n");
+    printf("1. Show Statistics\n");
+    printf("2. Export Statistics to JSON\n");
+    printf("3. Reset Statistics\n");
+    printf("4. Memory Report\n");
+    printf("5. Background Saving Status\n");
+    printf("0. Return to Main Menu\n");
+    printf("Please select an option (0-5): ");
+}
 
-    // 主循环
+// 处理性能统计
+// 功能：显示、导出或清零热点路径的统计数据，显示内存报告
+// 参数：manager - 商品管理器指针
+void handleStats(GoodsManager *manager)
+{
     int choice;
+
     do
     {
-        displayMenu();
+        displayStatsMenu();
         if (scanf_s("%d", &choice) != 1)
         {
             clearInputBuffer();
-            printf("Invalid input. Please enter a number between 0 and 9.\n");
+            printf("Invalid input. Please enter a number between 0 and 5.\n");
             continue;
         }
         clearInputBuffer();
 
-        if (choice < 0 || choice > 9)
-        {
-            printf("Invalid choice. Please enter a number between 0 and 9.\n");
-            continue;
-        }
-
-        // 处理用户选择
         switch (choice)
         {
-        case 0: // 退出系统
-            if (getConfirmation("Confirm exit?"))
-            {
-                freeGoodsManager(manager);
-                printf("Thank you for using. Goodbye!\n");
-                return 0;
-            }
-            break;
-
-        case 1: // 批量导入
-            handleBatchInput(&manager);
-            break;
-
-        case 2: // 显示所有商品
-            displayAllGoods(manager);
-            break;
+        case 0:
+            return;
 
-        case 3: // 查询商品
-            handleSearch(manager);
+        case 1: // 显示统计
+            displayStats();
             break;
 
-        case 4: // 添加新商品
-            printf("\n=== Add New Product ===\n");
-            Goods newGoods = inputGoodsInfo();
-            if (isValidGoods(newGoods))
+        case 2: // 导出JSON
+            if (exportStatsJson(STATS_FILE))
             {
-                if (addGoods(manager, newGoods))
-                {
-                    printf("Add successful!\n");
-                    if (saveToFile(manager, DATA_FILE))
-                    {
-                        printf("Changes saved to file.\n");
-                    }
-                    else
-                    {
-                        printf("Failed to save file!\n");
-                    }
-                }
-                else
-                {
-                    printf("Add failed, Product ID may already exist!\n");
-                }
+                printf("Statistics exported to %s.\n", STATS_FILE);
             }
             else
             {
-                printf("Invalid product information!\n");
+                printf("Failed to export statistics!\n");
             }
             break;
 
-        case 5: // 删除商品
-            handleDelete(manager);
+        case 3: // 清零统计
+            resetStats();
+            printf("Statistics reset.\n");
             break;
 
-        case 6: // 更新商品
-            handleUpdate(manager);
+        case 4: // 内存报告
+            displayMemoryReport(manager);
             break;
 
-        case 7: // 按类别统计
-            do {
-                printf("\n=== Count by Category ===\n");
-                displayCategoryMenu();
-                int categoryChoice;
-                if (scanf_s("%d", &categoryChoice) != 1 || categoryChoice < 0 || categoryChoice > 4)
-                {
-                    clearInputBuffer();
-                    printf("Invalid input. Please enter a number between 0 and 4.\n");
-                    continue;
-                }
-                clearInputBuffer();
+        case 5: // 后台保存状态
+            displayPersistStatus(g_persist);
+            break;
 
-                if (categoryChoice == 4) // All categories
-                {
-                    printf("Pen products: %d\n", countGoodsByCategory(manager, PEN));
-                    printf("Notebook products: %d\n", countGoodsByCategory(manager, NOTEBOOK));
-                    printf("Paint products: %d\n", countGoodsByCategory(manager, PAINT));
-                    printf("Other products: %d\n", countGoodsByCategory(manager, OTHER));
-                }
-                else
-                {
-                    GoodsCategory selectedCategory = (GoodsCategory)categoryChoice;
-                    int count = countGoodsByCategory(manager, selectedCategory);
-                    printf("Products in category [%s]: %d\n", categoryToString(selectedCategory), count);
-                }
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 5.\n");
+        }
+    } while (1);
+}
 
-                // 提示用户是否返回主菜单
-                if (getConfirmation("Return to main menu?"))
-                {
-                    break;
-                }
-            } while (1);
+// 显示排行查询子菜单
+// 功能：显示前N名和区间查询的子菜单选项
+void displayRankMenu()
+{
+    printf("\n=== Top-N / Range Queries ===\n");
+    printf("1. Top N by Price/Stock/Value\n");
+    printf("2. Range Query by Price/Stock/Value\n");
+    printf("3. Low Stock Alert (stock < N)\n");
+    printf("0. Return to Main Menu\n");
+    printf("Please select an option (0-3): ");
+}
+
+// 选择排序键
+// 功能：提示用户选择按单价、库存或库存价值查询
+RankKey inputRankKey()
+{
+    printf("Rank by: 1. Price  2. Stock  3. Value (price x stock)\n");
+    printf("Select key (1-3): ");
+    return (RankKey)(getIntegerInput(1, 3) - 1);
+}
+
+// 输入区间边界
+// 功能：价格和价值按金额格式输入，库存按整数输入
+// 返回：输入有效返回1，否则返回0
+int inputRankBound(RankKey key, const char *prompt, long long *value)
+{
+    char text[MAX_INPUT];
+    printf("%s: ", prompt);
+    scanf_s("%31s", text, (unsigned)sizeof(text));
+    clearInputBuffer();
+
+    if (key == RANK_BY_STOCK)
+    {
+        int stock;
+        if (sscanf_s(text, "%d", &stock) != 1)
+        {
+            return 0;
+        }
+        *value = stock;
+        return 1;
+    }
+    Money money;
+    if (!parseMoney(text, &money))
+    {
+        return 0;
+    }
+    *value = money;
+    return 1;
+}
+
+// 处理排行与区间查询
+// 功能：前N名查询、区间查询和低库存提醒，均不改变商品列表的顺序
+// 参数：manager - 商品管理器指针
+void handleRank(GoodsManager *manager)
+{
+    int choice;
+    char title[MAX_INPUT];
+
+    do
+    {
+        displayRankMenu();
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 3.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice)
+        {
+        case 0:
+            return;
+
+        case 1: // 前N名
+        {
+            RankKey key = inputRankKey();
+            printf("How many products (1-%d): ", MAX_TOP_N);
+            int n = getIntegerInput(1, MAX_TOP_N);
+            printf("1. Highest first  2. Lowest first\nSelect order (1-2): ");
+            int largest = getIntegerInput(1, 2) == 1;
+
+            Goods *results = (Goods *)malloc(n * sizeof(Goods));
+            if (results == NULL)
+            {
+                printf("Out of memory!\n");
+                break;
+            }
+            int count = topGoods(manager, key, n, largest, results);
+            sprintf_s(title, sizeof(title), "Top %d by %s (%s first):", count,
+                      rankKeyToString(key), largest ? "highest" : "lowest");
+            displayGoodsList(results, count, title);
+            free(results);
             break;
+        }
 
-        case 8: // 按价格排序
-            printf("\n=== Sort by Price ===\n");
-            printf("1. Ascending\n2. Descending\nSelect sort order (1-2): ");
-            int sortChoice = 1;
-            if (scanf_s("%d", &sortChoice) != 1 || (sortChoice != 1 && sortChoice != 2))
+        case 2: // 区间查询
+        {
+            RankKey key = inputRankKey();
+            long long low, high;
+            if (!inputRankBound(key, "Minimum (inclusive)", &low) ||
+                !inputRankBound(key, "Maximum (inclusive)", &high))
             {
-                clearInputBuffer();
-                printf("Invalid input, using default ascending order.\n");
-                sortChoice = 1;
+                printf("Invalid bound!\n");
+                break;
             }
-            else
+            Goods *results = NULL;
+            int count = rangeGoods(manager, key, low, high, &results);
+            if (count < 0)
             {
-                clearInputBuffer();
+                printf("Query failed!\n");
+                break;
             }
-            sortGoodsByPrice(manager, sortChoice == 1);
-            displayAllGoods(manager);
+            sprintf_s(title, sizeof(title), "Products by %s in range:", rankKeyToString(key));
+            displayGoodsList(results, count, title);
+            free(results);
+            break;
+        }
+
+        case 3: // 低库存提醒
+        {
+            printf("Stock threshold N: ");
+            int threshold = getIntegerInput(1, 1000000000);
+            Goods *results = NULL;
+            int count = rangeGoods(manager, RANK_BY_STOCK, 0, (long long)threshold - 1, &results);
+            if (count < 0)
+            {
+                printf("Query failed!\n");
+                break;
+            }
+            sprintf_s(title, sizeof(title), "Products with stock < %d:", threshold);
+            displayGoodsList(results, count, title);
+            free(results);
             break;
+        }
 
-        case 9: // 计算总价值
-            printf("\n=== Total Inventory Value ===\n");
-            float totalValue = calculateTotalValue(manager);
-            printf("Current total inventory value: %.2f\n", totalValue);
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 3.\n");
+        }
+    } while (1);
+}
+
+// 处理库存调整
+// 功能：按增量调整指定商品的库存，库存跌破补货点时立即提醒
+// 参数：manager - 商品管理器指针
+void handleAdjustStock(GoodsManager *manager)
+{
+    char id[MAX_INPUT];
+    printf("\n=== Adjust Stock ===\n");
+    printf("Enter Product ID: ");
+    scanf_s("%s", id, (unsigned)sizeof(id));
+    clearInputBuffer();
+
+    Goods current;
+    if (!findGoodsById(manager, id, &current))
+    {
+        printf("Product not found!\n");
+        return;
+    }
+
+    printf("Current stock: %d\n", current.stock);
+    printf("Stock change (positive to receive, negative to ship): ");
+    int delta = getIntegerInput(-1000000000, 1000000000);
+    int wasBelow = needsReorder(manager, id);
+    lockGoodsExclusive(manager);
+    int adjusted = adjustStock(manager, id, delta);
+    unlockGoodsExclusive(manager);
+    if (!adjusted)
+    {
+        printf("Adjust failed, stock cannot go below 0 (or out of memory)!\n");
+        return;
+    }
+
+    findGoodsById(manager, id, &current);
+    printf("Stock adjusted to %d.\n", current.stock);
+    if (needsReorder(manager, id) && !wasBelow)
+    {
+        printf("Reorder alert: stock is below reorder point %d!\n", getReorderPoint(manager, id));
+    }
+    queueSave();
+}
+
+// 显示补货提醒子菜单
+// 功能：显示补货提醒的子菜单选项
+void displayReorderMenu()
+{
+    printf("\n=== Reorder Alerts ===\n");
+    printf("1. Show Products Below Reorder Point\n");
+    printf("2. Set Reorder Point\n");
+    printf("0. Return to Main Menu\n");
+    printf("Please select an option (0-2): ");
+}
+
+// 处理补货提醒
+// 功能：列出库存低于补货点的商品，设置商品的补货点
+// 参数：manager - 商品管理器指针
+void handleReorder(GoodsManager *manager)
+{
+    int choice;
+    char id[MAX_INPUT];
+
+    do
+    {
+        displayReorderMenu();
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 2.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice)
+        {
+        case 0:
+            return;
+
+        case 1: // 显示补货提醒
+            displayReorderAlerts(manager);
+            break;
+
+        case 2: // 设置补货点
+        {
+            printf("Enter Product ID: ");
+            scanf_s("%s", id, (unsigned)sizeof(id));
+            clearInputBuffer();
+            int current = getReorderPoint(manager, id);
+            if (current < 0)
+            {
+                printf("Product not found!\n");
+                break;
+            }
+            printf("Current reorder point: %d\n", current);
+            printf("New reorder point (0 to disable): ");
+            int point = getIntegerInput(0, 1000000000);
+            lockGoodsExclusive(manager);
+            setReorderPoint(manager, id, point);
+            unlockGoodsExclusive(manager);
+            if (needsReorder(manager, id))
+            {
+                printf("Reorder alert: stock is already below the new reorder point!\n");
+            }
+            queueSave();
+            break;
+        }
+
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 2.\n");
+        }
+    } while (1);
+}
+
+// 显示增量同步子菜单
+// 功能：显示增量同步的子菜单选项
+void displayDeltaMenu()
+{
+    printf("\n=== Delta Sync ===\n");
+    printf("1. Show Changes Since Last Checkpoint\n");
+    printf("2. Export Delta (Text, %s)\n", DELTA_TEXT_FILE);
+    printf("3. Export Delta (Binary, %s)\n", DELTA_BINARY_FILE);
+    printf("4. Apply Delta File\n");
+    printf("0. Return to Main Menu\n");
+    printf("Please select an option (0-4): ");
+}
+
+// 导出增量文件
+// 功能：持读锁导出检查点之后的变更，成功后可选择设置新的检查点
+// 参数：manager - 商品管理器指针，filename - 导出文件，format - 文件格式
+void exportDeltaFile(GoodsManager *manager, const char *filename, DeltaFormat format)
+{
+    lockGoodsShared(manager);
+    int written = exportDelta(manager, filename, format);
+    unlockGoodsShared(manager);
+    if (written < 0)
+    {
+        printf("Failed to export delta. If change tracking is incomplete, copy the full %s instead.\n", DATA_FILE);
+        return;
+    }
+    printf("Exported %d changed products to %s.\n", written, filename);
+
+    if (getConfirmation("Start a new checkpoint (later exports exclude these changes)?"))
+    {
+        lockGoodsExclusive(manager);
+        clearChangeSet(&manager->changes);
+        unlockGoodsExclusive(manager);
+        printf("New checkpoint started.\n");
+    }
+}
+
+// 处理增量同步
+// 功能：显示检查点之后的变更，导出增量文件，将其他副本导出的增量文件合并进来
+// 参数：manager - 商品管理器指针
+void handleDelta(GoodsManager *manager)
+{
+    int choice;
+    char filename[MAX_INPUT];
+
+    do
+    {
+        displayDeltaMenu();
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 4.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice)
+        {
+        case 0:
+            return;
+
+        case 1: // 显示变更统计
+            lockGoodsShared(manager);
+            displayChangeSummary(manager);
+            unlockGoodsShared(manager);
+            break;
+
+        case 2: // 导出文本增量
+            exportDeltaFile(manager, DELTA_TEXT_FILE, DELTA_TEXT);
+            break;
+
+        case 3: // 导出二进制增量
+            exportDeltaFile(manager, DELTA_BINARY_FILE, DELTA_BINARY);
+            break;
+
+        case 4: // 合并增量文件
+        {
+            printf("Delta file name: ");
+            scanf_s("%s", filename, (unsigned)sizeof(filename));
+            clearInputBuffer();
+            lockGoodsExclusive(manager);
+            int applied = applyDelta(manager, filename);
+            unlockGoodsExclusive(manager);
+            if (applied < 0)
+            {
+                printf("Failed to apply %s: file missing or invalid, no changes made.\n", filename);
+                break;
+            }
+            printf("Applied %d delta records.\n", applied);
+            if (applied > 0)
+            {
+                queueSave();
+            }
+            break;
+        }
+
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 4.\n");
+        }
+    } while (1);
+}
+
+// 显示分组统计菜单
+// 参数：manager - 商品管理器指针(用于显示增量维护的状态)
+void displayGroupMenu(GoodsManager *manager)
+{
+    printf("\n=== Group Reports ===\n");
+    printf("1. By Brand\n");
+    printf("2. By Category\n");
+    printf("3. By Brand and Category\n");
+    printf("4. Export to CSV (%s)\n", GROUP_CSV_FILE);
+    printf("5. Live Updates (currently %s)\n", manager->groups.live ? "on" : "off");
+    printf("0. Return to Main Menu\n");
+    printf("Please select an option (0-5): ");
+}
+
+// 处理分组统计
+// 功能：按品牌、类别或品牌×类别显示商品数、库存和价值，导出CSV，开关增量维护
+// 参数：manager - 商品管理器指针
+void handleGroups(GoodsManager *manager)
+{
+    int choice;
+
+    do
+    {
+        displayGroupMenu(manager);
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 5.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        switch (choice)
+        {
+        case 0:
+            return;
+
+        case 1: // 按品牌
+        case 2: // 按类别
+        case 3: // 按品牌和类别
+        case 4: // 导出CSV
+        {
+            GroupBy by = (GroupBy)(choice - 1);
+            if (choice == 4)
+            {
+                printf("1. By Brand  2. By Category  3. By Brand and Category\nSelect grouping (1-3): ");
+                by = (GroupBy)(getIntegerInput(1, 3) - 1);
+            }
+            GroupReport report;
+            lockGoodsShared(manager);
+            if (!buildGroupReport(manager, by, &report))
+            {
+                unlockGoodsShared(manager);
+                printf("Not enough memory to build the report.\n");
+                break;
+            }
+            if (choice == 4)
+            {
+                int exported = exportGroupReportCsv(&report, GROUP_CSV_FILE);
+                printf(exported ? "Exported %d groups to %s.\n" : "Failed to write %d groups to %s!\n", report.count, GROUP_CSV_FILE);
+            }
+            else
+            {
+                printf("\n=== Products by %s ===\n", groupByToString(by));
+                displayGroupReport(&report);
+                if (report.examined > 0)
+                {
+                    printf("Scanned %d records.\n", report.examined);
+                }
+                else
+                {
+                    printf("Read from the live group table.\n");
+                }
+            }
+            freeGroupReport(&report);
+            unlockGoodsShared(manager);
+            break;
+        }
+
+        case 5: // 开关增量维护
+        {
+            lockGoodsExclusive(manager);
+            int enable = !manager->groups.live;
+            int ok = setLiveGroups(manager, enable);
+            unlockGoodsExclusive(manager);
+            if (!ok)
+            {
+                printf("Not enough memory to keep groups up to date.\n");
+            }
+            else
+            {
+                printf(enable ? "Group totals are now kept up to date on every edit.\n"
+                              : "Live updates are off; reports scan the catalog.\n");
+            }
+            break;
+        }
+
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 5.\n");
+        }
+    } while (1);
+}
+
+// 显示事务菜单
+void displayTxnMenu()
+{
+    printf("\n=== Transaction (%d staged changes) ===\n", g_txn.count);
+    printf("1. Stage Stock Adjustment\n");
+    printf("2. Stage Product Update\n");
+    printf("3. Stage New Product\n");
+    printf("4. Stage Product Delete\n");
+    printf("5. Stage Delivery File (ID and quantity per line)\n");
+    printf("6. Show Staged Changes\n");
+    printf("7. Commit\n");
+    printf("8. Abort\n");
+    printf("0. Return to Main Menu (staged changes are kept)\n");
+    printf("Please select an option (0-8): ");
+}
+
+// 处理事务
+// 功能：把多条修改暂存到事务中，提交时一次检查并应用，全部成功后只保存一次文件；任何一条不能应用时不做任何修改
+// 参数：manager - 商品管理器指针
+void handleTxn(GoodsManager *manager)
+{
+    int choice;
+    char filename[MAX_INPUT];
+    char error[TXN_ERROR_SIZE];
+
+    do
+    {
+        if (!g_txn.active)
+        {
+            beginTxn(&g_txn);
+        }
+        displayTxnMenu();
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 8.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        Goods current;
+        int staged = 1;
+        switch (choice)
+        {
+        case 0:
+            return;
+
+        case 1: // 暂存库存调整
+            if (!inputProductId(manager, "Enter Product ID: ", &current))
+            {
+                break;
+            }
+            printf("Current stock: %d\n", current.stock);
+            printf("Stock change (positive to receive, negative to ship): ");
+            staged = txnAdjustStock(&g_txn, current.id, getIntegerInput(-1000000000, 1000000000));
+            break;
+
+        case 2: // 暂存商品更新
+            if (!inputProductId(manager, "Enter Product ID to update: ", &current))
+            {
+                break;
+            }
+            printf("\nCurrent product information:\n");
+            displaySearchResults(&current);
+            staged = txnUpdate(&g_txn, current.id, inputGoodsInfo());
+            break;
+
+        case 3: // 暂存新商品
+            staged = txnAdd(&g_txn, inputGoodsInfo());
+            break;
+
+        case 4: // 暂存删除
+            if (!inputProductId(manager, "Enter Product ID to delete: ", &current))
+            {
+                break;
+            }
+            staged = txnDelete(&g_txn, current.id);
+            break;
+
+        case 5: // 暂存到货单
+        {
+            printf("Delivery file name: ");
+            scanf_s("%s", filename, (unsigned)sizeof(filename));
+            clearInputBuffer();
+            int lines = stageDeliveryFile(&g_txn, filename);
+            if (lines < 0)
+            {
+                printf("Could not stage %s.\n", filename);
+            }
+            else
+            {
+                printf("Staged %d stock adjustments from %s.\n", lines, filename);
+            }
+            break;
+        }
+
+        case 6: // 显示暂存的修改
+            displayTxn(&g_txn);
+            break;
+
+        case 7: // 提交
+        {
+            lockGoodsExclusive(manager);
+            int applied = commitTxn(manager, &g_txn, error, sizeof(error));
+            unlockGoodsExclusive(manager);
+            if (applied < 0)
+            {
+                printf("Commit failed: %s. No changes were made.\n", error);
+                break;
+            }
+            printf("Committed %d changes.\n", applied);
+            if (applied > 0)
+            {
+                persistChanged(g_persist);
+                printf(persistFlush(g_persist) ? "Saved to file.\n" : "Failed to save file!\n");
+            }
+            break;
+        }
+
+        case 8: // 放弃
+            abortTxn(&g_txn);
+            printf("Staged changes discarded.\n");
+            break;
+
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 8.\n");
+        }
+        if (!staged)
+        {
+            printf("Out of memory, change not staged.\n");
+        }
+    } while (1);
+}
+
+// 显示库存变动菜单
+void displayMovesMenu()
+{
+    printf("\n=== Stock Movement History ===\n");
+    printf("1. Units Sold of a Product (Last N Days)\n");
+    printf("2. Recent Movements of a Product\n");
+    printf("3. Top Movers (Last N Days)\n");
+    printf("4. Log Status\n");
+    printf("0. Return to Main Menu\n");
+    printf("Please select an option (0-4): ");
+}
+
+// 读取变动日志中的商品编号
+// 功能：已删除的商品仍可查询，因此不要求编号存在于当前商品中
+// 返回：编号有效返回1
+int inputMoveId(char *id, size_t size)
+{
+    printf("Enter Product ID: ");
+    scanf_s("%s", id, (unsigned)size);
+    clearInputBuffer();
+    if (strlen(id) >= 20)
+    {
+        printf("Product ID is too long.\n");
+        return 0;
+    }
+    return 1;
+}
+
+// 处理库存变动历史
+// 功能：按商品统计最近N天的销量和入库量，列出商品最近的变动，显示最近N天变动量最大的商品
+// 参数：manager - 商品管理器指针
+void handleMoves(GoodsManager *manager)
+{
+    int choice;
+    char id[MAX_INPUT];
+    MoveLog *log = manager->moves;
+    if (log == NULL)
+    {
+        printf("Stock movement log is not open.\n");
+        return;
+    }
+
+    do
+    {
+        displayMovesMenu();
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 4.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        unsigned int now = (unsigned int)time(NULL);
+        switch (choice)
+        {
+        case 0:
+            return;
+
+        case 1: // 最近N天的销量
+        {
+            if (!inputMoveId(id, sizeof(id)))
+            {
+                break;
+            }
+            printf("Number of days (1-3650): ");
+            int days = getIntegerInput(1, 3650);
+            MoveTotals totals;
+            lockGoodsShared(manager);
+            sumMovements(log, id, now - (unsigned int)days * MOVE_DAY_SECONDS, now, &totals);
+            unlockGoodsShared(manager);
+            printf("%s in the last %d days: %lld sold, %lld received, %d movements\n", id, days,
+                   -totals.units[MOVE_SALE], totals.units[MOVE_RECEIVE], totals.movements);
+            break;
+        }
+
+        case 2: // 最近的变动
+        {
+            int indexes[20];
+            if (!inputMoveId(id, sizeof(id)))
+            {
+                break;
+            }
+            lockGoodsShared(manager);
+            int count = listMovements(log, id, 20, indexes);
+            if (count == 0)
+            {
+                printf("No movements recorded for %s.\n", id);
+            }
+            else
+            {
+                printf("%-20s %10s  %s\n", "Time", "Change", "Reason");
+            }
+            for (int i = 0; i < count; i++)
+            {
+                const Movement *record = &log->records[indexes[i]];
+                time_t when = record->time;
+                struct tm local;
+                char text[32];
+                localtime_s(&local, &when);
+                strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+                printf("%-20s %+10d  %s\n", text, record->delta, moveReasonToString((MoveReason)record->reason));
+            }
+            unlockGoodsShared(manager);
+            break;
+        }
+
+        case 3: // 变动量最大的商品
+        {
+            MoveRank top[MAX_TOP_N];
+            printf("Number of days (1-3650): ");
+            int days = getIntegerInput(1, 3650);
+            printf("How many products (1-%d): ", MAX_TOP_N);
+            int k = getIntegerInput(1, MAX_TOP_N);
+            printf("1. Sales  2. Receipts  3. All movements\nSelect (1-3): ");
+            int kind = getIntegerInput(1, 3);
+            unsigned int mask = kind == 1 ? MOVE_MASK(MOVE_SALE) : kind == 2 ? MOVE_MASK(MOVE_RECEIVE) : MOVE_MASK_ALL;
+            lockGoodsShared(manager);
+            int count = topMovers(log, now - (unsigned int)days * MOVE_DAY_SECONDS, now, mask, k, top);
+            unlockGoodsShared(manager);
+            if (count < 0)
+            {
+                printf("Not enough memory to rank products.\n");
+                break;
+            }
+            printf("%4s  %-20s %12s %10s\n", "#", "ID", "Units", "Movements");
+            for (int i = 0; i < count; i++)
+            {
+                printf("%4d  %-20s %12lld %10d\n", i + 1, top[i].id, top[i].units, top[i].movements);
+            }
+            if (count == 0)
+            {
+                printf("No movements in the last %d days.\n", days);
+            }
+            break;
+        }
+
+        case 4: // 日志状态
+            lockGoodsShared(manager);
+            printf("Log file: %s\n", MOVE_LOG_FILE);
+            printf("Movements: %d, products: %d, memory: %.1f MB\n", log->count, log->skuCount,
+                   ((double)log->capacity * sizeof(Movement) + (double)log->skuCapacity * sizeof(MoveSku)
+                    + (double)log->skuTableSize * sizeof(int)) / 1048576.0);
+            printf("Failed appends: %lld\n", log->failures);
+            unlockGoodsShared(manager);
+            break;
+
+        default:
+            printf("Invalid choice. Please enter a number between 0 and 4.\n");
+        }
+    } while (1);
+}
+
+// 读取第index个命令行参数作为整数，参数不存在时返回默认值
+int argInt(int argc, char *argv[], int index, int defaultValue)
+{
+    return argc > index ? atoi(argv[index]) : defaultValue;
+}
+
+// 读取共享目录
+// 功能：只读映射查询服务发布的共享目录，显示版本和汇总信息，并直接在共享内存中按编号查找商品
+// 返回：进程退出码
+int runCatalogReader(const char *name, int idCount, char *ids[])
+{
+    CatalogView view;
+    if (!openCatalogView(&view, name))
+    {
+        printf("Shared catalog %s is not available. Start the server with --serve first.\n", name);
+        return 1;
+    }
+
+    const CatalogHeader *image = view.image;
+    char money[MONEY_TEXT_SIZE];
+    printf("Catalog %s version %lld: %d products, %d below reorder point, total value %s, %u bytes mapped.\n",
+           name, image->sequence, image->recordCount, image->reorderCount,
+           formatMoney(image->totalValue, money, sizeof(money)), image->imageSize);
+    printf("Pens: %d, Notebooks: %d, Paints: %d, Others: %d\n",
+           image->categoryCounts[PEN], image->categoryCounts[NOTEBOOK],
+           image->categoryCounts[PAINT], image->categoryCounts[OTHER]);
+
+    for (int i = 0; i < idCount; i++)
+    {
+        const CatalogRecord *record = catalogFind(&view, ids[i]);
+        if (record == NULL)
+        {
+            printf("%s: not found\n", ids[i]);
+            continue;
+        }
+        printf("%s: %s, %s, %s, price %s, stock %d\n",
+               catalogString(&view, record->idOffset),
+               catalogString(&view, record->nameOffset),
+               categoryToString((GoodsCategory)record->category),
+               catalogString(&view, record->brandOffset),
+               formatMoney(record->price, money, sizeof(money)), record->stock);
+    }
+
+    closeCatalogView(&view);
+    return 0;
+}
+
+// 延迟加载启动时换用完整的管理器
+// 功能：等待后台加载完成，把完整加载的管理器交给后台保存线程，释放启动时的空管理器和延迟目录
+void finishLazyStart(GoodsManager **manager, LazyCatalog **lazy)
+{
+    if (!lazyCatalogReady(*lazy))
+    {
+        printf("Waiting for the catalog to finish loading...\n");
+    }
+    GoodsManager *full = takeLazyManager(*lazy);
+    printf("Catalog fully loaded in %.0f ms.\n", lazyLoadMs(*lazy));
+    closeLazyCatalog(*lazy);
+    *lazy = NULL;
+    if (full == NULL)
+    {
+        printf("Failed to load %s; starting with an empty catalog.\n", DATA_FILE);
+        return;
+    }
+    full->moves = g_moves;
+    persistSetManager(g_persist, full);
+    freeGoodsManager(*manager);
+    *manager = full;
+}
+
+// 延迟加载期间按编号查找
+// 功能：后台加载完成之前直接使用编号索引，命中的行在首次访问时解析
+void handleLazySearch(LazyCatalog *lazy)
+{
+    char id[MAX_INPUT];
+    LARGE_INTEGER frequency, start, end;
+    printf("\n=== Search by ID (catalog still loading) ===\n");
+    printf("Enter Product ID: ");
+    scanf_s("%s", id, (unsigned)sizeof(id));
+    clearInputBuffer();
+    Goods result;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    int found = lazyFindGoods(lazy, id, &result);
+    QueryPerformanceCounter(&end);
+    displaySearchResults(found ? &result : NULL);
+    printf("Answered in %.3f ms from the ID index. Other searches are available once loading finishes.\n",
+           (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart);
+}
+
+// 多门店模式
+// 功能：读取门店列表后并行加载各门店的数据文件，显示各门店和全公司的统计，
+//       再按"门店:编号"形式的参数在对应门店中查找商品
+// 返回：进程退出码
+int runShardCommand(const char *listFile, int lookupCount, char *lookups[])
+{
+    ShardSet set;
+    initShardSet(&set);
+    if (loadShardList(&set, listFile) <= 0)
+    {
+        printf("No stores listed in %s (one 'store file' per line).\n", listFile);
+        freeShardSet(&set);
+        return 1;
+    }
+    TaskPool *pool = getTaskPool();
+    if (pool == NULL || loadShards(&set, pool) < 0)
+    {
+        printf("System initialization failed!\n");
+        freeShardSet(&set);
+        return 1;
+    }
+
+    printf("\n=== Stores (%d, loaded with %d threads) ===\n", set.count, poolThreadCount(pool));
+    for (int s = 0; s < set.count; s++)
+    {
+        const GoodsShard *shard = &set.shards[s];
+        printf("%-20s %-32s %10d products %8.1f ms%s\n", shard->name, shard->filename, shard->manager->count,
+               shard->loadMs, shard->loaded ? "" : "  (file missing or empty)");
+    }
+
+    ShardTotals *perShard = (ShardTotals *)malloc((size_t)set.count * sizeof(ShardTotals));
+    ShardTotals total;
+    if (perShard == NULL || !gatherShardTotals(&set, pool, perShard, &total))
+    {
+        printf("Not enough memory to compute totals.\n");
+        free(perShard);
+        freeShardSet(&set);
+        return 1;
+    }
+    printf("\n=== Company Totals ===\n");
+    displayShardTotals(&set, perShard, &total);
+    free(perShard);
+
+    int ok = 1;
+    for (int i = 0; i < lookupCount; i++)
+    {
+        char store[SHARD_NAME_SIZE];
+        const char *sep = strchr(lookups[i], ':');
+        if (sep == NULL || (size_t)(sep - lookups[i]) >= sizeof(store))
+        {
+            printf("\nExpected store:id, got '%s'.\n", lookups[i]);
+            ok = 0;
+            continue;
+        }
+        memcpy(store, lookups[i], (size_t)(sep - lookups[i]));
+        store[sep - lookups[i]] = '\0';
+        Goods goods;
+        int found = findShardGoods(&set, store, sep + 1, &goods);
+        if (found < 0)
+        {
+            printf("\nUnknown store '%s'.\n", store);
+        }
+        else if (found == 0)
+        {
+            printf("\n%s: product %s not found.\n", store, sep + 1);
+        }
+        else
+        {
+            printf("\n%s:\n", store);
+            displaySearchResults(&goods);
+        }
+        ok &= found == 1;
+    }
+    freeShardSet(&set);
+    return ok ? 0 : 1;
+}
+
+// 处理命令行模式
+// 功能：--serve [套接字路径] [工作线程数] [共享目录名称] 加载数据文件后作为查询服务运行，并发布共享目录；
+//       --catalog [共享目录名称] [编号...] 读取查询服务发布的共享目录；
+//       --loadgen [套接字路径] [连接数] [每连接操作数] [调整库存百分比] [批量大小] [流水线深度] 对查询服务进行压力测试；
+//       --bench-batch [套接字路径] [批量大小] [操作数] [调整库存百分比] 对比逐条请求与批量请求；
+//       --suggest 套接字路径 id|name 前缀 [最多条数] 向查询服务发送一次前缀查询；
+//       --merge-delta 基准文件 增量文件 输出文件 将增量合并到数据文件；
+//       --pack/--unpack 输入文件 输出文件 在文本和压缩格式之间转换数据文件；
+//       --bench-pack [数据文件] [重复次数] 对比文本与压缩格式的大小和加载/保存吞吐量；
+//       --bench-parallel [数据文件] [最大线程数] [重复次数] 对比不同线程数的排序和统计耗时；
+//       --bench-sort [数据文件] [重复次数] 对比规范化键排序与逐字段比较排序；
+//       --query 查询文本 [数据文件] 加载数据文件后执行一条查询；
+//       --group brand|category|brand,category [数据文件] [CSV文件] 加载数据文件后显示或导出分组统计；
+//       --bench-group [数据文件] [重复次数] 测量分组统计的耗时并核对增量维护的结果；
+//       --receive 到货单 [数据文件] 将到货单作为一个事务应用到数据文件，全部成功才保存；
+//       --bench-moves [变动数] [商品数] [重复次数] 测量库存变动日志的追加、加载和查询耗时；
+//       --shards [门店列表] [门店:编号...] 并行加载各门店的数据文件，显示全公司统计并按门店和编号查找；
+//       --bench-shards [数据文件] [分片数] [重复次数] 把数据文件拆成分片，对比串行与并行的加载和统计耗时；
+//       --bench-lazy [数据文件] [查找次数] 对比完整加载与延迟加载到第一次查询的耗时；
+//       --verify [数据文件] 校验数据文件，列出损坏的块或无效行
+// 返回：进程退出码
+int runCommandLine(int argc, char *argv[])
+{
+    const char *socketPath = argc > 2 ? argv[2] : PROTO_DEFAULT_SOCKET;
+
+    if (strcmp(argv[1], "--serve") == 0)
+    {
+        GoodsManager *manager = initGoodsManager();
+        if (manager == NULL)
+        {
+            printf("System initialization failed!\n");
+            return 1;
+        }
+        if (!loadFromFile(manager, DATA_FILE))
+        {
+            printf("Failed to load %s.\n", DATA_FILE);
+            freeGoodsManager(manager);
+            return 1;
+        }
+        ServerConfig config = {socketPath, argInt(argc, argv, 3, 0), DATA_FILE,
+                               argc > 4 ? argv[4] : CATALOG_DEFAULT_NAME};
+        manager->moves = openMoveLog(MOVE_LOG_FILE);
+        if (manager->moves == NULL)
+        {
+            printf("Warning: could not open %s, stock movements will not be recorded.\n", MOVE_LOG_FILE);
+        }
+        int ok = runGoodsServer(manager, &config);
+        closeMoveLog(manager->moves);
+        freeGoodsManager(manager);
+        return ok ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--catalog") == 0)
+    {
+        return runCatalogReader(argc > 2 ? argv[2] : CATALOG_DEFAULT_NAME, argc > 3 ? argc - 3 : 0, argv + 3);
+    }
+
+    if (strcmp(argv[1], "--loadgen") == 0)
+    {
+        LoadConfig config = {socketPath, DATA_FILE,
+                             argInt(argc, argv, 3, 4),
+                             argInt(argc, argv, 4, 10000),
+                             argInt(argc, argv, 5, 10),
+                             argInt(argc, argv, 6, 1),
+                             argInt(argc, argv, 7, 1)};
+        return runLoadGenerator(&config) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench-batch") == 0)
+    {
+        LoadConfig config = {socketPath, DATA_FILE, 1,
+                             argInt(argc, argv, 4, 100000),
+                             argInt(argc, argv, 5, 10),
+                             argInt(argc, argv, 3, 200),
+                             1};
+        return runBatchBenchmark(&config) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--suggest") == 0 && argc > 4)
+    {
+        return runSuggestQuery(argv[2], strcmp(argv[3], "name") == 0, argv[4], argInt(argc, argv, 5, 10)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--merge-delta") == 0 && argc > 4)
+    {
+        return mergeDeltaFile(argv[2], argv[3], argv[4]) ? 0 : 1;
+    }
+
+    if ((strcmp(argv[1], "--pack") == 0 || strcmp(argv[1], "--unpack") == 0) && argc > 3)
+    {
+        return convertDataFile(argv[2], argv[3], strcmp(argv[1], "--pack") == 0) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--verify") == 0)
+    {
+        return verifyDataFile(argc > 2 ? argv[2] : DATA_FILE) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench-pack") == 0)
+    {
+        return runPackBenchmark(argc > 2 ? argv[2] : DATA_FILE, argInt(argc, argv, 3, 3)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench-parallel") == 0)
+    {
+        return runParallelBenchmark(argc > 2 ? argv[2] : DATA_FILE, argInt(argc, argv, 3, 0), argInt(argc, argv, 4, 3)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--query") == 0 && argc > 2)
+    {
+        GoodsManager *manager = initGoodsManager();
+        if (manager == NULL || !loadFromFile(manager, argc > 3 ? argv[3] : DATA_FILE))
+        {
+            printf("Failed to load %s.\n", argc > 3 ? argv[3] : DATA_FILE);
+            freeGoodsManager(manager);
+            return 1;
+        }
+        int ok = runQueryText(manager, argv[2]);
+        freeGoodsManager(manager);
+        return ok ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench-sort") == 0)
+    {
+        return runSortBenchmark(argc > 2 ? argv[2] : DATA_FILE, argInt(argc, argv, 3, 3)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--group") == 0 && argc > 2 && parseGroupBy(argv[2]) >= 0)
+    {
+        GoodsManager *manager = initGoodsManager();
+        if (manager == NULL || !loadFromFile(manager, argc > 3 ? argv[3] : DATA_FILE))
+        {
+            printf("Failed to load %s.\n", argc > 3 ? argv[3] : DATA_FILE);
+            freeGoodsManager(manager);
+            return 1;
+        }
+        GroupReport report;
+        int ok = buildGroupReport(manager, (GroupBy)parseGroupBy(argv[2]), &report);
+        if (ok && argc > 4)
+        {
+            ok = exportGroupReportCsv(&report, argv[4]);
+            printf(ok ? "Exported %d groups to %s.\n" : "Failed to write %d groups to %s!\n", report.count, argv[4]);
+        }
+        else if (ok)
+        {
+            displayGroupReport(&report);
+        }
+        freeGroupReport(&report);
+        freeGoodsManager(manager);
+        return ok ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--receive") == 0 && argc > 2)
+    {
+        const char *dataFile = argc > 3 ? argv[3] : DATA_FILE;
+        GoodsManager *manager = initGoodsManager();
+        if (manager == NULL || !loadFromFile(manager, dataFile))
+        {
+            printf("Failed to load %s.\n", dataFile);
+            freeGoodsManager(manager);
+            return 1;
+        }
+        // 库存变动先记在内存中，数据文件保存成功后才写入日志，失败时丢弃
+        MoveLog *moveLog = openMoveLog(MOVE_LOG_FILE);  // 打开失败时不记录
+        manager->moves = moveLog != NULL ? openMoveLog(NULL) : NULL;
+        GoodsTxn txn = { 0 };
+        char error[TXN_ERROR_SIZE];
+        char tempFile[MAX_PATH];
+        snprintf(tempFile, sizeof(tempFile), "%s.tmp", dataFile);  // 写完临时文件再替换，中途失败不会留下半个文件
+        beginTxn(&txn);
+        int applied = -1;
+        if (stageDeliveryFile(&txn, argv[2]) < 0)
+        {
+            printf("Could not stage %s.\n", argv[2]);
+            abortTxn(&txn);
+        }
+        else if ((applied = commitTxn(manager, &txn, error, sizeof(error))) < 0)
+        {
+            printf("Commit failed: %s. %s was not changed.\n", error, dataFile);
+        }
+        else if (!saveToFile(manager, tempFile)
+                 || !MoveFileExA(tempFile, dataFile, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        {
+            printf("Failed to save %s.\n", dataFile);
+            applied = -1;
+        }
+        else
+        {
+            printf("Applied %d stock adjustments and saved %s.\n", applied, dataFile);
+            if (manager->moves != NULL && !appendMoveLog(moveLog, manager->moves))
+            {
+                printf("Warning: the stock movements could not be written to %s.\n", MOVE_LOG_FILE);
+            }
+        }
+        closeMoveLog(manager->moves);
+        closeMoveLog(moveLog);
+        freeGoodsManager(manager);
+        return applied < 0 ? 1 : 0;
+    }
+
+    if (strcmp(argv[1], "--bench-group") == 0)
+    {
+        return runGroupBenchmark(argc > 2 ? argv[2] : DATA_FILE, argInt(argc, argv, 3, 3)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--shards") == 0)
+    {
+        return runShardCommand(argc > 2 ? argv[2] : SHARD_LIST_FILE, argc > 3 ? argc - 3 : 0, argv + 3);
+    }
+
+    if (strcmp(argv[1], "--bench-shards") == 0)
+    {
+        return runShardBenchmark(argc > 2 ? argv[2] : DATA_FILE, argInt(argc, argv, 3, 8), argInt(argc, argv, 4, 3)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench-lazy") == 0)
+    {
+        return runLazyBenchmark(argc > 2 ? argv[2] : DATA_FILE, argInt(argc, argv, 3, 100000)) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench-moves") == 0)
+    {
+        return runMoveBenchmark(argInt(argc, argv, 2, 10000000), argInt(argc, argv, 3, 100000), argInt(argc, argv, 4, 3)) ? 0 : 1;
+    }
+
+    printf("Usage:\n");
+    printf("  %s                 Interactive menu\n", argv[0]);
+    printf("  %s --lazy          Interactive menu, loading %s in the background\n", argv[0], DATA_FILE);
+    printf("  %s --serve [socket] [workers] [catalog]\n", argv[0]);
+    printf("  %s --catalog [catalog] [id...]\n", argv[0]);
+    printf("  %s --loadgen [socket] [connections] [operations] [adjust%%] [batch] [pipeline]\n", argv[0]);
+    printf("  %s --bench-batch [socket] [batch] [operations] [adjust%%]\n", argv[0]);
+    printf("  %s --suggest socket id|name prefix [limit]\n", argv[0]);
+    printf("  %s --merge-delta base delta out\n", argv[0]);
+    printf("  %s --pack|--unpack in out\n", argv[0]);
+    printf("  %s --bench-pack [file] [rounds]\n", argv[0]);
+    printf("  %s --bench-parallel [file] [threads] [rounds]\n", argv[0]);
+    printf("  %s --bench-sort [file] [rounds]\n", argv[0]);
+    printf("  %s --query \"query\" [file]\n", argv[0]);
+    printf("  %s --group brand|category|brand,category [file] [csv]\n", argv[0]);
+    printf("  %s --bench-group [file] [rounds]\n", argv[0]);
+    printf("  %s --receive delivery [file]\n", argv[0]);
+    printf("  %s --bench-moves [movements] [skus] [rounds]\n", argv[0]);
+    printf("  %s --shards [stores] [store:id...]\n", argv[0]);
+    printf("  %s --bench-shards [file] [shards] [rounds]\n", argv[0]);
+    printf("  %s --bench-lazy [file] [lookups]\n", argv[0]);
+    printf("  %s --verify [file]\n", argv[0]);
+    return 1;
+}
+
+// 主函数
+// 功能：程序的入口点，实现主要交互逻辑；带参数时进入命令行模式
+int main(int argc, char *argv[])
+{
+    // --lazy：菜单立即出现，数据文件在后台完整加载(见lazy.h)
+    LazyCatalog *lazy = NULL;
+    if (argc > 1 && strcmp(argv[1], "--lazy") == 0)
+    {
+        lazy = openLazyCatalog(DATA_FILE);
+        if (lazy == NULL)
+        {
+            printf("Failed to open %s; starting with an empty catalog.\n", DATA_FILE);
+        }
+        else
+        {
+            printf("%s %d products by ID in %.1f ms; the full catalog is loading in the background.\n",
+                   lazyIndexLoaded(lazy) ? "Loaded the saved index of" : "Indexed", lazyIndexedCount(lazy), lazyIndexMs(lazy));
+        }
+    }
+    else if (argc > 1)
+    {
+        return runCommandLine(argc, argv);
+    }
+
+    // 初始化商品管理器
+    GoodsManager *manager = initGoodsManager();
+    if (manager == NULL)
+    {
+        printf("System initialization failed!\n");
+        closeLazyCatalog(lazy);
+        return 1;
+    }
+    g_persist = startPersistWriter(manager, DATA_FILE, PERSIST_DEFAULT_INTERVAL_MS, PERSIST_DEFAULT_MAX_PENDING);
+    if (g_persist == NULL)
+    {
+        printf("Failed to start background saving!\n");
+        closeLazyCatalog(lazy);
+        freeGoodsManager(manager);
+        return 1;
+    }
+    g_moves = openMoveLog(MOVE_LOG_FILE);
+    if (g_moves == NULL)
+    {
+        printf("Warning: could not open %s, stock movements will not be recorded.\n", MOVE_LOG_FILE);
+    }
+    manager->moves = g_moves;
+
+    // 主循环
+    int choice;
+    do
+    {
+        displayMenu();
+        if (scanf_s("%d", &choice) != 1)
+        {
+            clearInputBuffer();
+            printf("Invalid input. Please enter a number between 0 and 17.\n");
+            continue;
+        }
+        clearInputBuffer();
+
+        if (choice < 0 || choice > 17)
+        {
+            printf("Invalid choice. Please enter a number between 0 and 17.\n");
+            continue;
+        }
+
+        // 延迟加载期间只有按编号查找不必等待，其他功能先换用完整加载的管理器
+        if (lazy != NULL && choice == 3 && !lazyCatalogReady(lazy))
+        {
+            handleLazySearch(lazy);
+            continue;
+        }
+        if (lazy != NULL && choice != 0)
+        {
+            finishLazyStart(&manager, &lazy);
+        }
+
+        // 处理用户选择
+        switch (choice)
+        {
+        case 0: // 退出系统
+            if (getConfirmation("Confirm exit?"))
+            {
+                // 等待后台线程保存全部修改后再退出
+                PersistStatus status;
+                getPersistStatus(g_persist, &status);
+                if (!stopPersistWriter(g_persist))
+                {
+                    printf("Failed to save file! %lld changes were lost.\n", status.pending);
+                }
+                else if (status.pending > 0)
+                {
+                    printf("Saved %lld pending changes.\n", status.pending);
+                }
+                if (g_txn.count > 0)
+                {
+                    printf("Discarded %d uncommitted changes.\n", g_txn.count);
+                }
+                abortTxn(&g_txn);
+                closeLazyCatalog(lazy);
+                closeMoveLog(g_moves);
+                freeGoodsManager(manager);
+                printf("Thank you for using. Goodbye!\n");
+                return 0;
+            }
+            break;
+
+        case 1: // 批量导入
+            handleBatchInput(&manager);
+            break;
+
+        case 2: // 显示所有商品
+            displayAllGoods(manager);
+            break;
+
+        case 3: // 查询商品
+            handleSearch(manager);
+            break;
+
+        case 4: // 添加新商品
+            printf("\n=== Add New Product ===\n");
+            Goods newGoods = inputGoodsInfo();
+            if (isValidGoods(newGoods))
+            {
+                lockGoodsExclusive(manager);
+                int added = addGoods(manager, newGoods);
+                unlockGoodsExclusive(manager);
+                if (added)
+                {
+                    printf("Add successful!\n");
+                    queueSave();
+                }
+                else
+                {
+                    printf("Add failed, Product ID may already exist (or out of memory)!\n");
+                }
+            }
+            else
+            {
+                printf("Invalid product information!\n");
+            }
+            break;
+
+        case 5: // 删除商品
+            handleDelete(manager);
+            break;
+
+        case 6: // 更新商品
+            handleUpdate(manager);
+            break;
+
+        case 7: // 按类别统计
+            do {
+                printf("\n=== Count by Category ===\n");
+                displayCategoryMenu();
+                int categoryChoice;
+                if (scanf_s("%d", &categoryChoice) != 1 || categoryChoice < 0 || categoryChoice > 4)
+                {
+                    clearInputBuffer();
+                    printf("Invalid input. Please enter a number between 0 and 4.\n");
+                    continue;
+                }
+                clearInputBuffer();
+
+                if (categoryChoice == 4) // All categories
+                {
+                    printf("Pen products: %d\n", countGoodsByCategory(manager, PEN));
+                    printf("Notebook products: %d\n", countGoodsByCategory(manager, NOTEBOOK));
+                    printf("Paint products: %d\n", countGoodsByCategory(manager, PAINT));
+                    printf("Other products: %d\n", countGoodsByCategory(manager, OTHER));
+                }
+                else
+                {
+                    GoodsCategory selectedCategory = (GoodsCategory)categoryChoice;
+                    int count = countGoodsByCategory(manager, selectedCategory);
+                    printf("Products in category [%s]: %d\n", categoryToString(selectedCategory), count);
+                }
+
+                // 提示用户是否返回主菜单
+                if (getConfirmation("Return to main menu?"))
+                {
+                    break;
+                }
+            } while (1);
+            break;
+
+        case 8: // 排序
+            printf("\n=== Sort Products ===\n");
+            printf("1. Price Ascending\n2. Price Descending\n3. Multiple Fields\nSelect sort order (1-3): ");
+            int sortChoice = 1;
+            if (scanf_s("%d", &sortChoice) != 1 || sortChoice < 1 || sortChoice > 3)
+            {
+                clearInputBuffer();
+                printf("Invalid input, using default ascending order.\n");
+                sortChoice = 1;
+            }
+            else
+            {
+                clearInputBuffer();
+            }
+            if (sortChoice == 3)
+            {
+                char sortSpec[SORT_SPEC_SIZE];
+                SortKey sortKeys[SORT_MAX_KEYS];
+                printf("Fields: category, brand, name, price, stock, value; prefix '-' for descending.\n");
+                printf("Enter fields in order (e.g. category,brand,-price): ");
+                if (fgets(sortSpec, sizeof(sortSpec), stdin) == NULL)
+                {
+                    break;
+                }
+                sortSpec[strcspn(sortSpec, "\n")] = 0;
+                int keyCount = parseSortKeys(sortSpec, sortKeys);
+                if (keyCount == 0)
+                {
+                    printf("Invalid sort fields.\n");
+                    break;
+                }
+                lockGoodsExclusive(manager);
+                int sorted = sortGoods(manager, sortKeys, keyCount);
+                unlockGoodsExclusive(manager);
+                if (!sorted)
+                {
+                    printf("Not enough memory to sort.\n");
+                    break;
+                }
+            }
+            else
+            {
+                lockGoodsExclusive(manager);
+                sortGoodsByPrice(manager, sortChoice == 1);
+                unlockGoodsExclusive(manager);
+            }
+            displayAllGoods(manager);
+            break;
+
+        case 9: // 计算总价值
+            printf("\n=== Total Inventory Value ===\n");
+            char totalText[MONEY_TEXT_SIZE];
+            Money totalValue = calculateTotalValue(manager);
+            printf("Current total inventory value: %s\n",
+                   formatMoney(totalValue, totalText, sizeof(totalText)));
+            break;
+
+        case 10: // 性能统计
+            handleStats(manager);
+            break;
+
+        case 11: // 排行与区间查询
+            handleRank(manager);
+            break;
+
+        case 12: // 调整库存
+            handleAdjustStock(manager);
+            break;
+
+        case 13: // 补货提醒
+            handleReorder(manager);
+            break;
+
+        case 14: // 增量同步
+            handleDelta(manager);
+            break;
+
+        case 15: // 分组统计
+            handleGroups(manager);
+            break;
+
+        case 16: // 事务
+            handleTxn(manager);
+            break;
+
+        case 17: // 库存变动历史
+            handleMoves(manager);
             break;
 
         default:
@@ -0,0 +1,861 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "movelog.h"
+#include "store.h"
+#include "crc32c.h"
+#include <io.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#define MOVE_READ_BATCH 2048          // 加载时每次读取的记录数
+#define MOVE_BENCH_FILE "goods_moves_bench.log" // 基准测试使用的临时日志文件
+#define MOVE_BENCH_DAYS 90            // 基准测试记录覆盖的天数
+#define MOVE_BENCH_QUERIES 1000       // 基准测试中按SKU查询的次数
+
+//写入32位小端整数
+static void putMoveU32(unsigned char* p, unsigned int value)
+{
+    p[0] = (unsigned char)value;
+    p[1] = (unsigned char)(value >> 8);
+    p[2] = (unsigned char)(value >> 16);
+    p[3] = (unsigned char)(value >> 24);
+}
+
+//读取32位小端整数
+static unsigned int getMoveU32(const unsigned char* p)
+{
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+//编码一条记录
+//功能：按日志文件的格式版本写出32字节的记录，格式2在末尾附带前28字节的CRC32C
+static void encodeMoveRecord(unsigned char* p, int format, const char* id, unsigned int time, int delta, MoveReason reason)
+{
+    memset(p, 0, MOVE_RECORD_SIZE);
+    if (format == MOVE_FORMAT_V1)
+    {
+        memcpy(p, id, strlen(id));
+        putMoveU32(p + 20, time);
+        putMoveU32(p + 24, (unsigned int)delta);
+        p[28] = (unsigned char)reason;
+        return;
+    }
+    memcpy(p, id, strlen(id));  //19个字符的编号占满编号字段，不带'\0'
+    p[19] = (unsigned char)reason;
+    putMoveU32(p + 20, time);
+    putMoveU32(p + 24, (unsigned int)delta);
+    putMoveU32(p + 28, crc32c(0, p, 28));
+}
+
+//解码一条记录
+//返回：有效返回1，写入中断留下的残缺记录(编号为空、原因越界或校验和不符)返回0
+static int decodeMoveRecord(const unsigned char* p, int format, char* id, unsigned int* time, int* delta, unsigned int* reason)
+{
+    if (format == MOVE_FORMAT_V1)
+    {
+        memcpy(id, p, 20);
+        *reason = p[28];
+        if (memchr(id, '\0', 20) == NULL)
+        {
+            return 0;
+        }
+    }
+    else
+    {
+        memcpy(id, p, 19);
+        id[19] = '\0';
+        *reason = p[19];
+        if (getMoveU32(p + 28) != crc32c(0, p, 28))
+        {
+            return 0;
+        }
+    }
+    *time = getMoveU32(p + 20);
+    *delta = (int)getMoveU32(p + 24);
+    return id[0] != '\0' && *reason < MOVE_REASON_COUNT;
+}
+
+//查找编号对应的SKU
+//返回：SKU序号，未出现过返回-1；pos输出查找结束的位置(新SKU应放入的哈希表项)
+static int findMoveSku(const MoveLog* log, const char* id, unsigned int* pos)
+{
+    if (log->skuTableSize == 0)
+    {
+        return -1;
+    }
+    unsigned int mask = (unsigned int)log->skuTableSize - 1;
+    unsigned int i = hashGoodsId(id) & mask;
+    while (log->skuTable[i] != 0)
+    {
+        int sku = log->skuTable[i] - 1;
+        if (strcmp(log->skus[sku].id, id) == 0)
+        {
+            return sku;
+        }
+        i = (i + 1) & mask;
+    }
+    if (pos != NULL)
+    {
+        *pos = i;
+    }
+    return -1;
+}
+
+//扩大SKU哈希表
+//返回：成功返回1，内存不足返回0
+static int growMoveSkuTable(MoveLog* log)
+{
+    int newSize = log->skuTableSize == 0 ? 1024 : log->skuTableSize * 2;
+    int* table = (int*)calloc((size_t)newSize, sizeof(int));
+    if (table == NULL)
+    {
+        return 0;
+    }
+    unsigned int mask = (unsigned int)newSize - 1;
+    for (int sku = 0; sku < log->skuCount; sku++)
+    {
+        unsigned int i = hashGoodsId(log->skus[sku].id) & mask;
+        while (table[i] != 0)
+        {
+            i = (i + 1) & mask;
+        }
+        table[i] = sku + 1;
+    }
+    free(log->skuTable);
+    log->skuTable = table;
+    log->skuTableSize = newSize;
+    return 1;
+}
+
+//登记编号
+//返回：SKU序号，内存不足或SKU数超过24位序号的范围返回-1
+static int internMoveSku(MoveLog* log, const char* id)
+{
+    unsigned int pos;
+    int sku = findMoveSku(log, id, &pos);
+    if (sku >= 0)
+    {
+        return sku;
+    }
+    if (log->skuCount >= (1 << 24))
+    {
+        return -1;
+    }
+    if ((log->skuCount + 1) * 2 > log->skuTableSize)
+    {
+        if (!growMoveSkuTable(log))
+        {
+            return -1;
+        }
+        findMoveSku(log, id, &pos);
+    }
+    if (log->skuCount == log->skuCapacity)
+    {
+        int newCapacity = log->skuCapacity == 0 ? 256 : log->skuCapacity * 2;
+        MoveSku* skus = (MoveSku*)realloc(log->skus, (size_t)newCapacity * sizeof(MoveSku));
+        if (skus == NULL)
+        {
+            return -1;
+        }
+        log->skus = skus;
+        log->skuCapacity = newCapacity;
+    }
+    sku = log->skuCount++;
+    strcpy_s(log->skus[sku].id, sizeof(log->skus[sku].id), id);
+    log->skus[sku].last = -1;
+    log->skuTable[pos] = sku + 1;
+    return sku;
+}
+
+//为记录数组预留空间
+//功能：保证还能再放入extra条记录
+//返回：成功返回1，内存不足返回0
+static int reserveMoveRecords(MoveLog* log, int extra)
+{
+    if (log->count + (long long)extra <= log->capacity)
+    {
+        return 1;
+    }
+    if (log->count + (long long)extra > 0x40000000)
+    {
+        return 0;
+    }
+    int newCapacity = log->capacity == 0 ? 4096 : log->capacity;
+    while (newCapacity < log->count + extra)
+    {
+        newCapacity *= 2;
+    }
+    Movement* records = (Movement*)realloc(log->records, (size_t)newCapacity * sizeof(Movement));
+    if (records == NULL)
+    {
+        return 0;
+    }
+    log->records = records;
+    log->capacity = newCapacity;
+    return 1;
+}
+
+//在内存中放入一条记录
+//功能：调用者已预留记录空间并登记了SKU，这一步不会失败；时间早于上一条时沿用上一条的时间，保证记录按时间不递减
+static void placeMoveRecord(MoveLog* log, int sku, unsigned int time, int delta, MoveReason reason)
+{
+    if (time < log->lastTime)
+    {
+        time = log->lastTime;
+    }
+    Movement* record = &log->records[log->count];
+    record->time = time;
+    record->delta = delta;
+    record->prev = log->skus[sku].last;
+    record->sku = (unsigned int)sku;
+    record->reason = (unsigned int)reason;
+    log->skus[sku].last = log->count++;
+    log->lastTime = time;
+}
+
+//在内存中追加一条记录
+//返回：成功返回1，内存不足返回0
+static int addMoveRecord(MoveLog* log, const char* id, unsigned int time, int delta, MoveReason reason)
+{
+    int sku = reserveMoveRecords(log, 1) ? internMoveSku(log, id) : -1;
+    if (sku < 0)
+    {
+        return 0;
+    }
+    placeMoveRecord(log, sku, time, delta, reason);
+    return 1;
+}
+
+//把编码好的记录写入文件末尾
+//功能：写入后立即刷新；写入或刷新失败时回到原来的文件末尾并截断，不在文件中留下残缺的记录
+//返回：成功返回1，失败返回0
+static int writeMoveRecords(MoveLog* log, const unsigned char* data, int count)
+{
+    long long end = MOVE_HEADER_SIZE + (long long)log->count * MOVE_RECORD_SIZE;
+    if (fwrite(data, MOVE_RECORD_SIZE, (size_t)count, log->file) == (size_t)count && fflush(log->file) == 0)
+    {
+        return 1;
+    }
+    clearerr(log->file);
+    _fseeki64(log->file, end, SEEK_SET);
+    _chsize_s(_fileno(log->file), end);
+    return 0;
+}
+
+//加载日志文件中的全部记录
+//功能：逐批读取并解码，遇到无效的记录即停止并截掉文件中其后的内容，文件位置停在最后一条有效记录之后
+//返回：成功返回1，内存不足返回0
+static int loadMoveRecords(MoveLog* log)
+{
+    unsigned char* buffer = (unsigned char*)malloc((size_t)MOVE_READ_BATCH * MOVE_RECORD_SIZE);
+    if (buffer == NULL)
+    {
+        return 0;
+    }
+    int valid = 1;
+    int ok = 1;
+    while (valid && ok)
+    {
+        size_t read = fread(buffer, MOVE_RECORD_SIZE, MOVE_READ_BATCH, log->file);
+        for (size_t i = 0; i < read; i++)
+        {
+            const unsigned char* p = buffer + i * MOVE_RECORD_SIZE;
+            char id[20];
+            unsigned int time, reason;
+            int delta;
+            if (!decodeMoveRecord(p, log->format, id, &time, &delta, &reason))
+            {
+                valid = 0;  //写入中断留下的残缺记录
+                break;
+            }
+            if (!addMoveRecord(log, id, time, delta, (MoveReason)reason))
+            {
+                ok = 0;
+                break;
+            }
+        }
+        if (read < MOVE_READ_BATCH)
+        {
+            break;
+        }
+    }
+    free(buffer);
+
+    //截掉最后一条有效记录之后的内容，否则其后残留的有效记录会在下次追加覆盖残缺记录后重新被加载
+    long long end = MOVE_HEADER_SIZE + (long long)log->count * MOVE_RECORD_SIZE;
+    _fseeki64(log->file, end, SEEK_SET);
+    if (ok && !valid)
+    {
+        _chsize_s(_fileno(log->file), end);
+    }
+    return ok;
+}
+
+//打开库存变动日志
+//功能：文件不存在时创建并写入文件头；存在时校验文件头并加载全部记录。文件头无效时不修改文件，返回NULL
+//参数：filename - 日志文件，NULL表示只在内存中记录
+//返回：成功返回日志指针，失败返回NULL
+MoveLog* openMoveLog(const char* filename)
+{
+    MoveLog* log = (MoveLog*)calloc(1, sizeof(MoveLog));
+    if (log == NULL || filename == NULL)
+    {
+        if (log != NULL)
+        {
+            log->format = MOVE_FORMAT;
+        }
+        return log;
+    }
+
+    unsigned char header[MOVE_HEADER_SIZE];
+    errno_t err = fopen_s(&log->file, filename, "r+b");
+    if (err == ENOENT)
+    {
+        //文件不存在，新建
+        if (fopen_s(&log->file, filename, "w+b") != 0 || log->file == NULL)
+        {
+            free(log);
+            return NULL;
+        }
+        setvbuf(log->file, NULL, _IOFBF, 1 << 16);
+        memset(header, 0, sizeof(header));
+        putMoveU32(header, MOVE_MAGIC);
+        putMoveU32(header + 4, MOVE_FORMAT);
+        putMoveU32(header + 8, MOVE_RECORD_SIZE);
+        log->format = MOVE_FORMAT;
+        if (fwrite(header, 1, sizeof(header), log->file) != sizeof(header) || fflush(log->file) != 0)
+        {
+            fclose(log->file);
+            free(log);
+            return NULL;
+        }
+    }
+    else if (err != 0 || log->file == NULL)
+    {
+        free(log);
+        return NULL;
+    }
+    else if (setvbuf(log->file, NULL, _IOFBF, 1 << 16) != 0
+             || fread(header, 1, sizeof(header), log->file) != sizeof(header)
+             || getMoveU32(header) != MOVE_MAGIC
+             || (getMoveU32(header + 4) != MOVE_FORMAT && getMoveU32(header + 4) != MOVE_FORMAT_V1)
+             || getMoveU32(header + 8) != MOVE_RECORD_SIZE)
+    {
+        closeMoveLog(log);
+        return NULL;
+    }
+    else
+    {
+        log->format = (int)getMoveU32(header + 4);  //旧格式的日志沿用旧格式追加
+        if (!loadMoveRecords(log))
+        {
+            closeMoveLog(log);
+            return NULL;
+        }
+    }
+    return log;
+}
+
+//刷新并关闭日志
+void closeMoveLog(MoveLog* log)
+{
+    if (log == NULL)
+    {
+        return;
+    }
+    if (log->file != NULL)
+    {
+        fclose(log->file);
+    }
+    free(log->records);
+    free(log->skus);
+    free(log->skuTable);
+    free(log);
+}
+
+//追加一条库存变动记录
+//功能：先预留内存，再写入文件并刷新，写入成功后才加入内存中的索引；增量为0时不记录
+//参数：when - Unix秒，0表示当前时间
+//返回：成功返回1，内存不足或写文件失败返回0并计入失败次数
+int appendMovement(MoveLog* log, const char* id, int delta, MoveReason reason, unsigned int when)
+{
+    if (log == NULL || delta == 0)
+    {
+        return 1;
+    }
+    if (when == 0)
+    {
+        when = (unsigned int)time(NULL);
+    }
+    if (when < log->lastTime)
+    {
+        when = log->lastTime;
+    }
+    int sku = strlen(id) < 20 && reserveMoveRecords(log, 1) ? internMoveSku(log, id) : -1;
+    if (sku < 0)
+    {
+        log->failures++;
+        return 0;
+    }
+    if (log->file != NULL)
+    {
+        unsigned char record[MOVE_RECORD_SIZE];
+        encodeMoveRecord(record, log->format, id, when, delta, reason);
+        if (!writeMoveRecords(log, record, 1))
+        {
+            log->failures++;
+            return 0;
+        }
+    }
+    placeMoveRecord(log, sku, when, delta, reason);
+    return 1;
+}
+
+//追加另一日志中的全部记录
+//功能：按原顺序和时间把暂存日志(只在内存中记录的日志)中的记录追加到本日志，一次写入文件并刷新，
+//      写入成功后才加入内存中的索引；暂存日志的失败次数一并计入
+//返回：全部追加成功返回1，否则一条也不追加，返回0(失败次数记在日志中)
+int appendMoveLog(MoveLog* log, const MoveLog* staged)
+{
+    if (log == NULL)
+    {
+        return 1;
+    }
+    log->failures += staged->failures;
+    if (staged->count == 0)
+    {
+        return 1;
+    }
+
+    //先预留记录空间并登记SKU，再编码全部记录
+    int* skus = (int*)malloc((size_t)staged->count * sizeof(int));
+    unsigned char* data = log->file != NULL ? (unsigned char*)malloc((size_t)staged->count * MOVE_RECORD_SIZE) : NULL;
+    int ok = skus != NULL && (log->file == NULL || data != NULL) && reserveMoveRecords(log, staged->count);
+    unsigned int time = log->lastTime;
+    for (int i = 0; i < staged->count && ok; i++)
+    {
+        const Movement* record = &staged->records[i];
+        skus[i] = internMoveSku(log, staged->skus[record->sku].id);
+        ok = skus[i] >= 0;
+        time = record->time > time ? record->time : time;
+        if (ok && data != NULL)
+        {
+            encodeMoveRecord(data + (size_t)i * MOVE_RECORD_SIZE, log->format, staged->skus[record->sku].id,
+                             time, record->delta, (MoveReason)record->reason);
+        }
+    }
+    ok = ok && (data == NULL || writeMoveRecords(log, data, staged->count));
+    for (int i = 0; i < staged->count && ok; i++)
+    {
+        const Movement* record = &staged->records[i];
+        placeMoveRecord(log, skus[i], record->time, record->delta, (MoveReason)record->reason);
+    }
+    if (!ok)
+    {
+        log->failures += staged->count;
+    }
+    free(skus);
+    free(data);
+    return ok;
+}
+
+//将缓冲区中的记录写入文件
+//功能：每次追加都已刷新，这里只在还有未写入的数据时才会实际写文件
+//返回：成功或没有日志文件返回1，失败返回0
+int flushMoveLog(MoveLog* log)
+{
+    return log == NULL || log->file == NULL || fflush(log->file) == 0;
+}
+
+//定位时间区间
+//功能：记录按时间不递减，二分查找第一条时间>=from和第一条时间>to的记录
+//返回：区间内第一条记录的下标，end输出区间之后第一条记录的下标(区间为空时二者相等)
+int findMoveRange(const MoveLog* log, unsigned int from, unsigned int to, int* end)
+{
+    int low = 0, high = log->count;
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (log->records[mid].time < from)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    int first = low;
+    high = log->count;
+    while (low < high)
+    {
+        int mid = low + (high - low) / 2;
+        if (log->records[mid].time <= to)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    *end = low < first ? first : low;
+    return first;
+}
+
+//统计一件商品在时间区间内的变动
+//功能：从该商品最新一条记录沿前一条下标向旧记录走，早于from时停止，只访问该商品的记录
+//返回：访问的记录数
+int sumMovements(const MoveLog* log, const char* id, unsigned int from, unsigned int to, MoveTotals* totals)
+{
+    memset(totals, 0, sizeof(*totals));
+    int sku = findMoveSku(log, id, NULL);
+    int visited = 0;
+    for (int i = sku >= 0 ? log->skus[sku].last : -1; i >= 0; i = log->records[i].prev)
+    {
+        const Movement* record = &log->records[i];
+        visited++;
+        if (record->time < from)
+        {
+            break;
+        }
+        if (record->time <= to)
+        {
+            totals->units[record->reason] += record->delta;
+            totals->movements++;
+        }
+    }
+    return visited;
+}
+
+//列出一件商品最近的记录
+//参数：indexes - 输出记录下标(从新到旧)，至少limit项
+//返回：条数
+int listMovements(const MoveLog* log, const char* id, int limit, int* indexes)
+{
+    int sku = findMoveSku(log, id, NULL);
+    int count = 0;
+    for (int i = sku >= 0 ? log->skus[sku].last : -1; i >= 0 && count < limit; i = log->records[i].prev)
+    {
+        indexes[count++] = i;
+    }
+    return count;
+}
+
+//排行项的先后：变动量大的在前，相同时SKU序号小的在前
+static int moverBefore(long long unitsA, int skuA, long long unitsB, int skuB)
+{
+    return unitsA > unitsB || (unitsA == unitsB && skuA < skuB);
+}
+
+//时间区间内变动量最大的k件商品
+//功能：二分查找定位区间后顺序扫描，按SKU序号累加所选原因的增量绝对值，
+//      再用容量为k的小顶堆选出前k名，按变动量从大到小输出
+//参数：reasonMask - 计入的原因集合(MOVE_MASK的组合)，results - 输出，至少k项
+//返回：条数，内存不足返回-1
+int topMovers(const MoveLog* log, unsigned int from, unsigned int to, unsigned int reasonMask, int k, MoveRank* results)
+{
+    if (k <= 0 || log->skuCount == 0)
+    {
+        return 0;
+    }
+    long long* units = (long long*)calloc((size_t)log->skuCount, sizeof(long long));
+    int* movements = (int*)calloc((size_t)log->skuCount, sizeof(int));
+    int* heap = (int*)malloc((size_t)k * sizeof(int));
+    if (units == NULL || movements == NULL || heap == NULL)
+    {
+        free(units);
+        free(movements);
+        free(heap);
+        return -1;
+    }
+
+    int end;
+    for (int i = findMoveRange(log, from, to, &end); i < end; i++)
+    {
+        const Movement* record = &log->records[i];
+        if (reasonMask & MOVE_MASK(record->reason))
+        {
+            units[record->sku] += record->delta < 0 ? -(long long)record->delta : record->delta;
+            movements[record->sku]++;
+        }
+    }
+
+    //堆顶是当前前k名中最靠后的一名
+    int size = 0;
+    for (int sku = 0; sku < log->skuCount; sku++)
+    {
+        if (movements[sku] == 0)
+        {
+            continue;
+        }
+        int pos;
+        if (size < k)
+        {
+            pos = size++;
+            while (pos > 0 && moverBefore(units[heap[(pos - 1) / 2]], heap[(pos - 1) / 2], units[sku], sku))
+            {
+                heap[pos] = heap[(pos - 1) / 2];
+                pos = (pos - 1) / 2;
+            }
+            heap[pos] = sku;
+            continue;
+        }
+        if (!moverBefore(units[sku], sku, units[heap[0]], heap[0]))
+        {
+            continue;
+        }
+        pos = 0;
+        while (1)
+        {
+            int child = pos * 2 + 1;
+            if (child >= size)
+            {
+                break;
+            }
+            if (child + 1 < size && moverBefore(units[heap[child]], heap[child], units[heap[child + 1]], heap[child + 1]))
+            {
+                child++;
+            }
+            if (!moverBefore(units[sku], sku, units[heap[child]], heap[child]))
+            {
+                break;
+            }
+            heap[pos] = heap[child];
+            pos = child;
+        }
+        heap[pos] = sku;
+    }
+
+    //依次取出堆顶，从后往前填入结果
+    for (int n = size; n > 0; n--)
+    {
+        int top = heap[0];
+        int last = heap[n - 1];
+        int pos = 0;
+        while (1)
+        {
+            int child = pos * 2 + 1;
+            if (child >= n - 1)
+            {
+                break;
+            }
+            if (child + 1 < n - 1 && moverBefore(units[heap[child]], heap[child], units[heap[child + 1]], heap[child + 1]))
+            {
+                child++;
+            }
+            if (!moverBefore(units[last], last, units[heap[child]], heap[child]))
+            {
+                break;
+            }
+            heap[pos] = heap[child];
+            pos = child;
+        }
+        heap[pos] = last;
+        MoveRank* rank = &results[n - 1];
+        strcpy_s(rank->id, sizeof(rank->id), log->skus[top].id);
+        rank->units = units[top];
+        rank->movements = movements[top];
+    }
+    free(units);
+    free(movements);
+    free(heap);
+    return size;
+}
+
+//变动原因转换为字符串
+const char* moveReasonToString(MoveReason reason)
+{
+    switch (reason)
+    {
+        case MOVE_RECEIVE: return "receive";
+        case MOVE_SALE: return "sale";
+        case MOVE_ADD: return "add";
+        case MOVE_CORRECTION: return "correction";
+        default: return "remove";
+    }
+}
+
+//当前计时器刻度
+static long long moveNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//测量库存变动日志的耗时
+//功能：生成覆盖90天的count条记录(约八成为销售，SKU按平方分布使少数商品变动多)写入临时文件，
+//      测量追加、重新加载、按SKU统计最近7天销量和最近7天/全部时间的前10名的耗时，
+//      并与逐条扫描全部记录的结果核对；结束后删除临时文件
+//返回：结果一致返回1，否则返回0
+int runMoveBenchmark(int count, int skuCount, int rounds)
+{
+    if (count <= 0)
+    {
+        count = 10000000;
+    }
+    if (skuCount <= 0)
+    {
+        skuCount = 100000;
+    }
+    if (rounds <= 0)
+    {
+        rounds = 3;
+    }
+    remove(MOVE_BENCH_FILE);
+    MoveLog* log = openMoveLog(MOVE_BENCH_FILE);
+    if (log == NULL)
+    {
+        printf("Failed to create %s.\n", MOVE_BENCH_FILE);
+        return 0;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ms = 1000.0 / (double)frequency.QuadPart;
+    printf("\n=== Movement Log Benchmark (%d movements, %d SKUs, %d days) ===\n", count, skuCount, MOVE_BENCH_DAYS);
+
+    //每条追加都要刷新文件，这里按批暂存后一次追加，与事务提交的写法相同
+    unsigned int start = (unsigned int)time(NULL) - MOVE_BENCH_DAYS * MOVE_DAY_SECONDS;
+    unsigned int seed = 2024;
+    int ok = 1;
+    MoveLog* staged = NULL;
+    long long begin = moveNow();
+    for (int i = 0; i < count && ok; i++)
+    {
+        if (staged == NULL && (staged = openMoveLog(NULL)) == NULL)
+        {
+            ok = 0;
+            break;
+        }
+        char id[20];
+        seed = seed * 1103515245u + 12345u;
+        unsigned int r = (seed >> 8) % (unsigned int)skuCount;
+        snprintf(id, sizeof(id), "SKU%07u", (unsigned int)((unsigned long long)r * r / (unsigned int)skuCount));
+        seed = seed * 1103515245u + 12345u;
+        int sale = (seed >> 8) % 10 < 8;
+        int delta = sale ? -(int)(1 + (seed >> 16) % 5) : (int)(10 + (seed >> 16) % 41);
+        unsigned int time = start + (unsigned int)((long long)i * MOVE_BENCH_DAYS * MOVE_DAY_SECONDS / count);
+        ok = appendMovement(staged, id, delta, sale ? MOVE_SALE : MOVE_RECEIVE, time);
+        if (ok && (staged->count == MOVE_READ_BATCH || i == count - 1))
+        {
+            ok = appendMoveLog(log, staged);
+            closeMoveLog(staged);
+            staged = NULL;
+        }
+    }
+    closeMoveLog(staged);
+    ok = ok && flushMoveLog(log);
+    long long appendTicks = moveNow() - begin;
+    closeMoveLog(log);
+    if (!ok)
+    {
+        printf("Failed to write %s.\n", MOVE_BENCH_FILE);
+        remove(MOVE_BENCH_FILE);
+        return 0;
+    }
+
+    begin = moveNow();
+    log = openMoveLog(MOVE_BENCH_FILE);
+    long long loadTicks = moveNow() - begin;
+    if (log == NULL || log->count != count)
+    {
+        printf("Failed to reload %s.\n", MOVE_BENCH_FILE);
+        closeMoveLog(log);
+        remove(MOVE_BENCH_FILE);
+        return 0;
+    }
+    printf("Append: %.0f ms (%.0f ns/movement), file %.1f MB\n", appendTicks * ms, appendTicks * ms * 1e6 / count,
+           (MOVE_HEADER_SIZE + (double)count * MOVE_RECORD_SIZE) / 1048576.0);
+    printf("Load:   %.0f ms, %.1f MB in memory\n", loadTicks * ms,
+           ((double)log->capacity * sizeof(Movement) + (double)log->skuCapacity * sizeof(MoveSku) + log->skuTableSize * sizeof(int)) / 1048576.0);
+
+    //按SKU统计最近7天的销量
+    unsigned int now = log->lastTime;
+    unsigned int weekAgo = now - 7 * MOVE_DAY_SECONDS;
+    long long visited = 0;
+    int identical = 1;
+    begin = moveNow();
+    for (int q = 0; q < MOVE_BENCH_QUERIES; q++)
+    {
+        MoveTotals totals;
+        visited += sumMovements(log, log->skus[(q * 7919) % log->skuCount].id, weekAgo, now, &totals);
+    }
+    long long sumTicks = moveNow() - begin;
+    printf("Units sold of one SKU, last 7 days: %.3f ms/query (%.0f records visited on average)\n",
+           sumTicks * ms / MOVE_BENCH_QUERIES, (double)visited / MOVE_BENCH_QUERIES);
+    for (int q = 0; q < 20; q++)
+    {
+        const char* id = log->skus[(q * 7919) % log->skuCount].id;
+        MoveTotals totals;
+        sumMovements(log, id, weekAgo, now, &totals);
+        long long expected = 0;
+        for (int i = 0; i < log->count; i++)
+        {
+            const Movement* record = &log->records[i];
+            if (strcmp(log->skus[record->sku].id, id) == 0 && record->time >= weekAgo && record->reason == MOVE_SALE)
+            {
+                expected += record->delta;
+            }
+        }
+        identical &= totals.units[MOVE_SALE] == expected;
+    }
+
+    //前10名：最近7天和全部时间
+    unsigned int froms[2] = { weekAgo, 0 };
+    const char* labels[2] = { "last 7 days", "all time" };
+    long long* expected = (long long*)calloc((size_t)log->skuCount, sizeof(long long));
+    for (int w = 0; w < 2 && expected != NULL; w++)
+    {
+        MoveRank top[10];
+        int n = 0;
+        long long best = -1;
+        for (int r = 0; r < rounds; r++)
+        {
+            begin = moveNow();
+            n = topMovers(log, froms[w], now, MOVE_MASK(MOVE_SALE), 10, top);
+            long long ticks = moveNow() - begin;
+            best = best < 0 || ticks < best ? ticks : best;
+        }
+        int first, end;
+        first = findMoveRange(log, froms[w], now, &end);
+        printf("Top 10 sellers, %s (%d movements): %.1f ms, #1 %s with %lld units\n",
+               labels[w], end - first, best * ms, n > 0 ? top[0].id : "-", n > 0 ? top[0].units : 0);
+
+        memset(expected, 0, (size_t)log->skuCount * sizeof(long long));
+        for (int i = 0; i < log->count; i++)
+        {
+            if (log->records[i].time >= froms[w] && log->records[i].reason == MOVE_SALE)
+            {
+                expected[log->records[i].sku] -= log->records[i].delta;
+            }
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int sku = findMoveSku(log, top[i].id, NULL);
+            identical &= expected[sku] == top[i].units && (i == 0 || top[i - 1].units >= top[i].units);
+        }
+        for (int sku = 0; sku < log->skuCount && n == 10; sku++)
+        {
+            if (expected[sku] > top[9].units)
+            {
+                int listed = 0;
+                for (int i = 0; i < n; i++)
+                {
+                    listed |= strcmp(top[i].id, log->skus[sku].id) == 0;
+                }
+                identical &= listed;
+            }
+        }
+    }
+    identical &= expected != NULL;
+    free(expected);
+    closeMoveLog(log);
+    remove(MOVE_BENCH_FILE);
+    printf(identical ? "Query results match a full scan of the log.\n" : "MISMATCH: query results differ from a full scan!\n");
+    return identical;
+}
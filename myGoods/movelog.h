@@ -0,0 +1,100 @@
+#ifndef MOVELOG_H
+#define MOVELOG_H
+
+#include <stdio.h>
+
+// 库存变动日志
+// 每次库存变化追加一条定长记录(编号、时间、增量、原因)，只追加不修改。
+// 文件格式：uint32魔数"GDMV" + uint32格式版本 + uint32记录字节数 + uint32保留，之后每条记录32字节：
+//   char[19]商品编号(以'\0'补齐) + uint8原因 + uint32时间(Unix秒) + int32增量 + uint32前28字节的CRC32C
+// 格式1的记录为char[20]商品编号 + uint32时间 + int32增量 + uint8原因 + 3字节保留，没有校验和，仍可读取并按原格式追加。
+// 整数均为小端序。加载时遇到不完整、无效或校验和不符的记录即停止并截掉其后的内容，之后的追加从该处写入。
+// 内存中每条记录16字节，编号换成日志内的SKU序号。记录按追加顺序存放，时间不递减
+// (系统时钟回拨时沿用上一条的时间)，因此记录数组本身就是时间索引，时间区间用二分查找定位；
+// 每条记录还保存同一SKU上一条记录的下标，每个SKU记住最新一条，按SKU查询时从新到旧只访问该SKU的记录。
+// 追加时先写入文件并刷新，成功后才加入内存；写入失败时把文件截断回原来的末尾。
+#define MOVE_LOG_FILE "goods_moves.log" // 默认日志文件路径
+#define MOVE_MAGIC 0x564D4447u          // 魔数"GDMV"
+#define MOVE_FORMAT 2                   // 格式版本
+#define MOVE_FORMAT_V1 1                // 不带校验和的旧格式版本
+#define MOVE_HEADER_SIZE 16             // 文件头字节数
+#define MOVE_RECORD_SIZE 32             // 每条记录的字节数
+#define MOVE_DAY_SECONDS 86400          // 一天的秒数
+
+// 变动原因
+typedef enum
+{
+    MOVE_RECEIVE,    // 入库(调整库存，增量为正)
+    MOVE_SALE,       // 出库/销售(调整库存，增量为负)
+    MOVE_ADD,        // 新增商品时的初始库存
+    MOVE_CORRECTION, // 修改商品信息时库存的变化
+    MOVE_REMOVE,     // 删除商品时清零库存
+    MOVE_REASON_COUNT // 原因总数
+} MoveReason;
+
+#define MOVE_MASK(reason) (1u << (reason))  // 原因集合中的一个原因
+#define MOVE_MASK_ALL ((1u << MOVE_REASON_COUNT) - 1) // 全部原因
+
+// 内存中的变动记录(16字节)
+typedef struct
+{
+    unsigned int time;       // 时间(Unix秒)
+    int delta;               // 库存增量
+    int prev;                // 同一SKU上一条记录的下标，-1表示没有
+    unsigned int sku : 24;   // 日志内的SKU序号
+    unsigned int reason : 8; // 变动原因
+} Movement;
+
+// 日志内的SKU
+typedef struct
+{
+    char id[20]; // 商品编号
+    int last;    // 最新一条记录的下标，-1表示没有
+} MoveSku;
+
+// 库存变动日志结构体
+typedef struct
+{
+    FILE *file;             // 日志文件，NULL表示只在内存中记录
+    int format;             // 日志文件的格式版本
+    Movement *records;      // 全部记录，按追加顺序(时间不递减)
+    int count;              // 记录数
+    int capacity;           // 记录数组容量
+    MoveSku *skus;          // SKU数组，按第一次出现的顺序
+    int skuCount;           // SKU数
+    int skuCapacity;        // SKU数组容量
+    int *skuTable;          // 编号到SKU的开放寻址哈希表，存放SKU序号+1，0表示空项
+    int skuTableSize;       // 哈希表大小(2的幂)
+    unsigned int lastTime;  // 最后一条记录的时间
+    long long failures;     // 追加失败(内存或写文件失败)的次数
+} MoveLog;
+
+// 一件商品在时间区间内的变动合计
+typedef struct
+{
+    long long units[MOVE_REASON_COUNT]; // 各原因的增量合计
+    int movements;                      // 变动次数
+} MoveTotals;
+
+// 时间区间内变动量最大的商品
+typedef struct
+{
+    char id[20];      // 商品编号
+    long long units;  // 变动量(所选原因的增量绝对值之和)
+    int movements;    // 变动次数
+} MoveRank;
+
+// 日志函数声明(追加时调用者持有管理器的写锁，查询时持有读锁)
+MoveLog *openMoveLog(const char *filename);                 // 打开(不存在时创建)日志并加载全部记录，filename为NULL时只在内存中记录，失败返回NULL
+void closeMoveLog(MoveLog *log);                            // 刷新并关闭日志
+int appendMovement(MoveLog *log, const char *id, int delta, MoveReason reason, unsigned int when); // 追加一条记录(when为0时取当前时间)，失败返回0
+int appendMoveLog(MoveLog *log, const MoveLog *staged);     // 按原顺序和时间追加另一日志中的全部记录，全部成功返回1
+int flushMoveLog(MoveLog *log);                             // 将缓冲区中的记录写入文件，成功返回1
+int findMoveRange(const MoveLog *log, unsigned int from, unsigned int to, int *end); // 返回时间在[from,to]内的第一条记录下标，end输出最后一条之后的下标
+int sumMovements(const MoveLog *log, const char *id, unsigned int from, unsigned int to, MoveTotals *totals); // 统计一件商品在时间区间内的变动，返回访问的记录数
+int listMovements(const MoveLog *log, const char *id, int limit, int *indexes); // 列出一件商品最近的limit条记录(从新到旧)，返回条数
+int topMovers(const MoveLog *log, unsigned int from, unsigned int to, unsigned int reasonMask, int k, MoveRank *results); // 时间区间内变动量最大的k件商品，返回条数，内存不足返回-1
+const char *moveReasonToString(MoveReason reason);          // 将变动原因转换为字符串
+int runMoveBenchmark(int count, int skuCount, int rounds);  // 生成count条记录，测量追加、加载和查询的耗时并与逐条扫描核对
+
+#endif
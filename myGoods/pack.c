@@ -0,0 +1,719 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "pack.h"
+#include "lz.h"
+#include "crc32c.h"
+#include "protocol.h"
+#include "loadindex.h"
+#include <stdlib.h>
+
+// 解析后的一行
+typedef struct
+{
+    Goods goods;      // 商品信息
+    int reorderPoint; // 补货点
+    int valid;        // 是否通过校验
+    const char *text; // 行文本(无效行打印警告时重新解析)
+} PackLine;
+
+// 加载时的一块
+typedef struct
+{
+    const unsigned char *data; // 块数据(指向文件缓冲区)
+    long long offset;          // 块头在文件中的位置
+    int rawSize;               // 原始长度
+    int packedSize;            // 压缩后长度
+    unsigned int crc;          // 块校验和
+    char *text;                // 解压后的文本
+    PackLine *lines;           // 各行解析结果
+    int lineCount;             // 行数
+    int corrupted;             // 校验和不符或解压失败
+} PackBlock;
+
+// 并行解压任务，各线程依次领取下一块
+typedef struct
+{
+    PackBlock *blocks;  // 全部块
+    int blockCount;     // 块数
+    volatile long next; // 下一个待领取的块号
+} PackJob;
+
+//读取高精度计时器
+static long long packNow()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+//文件是否为压缩格式
+//功能：只读取文件开头的魔数
+int isPackedFile(const char* filename)
+{
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "rb") != 0 || file == NULL)
+    {
+        return 0;
+    }
+    unsigned char magic[4];
+    int packed = fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+              && (magic[0] | magic[1] << 8 | magic[2] << 16 | (unsigned int)magic[3] << 24) == PACK_MAGIC;
+    fclose(file);
+    return packed;
+}
+
+//压缩并写出一块
+//返回：成功返回1，失败返回0
+static int writePackBlock(FILE* file, const unsigned char* raw, int rawSize, unsigned char* packed)
+{
+    int packedSize = lzCompress(raw, rawSize, packed, lzCompressBound(PACK_BLOCK_SIZE));
+    const unsigned char* data = packed;
+    if (packedSize <= 0 || packedSize >= rawSize)
+    {
+        packedSize = rawSize;  //压缩无效时保存原文
+        data = raw;
+    }
+
+    unsigned char header[PACK_BLOCK_HEADER_SIZE];
+    ProtoBuffer out;
+    protoBufferInit(&out, header, sizeof(header));
+    protoPutI32(&out, rawSize);
+    protoPutI32(&out, packedSize);
+    unsigned int crc = crc32c(crc32c(0, header, out.pos), data, (size_t)packedSize);
+    protoPutI32(&out, (int)crc);
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header)
+        && fwrite(data, 1, (size_t)packedSize, file) == (size_t)packedSize;
+}
+
+//写出文件头
+//返回：成功返回1，失败返回0
+static int writePackHeader(FILE* file, int blockCount)
+{
+    unsigned char header[PACK_HEADER_SIZE];
+    ProtoBuffer out;
+    protoBufferInit(&out, header, sizeof(header));
+    protoPutI32(&out, (int)PACK_MAGIC);
+    protoPutI32(&out, PACK_FORMAT);
+    protoPutI32(&out, blockCount);
+    protoPutI32(&out, (int)crc32c(0, header, out.pos));
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+//将快照保存为压缩格式
+//功能：按链表顺序格式化各行，攒满一块(只在行边界切分)后压缩写出，最后回填文件头中的块数；全程不持锁
+//返回：成功返回1，失败返回0
+int savePackedSnapshot(const GoodsSnapshot* snapshot, const char* filename)
+{
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "wb") != 0 || file == NULL)
+    {
+        return 0;
+    }
+    unsigned char* raw = (unsigned char*)malloc(PACK_BLOCK_SIZE);
+    unsigned char* packed = (unsigned char*)malloc((size_t)lzCompressBound(PACK_BLOCK_SIZE));
+    int ok = raw != NULL && packed != NULL && writePackHeader(file, 0);
+
+    int used = 0;
+    int blockCount = 0;
+    char line[GOODS_LINE_MAX];
+    for (int current = snapshot->head; ok && current != GOODS_NIL; current = SNAPSHOT_HOT(snapshot, current)->next)
+    {
+        int length = formatSnapshotLine(snapshot, current, line, sizeof(line));
+        if (used + length > PACK_BLOCK_SIZE)
+        {
+            ok = writePackBlock(file, raw, used, packed);
+            blockCount++;
+            used = 0;
+        }
+        memcpy(raw + used, line, (size_t)length);
+        used += length;
+    }
+    if (ok && used > 0)
+    {
+        ok = writePackBlock(file, raw, used, packed);
+        blockCount++;
+    }
+    if (ok)
+    {
+        ok = fseek(file, 0, SEEK_SET) == 0 && writePackHeader(file, blockCount);
+    }
+
+    free(raw);
+    free(packed);
+    if (fclose(file) != 0)
+    {
+        ok = 0;
+    }
+    return ok;
+}
+
+//解压并解析一块
+//功能：先核对校验和，再解压到独立的文本缓冲区，按换行切分后逐行解析校验(不打印警告)；
+//      只访问本块的数据，可在任意线程执行
+static void decodePackBlock(PackBlock* block)
+{
+    if (crc32c(crc32c(0, block->data - PACK_BLOCK_HEADER_SIZE, 8), block->data, (size_t)block->packedSize) != block->crc)
+    {
+        block->corrupted = 1;
+        return;
+    }
+    block->text = (char*)malloc((size_t)block->rawSize + 1);
+    if (block->text == NULL)
+    {
+        block->corrupted = 1;
+        return;
+    }
+    if (block->packedSize == block->rawSize)
+    {
+        memcpy(block->text, block->data, (size_t)block->rawSize);
+    }
+    else if (lzDecompress(block->data, block->packedSize, (unsigned char*)block->text, block->rawSize) != block->rawSize)
+    {
+        block->corrupted = 1;
+        return;
+    }
+    block->text[block->rawSize] = '\0';
+
+    int capacity = 1;
+    for (int i = 0; i < block->rawSize; i++)
+    {
+        capacity += block->text[i] == '\n';
+    }
+    block->lines = (PackLine*)malloc((size_t)capacity * sizeof(PackLine));
+    if (block->lines == NULL)
+    {
+        block->corrupted = 1;
+        return;
+    }
+
+    char* line = block->text;
+    while (*line != '\0')
+    {
+        char* next = strchr(line, '\n');
+        if (next != NULL)
+        {
+            *next++ = '\0';
+        }
+        PackLine* parsed = &block->lines[block->lineCount++];
+        parsed->text = line;
+        parsed->valid = parseGoodsLine(line, 0, &parsed->goods, &parsed->reorderPoint);
+        line = next != NULL ? next : line + strlen(line);
+    }
+}
+
+//解压线程
+static DWORD WINAPI packWorker(LPVOID param)
+{
+    PackJob* job = (PackJob*)param;
+    long index;
+    while ((index = InterlockedIncrement(&job->next) - 1) < job->blockCount)
+    {
+        decodePackBlock(&job->blocks[index]);
+    }
+    return 0;
+}
+
+//检查文件头
+//返回：文件头有效返回块数，否则打印原因并返回-1
+static int checkPackHeader(const unsigned char* header, const char* filename)
+{
+    ProtoBuffer in;
+    protoBufferInit(&in, (unsigned char*)header, PACK_HEADER_SIZE);
+    unsigned int magic = (unsigned int)protoGetI32(&in);
+    int format = protoGetI32(&in);
+    int blockCount = protoGetI32(&in);
+    unsigned int crc = (unsigned int)protoGetI32(&in);
+    if (magic != PACK_MAGIC || crc != crc32c(0, header, 12) || blockCount < 0)
+    {
+        printf("%s: file header is damaged.\n", filename);
+        return -1;
+    }
+    if (format != PACK_FORMAT)
+    {
+        printf("%s: unsupported format version %d.\n", filename, format);
+        return -1;
+    }
+    return blockCount;
+}
+
+//读取块头
+//返回：块头有效返回1，否则返回0
+static int getPackBlockHeader(const unsigned char* header, PackBlock* block)
+{
+    ProtoBuffer in;
+    protoBufferInit(&in, (unsigned char*)header, PACK_BLOCK_HEADER_SIZE);
+    block->rawSize = protoGetI32(&in);
+    block->packedSize = protoGetI32(&in);
+    block->crc = (unsigned int)protoGetI32(&in);
+    return block->rawSize >= 0 && block->rawSize <= PACK_BLOCK_SIZE
+        && block->packedSize >= 0 && block->packedSize <= block->rawSize;
+}
+
+//读取块头，建立块列表
+//功能：块头损坏时无法找到之后的块，给出出错的块号和位置
+//返回：块数，文件头或块头损坏、文件被截断返回-1
+static int readPackBlocks(const unsigned char* data, size_t size, const char* filename, PackBlock** blocks)
+{
+    *blocks = NULL;
+    if (size < PACK_HEADER_SIZE)
+    {
+        printf("%s: file is truncated.\n", filename);
+        return -1;
+    }
+    int blockCount = checkPackHeader(data, filename);
+    if (blockCount < 0 || (size_t)blockCount > size / PACK_BLOCK_HEADER_SIZE)
+    {
+        if (blockCount >= 0)
+        {
+            printf("%s: file header is damaged.\n", filename);
+        }
+        return -1;
+    }
+
+    *blocks = (PackBlock*)calloc((size_t)blockCount + 1, sizeof(PackBlock));
+    if (*blocks == NULL)
+    {
+        return -1;
+    }
+    size_t pos = PACK_HEADER_SIZE;
+    for (int i = 0; i < blockCount; i++)
+    {
+        PackBlock* block = &(*blocks)[i];
+        block->offset = (long long)pos;
+        const char* problem = NULL;
+        if (size - pos < PACK_BLOCK_HEADER_SIZE)
+        {
+            problem = "file is truncated";
+        }
+        else if (!getPackBlockHeader(data + pos, block))
+        {
+            problem = "block header is damaged";
+        }
+        else if ((size_t)block->packedSize > size - pos - PACK_BLOCK_HEADER_SIZE)
+        {
+            problem = "file is truncated";
+        }
+        if (problem != NULL)
+        {
+            printf("%s: block %d at offset %lld: %s.\n", filename, i + 1, block->offset, problem);
+            free(*blocks);
+            *blocks = NULL;
+            return -1;
+        }
+        block->data = data + pos + PACK_BLOCK_HEADER_SIZE;
+        pos += PACK_BLOCK_HEADER_SIZE + (size_t)block->packedSize;
+    }
+    return blockCount;
+}
+
+//并行解压并加载压缩文件
+//功能：先读取全部块头，再由多个线程并行解压和解析各块，最后按文件顺序加入管理器，
+//      行号、重复检查和导入结果与文本格式相同；有块损坏时列出损坏的块，不加入任何商品
+//返回：至少加载一条商品返回1，否则返回0
+int loadPackedFile(GoodsManager* manager, const char* filename)
+{
+    size_t size = 0;
+    unsigned char* data = readWholeFile(filename, &size);
+    if (data == NULL)
+    {
+        return 0;
+    }
+    PackBlock* blocks;
+    int blockCount = readPackBlocks(data, size, filename, &blocks);
+    if (blockCount < 0)
+    {
+        printf("Nothing loaded from %s.\n", filename);
+        free(data);
+        return 0;
+    }
+
+    //工作线程与当前线程一起领取块，线程创建失败时由当前线程完成剩余的块
+    PackJob job = {blocks, blockCount, 0};
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int threadCount = (int)info.dwNumberOfProcessors - 1;
+    if (threadCount > blockCount - 1)
+    {
+        threadCount = blockCount - 1;
+    }
+    HANDLE* threads = threadCount > 0 ? (HANDLE*)calloc((size_t)threadCount, sizeof(HANDLE)) : NULL;
+    int started = 0;
+    while (threads != NULL && started < threadCount)
+    {
+        threads[started] = CreateThread(NULL, 0, packWorker, &job, 0, NULL);
+        if (threads[started] == NULL)
+        {
+            break;
+        }
+        started++;
+    }
+    packWorker(&job);
+    for (int i = 0; i < started; i++)
+    {
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+    }
+    free(threads);
+
+    //任何块损坏都放弃加载，管理器保持不变
+    int corrupted = 0;
+    for (int b = 0; b < blockCount; b++)
+    {
+        if (blocks[b].corrupted)
+        {
+            printf("%s: block %d at offset %lld is corrupted.\n", filename, b + 1, blocks[b].offset);
+            corrupted++;
+        }
+    }
+    if (corrupted > 0)
+    {
+        printf("%d of %d blocks are corrupted, nothing loaded from %s.\n", corrupted, blockCount, filename);
+        for (int b = 0; b < blockCount; b++)
+        {
+            free(blocks[b].lines);
+            free(blocks[b].text);
+        }
+        free(blocks);
+        free(data);
+        return 0;
+    }
+
+    int success_count = 0;
+    int invalid_count = 0;
+    int duplicate_count = 0;
+    int line_number = 0;
+    for (int b = 0; b < blockCount; b++)
+    {
+        PackBlock* block = &blocks[b];
+        for (int i = 0; i < block->lineCount; i++)
+        {
+            const PackLine* line = &block->lines[i];
+            line_number++;
+            if (!line->valid)
+            {
+                Goods goods;
+                int reorder_point;
+                parseGoodsLine(line->text, line_number, &goods, &reorder_point);  //打印警告
+                invalid_count++;
+                continue;
+            }
+            if (findGoodsById(manager, line->goods.id, NULL))
+            {
+                printf("Warning: Line %d - Duplicate product ID '%s', skipping...\n",
+                       line_number, line->goods.id);
+                duplicate_count++;
+                continue;
+            }
+            if (addGoods(manager, line->goods))
+            {
+                if (line->reorderPoint > 0)
+                {
+                    setReorderPoint(manager, line->goods.id, line->reorderPoint);
+                }
+                success_count++;
+            }
+        }
+        free(block->lines);
+        free(block->text);
+    }
+    free(blocks);
+    free(data);
+
+    displayImportSummary(success_count, duplicate_count, invalid_count);
+    return success_count > 0;
+}
+
+//校验压缩数据文件
+//功能：顺序读取每块并核对校验和，不解压；块头损坏或文件被截断时无法找到之后的块，在此停止
+//参数：bytes - 输出已读取的字节数
+//返回：没有损坏返回1，否则返回0
+static int verifyPackedFile(FILE* file, const char* filename, long long* bytes)
+{
+    unsigned char header[PACK_HEADER_SIZE];
+    *bytes = 0;
+    if (fread(header, 1, sizeof(header), file) != sizeof(header))
+    {
+        printf("%s: file is truncated.\n", filename);
+        return 0;
+    }
+    int blockCount = checkPackHeader(header, filename);
+    unsigned char* buffer = (unsigned char*)malloc(PACK_BLOCK_HEADER_SIZE + PACK_BLOCK_SIZE);
+    if (blockCount < 0 || buffer == NULL)
+    {
+        free(buffer);
+        return 0;
+    }
+
+    long long offset = PACK_HEADER_SIZE;
+    int corrupted = 0;
+    const char* problem = NULL;
+    int b;
+    for (b = 0; b < blockCount && problem == NULL; b++)
+    {
+        PackBlock block;
+        if (fread(buffer, 1, PACK_BLOCK_HEADER_SIZE, file) != PACK_BLOCK_HEADER_SIZE)
+        {
+            problem = "file is truncated";
+        }
+        else if (!getPackBlockHeader(buffer, &block))
+        {
+            problem = "block header is damaged";
+        }
+        else if (fread(buffer + PACK_BLOCK_HEADER_SIZE, 1, (size_t)block.packedSize, file) != (size_t)block.packedSize)
+        {
+            problem = "file is truncated";
+        }
+        else
+        {
+            if (crc32c(crc32c(0, buffer, 8), buffer + PACK_BLOCK_HEADER_SIZE, (size_t)block.packedSize) != block.crc)
+            {
+                printf("%s: block %d at offset %lld: checksum mismatch.\n", filename, b + 1, offset);
+                corrupted++;
+            }
+            offset += PACK_BLOCK_HEADER_SIZE + block.packedSize;
+        }
+    }
+    free(buffer);
+    if (problem != NULL)
+    {
+        printf("%s: block %d at offset %lld: %s, later blocks cannot be checked.\n", filename, b, offset, problem);
+    }
+    else if (fgetc(file) != EOF)
+    {
+        printf("%s: unexpected data after the last block at offset %lld.\n", filename, offset);
+        corrupted++;
+    }
+    *bytes = offset;
+    printf("%d of %d blocks checked, %d corrupted.\n", problem != NULL ? b - 1 : b, blockCount, corrupted);
+    return problem == NULL && corrupted == 0;
+}
+
+//校验文本数据文件
+//功能：逐行解析找出格式错误的行，同时累计校验和，有校验和尾行时与之核对；
+//      没有校验和行的文件(手工编写或旧版本保存)只能检查格式
+//返回：没有无效行且校验和一致(或没有校验和)返回1，否则返回0
+static int verifyTextFile(FILE* file, long long* bytes)
+{
+    char line[GOODS_LINE_MAX];
+    int line_number = 0;
+    int invalid_count = 0;
+    unsigned int crc = 0;
+    unsigned int expected = 0;
+    int checksumLine = 0;  //校验和行的行号
+    int checksumValid = 1;
+    *bytes = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        Goods goods;
+        int reorder_point;
+        line_number++;
+        *bytes += (long long)strlen(line);
+        if (checksumLine > 0)
+        {
+            printf("Line %d - Data after the checksum line.\n", line_number);
+            checksumValid = 0;
+        }
+        int found = parseChecksumLine(line, &expected);
+        if (found != 0)
+        {
+            checksumLine = line_number;
+            checksumValid &= found > 0;
+            continue;
+        }
+        crc = crc32cGoodsLine(crc, line);
+        if (!parseGoodsLine(line, line_number, &goods, &reorder_point))
+        {
+            invalid_count++;
+        }
+    }
+    checksumValid &= checksumLine == 0 || crc == expected;
+    printf("%d of %d lines are invalid.\n", invalid_count, checksumLine > 0 ? line_number - 1 : line_number);
+    if (checksumLine == 0)
+    {
+        printf("No checksum line (the file was written by hand or by an older version); only the format was checked.\n");
+    }
+    else
+    {
+        printf("Checksum at line %d: %s (CRC32C %s).\n", checksumLine, checksumValid ? "match" : "MISMATCH",
+               crc32cHardware() ? "SSE4.2" : "software");
+    }
+    return invalid_count == 0 && checksumValid;
+}
+
+//校验数据文件
+//功能：压缩格式逐块核对CRC32C并列出损坏块的块号和文件位置，文本格式列出无效行并核对校验和尾行；
+//      只顺序读取一遍文件，不解压也不建立管理器
+//返回：完好返回1，否则返回0
+int verifyDataFile(const char* filename)
+{
+    int packed = isPackedFile(filename);
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "rb") != 0 || file == NULL)
+    {
+        printf("Cannot open %s.\n", filename);
+        return 0;
+    }
+    setvbuf(file, NULL, _IOFBF, 1 << 20);
+
+    long long bytes = 0;
+    long long start = packNow();
+    int ok = packed ? verifyPackedFile(file, filename, &bytes) : verifyTextFile(file, &bytes);
+    long long elapsed = packNow() - start;
+    fclose(file);
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double seconds = (double)elapsed / (double)frequency.QuadPart;
+    printf("%s: %lld bytes (%s format) verified in %.3f s, %.1f MB/s",
+           filename, bytes, packed ? "packed" : "text", seconds,
+           seconds > 0 ? (double)bytes / (1024.0 * 1024.0) / seconds : 0.0);
+    if (packed)
+    {
+        printf(", CRC32C %s", crc32cHardware() ? "SSE4.2" : "software");
+    }
+    printf(".\n");
+    printf(ok ? "No corruption found.\n" : "Corruption found.\n");
+    return ok;
+}
+
+//在文本和压缩格式之间转换数据文件
+//参数：packed - 1转换为压缩格式，0转换为文本格式
+//返回：成功返回1，失败返回0
+int convertDataFile(const char* inFile, const char* outFile, int packed)
+{
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL)
+    {
+        return 0;
+    }
+    int converted = 0;
+    if (!loadFromFile(manager, inFile))
+    {
+        printf("Failed to load %s.\n", inFile);
+    }
+    else
+    {
+        manager->packed = packed;
+        converted = saveToFile(manager, outFile);
+        if (converted)
+        {
+            printf("%d products written to %s.\n", manager->count, outFile);
+        }
+        else
+        {
+            printf("Failed to save %s.\n", outFile);
+        }
+    }
+    freeGoodsManager(manager);
+    return converted;
+}
+
+//取得文件大小
+static long long packFileSize(const char* filename)
+{
+    FILE* file = NULL;
+    if (fopen_s(&file, filename, "rb") != 0 || file == NULL)
+    {
+        return 0;
+    }
+    long long size = fseek(file, 0, SEEK_END) == 0 ? (long long)ftell(file) : 0;
+    fclose(file);
+    return size;
+}
+
+//测量一种格式的保存和加载耗时
+//功能：各重复rounds次，取最短耗时(计时器刻度)
+//返回：成功返回1，失败返回0
+static int measurePackFormat(GoodsManager* manager, const char* filename, int packed, int rounds,
+                             long long* saveTicks, long long* loadTicks)
+{
+    *saveTicks = *loadTicks = 0;
+    manager->packed = packed;
+    for (int r = 0; r < rounds; r++)
+    {
+        long long start = packNow();
+        if (!saveToFile(manager, filename))
+        {
+            return 0;
+        }
+        long long elapsed = packNow() - start;
+        if (r == 0 || elapsed < *saveTicks)
+        {
+            *saveTicks = elapsed;
+        }
+    }
+    for (int r = 0; r < rounds; r++)
+    {
+        GoodsManager* loaded = initGoodsManager();
+        if (loaded == NULL)
+        {
+            return 0;
+        }
+        long long start = packNow();
+        int ok = loadFromFile(loaded, filename);
+        long long elapsed = packNow() - start;
+        ok = ok && loaded->count == manager->count;
+        freeGoodsManager(loaded);
+        if (!ok)
+        {
+            return 0;
+        }
+        if (r == 0 || elapsed < *loadTicks)
+        {
+            *loadTicks = elapsed;
+        }
+    }
+    return 1;
+}
+
+//对比文本与压缩格式
+//功能：加载数据文件后分别以两种格式保存、加载，显示文件大小、压缩率和吞吐量；
+//      吞吐量按文本格式的字节数计算，两种格式可直接比较
+//返回：成功返回1，失败返回0
+int runPackBenchmark(const char* filename, int rounds)
+{
+    if (rounds <= 0)
+    {
+        rounds = 3;
+    }
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL || !loadFromFile(manager, filename))
+    {
+        printf("Failed to load %s.\n", filename);
+        freeGoodsManager(manager);
+        return 0;
+    }
+
+    char textFile[MAX_PATH];
+    char packFile[MAX_PATH];
+    sprintf_s(textFile, sizeof(textFile), "%s.bench.txt", filename);
+    sprintf_s(packFile, sizeof(packFile), "%s.bench.pack", filename);
+    long long textSave, textLoad, packSave, packLoad;
+    int ok = measurePackFormat(manager, textFile, 0, rounds, &textSave, &textLoad)
+          && measurePackFormat(manager, packFile, 1, rounds, &packSave, &packLoad);
+    long long textBytes = packFileSize(textFile);
+    long long packBytes = packFileSize(packFile);
+    int count = manager->count;
+    freeGoodsManager(manager);
+    remove(textFile);
+    removeLoadIndex(textFile);
+    remove(packFile);
+    if (!ok || textBytes == 0 || packBytes == 0)
+    {
+        printf("Benchmark failed.\n");
+        return 0;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double megabytes = (double)textBytes / (1024.0 * 1024.0);
+    double ticks = (double)frequency.QuadPart;
+    printf("\n=== Compression Benchmark (%d products, best of %d) ===\n", count, rounds);
+    printf("%-8s %14s %10s %14s %14s\n", "Format", "Bytes", "Ratio", "Save MB/s", "Load MB/s");
+    printf("%-8s %14lld %10.2f %14.1f %14.1f\n", "Text", textBytes, 1.0,
+           megabytes * ticks / (double)(textSave > 0 ? textSave : 1), megabytes * ticks / (double)(textLoad > 0 ? textLoad : 1));
+    printf("%-8s %14lld %10.2f %14.1f %14.1f\n", "Packed", packBytes, (double)textBytes / (double)packBytes,
+           megabytes * ticks / (double)(packSave > 0 ? packSave : 1), megabytes * ticks / (double)(packLoad > 0 ? packLoad : 1));
+    return 1;
+}
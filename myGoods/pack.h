@@ -0,0 +1,28 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include "snapshot.h"
+
+// 压缩数据文件
+// 内容与goods.txt的文本行相同，按整行切分为不超过64KB的块，每块用LZ块压缩(见lz.h)独立压缩，
+// 因此加载时各块可以并行解压和解析，之后按文件顺序依次加入管理器。
+// 文件格式：uint32魔数"GDPK" + uint32格式版本 + uint32块数 + uint32文件头校验和(前12字节的CRC32C)，之后每块为
+//   uint32原始长度 + uint32压缩后长度 + uint32块校验和 + 压缩数据(压缩后长度等于原始长度时为未压缩的原文)
+// 块校验和是块头前8字节与压缩数据连在一起的CRC32C(见crc32c.h)，因此不解压就能校验。
+// 整数均为小端序。loadFromFile按魔数自动识别；从压缩文件加载的管理器保存时仍写压缩格式。
+// 加载时先校验全部块，有任何块损坏都不加入任何商品，并列出损坏的块。
+#define PACK_MAGIC 0x4B504447u     // 魔数"GDPK"
+#define PACK_FORMAT 2              // 格式版本(2起带校验和)
+#define PACK_BLOCK_SIZE 65536      // 每块原始数据的最大字节数
+#define PACK_HEADER_SIZE 16        // 文件头字节数
+#define PACK_BLOCK_HEADER_SIZE 12  // 块头字节数
+
+// 压缩数据文件函数声明
+int isPackedFile(const char *filename);                                       // 文件是否为压缩格式
+int savePackedSnapshot(const GoodsSnapshot *snapshot, const char *filename);  // 将快照保存为压缩格式，成功返回1
+int loadPackedFile(GoodsManager *manager, const char *filename);              // 并行解压并加载压缩文件，至少加载一条返回1
+int verifyDataFile(const char *filename);                                     // 校验数据文件并列出损坏的块或行，完好返回1
+int convertDataFile(const char *inFile, const char *outFile, int packed);     // 在文本和压缩格式之间转换数据文件，成功返回1
+int runPackBenchmark(const char *filename, int rounds);                       // 对比文本与压缩格式的大小和加载/保存吞吐量
+
+#endif
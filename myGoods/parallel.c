@@ -0,0 +1,535 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PARALLEL_PARTITIONS_PER_THREAD 4 // 每个线程分到的分区数
+#define PARALLEL_PIECES_PER_THREAD 2     // 每轮合并中每个线程分到的块数
+
+// 价格排序项
+// 排序时只搬移价格和槽位号，价格相同才访问冷数据中的ID；ID唯一，因此任意两项都有确定的先后
+typedef struct
+{
+    Money price; // 商品单价(分)
+    int slot;    // 记录槽位号
+} PriceSortEntry;
+
+// 并行排序的状态
+typedef struct
+{
+    GoodsStore *store;        // 记录存储
+    int ascending;            // 是否升序
+    int partitions;           // 分区数
+    int *bounds;              // 各有序段在排序项数组中的起点，bounds[runCount]为总数
+    int runCount;             // 当前的有序段数
+    int piecesPerPair;        // 每对有序段的合并切成的块数
+    PriceSortEntry *src;      // 本轮输入
+    PriceSortEntry *dst;      // 本轮输出
+    volatile long failed;     // 是否有分区排序失败(内存不足)
+} ParallelSort;
+
+// 并行扫描的状态
+typedef struct
+{
+    GoodsStore *store;        // 记录存储
+    int partitions;           // 分区数
+    Money *sums;              // 各分区的库存价值
+    int *counts;              // 各分区的商品数
+    unsigned char category;   // 要统计的类别
+} ParallelScan;
+
+//排序辅助函数：比较两个排序项的先后
+//功能：按价格比较，价格相同时按ID升序
+//返回：a应排在b之前返回1，否则返回0
+static int priceEntryBefore(GoodsStore* store, const PriceSortEntry* a, const PriceSortEntry* b, int ascending)
+{
+    if (a->price != b->price)
+    {
+        return ascending ? a->price < b->price : a->price > b->price;
+    }
+    return strcmp(STORE_COLD(store, a->slot)->id, STORE_COLD(store, b->slot)->id) < 0;
+}
+
+//排序辅助函数：合并两个有序序列
+//功能：将两个有序的排序项序列合并到输出数组中
+//参数：a,b - 要合并的两个序列及其长度，out - 输出数组，ascending - 是否升序
+static void mergeSortedLists(GoodsStore* store, const PriceSortEntry* a, int aCount,
+                             const PriceSortEntry* b, int bCount, PriceSortEntry* out, int ascending)
+{
+    int i = 0, j = 0, k = 0;
+    while (i < aCount && j < bCount)
+    {
+        //升序：价格小的在前；降序：价格大的在前；价格相同时按ID升序
+        if (priceEntryBefore(store, &a[i], &b[j], ascending))
+        {
+            out[k++] = a[i++];
+        }
+        else
+        {
+            out[k++] = b[j++];
+        }
+    }
+    while (i < aCount)
+    {
+        out[k++] = a[i++];
+    }
+    while (j < bCount)
+    {
+        out[k++] = b[j++];
+    }
+}
+
+//归并排序
+//功能：对排序项数组进行自底向上的归并排序，不使用递归
+//参数：entries - 排序项数组，count - 数组长度，ascending - 是否升序
+//返回：成功返回1，内存不足返回0
+static int mergeSort(GoodsStore* store, PriceSortEntry* entries, int count, int ascending)
+{
+    PriceSortEntry* buffer = (PriceSortEntry*)malloc((size_t)count * sizeof(PriceSortEntry));
+    if (buffer == NULL)
+    {
+        return 0;
+    }
+
+    //每轮将相邻的两个长度为width的有序段合并
+    PriceSortEntry* src = entries;
+    PriceSortEntry* dst = buffer;
+    for (int width = 1; width < count; width *= 2)
+    {
+        for (int start = 0; start < count; start += 2 * width)
+        {
+            int mid = start + width < count ? start + width : count;
+            int end = start + 2 * width < count ? start + 2 * width : count;
+            mergeSortedLists(store, src + start, mid - start, src + mid, end - mid, dst + start, ascending);
+        }
+        PriceSortEntry* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    //结果位于缓冲区时复制回原数组
+    if (src != entries)
+    {
+        memcpy(entries, src, (size_t)count * sizeof(PriceSortEntry));
+    }
+    free(buffer);
+    return 1;
+}
+
+//分区数：每个线程若干个分区，但不超过页数
+static int partitionCount(const GoodsStore* store, TaskPool* pool)
+{
+    int partitions = poolThreadCount(pool) * PARALLEL_PARTITIONS_PER_THREAD;
+    return partitions < store->pageCount ? partitions : store->pageCount;
+}
+
+//分区的起始页
+static int partitionPage(const GoodsStore* store, int partitions, int partition)
+{
+    return (int)((long long)store->pageCount * partition / partitions);
+}
+
+//任务：统计分区中已使用的槽位数
+static void countSortPartition(void* context, int partition)
+{
+    ParallelSort* sort = (ParallelSort*)context;
+    GoodsStore* store = sort->store;
+    int count = 0;
+    int end = partitionPage(store, sort->partitions, partition + 1);
+    for (int page = partitionPage(store, sort->partitions, partition); page < end; page++)
+    {
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            count += (hot[i].flags & GOODS_FLAG_USED) != 0;
+        }
+    }
+    sort->bounds[partition + 1] = count;
+}
+
+//任务：收集分区中的排序项并排序
+static void sortPartition(void* context, int partition)
+{
+    ParallelSort* sort = (ParallelSort*)context;
+    GoodsStore* store = sort->store;
+    PriceSortEntry* out = sort->src + sort->bounds[partition];
+    int count = 0;
+    int end = partitionPage(store, sort->partitions, partition + 1);
+    for (int page = partitionPage(store, sort->partitions, partition); page < end; page++)
+    {
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            if (hot[i].flags & GOODS_FLAG_USED)
+            {
+                out[count].price = hot[i].price;
+                out[count].slot = (page << GOODS_PAGE_SHIFT) | i;
+                count++;
+            }
+        }
+    }
+    if (!mergeSort(store, out, count, sort->ascending))
+    {
+        InterlockedExchange(&sort->failed, 1);
+    }
+}
+
+//定位合并的切分点
+//功能：合并a、b后前diagonal项中有多少项来自a(二分查找合并路径与对角线的交点)
+static int splitMerge(GoodsStore* store, const PriceSortEntry* a, int aCount,
+                      const PriceSortEntry* b, int bCount, int diagonal, int ascending)
+{
+    int low = diagonal > bCount ? diagonal - bCount : 0;
+    int high = diagonal < aCount ? diagonal : aCount;
+    while (low < high)
+    {
+        int i = (low + high) / 2;
+        int j = diagonal - i;
+        if (j > 0 && priceEntryBefore(store, &a[i], &b[j - 1], ascending))
+        {
+            low = i + 1;  //a[i]应在b[j-1]之前输出，前diagonal项中来自a的更多
+        }
+        else
+        {
+            high = i;
+        }
+    }
+    return low;
+}
+
+//任务：合并一对有序段中的一块
+static void mergeSortPiece(void* context, int task)
+{
+    ParallelSort* sort = (ParallelSort*)context;
+    int pair = task / sort->piecesPerPair;
+    int piece = task % sort->piecesPerPair;
+    int first = 2 * pair;
+    int aBegin = sort->bounds[first];
+    int aEnd = sort->bounds[first + 1 < sort->runCount ? first + 1 : sort->runCount];
+    int bEnd = sort->bounds[first + 2 < sort->runCount ? first + 2 : sort->runCount];
+    const PriceSortEntry* a = sort->src + aBegin;
+    const PriceSortEntry* b = sort->src + aEnd;
+    int aCount = aEnd - aBegin;
+    int bCount = bEnd - aEnd;
+
+    int total = aCount + bCount;
+    int low = (int)((long long)total * piece / sort->piecesPerPair);
+    int high = (int)((long long)total * (piece + 1) / sort->piecesPerPair);
+    int aLow = splitMerge(sort->store, a, aCount, b, bCount, low, sort->ascending);
+    int aHigh = splitMerge(sort->store, a, aCount, b, bCount, high, sort->ascending);
+    mergeSortedLists(sort->store, a + aLow, aHigh - aLow, b + (low - aLow), (high - aHigh) - (low - aLow),
+                     sort->dst + aBegin + low, sort->ascending);
+}
+
+//任务：按排序结果重建一段链表
+static void relinkSortRange(void* context, int task)
+{
+    ParallelSort* sort = (ParallelSort*)context;
+    const PriceSortEntry* entries = sort->src;
+    int count = sort->bounds[sort->runCount];
+    int begin = (int)((long long)count * task / sort->partitions);
+    int end = (int)((long long)count * (task + 1) / sort->partitions);
+    for (int i = begin; i < end; i++)
+    {
+        int slot = entries[i].slot;
+        STORE_HOT(sort->store, slot)->next = i + 1 < count ? entries[i + 1].slot : GOODS_NIL;
+        STORE_COLD(sort->store, slot)->prev = i > 0 ? entries[i - 1].slot : GOODS_NIL;
+    }
+}
+
+//并行按价格排序
+//功能：分区并行排序后逐轮并行合并，再并行重建链表。重建前先在当前线程取得所有页的私有副本，
+//      之后各线程只写入各自负责的槽位，不再触发写时复制
+//返回：成功返回1，内存不足返回0(链表保持不变)
+int parallelSortGoodsByPrice(GoodsManager* manager, TaskPool* pool, int ascending)
+{
+    GoodsStore* store = &manager->store;
+    if (manager->count == 0)
+    {
+        return 1;
+    }
+    ParallelSort sort;
+    memset(&sort, 0, sizeof(sort));
+    sort.store = store;
+    sort.ascending = ascending;
+    sort.partitions = partitionCount(store, pool);
+    sort.bounds = (int*)calloc((size_t)sort.partitions + 1, sizeof(int));
+    sort.src = (PriceSortEntry*)malloc((size_t)manager->count * sizeof(PriceSortEntry));
+    sort.dst = (PriceSortEntry*)malloc((size_t)manager->count * sizeof(PriceSortEntry));
+    int ok = sort.bounds != NULL && sort.src != NULL && sort.dst != NULL && reserveGoodsPages(store, store->pageCount);
+    if (ok)
+    {
+        //统计各分区的记录数，得到各分区在排序项数组中的起点
+        runPoolTasks(pool, countSortPartition, &sort, sort.partitions);
+        for (int p = 0; p < sort.partitions; p++)
+        {
+            sort.bounds[p + 1] += sort.bounds[p];
+        }
+        runPoolTasks(pool, sortPartition, &sort, sort.partitions);
+        ok = !sort.failed && sort.bounds[sort.partitions] == manager->count;
+    }
+    if (ok)
+    {
+        //逐轮两两合并，直到只剩一个有序段
+        sort.runCount = sort.partitions;
+        int threads = poolThreadCount(pool);
+        while (sort.runCount > 1)
+        {
+            int pairs = (sort.runCount + 1) / 2;
+            sort.piecesPerPair = (threads * PARALLEL_PIECES_PER_THREAD + pairs - 1) / pairs;
+            runPoolTasks(pool, mergeSortPiece, &sort, pairs * sort.piecesPerPair);
+            for (int k = 0; k < pairs; k++)
+            {
+                sort.bounds[k] = sort.bounds[2 * k];
+            }
+            sort.bounds[pairs] = manager->count;
+            sort.runCount = pairs;
+            PriceSortEntry* swap = sort.src;
+            sort.src = sort.dst;
+            sort.dst = swap;
+        }
+
+        for (int page = 0; page < store->pageCount; page++)
+        {
+            ownGoodsPage(store, page << GOODS_PAGE_SHIFT);
+        }
+        runPoolTasks(pool, relinkSortRange, &sort, sort.partitions);
+        store->head = sort.src[0].slot;
+        store->tail = sort.src[manager->count - 1].slot;
+    }
+    free(sort.bounds);
+    free(sort.src);
+    free(sort.dst);
+    return ok;
+}
+
+//任务：计算分区的库存价值
+static void sumValuePartition(void* context, int partition)
+{
+    ParallelScan* scan = (ParallelScan*)context;
+    Money total = 0;
+    int end = partitionPage(scan->store, scan->partitions, partition + 1);
+    for (int page = partitionPage(scan->store, scan->partitions, partition); page < end; page++)
+    {
+        const GoodsHot* hot = scan->store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            total += hot[i].price * (Money)hot[i].stock;
+        }
+    }
+    scan->sums[partition] = total;
+}
+
+//任务：统计分区中指定类别的商品数
+static void countCategoryPartition(void* context, int partition)
+{
+    ParallelScan* scan = (ParallelScan*)context;
+    int count = 0;
+    int end = partitionPage(scan->store, scan->partitions, partition + 1);
+    for (int page = partitionPage(scan->store, scan->partitions, partition); page < end; page++)
+    {
+        const GoodsHot* hot = scan->store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            count += hot[i].category == scan->category;
+        }
+    }
+    scan->counts[partition] = count;
+}
+
+//并行计算总库存价值
+//功能：各分区并行求和，再按分区顺序累加；内存不足时在当前线程串行计算
+Money parallelTotalValue(GoodsManager* manager, TaskPool* pool)
+{
+    ParallelScan scan = { &manager->store, partitionCount(&manager->store, pool), NULL, NULL, 0 };
+    Money single = 0;
+    scan.sums = (Money*)calloc((size_t)scan.partitions + 1, sizeof(Money));
+    if (scan.sums == NULL)
+    {
+        scan.partitions = 1;
+        scan.sums = &single;
+        sumValuePartition(&scan, 0);
+        return single;
+    }
+    runPoolTasks(pool, sumValuePartition, &scan, scan.partitions);
+    Money total = 0;
+    for (int p = 0; p < scan.partitions; p++)
+    {
+        total += scan.sums[p];
+    }
+    free(scan.sums);
+    return total;
+}
+
+//并行按类别统计商品数量
+//功能：各分区并行计数，再按分区顺序累加；内存不足时在当前线程串行计算
+int parallelCountByCategory(GoodsManager* manager, TaskPool* pool, GoodsCategory category)
+{
+    ParallelScan scan = { &manager->store, partitionCount(&manager->store, pool), NULL, NULL, (unsigned char)category };
+    int single = 0;
+    scan.counts = (int*)calloc((size_t)scan.partitions + 1, sizeof(int));
+    if (scan.counts == NULL)
+    {
+        scan.partitions = 1;
+        scan.counts = &single;
+        countCategoryPartition(&scan, 0);
+        return single;
+    }
+    runPoolTasks(pool, countCategoryPartition, &scan, scan.partitions);
+    int total = 0;
+    for (int p = 0; p < scan.partitions; p++)
+    {
+        total += scan.counts[p];
+    }
+    free(scan.counts);
+    return total;
+}
+
+//计时(计时器刻度)
+static long long parallelNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//链表顺序的校验值(FNV-1a)
+static unsigned int listChecksum(const GoodsStore* store)
+{
+    unsigned int hash = 2166136261u;
+    for (int slot = store->head; slot != GOODS_NIL; slot = STORE_HOT(store, slot)->next)
+    {
+        hash = (hash ^ (unsigned int)slot) * 16777619u;
+    }
+    return hash;
+}
+
+//串行参考结果：按链表收集排序项后用mergeSort升序排序，返回槽位顺序的校验值
+static unsigned int serialSortChecksum(GoodsManager* manager)
+{
+    GoodsStore* store = &manager->store;
+    PriceSortEntry* entries = (PriceSortEntry*)malloc((size_t)manager->count * sizeof(PriceSortEntry));
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    int count = 0;
+    for (int slot = store->head; slot != GOODS_NIL; slot = STORE_HOT(store, slot)->next)
+    {
+        entries[count].price = STORE_HOT(store, slot)->price;
+        entries[count].slot = slot;
+        count++;
+    }
+    unsigned int hash = 0;
+    if (mergeSort(store, entries, count, 1))
+    {
+        hash = 2166136261u;
+        for (int i = 0; i < count; i++)
+        {
+            hash = (hash ^ (unsigned int)entries[i].slot) * 16777619u;
+        }
+    }
+    free(entries);
+    return hash;
+}
+
+//对比不同线程数的并行排序和统计
+//功能：线程数从1开始倍增到maxThreads，每种线程数取rounds次中最快的一次：先降序打乱再计时升序排序，
+//      计时总价值和4个类别的计数；检查各线程数的排序结果、总价值和计数与串行结果完全相同
+//参数：maxThreads - 最大线程数，0表示处理器数；rounds - 重复次数，0表示3次
+//返回：结果全部一致返回1，否则返回0
+int runParallelBenchmark(const char* filename, int maxThreads, int rounds)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    if (maxThreads <= 0)
+    {
+        maxThreads = (int)info.dwNumberOfProcessors;
+    }
+    if (rounds <= 0)
+    {
+        rounds = 3;
+    }
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL || !loadFromFile(manager, filename))
+    {
+        printf("Failed to load %s.\n", filename);
+        freeGoodsManager(manager);
+        return 0;
+    }
+
+    unsigned int expectedOrder = serialSortChecksum(manager);
+    Money expectedValue = calculateTotalValue(manager);
+    int expectedCounts[4];
+    for (int c = 0; c < 4; c++)
+    {
+        expectedCounts[c] = countGoodsByCategory(manager, (GoodsCategory)c);
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ms = 1000.0 / (double)frequency.QuadPart;
+    printf("\n=== Parallel Benchmark (%d products, %d processors, best of %d) ===\n",
+           manager->count, (int)info.dwNumberOfProcessors, rounds);
+    printf("%-8s %10s %8s %10s %8s %10s %8s %8s\n",
+           "Threads", "Sort ms", "Speedup", "Value ms", "Speedup", "Count ms", "Speedup", "Steals");
+
+    int identical = 1;
+    double baseSort = 0, baseValue = 0, baseCount = 0;
+    for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads)
+    {
+        TaskPool* pool = createTaskPool(threads);
+        if (pool == NULL)
+        {
+            printf("Failed to create %d threads.\n", threads);
+            break;
+        }
+        long long bestSort = -1, bestValue = -1, bestCount = -1;
+        for (int r = 0; r < rounds; r++)
+        {
+            parallelSortGoodsByPrice(manager, pool, 0);
+            long long start = parallelNow();
+            int sorted = parallelSortGoodsByPrice(manager, pool, 1);
+            long long sortTicks = parallelNow() - start;
+            identical &= sorted && listChecksum(&manager->store) == expectedOrder;
+
+            start = parallelNow();
+            Money value = parallelTotalValue(manager, pool);
+            long long valueTicks = parallelNow() - start;
+            identical &= value == expectedValue;
+
+            start = parallelNow();
+            for (int c = 0; c < 4; c++)
+            {
+                identical &= parallelCountByCategory(manager, pool, (GoodsCategory)c) == expectedCounts[c];
+            }
+            long long countTicks = parallelNow() - start;
+
+            bestSort = bestSort < 0 || sortTicks < bestSort ? sortTicks : bestSort;
+            bestValue = bestValue < 0 || valueTicks < bestValue ? valueTicks : bestValue;
+            bestCount = bestCount < 0 || countTicks < bestCount ? countTicks : bestCount;
+        }
+        if (threads == 1)
+        {
+            baseSort = (double)bestSort;
+            baseValue = (double)bestValue;
+            baseCount = (double)bestCount;
+        }
+        printf("%-8d %10.2f %7.2fx %10.2f %7.2fx %10.2f %7.2fx %8lld\n", poolThreadCount(pool),
+               bestSort * ms, baseSort / (double)(bestSort > 0 ? bestSort : 1),
+               bestValue * ms, baseValue / (double)(bestValue > 0 ? bestValue : 1),
+               bestCount * ms, baseCount / (double)(bestCount > 0 ? bestCount : 1), poolStealCount(pool));
+        destroyTaskPool(pool);
+        if (threads >= maxThreads)
+        {
+            break;
+        }
+    }
+    freeGoodsManager(manager);
+    printf(identical ? "Results are identical to the serial sort and scans for every thread count.\n"
+                     : "MISMATCH: parallel results differ from the serial results!\n");
+    return identical;
+}
@@ -0,0 +1,21 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "goods.h"
+#include "pool.h"
+
+// 并行排序与统计
+// 按页把存储分成若干分区(分区数为线程数的4倍，便于工作窃取平衡负载)。
+// 排序：各分区并行收集并排序自己的记录，再逐轮两两合并有序段；每对有序段的合并按输出位置
+// 切成若干块，用二分查找定出每块在两个输入段中的起点，各块并行合并，因此最后一轮也能用上全部线程。
+// 排序规则与sortGoodsByPrice相同(价格，相同时ID升序)，ID唯一，结果与线程数和分区方式无关。
+// 统计：各分区并行扫描热数据得到部分结果，再按分区顺序归并，全部使用整数运算，结果与串行扫描相同。
+#define PARALLEL_MIN_GOODS 65536 // 商品数达到此值且有多个处理器时，排序和统计自动使用共享线程池
+
+// 并行函数声明(调用者按串行版本的要求加锁)
+int parallelSortGoodsByPrice(GoodsManager *manager, TaskPool *pool, int ascending);             // 并行按价格排序，内存不足返回0且不修改链表
+Money parallelTotalValue(GoodsManager *manager, TaskPool *pool);                                // 并行计算总库存价值(分)
+int parallelCountByCategory(GoodsManager *manager, TaskPool *pool, GoodsCategory category);     // 并行按类别统计商品数量
+int runParallelBenchmark(const char *filename, int maxThreads, int rounds);                     // 对比不同线程数的排序和统计耗时，并检查结果一致
+
+#endif
@@ -0,0 +1,286 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "persist.h"
+#include "snapshot.h"
+#include <stdlib.h>
+
+// 后台持久化线程
+// 变更序号changeSeq每登记一次变更加1，flushedSeq为已写入文件的最大序号，
+// 二者之差即未保存的变更数；等待保存的线程比较这两个序号判断自己的变更是否已落盘
+struct PersistWriter
+{
+    GoodsManager *manager;          // 要保存的管理器，NULL表示暂不保存
+    char filename[MAX_PATH];        // 数据文件
+    char tempname[MAX_PATH];        // 临时文件，写完后替换数据文件
+    int intervalMs;                 // 保存间隔
+    int maxPending;                 // 未保存变更数阈值
+    HANDLE thread;                  // 后台线程
+    CRITICAL_SECTION lock;          // 保护以下字段
+    CONDITION_VARIABLE wake;        // 有新变更、请求立即保存或停止
+    CONDITION_VARIABLE done;        // 一次保存结束
+    long long changeSeq;            // 已登记的变更序号
+    long long flushedSeq;           // 已写入文件的变更序号
+    ULONGLONG firstDirty;           // 最早未保存变更的时刻，0表示没有未保存变更
+    int flushRequested;             // 是否有线程在等待立即保存
+    int stopping;                   // 是否正在停止
+    long long flushes;              // 成功保存的次数
+    long long failures;             // 保存失败的次数
+    long long lastLagMs;            // 最近一次持久化延迟
+    long long maxLagMs;             // 最大持久化延迟
+    long long lastWriteMs;          // 最近一次写文件的耗时
+};
+
+//保存一次
+//功能：持读锁创建快照后立即释放锁，写入临时文件后替换数据文件，写文件期间不阻塞修改
+//返回：成功返回1，失败返回0
+static int writeSnapshot(PersistWriter* writer, GoodsManager* manager)
+{
+    lockGoodsShared(manager);
+    GoodsSnapshot* snapshot = createGoodsSnapshot(manager);
+    int logged = flushMoveLog(manager->moves);  //快照中的库存变化对应的变动记录先于快照写入文件
+    unlockGoodsShared(manager);
+    if (snapshot == NULL || !logged)
+    {
+        releaseGoodsSnapshot(snapshot);
+        return 0;
+    }
+    int saved = saveSnapshotToFile(snapshot, writer->tempname)
+             && MoveFileExA(writer->tempname, writer->filename, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+    releaseGoodsSnapshot(snapshot);
+    return saved;
+}
+
+//后台线程
+//功能：等到未保存变更超过间隔时间或数量阈值、有线程请求立即保存或正在停止时保存一次；
+//      保存期间登记的新变更留给下一次保存
+static DWORD WINAPI persistMain(LPVOID param)
+{
+    PersistWriter* writer = (PersistWriter*)param;
+
+    EnterCriticalSection(&writer->lock);
+    while (1)
+    {
+        long long pending = writer->changeSeq - writer->flushedSeq;
+        if (pending == 0 || writer->manager == NULL)
+        {
+            if (writer->stopping)
+            {
+                break;
+            }
+            SleepConditionVariableCS(&writer->wake, &writer->lock, INFINITE);
+            continue;
+        }
+        ULONGLONG elapsed = GetTickCount64() - writer->firstDirty;
+        if (!writer->stopping && !writer->flushRequested && pending < writer->maxPending
+            && elapsed < (ULONGLONG)writer->intervalMs)
+        {
+            SleepConditionVariableCS(&writer->wake, &writer->lock, (DWORD)((ULONGLONG)writer->intervalMs - elapsed));
+            continue;
+        }
+
+        //取走当前全部变更，写文件时不持锁
+        long long target = writer->changeSeq;
+        ULONGLONG firstDirty = writer->firstDirty;
+        GoodsManager* manager = writer->manager;
+        writer->flushRequested = 0;
+        writer->firstDirty = 0;
+        LeaveCriticalSection(&writer->lock);
+
+        ULONGLONG start = GetTickCount64();
+        int saved = writeSnapshot(writer, manager);
+        ULONGLONG end = GetTickCount64();
+
+        EnterCriticalSection(&writer->lock);
+        writer->lastWriteMs = (long long)(end - start);
+        if (saved)
+        {
+            writer->flushedSeq = target;
+            writer->flushes++;
+            writer->lastLagMs = (long long)(end - firstDirty);
+            if (writer->lastLagMs > writer->maxLagMs)
+            {
+                writer->maxLagMs = writer->lastLagMs;
+            }
+        }
+        else
+        {
+            //保存失败，变更仍视为未保存，等待一个间隔后重试；停止时不再重试
+            writer->failures++;
+            writer->firstDirty = firstDirty;
+            WakeAllConditionVariable(&writer->done);
+            if (writer->stopping)
+            {
+                break;
+            }
+            SleepConditionVariableCS(&writer->wake, &writer->lock, (DWORD)writer->intervalMs);
+            continue;
+        }
+        if (writer->changeSeq != writer->flushedSeq && writer->firstDirty == 0)
+        {
+            writer->firstDirty = end;  //保存期间登记的变更从现在开始计时
+        }
+        WakeAllConditionVariable(&writer->done);
+    }
+    LeaveCriticalSection(&writer->lock);
+    return 0;
+}
+
+//启动后台持久化线程
+//参数：intervalMs - 保存间隔(毫秒)，maxPending - 未保存变更数阈值
+//返回：成功返回持久化线程，失败返回NULL
+PersistWriter* startPersistWriter(GoodsManager* manager, const char* filename, int intervalMs, int maxPending)
+{
+    if (filename == NULL)
+    {
+        return NULL;
+    }
+    PersistWriter* writer = (PersistWriter*)calloc(1, sizeof(PersistWriter));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    writer->manager = manager;
+    strncpy_s(writer->filename, sizeof(writer->filename), filename, _TRUNCATE);
+    sprintf_s(writer->tempname, sizeof(writer->tempname), "%s.tmp", filename);
+    writer->intervalMs = intervalMs > 0 ? intervalMs : PERSIST_DEFAULT_INTERVAL_MS;
+    writer->maxPending = maxPending > 0 ? maxPending : PERSIST_DEFAULT_MAX_PENDING;
+    InitializeCriticalSection(&writer->lock);
+    InitializeConditionVariable(&writer->wake);
+    InitializeConditionVariable(&writer->done);
+
+    writer->thread = CreateThread(NULL, 0, persistMain, writer, 0, NULL);
+    if (writer->thread == NULL)
+    {
+        DeleteCriticalSection(&writer->lock);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+//登记一次变更
+//功能：只更新变更序号，达到数量阈值时唤醒后台线程，不做任何文件操作
+void persistChanged(PersistWriter* writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    EnterCriticalSection(&writer->lock);
+    writer->changeSeq++;
+    if (writer->firstDirty == 0)
+    {
+        writer->firstDirty = GetTickCount64();
+        WakeConditionVariable(&writer->wake);  //开始计时
+    }
+    else if (writer->changeSeq - writer->flushedSeq >= writer->maxPending)
+    {
+        WakeConditionVariable(&writer->wake);
+    }
+    LeaveCriticalSection(&writer->lock);
+}
+
+//等待全部变更写入文件
+//功能：请求后台线程立即保存，直到调用前登记的变更都已写入文件或保存失败
+//说明：调用者不能持有管理器的锁，否则后台线程无法创建快照
+//返回：全部写入返回1，保存失败返回0
+int persistFlush(PersistWriter* writer)
+{
+    if (writer == NULL)
+    {
+        return 1;
+    }
+    EnterCriticalSection(&writer->lock);
+    long long target = writer->changeSeq;
+    long long failures = writer->failures;
+    if (writer->flushedSeq < target && writer->manager != NULL)
+    {
+        writer->flushRequested = 1;
+        WakeConditionVariable(&writer->wake);
+        while (writer->flushedSeq < target && writer->failures == failures)
+        {
+            SleepConditionVariableCS(&writer->done, &writer->lock, INFINITE);
+        }
+    }
+    int flushed = writer->flushedSeq >= target;
+    LeaveCriticalSection(&writer->lock);
+    return flushed;
+}
+
+//更换要保存的管理器
+//功能：先保存当前管理器的全部变更，再改为保存新的管理器；用于重新导入数据前后
+//返回：之前的变更全部保存成功返回1
+int persistSetManager(PersistWriter* writer, GoodsManager* manager)
+{
+    if (writer == NULL)
+    {
+        return 1;
+    }
+    int flushed = persistFlush(writer);
+    EnterCriticalSection(&writer->lock);
+    writer->manager = manager;
+    writer->flushedSeq = writer->changeSeq;  //未能保存的旧变更随旧管理器一起丢弃
+    writer->firstDirty = 0;
+    LeaveCriticalSection(&writer->lock);
+    return flushed;
+}
+
+//停止后台持久化线程
+//功能：保存剩余变更后结束线程并释放资源，作为退出前的屏障
+//返回：全部变更保存成功返回1
+int stopPersistWriter(PersistWriter* writer)
+{
+    if (writer == NULL)
+    {
+        return 1;
+    }
+    EnterCriticalSection(&writer->lock);
+    writer->stopping = 1;
+    WakeConditionVariable(&writer->wake);
+    LeaveCriticalSection(&writer->lock);
+    WaitForSingleObject(writer->thread, INFINITE);
+    CloseHandle(writer->thread);
+
+    int flushed = writer->flushedSeq == writer->changeSeq || writer->manager == NULL;
+    DeleteCriticalSection(&writer->lock);
+    free(writer);
+    return flushed;
+}
+
+//获取持久化状态
+void getPersistStatus(PersistWriter* writer, PersistStatus* status)
+{
+    memset(status, 0, sizeof(*status));
+    if (writer == NULL)
+    {
+        return;
+    }
+    EnterCriticalSection(&writer->lock);
+    status->pending = writer->changeSeq - writer->flushedSeq;
+    status->flushes = writer->flushes;
+    status->failures = writer->failures;
+    status->lastLagMs = writer->lastLagMs;
+    status->maxLagMs = writer->maxLagMs;
+    status->lastWriteMs = writer->lastWriteMs;
+    LeaveCriticalSection(&writer->lock);
+}
+
+//显示持久化状态
+void displayPersistStatus(PersistWriter* writer)
+{
+    if (writer == NULL)
+    {
+        printf("Background saving is not running.\n");
+        return;
+    }
+    PersistStatus status;
+    getPersistStatus(writer, &status);
+    printf("\n=== Background Saving ===\n");
+    printf("Data file: %s (saved every %d ms or every %d changes)\n",
+           writer->filename, writer->intervalMs, writer->maxPending);
+    printf("Unsaved changes: %lld\n", status.pending);
+    printf("Saves: %lld, failed: %lld\n", status.flushes, status.failures);
+    printf("Durability lag: last %lld ms, max %lld ms (last write took %lld ms)\n",
+           status.lastLagMs, status.maxLagMs, status.lastWriteMs);
+}
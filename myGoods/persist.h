@@ -0,0 +1,37 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include "goods.h"
+
+// 后台持久化
+// 修改商品后只登记一次变更并立即返回，由后台线程合并多次变更后统一保存：
+// 距第一次未保存的变更超过间隔时间，或未保存的变更数达到阈值时，
+// 后台线程持读锁创建快照后立即释放锁，再将快照写入临时文件并替换数据文件。
+// 调用者修改商品时需持有管理器的写锁。
+#define PERSIST_DEFAULT_INTERVAL_MS 2000 // 默认保存间隔(毫秒)
+#define PERSIST_DEFAULT_MAX_PENDING 256  // 默认未保存变更数阈值，达到后立即保存
+
+typedef struct PersistWriter PersistWriter; // 后台持久化线程(内部结构)
+
+// 持久化状态
+typedef struct
+{
+    long long pending;        // 尚未保存的变更数
+    long long flushes;        // 成功保存的次数
+    long long failures;       // 保存失败的次数
+    long long lastLagMs;      // 最近一次保存的持久化延迟：最早未保存变更到写入完成的时间(毫秒)
+    long long maxLagMs;       // 最大持久化延迟(毫秒)
+    long long lastWriteMs;    // 最近一次写文件的耗时(毫秒)
+} PersistStatus;
+
+// 持久化函数声明
+PersistWriter *startPersistWriter(GoodsManager *manager, const char *filename,
+                                  int intervalMs, int maxPending);        // 启动后台线程，失败返回NULL
+void persistChanged(PersistWriter *writer);                              // 登记一次变更，立即返回
+int persistFlush(PersistWriter *writer);                                 // 等待调用前的全部变更写入文件，成功返回1
+int persistSetManager(PersistWriter *writer, GoodsManager *manager);     // 保存当前管理器的变更后改为保存另一个管理器(可为NULL)
+int stopPersistWriter(PersistWriter *writer);                            // 保存剩余变更并结束线程，全部保存成功返回1
+void getPersistStatus(PersistWriter *writer, PersistStatus *status);     // 获取持久化状态
+void displayPersistStatus(PersistWriter *writer);                        // 显示持久化状态
+
+#endif
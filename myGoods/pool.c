@@ -0,0 +1,314 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "pool.h"
+#include <stdlib.h>
+
+#define POOL_MAX_THREADS 64 // 线程数上限
+
+// 线程的任务区间
+// 各线程的区间分开加锁，末尾补齐到缓存行，避免相邻区间的锁互相干扰
+typedef struct
+{
+    CRITICAL_SECTION lock; // 保护begin和end
+    int begin;             // 下一个要执行的任务序号
+    int end;               // 区间末尾(不含)
+    char padding[64];      // 填充
+} PoolQueue;
+
+// 工作线程参数
+typedef struct
+{
+    TaskPool *pool; // 所属线程池
+    int id;         // 线程序号，0号为提交任务的线程
+} PoolWorker;
+
+// 线程池
+// 批次号generation每提交一批任务加1，工作线程发现批次号变化且批次仍开放时开始取任务。
+// 提交者等到任务全部完成且没有工作线程还在取任务后才关闭批次，因此下一批填写区间时
+// 不会有上一批的线程同时改写区间
+struct TaskPool
+{
+    int threadCount;              // 线程数(含提交任务的线程)
+    HANDLE *threads;              // 工作线程，共threadCount-1个
+    PoolWorker *workers;          // 工作线程参数
+    PoolQueue *queues;            // 各线程的任务区间
+    CRITICAL_SECTION runLock;     // 保证同一时刻只执行一批任务
+    CRITICAL_SECTION lock;        // 保护以下字段
+    CONDITION_VARIABLE start;     // 有新的一批任务或正在停止
+    CONDITION_VARIABLE finished;  // 一批任务全部完成
+    long generation;              // 批次号
+    int open;                     // 当前批次是否开放
+    int active;                   // 正在取任务的工作线程数
+    int stopping;                 // 是否正在停止
+    PoolTask task;                // 当前批次的任务函数
+    void *context;                // 当前批次的任务参数
+    volatile long remaining;      // 当前批次未完成的任务数
+    volatile long steals;         // 累计窃取次数
+};
+
+static INIT_ONCE g_poolInit = INIT_ONCE_STATIC_INIT; // 共享线程池只创建一次
+static TaskPool *g_pool = NULL;                       // 进程共享的线程池
+
+//从自己的区间开头取一个任务
+//返回：任务序号，区间已空返回-1
+static int takePoolTask(PoolQueue* queue)
+{
+    EnterCriticalSection(&queue->lock);
+    int index = queue->begin < queue->end ? queue->begin++ : -1;
+    LeaveCriticalSection(&queue->lock);
+    return index;
+}
+
+//从其他线程的区间末尾窃取剩余任务的一半
+//功能：窃取的第一个任务立即返回执行，其余放入自己的区间，其他线程还可以再从这里窃取
+//返回：任务序号，所有区间都已空返回-1
+static int stealPoolTask(TaskPool* pool, int id)
+{
+    for (int k = 1; k < pool->threadCount; k++)
+    {
+        PoolQueue* victim = &pool->queues[(id + k) % pool->threadCount];
+        EnterCriticalSection(&victim->lock);
+        int available = victim->end - victim->begin;
+        int stolenEnd = victim->end;
+        if (available > 0)
+        {
+            victim->end -= (available + 1) / 2;
+        }
+        int stolenBegin = victim->end;
+        LeaveCriticalSection(&victim->lock);
+        if (available <= 0)
+        {
+            continue;
+        }
+
+        InterlockedIncrement(&pool->steals);
+        PoolQueue* own = &pool->queues[id];
+        EnterCriticalSection(&own->lock);
+        own->begin = stolenBegin + 1;
+        own->end = stolenEnd;
+        LeaveCriticalSection(&own->lock);
+        return stolenBegin;
+    }
+    return -1;
+}
+
+//执行任务直到所有区间都已空
+static void runPoolQueue(TaskPool* pool, int id)
+{
+    while (1)
+    {
+        int index = takePoolTask(&pool->queues[id]);
+        if (index < 0)
+        {
+            index = stealPoolTask(pool, id);
+        }
+        if (index < 0)
+        {
+            return;
+        }
+        pool->task(pool->context, index);
+        if (InterlockedDecrement(&pool->remaining) == 0)
+        {
+            EnterCriticalSection(&pool->lock);
+            WakeAllConditionVariable(&pool->finished);
+            LeaveCriticalSection(&pool->lock);
+        }
+    }
+}
+
+//工作线程
+//功能：等待新的一批任务，取完所有区间后继续等待，直到线程池停止
+static DWORD WINAPI poolWorkerMain(LPVOID param)
+{
+    PoolWorker* worker = (PoolWorker*)param;
+    TaskPool* pool = worker->pool;
+    long seen = 0;
+
+    EnterCriticalSection(&pool->lock);
+    while (1)
+    {
+        while (!pool->stopping && (pool->generation == seen || !pool->open))
+        {
+            SleepConditionVariableCS(&pool->start, &pool->lock, INFINITE);
+        }
+        if (pool->stopping)
+        {
+            break;
+        }
+        seen = pool->generation;
+        pool->active++;
+        LeaveCriticalSection(&pool->lock);
+        runPoolQueue(pool, worker->id);
+        EnterCriticalSection(&pool->lock);
+        if (--pool->active == 0)
+        {
+            WakeAllConditionVariable(&pool->finished);
+        }
+    }
+    LeaveCriticalSection(&pool->lock);
+    return 0;
+}
+
+//创建线程池
+//参数：threadCount - 线程数(含提交任务的线程)，0表示等于处理器数
+//返回：线程池指针，失败返回NULL；部分工作线程创建失败时以已创建的线程运行
+TaskPool* createTaskPool(int threadCount)
+{
+    if (threadCount <= 0)
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        threadCount = (int)info.dwNumberOfProcessors;
+    }
+    if (threadCount > POOL_MAX_THREADS)
+    {
+        threadCount = POOL_MAX_THREADS;
+    }
+    TaskPool* pool = (TaskPool*)calloc(1, sizeof(TaskPool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    pool->queues = (PoolQueue*)calloc((size_t)threadCount, sizeof(PoolQueue));
+    pool->workers = (PoolWorker*)calloc((size_t)threadCount, sizeof(PoolWorker));
+    pool->threads = (HANDLE*)calloc((size_t)threadCount, sizeof(HANDLE));
+    if (pool->queues == NULL || pool->workers == NULL || pool->threads == NULL)
+    {
+        free(pool->queues);
+        free(pool->workers);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    for (int i = 0; i < threadCount; i++)
+    {
+        InitializeCriticalSection(&pool->queues[i].lock);
+    }
+    InitializeCriticalSection(&pool->runLock);
+    InitializeCriticalSection(&pool->lock);
+    InitializeConditionVariable(&pool->start);
+    InitializeConditionVariable(&pool->finished);
+
+    int started = 0;
+    for (int i = 1; i < threadCount; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+        pool->threads[started] = CreateThread(NULL, 0, poolWorkerMain, &pool->workers[i], 0, NULL);
+        if (pool->threads[started] == NULL)
+        {
+            break;
+        }
+        started++;
+    }
+    pool->threadCount = started + 1;
+    return pool;
+}
+
+//结束工作线程并释放线程池
+void destroyTaskPool(TaskPool* pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    EnterCriticalSection(&pool->lock);
+    pool->stopping = 1;
+    WakeAllConditionVariable(&pool->start);
+    LeaveCriticalSection(&pool->lock);
+    for (int i = 0; i < pool->threadCount - 1; i++)
+    {
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+    }
+    for (int i = 0; i < pool->threadCount; i++)
+    {
+        DeleteCriticalSection(&pool->queues[i].lock);
+    }
+    DeleteCriticalSection(&pool->runLock);
+    DeleteCriticalSection(&pool->lock);
+    free(pool->queues);
+    free(pool->workers);
+    free(pool->threads);
+    free(pool);
+}
+
+//创建共享线程池
+static BOOL CALLBACK initTaskPool(PINIT_ONCE once, PVOID param, PVOID* context)
+{
+    (void)once;
+    (void)param;
+    (void)context;
+    g_pool = createTaskPool(0);
+    return TRUE;
+}
+
+//进程共享的线程池
+//功能：首次调用时创建，线程数等于处理器数，随进程结束
+//返回：线程池指针，创建失败返回NULL
+TaskPool* getTaskPool()
+{
+    InitOnceExecuteOnce(&g_poolInit, initTaskPool, NULL, NULL);
+    return g_pool;
+}
+
+//线程数
+int poolThreadCount(const TaskPool* pool)
+{
+    return pool != NULL ? pool->threadCount : 1;
+}
+
+//执行一批任务
+//功能：把任务序号按连续区间分给各线程，当前线程作为0号线程一起执行，全部完成后返回。
+//      pool为NULL或只有一个线程时在当前线程依次执行
+void runPoolTasks(TaskPool* pool, PoolTask task, void* context, int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    if (pool == NULL || pool->threadCount == 1)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            task(context, i);
+        }
+        return;
+    }
+
+    EnterCriticalSection(&pool->runLock);
+    pool->task = task;
+    pool->context = context;
+    pool->remaining = count;
+    for (int t = 0; t < pool->threadCount; t++)
+    {
+        PoolQueue* queue = &pool->queues[t];
+        EnterCriticalSection(&queue->lock);
+        queue->begin = (int)((long long)count * t / pool->threadCount);
+        queue->end = (int)((long long)count * (t + 1) / pool->threadCount);
+        LeaveCriticalSection(&queue->lock);
+    }
+    EnterCriticalSection(&pool->lock);
+    pool->generation++;
+    pool->open = 1;
+    WakeAllConditionVariable(&pool->start);
+    LeaveCriticalSection(&pool->lock);
+
+    runPoolQueue(pool, 0);
+
+    EnterCriticalSection(&pool->lock);
+    while (pool->remaining > 0 || pool->active > 0)
+    {
+        SleepConditionVariableCS(&pool->finished, &pool->lock, INFINITE);
+    }
+    pool->open = 0;
+    LeaveCriticalSection(&pool->lock);
+    LeaveCriticalSection(&pool->runLock);
+}
+
+//累计窃取次数
+long long poolStealCount(const TaskPool* pool)
+{
+    return pool != NULL ? pool->steals : 0;
+}
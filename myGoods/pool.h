@@ -0,0 +1,21 @@
+#ifndef POOL_H
+#define POOL_H
+
+// 工作窃取线程池
+// 一批任务以序号0~count-1表示，提交时按连续区间平均分给各线程(含提交任务的线程)的队列。
+// 线程从自己区间的开头逐个取任务，区间取完后从其他线程的区间末尾窃取剩余任务的一半，
+// 因此任务耗时不均时空闲线程会自动分担，任务耗时均匀时几乎不发生窃取。
+// 同一时刻只执行一批任务，多个线程同时提交时依次执行；任务中不能再提交任务。
+typedef struct TaskPool TaskPool; // 线程池(内部结构)
+
+typedef void (*PoolTask)(void *context, int index); // 任务函数，index为任务序号
+
+// 线程池函数声明
+TaskPool *createTaskPool(int threadCount);                                 // 创建线程池，threadCount为0时等于处理器数，失败返回NULL
+void destroyTaskPool(TaskPool *pool);                                      // 结束工作线程并释放线程池
+TaskPool *getTaskPool();                                                   // 进程共享的线程池(首次调用时创建，线程数等于处理器数)
+int poolThreadCount(const TaskPool *pool);                                 // 线程数(含提交任务的线程)
+void runPoolTasks(TaskPool *pool, PoolTask task, void *context, int count); // 执行一批任务，全部完成后返回
+long long poolStealCount(const TaskPool *pool);                            // 累计窃取次数
+
+#endif
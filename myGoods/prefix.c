@@ -0,0 +1,646 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "prefix.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PREFIX_NIL (-1)              // 空下标
+#define PREFIX_COMPACT_MIN 4096      // 废弃标签字节数达到此值且超过一半时压缩标签池
+
+//扩大数组容量
+//返回：成功返回1，失败返回0
+static int growPrefixArray(void** array, int* capacity, int needed, size_t itemSize)
+{
+    if (needed <= *capacity)
+    {
+        return 1;
+    }
+    int newCapacity = *capacity == 0 ? 64 : *capacity;
+    while (newCapacity < needed)
+    {
+        newCapacity *= 2;
+    }
+    void* grown = realloc(*array, (size_t)newCapacity * itemSize);
+    if (grown == NULL)
+    {
+        return 0;
+    }
+    *array = grown;
+    *capacity = newCapacity;
+    return 1;
+}
+
+//取得空闲节点(调用者已预留空间)
+static int allocPrefixNode(PrefixIndex* index, int label, int length)
+{
+    int node = index->freeNodes;
+    if (node != PREFIX_NIL)
+    {
+        index->freeNodes = index->nodes[node].sibling;
+    }
+    else
+    {
+        node = index->nodeCount++;
+    }
+    PrefixNode* n = &index->nodes[node];
+    n->label = label;
+    n->length = length;
+    n->child = PREFIX_NIL;
+    n->sibling = PREFIX_NIL;
+    n->values = PREFIX_NIL;
+    return node;
+}
+
+//在子节点链表中查找标签首字节为c的节点
+//参数：prev - 输出前一个兄弟节点(用于插入和摘除)，可为NULL
+//返回：找到返回节点下标，否则返回PREFIX_NIL(prev为应插入位置的前一个节点)
+static int findPrefixChild(const PrefixIndex* index, int node, unsigned char c, int* prev)
+{
+    int before = PREFIX_NIL;
+    int child = index->nodes[node].child;
+    while (child != PREFIX_NIL && (unsigned char)index->labels[index->nodes[child].label] < c)
+    {
+        before = child;
+        child = index->nodes[child].sibling;
+    }
+    if (prev != NULL)
+    {
+        *prev = before;
+    }
+    return child != PREFIX_NIL && (unsigned char)index->labels[index->nodes[child].label] == c ? child : PREFIX_NIL;
+}
+
+//将节点挂到父节点的子节点链表中prev之后
+static void linkPrefixChild(PrefixIndex* index, int parent, int prev, int node)
+{
+    if (prev == PREFIX_NIL)
+    {
+        index->nodes[parent].child = node;
+    }
+    else
+    {
+        index->nodes[prev].sibling = node;
+    }
+}
+
+//压缩标签池
+//功能：按节点顺序把各节点的标签复制到新的标签池，丢弃已删除节点的标签
+//返回：成功返回1，失败返回0(原标签池保持不变)
+static int compactPrefixLabels(PrefixIndex* index)
+{
+    int live = index->labelSize - index->labelGarbage;
+    int capacity = live * 2 > 256 ? live * 2 : 256;
+    char* labels = (char*)malloc((size_t)capacity);
+    if (labels == NULL)
+    {
+        return 0;
+    }
+    int used = 0;
+    for (int i = 0; i < index->nodeCount; i++)
+    {
+        PrefixNode* node = &index->nodes[i];
+        if (node->length > 0)
+        {
+            memcpy(labels + used, index->labels + node->label, (size_t)node->length);
+            node->label = used;
+            used += node->length;
+        }
+    }
+    free(index->labels);
+    index->labels = labels;
+    index->labelSize = used;
+    index->labelCapacity = capacity;
+    index->labelGarbage = 0;
+    return 1;
+}
+
+//初始化前缀索引
+void initPrefixIndex(PrefixIndex* index)
+{
+    memset(index, 0, sizeof(*index));
+    index->freeNodes = PREFIX_NIL;
+    index->freeValues = PREFIX_NIL;
+}
+
+//释放前缀索引
+void freePrefixIndex(PrefixIndex* index)
+{
+    free(index->nodes);
+    free(index->values);
+    free(index->labels);
+    initPrefixIndex(index);
+}
+
+//预留插入键所需的空间
+//功能：每个键最多新建2个节点(分裂出的中间节点和新叶子)、1个值和键长字节的标签，
+//      预留之后这些键的prefixInsert不会失败，调用者可以先预留再修改其他数据结构
+//参数：keyCount - 键数，keyBytes - 各键的总长度
+//返回：成功返回1，内存不足返回0
+int reservePrefixIndex(PrefixIndex* index, int keyCount, int keyBytes)
+{
+    if (index->labelGarbage >= PREFIX_COMPACT_MIN && index->labelGarbage * 2 > index->labelSize)
+    {
+        compactPrefixLabels(index);  //失败时继续使用原标签池
+    }
+    if (!growPrefixArray((void**)&index->nodes, &index->nodeCapacity, index->nodeCount + 2 * keyCount + 1, sizeof(PrefixNode))
+        || !growPrefixArray((void**)&index->values, &index->valueCapacity, index->valueCount + keyCount, sizeof(PrefixValue))
+        || !growPrefixArray((void**)&index->labels, &index->labelCapacity, index->labelSize + keyBytes, 1))
+    {
+        return 0;
+    }
+    if (index->nodeCount == 0)
+    {
+        allocPrefixNode(index, 0, 0);  //根节点
+    }
+    return 1;
+}
+
+//插入键值对
+//功能：沿与键相同的边向下走；边标签只有一部分相同时在分歧处分裂出中间节点，
+//      走不下去时把键的剩余部分作为新叶子的标签
+void prefixInsert(PrefixIndex* index, const char* key, int slot)
+{
+    int node = 0;
+    const unsigned char* rest = (const unsigned char*)key;
+    while (*rest != '\0')
+    {
+        int prev;
+        int child = findPrefixChild(index, node, *rest, &prev);
+        if (child == PREFIX_NIL)
+        {
+            int length = (int)strlen((const char*)rest);
+            int label = index->labelSize;
+            memcpy(index->labels + label, rest, (size_t)length);
+            index->labelSize += length;
+            int leaf = allocPrefixNode(index, label, length);
+            index->nodes[leaf].sibling = prev == PREFIX_NIL ? index->nodes[node].child : index->nodes[prev].sibling;
+            linkPrefixChild(index, node, prev, leaf);
+            node = leaf;
+            break;
+        }
+
+        const PrefixNode* c = &index->nodes[child];
+        const unsigned char* label = (const unsigned char*)index->labels + c->label;
+        int common = 1;
+        while (common < c->length && rest[common] == label[common])
+        {
+            common++;
+        }
+        if (common < c->length)
+        {
+            //在分歧处分裂：中间节点取标签的相同部分，原节点保留剩余部分
+            int middle = allocPrefixNode(index, index->nodes[child].label, common);
+            index->nodes[middle].child = child;
+            index->nodes[middle].sibling = index->nodes[child].sibling;
+            index->nodes[child].label += common;
+            index->nodes[child].length -= common;
+            index->nodes[child].sibling = PREFIX_NIL;
+            linkPrefixChild(index, node, prev, middle);
+            child = middle;
+        }
+        node = child;
+        rest += common;
+    }
+
+    int value = index->freeValues;
+    if (value != PREFIX_NIL)
+    {
+        index->freeValues = index->values[value].next;
+    }
+    else
+    {
+        value = index->valueCount++;
+    }
+    index->values[value].slot = slot;
+    index->values[value].next = index->nodes[node].values;
+    index->nodes[node].values = value;
+    index->keyCount++;
+}
+
+//删除键值对
+//功能：找到键所在节点并从值链表中摘除槽位，再自下而上回收不再有值也没有子节点的节点
+void prefixRemove(PrefixIndex* index, const char* key, int slot)
+{
+    if (index->nodeCount == 0)
+    {
+        return;
+    }
+    int path[PREFIX_KEY_MAX + 1];
+    int depth = 0;
+    int node = 0;
+    path[0] = 0;
+    const unsigned char* rest = (const unsigned char*)key;
+    while (*rest != '\0')
+    {
+        int child = findPrefixChild(index, node, *rest, NULL);
+        if (child == PREFIX_NIL || depth == PREFIX_KEY_MAX)
+        {
+            return;
+        }
+        const PrefixNode* c = &index->nodes[child];
+        if (strncmp(index->labels + c->label, (const char*)rest, (size_t)c->length) != 0)
+        {
+            return;
+        }
+        rest += c->length;
+        node = child;
+        path[++depth] = node;
+    }
+
+    int* link = &index->nodes[node].values;
+    while (*link != PREFIX_NIL && index->values[*link].slot != slot)
+    {
+        link = &index->values[*link].next;
+    }
+    if (*link == PREFIX_NIL)
+    {
+        return;
+    }
+    int value = *link;
+    *link = index->values[value].next;
+    index->values[value].next = index->freeValues;
+    index->freeValues = value;
+    index->keyCount--;
+
+    while (depth > 0 && index->nodes[node].values == PREFIX_NIL && index->nodes[node].child == PREFIX_NIL)
+    {
+        int parent = path[--depth];
+        int prev;
+        findPrefixChild(index, parent, (unsigned char)index->labels[index->nodes[node].label], &prev);
+        linkPrefixChild(index, parent, prev, index->nodes[node].sibling);
+        index->labelGarbage += index->nodes[node].length;
+        index->nodes[node].length = -1;
+        index->nodes[node].sibling = index->freeNodes;
+        index->freeNodes = node;
+        node = parent;
+    }
+}
+
+//按字典序收集子树中的槽位
+//返回：收集后的总数
+static int collectPrefix(const PrefixIndex* index, int node, int* slots, int count, int limit)
+{
+    for (int value = index->nodes[node].values; value != PREFIX_NIL && count < limit; value = index->values[value].next)
+    {
+        slots[count++] = index->values[value].slot;
+    }
+    for (int child = index->nodes[node].child; child != PREFIX_NIL && count < limit; child = index->nodes[child].sibling)
+    {
+        count = collectPrefix(index, child, slots, count, limit);
+    }
+    return count;
+}
+
+//按前缀查找
+//功能：沿前缀走到子树根(前缀可以在某条边的中间结束)，再按字典序收集子树中的槽位，最多limit个
+//返回：找到的槽位数
+int prefixSearch(const PrefixIndex* index, const char* prefix, int* slots, int limit)
+{
+    if (index->nodeCount == 0 || limit <= 0)
+    {
+        return 0;
+    }
+    int node = 0;
+    const unsigned char* rest = (const unsigned char*)prefix;
+    while (*rest != '\0')
+    {
+        int child = findPrefixChild(index, node, *rest, NULL);
+        if (child == PREFIX_NIL)
+        {
+            return 0;
+        }
+        const PrefixNode* c = &index->nodes[child];
+        const unsigned char* label = (const unsigned char*)index->labels + c->label;
+        int i = 1;
+        while (i < c->length && rest[i] != '\0')
+        {
+            if (rest[i] != label[i])
+            {
+                return 0;
+            }
+            i++;
+        }
+        rest += i;
+        node = child;
+    }
+    return collectPrefix(index, node, slots, 0, limit);
+}
+
+//给子树中的键按字典序编号
+//返回：子树之后的下一个序号
+static int rankPrefixSubtree(const PrefixIndex* index, int node, int* ranks, int rank)
+{
+    int value = index->nodes[node].values;
+    if (value != PREFIX_NIL)
+    {
+        for (; value != PREFIX_NIL; value = index->values[value].next)
+        {
+            ranks[index->values[value].slot] = rank;
+        }
+        rank++;
+    }
+    for (int child = index->nodes[node].child; child != PREFIX_NIL; child = index->nodes[child].sibling)
+    {
+        rank = rankPrefixSubtree(index, child, ranks, rank);
+    }
+    return rank;
+}
+
+//按字典序给键编号
+//功能：遍历整棵树，键按字节(无符号)字典序从0开始编号，与strcmp的顺序相同；同一个键的槽位编号相同。
+//      ranks按槽位号索引，调用者保证数组能容纳所有槽位号，不在索引中的槽位保持原值
+//返回：不同键的个数
+int prefixRanks(const PrefixIndex* index, int* ranks)
+{
+    return index->nodeCount == 0 ? 0 : rankPrefixSubtree(index, 0, ranks, 0);
+}
+
+//按深度优先顺序把子树中的值复制到新数组
+//返回：复制后新数组已使用的项数
+static int copyPrefixValues(PrefixIndex* index, int node, PrefixValue* values, int used)
+{
+    int value = index->nodes[node].values;
+    int* link = &index->nodes[node].values;
+    while (value != PREFIX_NIL)
+    {
+        values[used].slot = index->values[value].slot;
+        values[used].next = PREFIX_NIL;
+        *link = used;
+        link = &values[used].next;
+        value = index->values[value].next;
+        used++;
+    }
+    for (int child = index->nodes[node].child; child != PREFIX_NIL; child = index->nodes[child].sibling)
+    {
+        used = copyPrefixValues(index, child, values, used);
+    }
+    return used;
+}
+
+//重排值数组
+//功能：逐条插入的键交错分配值，同一个键的值链表散落在整个数组中，遍历时几乎每项都不命中缓存。
+//      按深度优先顺序重新分配后，每个键的值连续存放，相邻键的值也相邻，模糊查找和前缀查找顺序读取。
+//      批量加载之后调用一次即可，之后零星的修改只在链表头部插入少量项
+//返回：成功返回1，内存不足返回0(索引保持不变)
+int compactPrefixIndex(PrefixIndex* index)
+{
+    if (index->nodeCount == 0)
+    {
+        return 1;
+    }
+    PrefixValue* values = (PrefixValue*)malloc((size_t)index->valueCapacity * sizeof(PrefixValue));
+    if (values == NULL)
+    {
+        return 0;
+    }
+    index->valueCount = copyPrefixValues(index, 0, values, 0);
+    free(index->values);
+    index->values = values;
+    index->freeValues = PREFIX_NIL;
+    if (index->labelGarbage > 0)
+    {
+        compactPrefixLabels(index);  //失败时继续使用原标签池
+    }
+    return 1;
+}
+
+//登记一次对节点或值的引用
+//返回：下标在范围内且之前没有被引用过返回1
+static int markPrefixRef(unsigned char* seen, int ref, int count)
+{
+    if (ref == PREFIX_NIL)
+    {
+        return 1;
+    }
+    if (ref < 0 || ref >= count || seen[ref])
+    {
+        return 0;
+    }
+    seen[ref] = 1;
+    return 1;
+}
+
+//检查索引结构
+//功能：用于从文件读入的索引(见loadindex.h)，保证之后的查找和修改不会越界或陷入循环：
+//      各下标和标签在范围内，每个节点和值至多被引用一次且根节点不被引用(因此没有环)，
+//      空闲链表上只有空闲节点，值链表中的槽位小于slotLimit
+//返回：结构完好返回1，否则返回0
+int checkPrefixIndex(const PrefixIndex* index, int slotLimit)
+{
+    if (index->nodeCount < 0 || index->valueCount < 0 || index->labelSize < 0
+        || index->nodeCount > index->nodeCapacity || index->valueCount > index->valueCapacity
+        || index->labelSize > index->labelCapacity || index->labelGarbage < 0 || index->labelGarbage > index->labelSize
+        || index->keyCount < 0 || index->keyCount > index->valueCount)
+    {
+        return 0;
+    }
+    if (index->nodeCount == 0)
+    {
+        return index->valueCount == 0 && index->freeNodes == PREFIX_NIL && index->freeValues == PREFIX_NIL;
+    }
+    unsigned char* nodeSeen = (unsigned char*)calloc((size_t)index->nodeCount, 1);
+    unsigned char* valueSeen = (unsigned char*)calloc((size_t)index->valueCount + 1, 1);
+    int valid = nodeSeen != NULL && valueSeen != NULL && index->nodes[0].length == 0;
+    if (valid)
+    {
+        nodeSeen[0] = 1;  //根节点出现在任何引用中都会失败
+        valid = markPrefixRef(nodeSeen, index->freeNodes, index->nodeCount)
+             && markPrefixRef(valueSeen, index->freeValues, index->valueCount);
+    }
+    for (int i = 0; valid && i < index->nodeCount; i++)
+    {
+        const PrefixNode* node = &index->nodes[i];
+        if (node->length == -1)
+        {
+            valid = markPrefixRef(nodeSeen, node->sibling, index->nodeCount);
+            continue;
+        }
+        valid = node->length >= (i == 0 ? 0 : 1) && node->length <= PREFIX_KEY_MAX
+             && node->label >= 0 && node->label <= index->labelSize - node->length
+             && markPrefixRef(nodeSeen, node->child, index->nodeCount)
+             && markPrefixRef(nodeSeen, node->sibling, index->nodeCount)
+             && markPrefixRef(valueSeen, node->values, index->valueCount);
+    }
+    for (int i = 0; valid && i < index->valueCount; i++)
+    {
+        valid = markPrefixRef(valueSeen, index->values[i].next, index->valueCount);
+    }
+
+    //引用唯一，因此各链表都有终点；树中的节点必须在用，空闲链表上的节点必须空闲，值链表上的槽位必须有效
+    for (int i = 0; valid && i < index->nodeCount; i++)
+    {
+        const PrefixNode* node = &index->nodes[i];
+        if (node->length == -1)
+        {
+            valid = node->sibling == PREFIX_NIL || index->nodes[node->sibling].length == -1;
+            continue;
+        }
+        valid = (node->child == PREFIX_NIL || index->nodes[node->child].length != -1)
+             && (node->sibling == PREFIX_NIL || index->nodes[node->sibling].length != -1);
+        for (int value = node->values; valid && value != PREFIX_NIL; value = index->values[value].next)
+        {
+            valid = index->values[value].slot >= 0 && index->values[value].slot < slotLimit;
+        }
+    }
+    valid = valid && (index->freeNodes == PREFIX_NIL || index->nodes[index->freeNodes].length == -1);
+    free(nodeSeen);
+    free(valueSeen);
+    return valid;
+}
+
+// 模糊查找的遍历状态
+// rows[d]是查询键与当前路径前d个字符之间的编辑距离行(动态规划表的第d行)，沿路径逐字符计算
+typedef struct
+{
+    const PrefixIndex* index;
+    const unsigned char* key;   // 查询键
+    int length;                 // 查询键长度
+    int maxDistance;            // 整个键允许的最大编辑距离
+    int maxPrefixDistance;      // 键的前缀允许的最大编辑距离，-1表示不做前缀匹配
+    PrefixVisit visit;          // 回调
+    void* context;              // 回调参数
+    int nodes;                  // 访问的节点数
+    unsigned char rows[PREFIX_KEY_MAX + 1][PREFIX_KEY_MAX + 1];
+} PrefixFuzzyWalk;
+
+//对节点上的值调用回调
+static void visitPrefixValues(PrefixFuzzyWalk* walk, int node, int distance, int partial)
+{
+    const PrefixIndex* index = walk->index;
+    for (int value = index->nodes[node].values; value != PREFIX_NIL; value = index->values[value].next)
+    {
+        walk->visit(walk->context, index->values[value].slot, distance, partial);
+    }
+}
+
+//对子树中的全部值按前缀匹配调用回调
+static void visitPrefixSubtree(PrefixFuzzyWalk* walk, int node, int distance)
+{
+    walk->nodes++;
+    visitPrefixValues(walk, node, distance, 1);
+    for (int child = walk->index->nodes[node].child; child != PREFIX_NIL; child = walk->index->nodes[child].sibling)
+    {
+        visitPrefixSubtree(walk, child, distance);
+    }
+}
+
+//沿节点的边标签逐字符计算编辑距离行，再递归访问子节点
+//参数：depth - 到父节点为止的路径长度，prefixDistance - 路径上各前缀与查询键的最小编辑距离
+static void walkPrefixFuzzy(PrefixFuzzyWalk* walk, int node, int depth, int prefixDistance)
+{
+    const PrefixIndex* index = walk->index;
+    const PrefixNode* n = &index->nodes[node];
+    const unsigned char* label = (const unsigned char*)index->labels + n->label;
+    int m = walk->length;
+    walk->nodes++;
+    for (int i = 0; i < n->length; i++)
+    {
+        if (depth == PREFIX_KEY_MAX)
+        {
+            return;
+        }
+        const unsigned char* prev = walk->rows[depth];
+        unsigned char* row = walk->rows[depth + 1];
+        int rowMin = row[0] = (unsigned char)(prev[0] + 1);
+        for (int j = 1; j <= m; j++)
+        {
+            int best = prev[j - 1] + (walk->key[j - 1] != label[i]);
+            if (prev[j] + 1 < best)
+            {
+                best = prev[j] + 1;
+            }
+            if (row[j - 1] + 1 < best)
+            {
+                best = row[j - 1] + 1;
+            }
+            row[j] = (unsigned char)best;
+            if (best < rowMin)
+            {
+                rowMin = best;
+            }
+        }
+        depth++;
+        if (row[m] < prefixDistance)
+        {
+            prefixDistance = row[m];
+        }
+        if (rowMin > walk->maxDistance)
+        {
+            //路径再延长距离也不会变小；前缀已经足够接近时子树中的键都按前缀匹配
+            if (prefixDistance <= walk->maxPrefixDistance)
+            {
+                visitPrefixValues(walk, node, prefixDistance, 1);
+                for (int child = n->child; child != PREFIX_NIL; child = index->nodes[child].sibling)
+                {
+                    visitPrefixSubtree(walk, child, prefixDistance);
+                }
+            }
+            return;
+        }
+    }
+
+    if (n->values != PREFIX_NIL)
+    {
+        //整个键匹配记2倍距离，前缀匹配记2倍距离加1，取较好的一种
+        int distance = walk->rows[depth][m];
+        int full = distance <= walk->maxDistance;
+        int partial = prefixDistance <= walk->maxPrefixDistance;
+        if (full && (!partial || 2 * distance <= 2 * prefixDistance + 1))
+        {
+            visitPrefixValues(walk, node, distance, 0);
+        }
+        else if (partial)
+        {
+            visitPrefixValues(walk, node, prefixDistance, 1);
+        }
+    }
+    for (int child = n->child; child != PREFIX_NIL; child = index->nodes[child].sibling)
+    {
+        walkPrefixFuzzy(walk, child, depth, prefixDistance);
+    }
+}
+
+//按编辑距离模糊查找
+//功能：相当于在基数树上运行有界的Levenshtein自动机：沿路径逐字符计算编辑距离行，
+//      一行的最小值超过maxDistance时路径再长也不会匹配，整棵子树被剪掉。
+//      与key的编辑距离不超过maxDistance的键按整键匹配回调；maxPrefixDistance不小于0时，
+//      某个前缀与key的编辑距离不超过它的键也按前缀匹配回调
+//参数：key - 查询键(长度小于PREFIX_KEY_MAX)，visit/context - 回调及其参数
+//返回：访问的节点数
+int prefixFuzzySearch(const PrefixIndex* index, const char* key, int maxDistance, int maxPrefixDistance,
+                      PrefixVisit visit, void* context)
+{
+    if (index->nodeCount == 0)
+    {
+        return 0;
+    }
+    PrefixFuzzyWalk* walk = (PrefixFuzzyWalk*)malloc(sizeof(PrefixFuzzyWalk));
+    if (walk == NULL)
+    {
+        return 0;
+    }
+    walk->index = index;
+    walk->key = (const unsigned char*)key;
+    walk->length = (int)strnlen(key, PREFIX_KEY_MAX - 1);
+    walk->maxDistance = maxDistance;
+    walk->maxPrefixDistance = maxPrefixDistance;
+    walk->visit = visit;
+    walk->context = context;
+    walk->nodes = 0;
+    for (int j = 0; j <= walk->length; j++)
+    {
+        walk->rows[0][j] = (unsigned char)j;
+    }
+    walkPrefixFuzzy(walk, 0, 0, walk->length);
+    int nodes = walk->nodes;
+    free(walk);
+    return nodes;
+}
+
+//占用的内存字节数
+size_t prefixIndexBytes(const PrefixIndex* index)
+{
+    return (size_t)index->nodeCapacity * sizeof(PrefixNode)
+         + (size_t)index->valueCapacity * sizeof(PrefixValue)
+         + (size_t)index->labelCapacity;
+}
@@ -0,0 +1,64 @@
+#ifndef PREFIX_H
+#define PREFIX_H
+
+#include <stddef.h>
+
+#define PREFIX_KEY_MAX 64 // 键的最大长度(商品编号和名称都短于此值)
+
+// 前缀索引结构体
+// 基数树(压缩字典树)：每条边带一段标签，只有一个后继的路径合并为一条边，节点数不超过键数的2倍。
+// 子节点按标签首字节升序串成兄弟链表，因此按前缀查找时先沿前缀走到子树根，再按键的字典序
+// 遍历子树收集槽位，代价为O(前缀长度 + 结果数)。同一个键可对应多个槽位(重名商品)。
+// 节点、值和标签都存放在可增长的数组中，以下标互相引用；删除键时只回收变空的叶子，不合并路径，
+// 标签池中的废弃字节超过一半时整体压缩。
+typedef struct
+{
+    int label;   // 边标签在标签池中的偏移
+    int length;  // 边标签长度，-1表示空闲节点
+    int child;   // 第一个子节点，-1表示没有
+    int sibling; // 下一个兄弟节点(空闲节点为空闲链表的下一项)，-1表示没有
+    int values;  // 键恰好在此结束的值链表，-1表示没有
+} PrefixNode;
+
+// 值链表项
+typedef struct
+{
+    int slot; // 槽位号
+    int next; // 下一项(空闲项为空闲链表的下一项)，-1表示没有
+} PrefixValue;
+
+typedef struct
+{
+    PrefixNode *nodes;   // 节点数组，0号为根节点
+    int nodeCount;       // 已使用的节点数(含空闲节点)
+    int nodeCapacity;    // 节点数组容量
+    int freeNodes;       // 空闲节点链表
+    PrefixValue *values; // 值数组
+    int valueCount;      // 已使用的值数(含空闲项)
+    int valueCapacity;   // 值数组容量
+    int freeValues;      // 空闲值链表
+    char *labels;        // 标签池
+    int labelSize;       // 标签池已使用的字节数
+    int labelCapacity;   // 标签池容量
+    int labelGarbage;    // 标签池中已废弃的字节数
+    int keyCount;        // 键值对数
+} PrefixIndex;
+
+// 模糊查找的回调：slot为槽位号，distance为编辑距离，partial非0表示键的某个前缀(而非整个键)与查询相近
+typedef void (*PrefixVisit)(void *context, int slot, int distance, int partial);
+
+// 前缀索引函数声明
+void initPrefixIndex(PrefixIndex *index);                                      // 初始化前缀索引
+void freePrefixIndex(PrefixIndex *index);                                      // 释放前缀索引
+int reservePrefixIndex(PrefixIndex *index, int keyCount, int keyBytes);        // 预留插入keyCount个共keyBytes字节的键所需的空间，失败返回0
+void prefixInsert(PrefixIndex *index, const char *key, int slot);              // 插入键值对(须先预留空间，不会失败)
+void prefixRemove(PrefixIndex *index, const char *key, int slot);              // 删除键值对
+int prefixSearch(const PrefixIndex *index, const char *prefix, int *slots, int limit); // 按字典序列出前缀匹配的槽位，返回数量
+int prefixFuzzySearch(const PrefixIndex *index, const char *key, int maxDistance, int maxPrefixDistance,
+                      PrefixVisit visit, void *context);                       // 列出与key编辑距离有界的键的槽位，返回访问的节点数
+int prefixRanks(const PrefixIndex *index, int *ranks);                         // 按字典序给每个键编号，ranks[槽位]为键的序号，返回不同键的个数
+int compactPrefixIndex(PrefixIndex *index);                                    // 按遍历顺序重排值数组并压缩标签池，失败返回0
+int checkPrefixIndex(const PrefixIndex *index, int slotLimit);                 // 检查从文件读入的索引结构是否完好，槽位须小于slotLimit
+size_t prefixIndexBytes(const PrefixIndex *index);                             // 占用的内存字节数
+
+#endif
@@ -0,0 +1,232 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "protocol.h"
+
+//按小端序写入无符号整数
+static void putLittleEndian(unsigned char* out, unsigned long long value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        out[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+//按小端序读取无符号整数
+static unsigned long long getLittleEndian(const unsigned char* in, int bytes)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+        value |= (unsigned long long)in[i] << (8 * i);
+    }
+    return value;
+}
+
+//将帧头写入12字节缓冲区
+void protoEncodeHeader(unsigned char* out, const ProtoHeader* header)
+{
+    putLittleEndian(out, header->length, 4);
+    out[4] = header->op;
+    out[5] = header->status;
+    putLittleEndian(out + 6, header->count, 2);
+    putLittleEndian(out + 8, header->requestId, 4);
+}
+
+//从12字节缓冲区读出帧头
+void protoDecodeHeader(const unsigned char* in, ProtoHeader* header)
+{
+    header->length = (unsigned int)getLittleEndian(in, 4);
+    header->op = in[4];
+    header->status = in[5];
+    header->count = (unsigned short)getLittleEndian(in + 6, 2);
+    header->requestId = (unsigned int)getLittleEndian(in + 8, 4);
+}
+
+//初始化缓冲区
+void protoBufferInit(ProtoBuffer* buffer, unsigned char* data, size_t size)
+{
+    buffer->data = data;
+    buffer->size = size;
+    buffer->pos = 0;
+    buffer->overflow = 0;
+}
+
+//预留n字节
+//返回：可写入/读取的位置，越界时返回NULL并置overflow标志
+static unsigned char* reserve(ProtoBuffer* buffer, size_t n)
+{
+    if (buffer->overflow || buffer->size - buffer->pos < n)
+    {
+        buffer->overflow = 1;
+        return NULL;
+    }
+    unsigned char* at = buffer->data + buffer->pos;
+    buffer->pos += n;
+    return at;
+}
+
+//写入1字节
+void protoPutU8(ProtoBuffer* buffer, unsigned char value)
+{
+    unsigned char* at = reserve(buffer, 1);
+    if (at != NULL)
+    {
+        *at = value;
+    }
+}
+
+//写入4字节整数
+void protoPutI32(ProtoBuffer* buffer, int value)
+{
+    unsigned char* at = reserve(buffer, 4);
+    if (at != NULL)
+    {
+        putLittleEndian(at, (unsigned int)value, 4);
+    }
+}
+
+//写入8字节整数
+void protoPutI64(ProtoBuffer* buffer, long long value)
+{
+    unsigned char* at = reserve(buffer, 8);
+    if (at != NULL)
+    {
+        putLittleEndian(at, (unsigned long long)value, 8);
+    }
+}
+
+//写入字符串
+//功能：超过255字节的部分被截断
+void protoPutString(ProtoBuffer* buffer, const char* text)
+{
+    size_t length = strlen(text);
+    if (length > 255)
+    {
+        length = 255;
+    }
+    unsigned char* at = reserve(buffer, 1 + length);
+    if (at != NULL)
+    {
+        at[0] = (unsigned char)length;
+        memcpy(at + 1, text, length);
+    }
+}
+
+//写入商品记录
+//格式：id, name, brand(字符串) + category(uint8) + price(int64分) + stock(int32)
+void protoPutGoods(ProtoBuffer* buffer, const Goods* goods)
+{
+    protoPutString(buffer, goods->id);
+    protoPutString(buffer, goods->name);
+    protoPutString(buffer, goods->brand);
+    protoPutU8(buffer, (unsigned char)goods->category);
+    protoPutI64(buffer, goods->price);
+    protoPutI32(buffer, goods->stock);
+}
+
+//写入库存汇总
+void protoPutSummary(ProtoBuffer* buffer, const ProtoSummary* summary)
+{
+    protoPutI32(buffer, summary->goodsCount);
+    protoPutI32(buffer, summary->reorderCount);
+    protoPutI64(buffer, summary->totalValue);
+    for (int i = 0; i < 4; i++)
+    {
+        protoPutI32(buffer, summary->categoryCounts[i]);
+    }
+}
+
+//读取1字节
+unsigned char protoGetU8(ProtoBuffer* buffer)
+{
+    unsigned char* at = reserve(buffer, 1);
+    return at != NULL ? *at : 0;
+}
+
+//读取4字节整数
+int protoGetI32(ProtoBuffer* buffer)
+{
+    unsigned char* at = reserve(buffer, 4);
+    return at != NULL ? (int)(unsigned int)getLittleEndian(at, 4) : 0;
+}
+
+//读取8字节整数
+long long protoGetI64(ProtoBuffer* buffer)
+{
+    unsigned char* at = reserve(buffer, 8);
+    return at != NULL ? (long long)getLittleEndian(at, 8) : 0;
+}
+
+//读取字符串
+//功能：超出目标缓冲区的部分被截断，结果总以0结尾
+void protoGetString(ProtoBuffer* buffer, char* text, size_t size)
+{
+    text[0] = '\0';
+    unsigned char* lengthAt = reserve(buffer, 1);
+    if (lengthAt == NULL)
+    {
+        return;
+    }
+    unsigned char* at = reserve(buffer, *lengthAt);
+    if (at != NULL)
+    {
+        size_t copy = *lengthAt < size - 1 ? *lengthAt : size - 1;
+        memcpy(text, at, copy);
+        text[copy] = '\0';
+    }
+}
+
+//读取商品记录
+void protoGetGoods(ProtoBuffer* buffer, Goods* goods)
+{
+    protoGetString(buffer, goods->id, sizeof(goods->id));
+    protoGetString(buffer, goods->name, sizeof(goods->name));
+    protoGetString(buffer, goods->brand, sizeof(goods->brand));
+    goods->category = (GoodsCategory)protoGetU8(buffer);
+    goods->price = protoGetI64(buffer);
+    goods->stock = protoGetI32(buffer);
+}
+
+//读取库存汇总
+void protoGetSummary(ProtoBuffer* buffer, ProtoSummary* summary)
+{
+    summary->goodsCount = protoGetI32(buffer);
+    summary->reorderCount = protoGetI32(buffer);
+    summary->totalValue = protoGetI64(buffer);
+    for (int i = 0; i < 4; i++)
+    {
+        summary->categoryCounts[i] = protoGetI32(buffer);
+    }
+}
+
+//操作码转换为字符串
+const char* protoOpToString(ProtoOp op)
+{
+    switch (op)
+    {
+        case PROTO_OP_PING: return "ping";
+        case PROTO_OP_FIND_BY_ID: return "findById";
+        case PROTO_OP_FIND_BY_NAME: return "findByName";
+        case PROTO_OP_FIND_BY_BRAND: return "findByBrand";
+        case PROTO_OP_STATS: return "stats";
+        case PROTO_OP_ADJUST_STOCK: return "adjustStock";
+        case PROTO_OP_BATCH_FIND: return "batchFind";
+        case PROTO_OP_BATCH_ADJUST: return "batchAdjust";
+        case PROTO_OP_SUGGEST: return "suggest";
+        default: return "unknown";
+    }
+}
+
+//响应状态转换为字符串
+const char* protoStatusToString(ProtoStatus status)
+{
+    switch (status)
+    {
+        case PROTO_OK: return "OK";
+        case PROTO_NOT_FOUND: return "Not found";
+        case PROTO_BAD_REQUEST: return "Bad request";
+        case PROTO_REJECTED: return "Rejected";
+        case PROTO_SERVER_ERROR: return "Server error";
+        default: return "Unknown";
+    }
+}
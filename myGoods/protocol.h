@@ -0,0 +1,98 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "goods.h"
+
+// 查询服务二进制协议
+// 每个请求和响应都由12字节帧头和负载组成，多字节整数均为小端序：
+//   uint32 length     负载字节数(不含帧头)
+//   uint8  op         操作码
+//   uint8  status     响应状态(请求中为0)
+//   uint16 count      负载中的记录数
+//   uint32 requestId  请求编号，响应原样带回，便于客户端在同一连接上连续发送多个请求
+// 字符串编码为1字节长度加字符内容(不含结尾0)
+#define PROTO_HEADER_SIZE 12            // 帧头字节数
+#define PROTO_MAX_PAYLOAD (64 * 1024)   // 单帧负载上限
+#define PROTO_DEFAULT_SOCKET "goods.sock" // 默认套接字路径
+#define PROTO_MAX_BATCH 256             // 批量请求的最大条目数，保证最大响应不超过负载上限
+#define PROTO_MAX_SUGGEST 100           // 前缀查询单次返回的最大记录数
+
+// 操作码
+typedef enum
+{
+    PROTO_OP_PING = 1,          // 连通性检查，负载为空
+    PROTO_OP_FIND_BY_ID = 2,    // 按ID查找，负载：字符串id
+    PROTO_OP_FIND_BY_NAME = 3,  // 按名称搜索，负载：字符串name
+    PROTO_OP_FIND_BY_BRAND = 4, // 按品牌搜索，负载：字符串brand
+    PROTO_OP_STATS = 5,         // 库存汇总，负载为空
+    PROTO_OP_ADJUST_STOCK = 6,  // 调整库存，负载：字符串id + int32 delta
+    PROTO_OP_BATCH_FIND = 7,    // 批量按ID查找，帧头count为条目数，负载：count个字符串id；
+                                // 响应每条为uint8状态，成功时后跟商品记录
+    PROTO_OP_BATCH_ADJUST = 8,  // 批量调整库存，负载：count个(字符串id + int32 delta)；
+                                // 响应每条为uint8状态 + int32调整后库存(失败时为当前库存，未找到为0)
+    PROTO_OP_SUGGEST = 9        // 前缀查询，负载：uint8字段(0编号，1名称) + uint8最多条数 + 字符串前缀；
+                                // 响应帧头count为记录数，负载为按字典序排列的商品记录
+} ProtoOp;
+
+// 响应状态
+typedef enum
+{
+    PROTO_OK = 0,           // 成功
+    PROTO_NOT_FOUND = 1,    // 未找到商品
+    PROTO_BAD_REQUEST = 2,  // 请求格式错误或操作码未知
+    PROTO_REJECTED = 3,     // 请求被拒绝(如库存将为负)
+    PROTO_SERVER_ERROR = 4  // 服务器内部错误
+} ProtoStatus;
+
+// 帧头
+typedef struct
+{
+    unsigned int length;    // 负载字节数
+    unsigned char op;       // 操作码
+    unsigned char status;   // 响应状态
+    unsigned short count;   // 记录数
+    unsigned int requestId; // 请求编号
+} ProtoHeader;
+
+// 库存汇总(PROTO_OP_STATS的响应负载)
+typedef struct
+{
+    int goodsCount;         // 商品总数
+    int reorderCount;       // 需要补货的商品数
+    Money totalValue;       // 库存总价值(分)
+    int categoryCounts[4];  // 各类别商品数
+} ProtoSummary;
+
+// 编解码缓冲区
+// 写入或读取越界时置overflow标志而不访问越界内存，调用者在最后统一检查
+typedef struct
+{
+    unsigned char *data; // 缓冲区
+    size_t size;         // 缓冲区大小
+    size_t pos;          // 当前读写位置
+    int overflow;        // 是否发生越界
+} ProtoBuffer;
+
+// 帧头编解码
+void protoEncodeHeader(unsigned char *out, const ProtoHeader *header);   // 将帧头写入12字节缓冲区
+void protoDecodeHeader(const unsigned char *in, ProtoHeader *header);    // 从12字节缓冲区读出帧头
+
+// 负载编解码函数声明
+void protoBufferInit(ProtoBuffer *buffer, unsigned char *data, size_t size); // 初始化缓冲区
+void protoPutU8(ProtoBuffer *buffer, unsigned char value);       // 写入1字节
+void protoPutI32(ProtoBuffer *buffer, int value);                // 写入4字节整数
+void protoPutI64(ProtoBuffer *buffer, long long value);          // 写入8字节整数
+void protoPutString(ProtoBuffer *buffer, const char *text);      // 写入字符串
+void protoPutGoods(ProtoBuffer *buffer, const Goods *goods);     // 写入商品记录
+void protoPutSummary(ProtoBuffer *buffer, const ProtoSummary *summary); // 写入库存汇总
+unsigned char protoGetU8(ProtoBuffer *buffer);                   // 读取1字节
+int protoGetI32(ProtoBuffer *buffer);                            // 读取4字节整数
+long long protoGetI64(ProtoBuffer *buffer);                      // 读取8字节整数
+void protoGetString(ProtoBuffer *buffer, char *text, size_t size); // 读取字符串
+void protoGetGoods(ProtoBuffer *buffer, Goods *goods);           // 读取商品记录
+void protoGetSummary(ProtoBuffer *buffer, ProtoSummary *summary); // 读取库存汇总
+
+const char *protoOpToString(ProtoOp op);             // 操作码转换为字符串
+const char *protoStatusToString(ProtoStatus status); // 响应状态转换为字符串
+
+#endif
@@ -0,0 +1,977 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "query.h"
+#include "stats.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QUERY_BRAND_IDS (MAX_BRANDS + 1) // 品牌位图的大小，可容纳任何品牌ID
+
+// 字段名(下标为QueryField)
+static const char* const g_queryFieldNames[QUERY_FIELD_COUNT] = { "id", "name", "category", "brand", "price", "stock", "value" };
+// 运算符文本(下标为QueryOp)
+static const char* const g_queryOpNames[] = { "=", "!=", "<", "<=", ">", ">=", "^", "~" };
+
+// 词法单元类型
+typedef enum
+{
+    TOKEN_END,    // 查询结束
+    TOKEN_WORD,   // 关键字、字段名或未加引号的值
+    TOKEN_STRING, // 加引号的值
+    TOKEN_OP,     // 比较运算符
+    TOKEN_COMMA   // 逗号
+} TokenType;
+
+// 词法分析状态
+typedef struct
+{
+    const char *p;               // 下一个字符
+    TokenType type;              // 当前词法单元类型
+    QueryOp op;                  // 当前运算符
+    char text[QUERY_TEXT_MAX];   // 当前词法单元文本
+    char *error;                 // 错误信息缓冲区
+    size_t errorSize;            // 错误信息缓冲区大小
+} QueryLexer;
+
+// 访问路径
+typedef enum
+{
+    PATH_EMPTY,       // 条件矛盾或品牌不存在，不读取任何记录
+    PATH_ID_LOOKUP,   // 编号哈希索引
+    PATH_ID_PREFIX,   // 编号前缀索引
+    PATH_NAME_PREFIX, // 名称前缀索引
+    PATH_SCAN         // 按页扫描热数据
+} QueryPath;
+
+// 执行计划
+// 热数据上的条件编译为查表和区间：类别和品牌各一张表，单价、库存和价值各一个闭区间；
+// 其余条件逐个留给候选记录检查
+typedef struct
+{
+    QueryPath path;                          // 访问路径
+    const QueryCond *access;                 // 访问路径使用的条件(扫描时为NULL)
+    unsigned char categoryOk[256];           // 类别是否满足条件，空闲槽位的类别值(GOODS_FREE_CATEGORY)处为0
+    unsigned char *brandOk;                  // 品牌ID是否满足条件
+    int brandFiltered;                       // 是否有品牌条件
+    int brandMatches;                        // 满足品牌条件的品牌数
+    long long low[3];                        // 单价、库存、价值的下限
+    long long high[3];                       // 单价、库存、价值的上限
+    const QueryCond *residual[QUERY_MAX_CONDS]; // 逐个检查的条件
+    int residualCount;                       // 逐个检查的条件数
+} QueryPlan;
+
+//写入错误信息
+//返回：0，便于直接返回失败
+static int queryError(char* error, size_t errorSize, const char* format, const char* detail)
+{
+    if (error != NULL && errorSize > 0)
+    {
+        snprintf(error, errorSize, format, detail);
+    }
+    return 0;
+}
+
+//读取下一个词法单元
+//返回：成功返回1，引号不配对或词过长返回0
+static int nextToken(QueryLexer* lexer)
+{
+    const char* p = lexer->p;
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+    {
+        p++;
+    }
+    lexer->text[0] = '\0';
+    if (*p == '\0')
+    {
+        lexer->type = TOKEN_END;
+        lexer->p = p;
+        return 1;
+    }
+    if (*p == ',')
+    {
+        lexer->type = TOKEN_COMMA;
+        lexer->p = p + 1;
+        return 1;
+    }
+
+    //运算符
+    lexer->type = TOKEN_OP;
+    switch (*p)
+    {
+    case '=': lexer->op = QUERY_EQ; lexer->p = p + 1; return 1;
+    case '^': lexer->op = QUERY_PREFIX; lexer->p = p + 1; return 1;
+    case '~': lexer->op = QUERY_CONTAINS; lexer->p = p + 1; return 1;
+    case '<': lexer->op = p[1] == '=' ? QUERY_LE : QUERY_LT; lexer->p = p + (p[1] == '=' ? 2 : 1); return 1;
+    case '>': lexer->op = p[1] == '=' ? QUERY_GE : QUERY_GT; lexer->p = p + (p[1] == '=' ? 2 : 1); return 1;
+    case '!':
+        if (p[1] == '=')
+        {
+            lexer->op = QUERY_NE;
+            lexer->p = p + 2;
+            return 1;
+        }
+        return queryError(lexer->error, lexer->errorSize, "Expected '=' after '!'%s", "");
+    default:
+        break;
+    }
+
+    //加引号的值，或到空白、逗号、运算符为止的词
+    size_t length = 0;
+    if (*p == '\'' || *p == '"')
+    {
+        char quote = *p++;
+        while (*p != quote)
+        {
+            if (*p == '\0')
+            {
+                return queryError(lexer->error, lexer->errorSize, "Unterminated string%s", "");
+            }
+            if (length + 1 >= sizeof(lexer->text))
+            {
+                return queryError(lexer->error, lexer->errorSize, "Value too long%s", "");
+            }
+            lexer->text[length++] = *p++;
+        }
+        p++;
+        lexer->type = TOKEN_STRING;
+    }
+    else
+    {
+        while (*p != '\0' && strchr(" \t\r\n,=!<>^~'\"", *p) == NULL)
+        {
+            if (length + 1 >= sizeof(lexer->text))
+            {
+                return queryError(lexer->error, lexer->errorSize, "Word too long%s", "");
+            }
+            lexer->text[length++] = *p++;
+        }
+        lexer->type = TOKEN_WORD;
+    }
+    lexer->text[length] = '\0';
+    lexer->p = p;
+    return 1;
+}
+
+//当前词法单元是否为指定关键字(不区分大小写)
+static int isKeyword(const QueryLexer* lexer, const char* keyword)
+{
+    return lexer->type == TOKEN_WORD && _stricmp(lexer->text, keyword) == 0;
+}
+
+//将当前词法单元解析为字段名
+//返回：字段，不是字段名返回-1
+static int lookupField(const QueryLexer* lexer)
+{
+    for (int f = 0; f < QUERY_FIELD_COUNT && lexer->type == TOKEN_WORD; f++)
+    {
+        if (_stricmp(lexer->text, g_queryFieldNames[f]) == 0)
+        {
+            return f;
+        }
+    }
+    return -1;
+}
+
+//解析条件的值
+//功能：price和value按元解析为分，stock解析为整数，category解析为类别(不区分大小写)，文本字段原样保存
+//返回：成功返回1，值无效返回0
+static int parseCondValue(QueryLexer* lexer, QueryCond* cond)
+{
+    if (lexer->type != TOKEN_WORD && lexer->type != TOKEN_STRING)
+    {
+        return queryError(lexer->error, lexer->errorSize, "Expected a value after %s", g_queryFieldNames[cond->field]);
+    }
+    switch (cond->field)
+    {
+    case QUERY_PRICE:
+    case QUERY_VALUE:
+        if (!parseMoney(lexer->text, &cond->number))
+        {
+            return queryError(lexer->error, lexer->errorSize, "Invalid amount '%s'", lexer->text);
+        }
+        return 1;
+    case QUERY_STOCK:
+    {
+        char* end = NULL;
+        cond->number = strtoll(lexer->text, &end, 10);
+        if (end == lexer->text || *end != '\0')
+        {
+            return queryError(lexer->error, lexer->errorSize, "Invalid stock '%s'", lexer->text);
+        }
+        return 1;
+    }
+    case QUERY_CATEGORY:
+        for (int c = PEN; c <= OTHER; c++)
+        {
+            if (_stricmp(lexer->text, categoryToString((GoodsCategory)c)) == 0)
+            {
+                cond->number = c;
+                return 1;
+            }
+        }
+        return queryError(lexer->error, lexer->errorSize, "Unknown category '%s' (Pen/Notebook/Paint/Other)", lexer->text);
+    default:
+        strcpy_s(cond->text, sizeof(cond->text), lexer->text);
+        return 1;
+    }
+}
+
+//解析一个条件：字段 运算符 值
+static int parseCond(QueryLexer* lexer, QueryCond* cond)
+{
+    int field = lookupField(lexer);
+    if (field < 0)
+    {
+        return queryError(lexer->error, lexer->errorSize, "Unknown field '%s'", lexer->text);
+    }
+    memset(cond, 0, sizeof(*cond));
+    cond->field = (QueryField)field;
+    if (!nextToken(lexer))
+    {
+        return 0;
+    }
+    if (lexer->type != TOKEN_OP)
+    {
+        return queryError(lexer->error, lexer->errorSize, "Expected an operator after %s", g_queryFieldNames[field]);
+    }
+    cond->op = lexer->op;
+
+    //数值字段不支持^和~，文本字段不支持大小比较，类别只支持=和!=
+    int numeric = field == QUERY_PRICE || field == QUERY_STOCK || field == QUERY_VALUE;
+    int valid = numeric ? cond->op <= QUERY_GE
+              : field == QUERY_CATEGORY ? cond->op <= QUERY_NE
+              : cond->op <= QUERY_NE || cond->op >= QUERY_PREFIX;
+    if (!valid)
+    {
+        return queryError(lexer->error, lexer->errorSize, "Operator not supported for %s", g_queryFieldNames[field]);
+    }
+    return nextToken(lexer) && parseCondValue(lexer, cond) && nextToken(lexer);
+}
+
+//解析查询文本
+//功能：按query.h中的语法解析为Query，只检查语法和值的格式，不访问数据
+//返回：成功返回1，失败返回0并写入错误信息
+int parseQuery(const char* text, Query* query, char* error, size_t errorSize)
+{
+    QueryLexer lexer;
+    memset(&lexer, 0, sizeof(lexer));
+    memset(query, 0, sizeof(*query));
+    lexer.p = text;
+    lexer.error = error;
+    lexer.errorSize = errorSize;
+    if (!nextToken(&lexer))
+    {
+        return 0;
+    }
+
+    if (isKeyword(&lexer, "explain"))
+    {
+        query->explain = 1;
+        if (!nextToken(&lexer))
+        {
+            return 0;
+        }
+    }
+
+    //输出列，默认与商品列表相同(不含价值)
+    if (isKeyword(&lexer, "select"))
+    {
+        do
+        {
+            if (!nextToken(&lexer))
+            {
+                return 0;
+            }
+            int field = lookupField(&lexer);
+            if (field < 0 || query->columnCount == QUERY_FIELD_COUNT)
+            {
+                return queryError(error, errorSize, "Invalid column '%s'", lexer.text);
+            }
+            query->columns[query->columnCount++] = (QueryField)field;
+            if (!nextToken(&lexer))
+            {
+                return 0;
+            }
+        } while (lexer.type == TOKEN_COMMA);
+    }
+    else
+    {
+        for (int f = QUERY_ID; f <= QUERY_STOCK; f++)
+        {
+            query->columns[query->columnCount++] = (QueryField)f;
+        }
+    }
+
+    //条件
+    if (isKeyword(&lexer, "where") && !nextToken(&lexer))
+    {
+        return 0;
+    }
+    if (lexer.type != TOKEN_END && !isKeyword(&lexer, "order") && !isKeyword(&lexer, "limit"))
+    {
+        while (1)
+        {
+            if (query->condCount == QUERY_MAX_CONDS)
+            {
+                return queryError(error, errorSize, "Too many conditions%s", "");
+            }
+            if (!parseCond(&lexer, &query->conds[query->condCount++]))
+            {
+                return 0;
+            }
+            if (!isKeyword(&lexer, "and"))
+            {
+                break;
+            }
+            if (!nextToken(&lexer))
+            {
+                return 0;
+            }
+        }
+    }
+
+    //排序
+    if (isKeyword(&lexer, "order"))
+    {
+        if (!nextToken(&lexer) || !isKeyword(&lexer, "by"))
+        {
+            return queryError(error, errorSize, "Expected 'by' after 'order'%s", "");
+        }
+        do
+        {
+            if (!nextToken(&lexer))
+            {
+                return 0;
+            }
+            static const SortField sortFields[QUERY_FIELD_COUNT] = {
+                SORT_FIELD_COUNT, SORT_BY_NAME, SORT_BY_CATEGORY, SORT_BY_BRAND, SORT_BY_PRICE, SORT_BY_STOCK, SORT_BY_VALUE };
+            int field = lookupField(&lexer);
+            if (field < 0)
+            {
+                return queryError(error, errorSize, "Invalid order field '%s'", lexer.text);
+            }
+            if (field == QUERY_ID)
+            {
+                return queryError(error, errorSize, "Cannot order by '%s' (results are in ID order by default)", lexer.text);
+            }
+            for (int k = 0; k < query->orderCount; k++)
+            {
+                if (query->order[k].field == sortFields[field])
+                {
+                    return queryError(error, errorSize, "Duplicate order field '%s'", lexer.text);
+                }
+            }
+            SortKey* key = &query->order[query->orderCount++];
+            key->field = sortFields[field];
+            key->descending = 0;
+            if (!nextToken(&lexer))
+            {
+                return 0;
+            }
+            if (isKeyword(&lexer, "asc") || isKeyword(&lexer, "desc"))
+            {
+                key->descending = isKeyword(&lexer, "desc");
+                if (!nextToken(&lexer))
+                {
+                    return 0;
+                }
+            }
+        } while (lexer.type == TOKEN_COMMA);
+    }
+
+    //条数限制
+    if (isKeyword(&lexer, "limit"))
+    {
+        if (!nextToken(&lexer))
+        {
+            return 0;
+        }
+        char* end = NULL;
+        long limit = strtol(lexer.text, &end, 10);
+        if (lexer.type != TOKEN_WORD || end == lexer.text || *end != '\0' || limit <= 0 || limit > INT_MAX)
+        {
+            return queryError(error, errorSize, "Invalid limit '%s'", lexer.text);
+        }
+        query->limit = (int)limit;
+        if (!nextToken(&lexer))
+        {
+            return 0;
+        }
+    }
+
+    if (lexer.type != TOKEN_END)
+    {
+        return queryError(error, errorSize, "Unexpected '%s'", lexer.type == TOKEN_COMMA ? "," : lexer.text);
+    }
+    return 1;
+}
+
+//不区分ASCII大小写地查找子串
+static int containsNoCase(const char* text, const char* part)
+{
+    size_t length = strlen(part);
+    for (; *text != '\0'; text++)
+    {
+        if (_strnicmp(text, part, length) == 0)
+        {
+            return 1;
+        }
+    }
+    return length == 0;
+}
+
+//文本条件求值
+static int matchText(const char* value, const QueryCond* cond)
+{
+    switch (cond->op)
+    {
+    case QUERY_EQ: return strcmp(value, cond->text) == 0;
+    case QUERY_NE: return strcmp(value, cond->text) != 0;
+    case QUERY_PREFIX: return strncmp(value, cond->text, strlen(cond->text)) == 0;
+    default: return containsNoCase(value, cond->text);
+    }
+}
+
+//数值条件求值
+static int matchNumber(long long value, const QueryCond* cond)
+{
+    switch (cond->op)
+    {
+    case QUERY_EQ: return value == cond->number;
+    case QUERY_NE: return value != cond->number;
+    case QUERY_LT: return value < cond->number;
+    case QUERY_LE: return value <= cond->number;
+    case QUERY_GT: return value > cond->number;
+    default: return value >= cond->number;
+    }
+}
+
+//对一条记录检查一个条件
+static int matchCond(GoodsManager* manager, int slot, const QueryCond* cond)
+{
+    const GoodsHot* hot = STORE_HOT(&manager->store, slot);
+    switch (cond->field)
+    {
+    case QUERY_ID: return matchText(STORE_COLD(&manager->store, slot)->id, cond);
+    case QUERY_NAME: return matchText(getGoodsName(&STORE_COLD(&manager->store, slot)->name, &manager->names), cond);
+    case QUERY_BRAND: return matchText(brandName(&manager->brands, hot->brandId), cond);
+    case QUERY_CATEGORY: return matchNumber(hot->category, cond);
+    case QUERY_PRICE: return matchNumber(hot->price, cond);
+    case QUERY_STOCK: return matchNumber(hot->stock, cond);
+    default: return matchNumber(hot->price * (Money)hot->stock, cond);
+    }
+}
+
+//热数据上的编译条件
+//功能：类别和品牌查表，单价、库存、价值用无符号减法各做一次闭区间比较，全程无分支
+static int matchHot(const QueryPlan* plan, const GoodsHot* hot)
+{
+    unsigned long long price = (unsigned long long)hot->price;
+    unsigned long long stock = (unsigned long long)(long long)hot->stock;
+    unsigned long long value = (unsigned long long)(hot->price * (Money)hot->stock);
+    return plan->categoryOk[hot->category]
+         & plan->brandOk[hot->brandId]
+         & (price - (unsigned long long)plan->low[0] <= (unsigned long long)plan->high[0] - (unsigned long long)plan->low[0])
+         & (stock - (unsigned long long)plan->low[1] <= (unsigned long long)plan->high[1] - (unsigned long long)plan->low[1])
+         & (value - (unsigned long long)plan->low[2] <= (unsigned long long)plan->high[2] - (unsigned long long)plan->low[2]);
+}
+
+//把数值条件并入闭区间
+//返回：能并入返回1；!=不能表示为区间，返回0
+static int narrowRange(long long* low, long long* high, const QueryCond* cond)
+{
+    long long v = cond->number;
+    switch (cond->op)
+    {
+    case QUERY_EQ: *low = v > *low ? v : *low; *high = v < *high ? v : *high; return 1;
+    case QUERY_LT: if (v == LLONG_MIN) { *high = LLONG_MIN; *low = LLONG_MAX; } else if (v - 1 < *high) { *high = v - 1; } return 1;
+    case QUERY_LE: *high = v < *high ? v : *high; return 1;
+    case QUERY_GT: if (v == LLONG_MAX) { *low = LLONG_MAX; *high = LLONG_MIN; } else if (v + 1 > *low) { *low = v + 1; } return 1;
+    case QUERY_GE: *low = v > *low ? v : *low; return 1;
+    default: return 0;
+    }
+}
+
+//编译执行计划
+//功能：把类别、品牌和数值条件编译为查表和区间，选择访问路径，其余条件留给候选记录检查
+//返回：成功返回1，内存不足返回0
+static int planQuery(GoodsManager* manager, const Query* query, QueryPlan* plan)
+{
+    memset(plan, 0, sizeof(*plan));
+    plan->path = PATH_SCAN;
+    plan->brandOk = (unsigned char*)malloc(QUERY_BRAND_IDS);
+    if (plan->brandOk == NULL)
+    {
+        return 0;
+    }
+    memset(plan->brandOk, 1, QUERY_BRAND_IDS);
+    for (int c = PEN; c <= OTHER; c++)
+    {
+        plan->categoryOk[c] = 1;
+    }
+    for (int r = 0; r < 3; r++)
+    {
+        plan->low[r] = LLONG_MIN;
+        plan->high[r] = LLONG_MAX;
+    }
+
+    int empty = 0;
+    for (int i = 0; i < query->condCount; i++)
+    {
+        const QueryCond* cond = &query->conds[i];
+        switch (cond->field)
+        {
+        case QUERY_CATEGORY:
+            for (int c = PEN; c <= OTHER; c++)
+            {
+                plan->categoryOk[c] &= (unsigned char)matchNumber(c, cond);
+            }
+            break;
+        case QUERY_BRAND:
+            //在品牌字典上逐个品牌求值，扫描时只需按品牌ID查表
+            plan->brandFiltered = 1;
+            for (int b = 0; b < manager->brands.count; b++)
+            {
+                plan->brandOk[b] &= (unsigned char)matchText(brandName(&manager->brands, b), cond);
+            }
+            break;
+        case QUERY_PRICE:
+        case QUERY_STOCK:
+        case QUERY_VALUE:
+        {
+            int r = cond->field == QUERY_PRICE ? 0 : cond->field == QUERY_STOCK ? 1 : 2;
+            if (!narrowRange(&plan->low[r], &plan->high[r], cond))
+            {
+                plan->residual[plan->residualCount++] = cond;
+            }
+            break;
+        }
+        default:
+            plan->residual[plan->residualCount++] = cond;
+            //访问路径：编号精确匹配 > 编号前缀 > 名称前缀(名称相等也先按前缀列出) > 扫描
+            if (cond->field == QUERY_ID && cond->op == QUERY_EQ)
+            {
+                plan->path = PATH_ID_LOOKUP;
+                plan->access = cond;
+            }
+            else if (cond->field == QUERY_ID && cond->op == QUERY_PREFIX && plan->path != PATH_ID_LOOKUP)
+            {
+                plan->path = PATH_ID_PREFIX;
+                plan->access = cond;
+            }
+            else if (cond->field == QUERY_NAME && (cond->op == QUERY_EQ || cond->op == QUERY_PREFIX) && plan->path == PATH_SCAN)
+            {
+                plan->path = PATH_NAME_PREFIX;
+                plan->access = cond;
+            }
+            break;
+        }
+    }
+
+    if (plan->brandFiltered)
+    {
+        for (int b = 0; b < manager->brands.count; b++)
+        {
+            plan->brandMatches += plan->brandOk[b];
+        }
+        empty |= plan->brandMatches == 0;
+    }
+    empty |= plan->categoryOk[PEN] + plan->categoryOk[NOTEBOOK] + plan->categoryOk[PAINT] + plan->categoryOk[OTHER] == 0;
+    for (int r = 0; r < 3; r++)
+    {
+        empty |= plan->low[r] > plan->high[r];
+    }
+    if (empty)
+    {
+        plan->path = PATH_EMPTY;
+        plan->access = NULL;
+    }
+    return 1;
+}
+
+// 按编号排序的排序项
+typedef struct
+{
+    const char *id; // 商品编号(指向冷数据)
+    int slot;       // 槽位号
+} IdSortEntry;
+
+//比较函数：按编号排序(供qsort使用)
+static int compareIdSortEntries(const void* a, const void* b)
+{
+    return strcmp(((const IdSortEntry*)a)->id, ((const IdSortEntry*)b)->id);
+}
+
+//把候选槽位按编号升序排列
+//功能：候选较少时直接按编号排序；较多时标记候选后按编号前缀索引的顺序取出，代价与商品总数成正比
+//返回：成功返回1，内存不足返回0
+static int orderSlotsById(GoodsManager* manager, int* slots, int count)
+{
+    if ((long long)count * 8 < manager->count)
+    {
+        IdSortEntry* entries = (IdSortEntry*)malloc((size_t)(count > 0 ? count : 1) * sizeof(IdSortEntry));
+        if (entries == NULL)
+        {
+            return 0;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            entries[i].id = STORE_COLD(&manager->store, slots[i])->id;
+            entries[i].slot = slots[i];
+        }
+        qsort(entries, (size_t)count, sizeof(IdSortEntry), compareIdSortEntries);
+        for (int i = 0; i < count; i++)
+        {
+            slots[i] = entries[i].slot;
+        }
+        free(entries);
+        return 1;
+    }
+    unsigned char* marked = (unsigned char*)calloc((size_t)manager->store.slotLimit, 1);
+    int* all = (int*)malloc((size_t)manager->count * sizeof(int));
+    int ok = marked != NULL && all != NULL;
+    if (ok)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            marked[slots[i]] = 1;
+        }
+        int total = prefixSearch(&manager->idPrefix, "", all, manager->count);
+        int kept = 0;
+        for (int i = 0; i < total; i++)
+        {
+            slots[kept] = all[i];
+            kept += marked[all[i]];
+        }
+    }
+    free(marked);
+    free(all);
+    return ok;
+}
+
+//扫描全部页的热数据
+//功能：对每条记录计算编译条件，把槽位写到当前输出位置后按结果前进，满足与否都不分支
+//返回：满足条件的槽位数
+static int scanHotPages(const GoodsStore* store, const QueryPlan* plan, int* slots)
+{
+    int found = 0;
+    for (int page = 0; page < store->pageCount; page++)
+    {
+        const GoodsHot* hot = store->pages[page]->hot;
+        int base = page << GOODS_PAGE_SHIFT;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            slots[found] = base + i;
+            found += matchHot(plan, &hot[i]);
+        }
+    }
+    return found;
+}
+
+//在说明后追加一行
+static void appendExplain(QueryResult* result, const char* line)
+{
+    size_t used = strlen(result->explain);
+    snprintf(result->explain + used, sizeof(result->explain) - used, "%s\n", line);
+}
+
+//生成执行计划说明
+static void explainPlan(GoodsManager* manager, const Query* query, const QueryPlan* plan, int candidates, int passes,
+                        QueryResult* result)
+{
+    char line[256];
+    char low[MONEY_TEXT_SIZE], high[MONEY_TEXT_SIZE];
+    result->explain[0] = '\0';
+    switch (plan->path)
+    {
+    case PATH_EMPTY:
+        appendExplain(result, "access: none (conditions cannot match; no records read)");
+        break;
+    case PATH_ID_LOOKUP:
+        snprintf(line, sizeof(line), "access: id hash index, id = '%s' (%d candidate)", plan->access->text, candidates);
+        appendExplain(result, line);
+        break;
+    case PATH_ID_PREFIX:
+    case PATH_NAME_PREFIX:
+        snprintf(line, sizeof(line), "access: %s prefix tree, %s %s '%s' (%d candidates)",
+                 g_queryFieldNames[plan->access->field], g_queryFieldNames[plan->access->field],
+                 g_queryOpNames[plan->access->op], plan->access->text, candidates);
+        appendExplain(result, line);
+        break;
+    default:
+        snprintf(line, sizeof(line), "access: scan %d pages of hot data, branch-free compiled filter (%d candidates)",
+                 manager->store.pageCount, candidates);
+        appendExplain(result, line);
+        break;
+    }
+
+    //编译条件
+    if (plan->categoryOk[PEN] + plan->categoryOk[NOTEBOOK] + plan->categoryOk[PAINT] + plan->categoryOk[OTHER] < 4)
+    {
+        size_t used = (size_t)snprintf(line, sizeof(line), "filter: category in {");
+        int listed = 0;
+        for (int c = PEN; c <= OTHER; c++)
+        {
+            if (plan->categoryOk[c] && used < sizeof(line))
+            {
+                used += (size_t)snprintf(line + used, sizeof(line) - used, "%s%s", listed++ > 0 ? "," : "", categoryToString((GoodsCategory)c));
+            }
+        }
+        if (used < sizeof(line))
+        {
+            snprintf(line + used, sizeof(line) - used, "} (lookup table)");
+        }
+        appendExplain(result, line);
+    }
+    if (plan->brandFiltered)
+    {
+        snprintf(line, sizeof(line), "filter: brand matches %d of %d dictionary brands (brand id bitmap)",
+                 plan->brandMatches, manager->brands.count);
+        appendExplain(result, line);
+    }
+    for (int r = 0; r < 3; r++)
+    {
+        if (plan->low[r] == LLONG_MIN && plan->high[r] == LLONG_MAX)
+        {
+            continue;
+        }
+        static const char* const names[3] = { "price", "stock", "value" };
+        if (r == 1)
+        {
+            snprintf(low, sizeof(low), plan->low[r] == LLONG_MIN ? "-inf" : "%lld", plan->low[r]);
+            snprintf(high, sizeof(high), plan->high[r] == LLONG_MAX ? "+inf" : "%lld", plan->high[r]);
+        }
+        else
+        {
+            if (plan->low[r] == LLONG_MIN) strcpy_s(low, sizeof(low), "-inf"); else formatMoney(plan->low[r], low, sizeof(low));
+            if (plan->high[r] == LLONG_MAX) strcpy_s(high, sizeof(high), "+inf"); else formatMoney(plan->high[r], high, sizeof(high));
+        }
+        snprintf(line, sizeof(line), "filter: %s in [%s, %s] (range compare%s)", names[r], low, high,
+                 r == 0 ? ", no price index" : "");
+        appendExplain(result, line);
+    }
+    for (int i = 0; i < plan->residualCount; i++)
+    {
+        const QueryCond* cond = plan->residual[i];
+        char value[QUERY_TEXT_MAX + 2];
+        if (cond->field == QUERY_PRICE || cond->field == QUERY_VALUE)
+        {
+            formatMoney(cond->number, value, sizeof(value));
+        }
+        else if (cond->field == QUERY_STOCK)
+        {
+            snprintf(value, sizeof(value), "%lld", cond->number);
+        }
+        else
+        {
+            snprintf(value, sizeof(value), "'%s'", cond->text);
+        }
+        snprintf(line, sizeof(line), "check: %s %s %s per candidate", g_queryFieldNames[cond->field], g_queryOpNames[cond->op], value);
+        appendExplain(result, line);
+    }
+
+    //排序和截取
+    if (query->orderCount > 0)
+    {
+        char spec[SORT_SPEC_SIZE];
+        snprintf(line, sizeof(line), "order: %s, then id (%s)", formatSortKeys(query->order, query->orderCount, spec, sizeof(spec)),
+                 passes >= 0 ? "normalized keys, radix sort" : "normalized keys, merge sort");
+        appendExplain(result, line);
+    }
+    else
+    {
+        appendExplain(result, "order: id");
+    }
+    if (query->limit > 0)
+    {
+        snprintf(line, sizeof(line), "limit: %d", query->limit);
+        appendExplain(result, line);
+    }
+}
+
+//编译并执行查询
+//功能：按当前数据编译执行计划，沿访问路径取候选，检查其余条件，按编号排列后按order by稳定排序，截取limit条
+//返回：成功返回1，内存不足返回0
+int runQuery(GoodsManager* manager, const Query* query, QueryResult* result)
+{
+    memset(result, 0, sizeof(*result));
+    QueryPlan plan;
+    if (!planQuery(manager, query, &plan))
+    {
+        return 0;
+    }
+    STATS_BEGIN(STAT_QUERY);
+    GoodsStore* store = &manager->store;
+    result->slots = (int*)malloc(((size_t)manager->count + 1) * sizeof(int));
+    int ok = result->slots != NULL;
+    int candidates = 0;
+    int passes = -1;
+    if (ok)
+    {
+        //沿访问路径取候选，索引路径取出的候选还需检查热数据上的条件
+        int found = 0;
+        int probes = 0;
+        switch (plan.path)
+        {
+        case PATH_EMPTY:
+            break;
+        case PATH_ID_LOOKUP:
+        {
+            int slot = indexFindGoods(store, plan.access->text, &probes);
+            if (slot != GOODS_NIL)
+            {
+                result->slots[found++] = slot;
+            }
+            break;
+        }
+        case PATH_ID_PREFIX:
+        case PATH_NAME_PREFIX:
+            found = prefixSearch(plan.path == PATH_ID_PREFIX ? &manager->idPrefix : &manager->namePrefix,
+                                 plan.access->text, result->slots, manager->count);
+            break;
+        default:
+            found = scanHotPages(store, &plan, result->slots);
+            result->examined = store->pageCount * GOODS_PAGE_SIZE;
+            break;
+        }
+        candidates = found;
+        if (plan.path != PATH_SCAN)
+        {
+            result->examined = found;
+        }
+
+        //检查其余条件
+        int kept = 0;
+        for (int i = 0; i < found; i++)
+        {
+            int slot = result->slots[i];
+            int match = plan.path == PATH_SCAN || matchHot(&plan, STORE_HOT(store, slot));
+            for (int c = 0; c < plan.residualCount && match; c++)
+            {
+                match = matchCond(manager, slot, plan.residual[c]);
+            }
+            result->slots[kept] = slot;
+            kept += match;
+        }
+        result->matched = kept;
+
+        //编号前缀索引已按编号排列，其余路径需要重新排列
+        ok = plan.path == PATH_ID_PREFIX || orderSlotsById(manager, result->slots, kept);
+        if (ok && query->orderCount > 0)
+        {
+            ok = sortSlotList(manager, query->order, query->orderCount, result->slots, kept, &passes);
+        }
+        result->count = query->limit > 0 && kept > query->limit ? query->limit : kept;
+    }
+    if (ok)
+    {
+        explainPlan(manager, query, &plan, candidates, passes, result);
+    }
+    else
+    {
+        freeQueryResult(result);
+    }
+    STATS_VISIT_N(result->examined);
+    STATS_END();
+    free(plan.brandOk);
+    return ok;
+}
+
+//释放查询结果
+void freeQueryResult(QueryResult* result)
+{
+    free(result->slots);
+    result->slots = NULL;
+    result->count = 0;
+}
+
+//按输出列显示结果
+void displayQueryResult(GoodsManager* manager, const Query* query, const QueryResult* result)
+{
+    // 各列的表头、宽度(负数为左对齐)和截断长度
+    static const char* const titles[QUERY_FIELD_COUNT] = { "ID", "Name", "Category", "Brand", "Price", "Stock", "Value" };
+    static const int widths[QUERY_FIELD_COUNT] = { -16, -25, -12, -20, 10, 8, 14 };
+
+    if (result->count == 0)
+    {
+        printf("No matching products found.\n");
+        return;
+    }
+    for (int c = 0; c < query->columnCount; c++)
+    {
+        printf("%*s  ", widths[query->columns[c]], titles[query->columns[c]]);
+    }
+    printf("\n");
+    for (int c = 0; c < query->columnCount; c++)
+    {
+        int width = abs(widths[query->columns[c]]);
+        for (int i = 0; i < width; i++)
+        {
+            putchar('-');
+        }
+        printf("  ");
+    }
+    printf("\n");
+
+    for (int i = 0; i < result->count; i++)
+    {
+        Goods goods;
+        slotToGoods(manager, result->slots[i], &goods);
+        for (int c = 0; c < query->columnCount; c++)
+        {
+            QueryField field = query->columns[c];
+            char text[64];
+            switch (field)
+            {
+            case QUERY_ID: truncateString(text, goods.id, 16); break;
+            case QUERY_NAME: truncateString(text, goods.name, 25); break;
+            case QUERY_CATEGORY: strcpy_s(text, sizeof(text), categoryToString(goods.category)); break;
+            case QUERY_BRAND: truncateString(text, goods.brand, 20); break;
+            case QUERY_PRICE: formatMoney(goods.price, text, sizeof(text)); break;
+            case QUERY_STOCK: snprintf(text, sizeof(text), "%d", goods.stock); break;
+            default: formatMoney(goods.price * (Money)goods.stock, text, sizeof(text)); break;
+            }
+            printf("%*s  ", widths[field], text);
+        }
+        printf("\n");
+    }
+    printf("\n%d of %d matching products shown.\n", result->count, result->matched);
+}
+
+//解析、执行并显示一条查询
+//功能：查询以explain开头时先显示执行计划和耗时
+//返回：成功返回1，语法错误或内存不足返回0
+int runQueryText(GoodsManager* manager, const char* text)
+{
+    Query query;
+    char error[QUERY_ERROR_SIZE];
+    if (!parseQuery(text, &query, error, sizeof(error)))
+    {
+        printf("Query error: %s\n", error);
+        return 0;
+    }
+
+    LARGE_INTEGER frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+    QueryResult result;
+    int ok = runQuery(manager, &query, &result);
+    QueryPerformanceCounter(&end);
+    if (!ok)
+    {
+        printf("Not enough memory to run the query.\n");
+        return 0;
+    }
+    if (query.explain)
+    {
+        printf("\n=== Query Plan ===\n%s", result.explain);
+        printf("examined %d records, %d matched, %.3f ms\n\n", result.examined, result.matched,
+               (double)(end.QuadPart - start.QuadPart) * 1000.0 / (double)frequency.QuadPart);
+    }
+    displayQueryResult(manager, &query, &result);
+    freeQueryResult(&result);
+    return 1;
+}
@@ -0,0 +1,89 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "sortkey.h"
+
+// 查询语言
+// 语法(关键字不区分大小写)：
+//   [explain] [select 字段,...] [where] 条件 [and 条件 ...] [order by 字段 [asc|desc], ...] [limit N]
+//   条件为"字段 运算符 值"，字段为id/name/brand/category/price/stock/value。
+//   运算符：= != < <= > >= (数值字段)；= != ^(前缀) ~(包含，不区分大小写) (文本字段)；= != (category)。
+//   文本值可以用单引号或双引号括起；price和value以元为单位，最多两位小数。
+//   例：category=Pen and price<5 and brand~pilot order by stock desc limit 50
+// 查询先解析为Query(只与文本有关，可重复执行)，执行时按当前数据编译为执行计划：
+//   选择访问路径：id=用编号哈希索引，id^用编号前缀索引，name=和name^用名称前缀索引，
+//   品牌条件先在品牌字典上逐个品牌求值得到品牌ID位图(没有品牌满足时不扫描)，
+//   其余情况按页扫描热数据，类别、品牌、单价、库存和价值条件编译为查表和区间比较，无分支地筛出候选；
+//   名称和编号上的其余条件只对候选读取冷数据检查。
+// 结果按编号升序，有order by时再稳定排序(见sortkey.h)，最后截取limit条。
+#define QUERY_MAX_CONDS 16     // 最多条件数
+#define QUERY_TEXT_MAX 64      // 文本值的最大长度(含'\0')
+#define QUERY_ERROR_SIZE 128   // 错误信息缓冲区大小
+#define QUERY_EXPLAIN_SIZE 1024 // 执行计划说明缓冲区大小
+
+// 查询字段(取值与输出列相同)
+typedef enum
+{
+    QUERY_ID,       // 编号
+    QUERY_NAME,     // 名称
+    QUERY_CATEGORY, // 类别
+    QUERY_BRAND,    // 品牌
+    QUERY_PRICE,    // 单价(分)
+    QUERY_STOCK,    // 库存
+    QUERY_VALUE,    // 库存价值(分)
+    QUERY_FIELD_COUNT // 字段总数
+} QueryField;
+
+// 比较运算符
+typedef enum
+{
+    QUERY_EQ,       // =
+    QUERY_NE,       // !=
+    QUERY_LT,       // <
+    QUERY_LE,       // <=
+    QUERY_GT,       // >
+    QUERY_GE,       // >=
+    QUERY_PREFIX,   // ^ 以值开头
+    QUERY_CONTAINS  // ~ 包含值(不区分大小写)
+} QueryOp;
+
+// 查询条件
+typedef struct
+{
+    QueryField field;           // 字段
+    QueryOp op;                 // 运算符
+    long long number;           // 数值字段和类别的值
+    char text[QUERY_TEXT_MAX];  // 文本字段的值
+} QueryCond;
+
+// 解析后的查询
+typedef struct
+{
+    int explain;                         // 是否输出执行计划
+    QueryField columns[QUERY_FIELD_COUNT]; // 输出列
+    int columnCount;                     // 输出列数
+    QueryCond conds[QUERY_MAX_CONDS];    // 条件(全部满足)
+    int condCount;                       // 条件数
+    SortKey order[SORT_MAX_KEYS];        // 排序字段
+    int orderCount;                      // 排序字段数，0表示按编号
+    int limit;                           // 最多结果数，0表示不限
+} Query;
+
+// 查询执行结果
+typedef struct
+{
+    int *slots;                          // 结果槽位(按输出顺序)
+    int count;                           // 结果数
+    int matched;                         // 满足条件的商品数(截取limit之前)
+    int examined;                        // 检查过的记录数
+    char explain[QUERY_EXPLAIN_SIZE];    // 执行计划说明
+} QueryResult;
+
+// 查询函数声明(执行和显示时调用者需持有读锁)
+int parseQuery(const char *text, Query *query, char *error, size_t errorSize); // 解析查询文本，失败返回0并写入错误信息
+int runQuery(GoodsManager *manager, const Query *query, QueryResult *result);  // 编译并执行查询，内存不足返回0
+void freeQueryResult(QueryResult *result);                                     // 释放查询结果
+void displayQueryResult(GoodsManager *manager, const Query *query, const QueryResult *result); // 按输出列显示结果
+int runQueryText(GoodsManager *manager, const char *text);                     // 解析、执行并显示一条查询，成功返回1
+
+#endif
@@ -0,0 +1,245 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "rank.h"
+#include "stats.h"
+#include <stdlib.h>
+
+//排行项：只保存排序键、槽位号和编号指针，入选后才还原为完整商品信息
+typedef struct
+{
+    long long key;  // 排序键值
+    int slot;       // 记录槽位号
+    const char* id; // 商品编号(指向冷数据)，键值相同时用于确定先后
+} RankEntry;
+
+//排序键转换为字符串
+const char* rankKeyToString(RankKey key)
+{
+    switch (key)
+    {
+        case RANK_BY_PRICE: return "Price";
+        case RANK_BY_STOCK: return "Stock";
+        case RANK_BY_VALUE: return "Value";
+        default: return "Unknown";
+    }
+}
+
+//从热数据中取出排序键值
+static long long rankKeyOf(const GoodsHot* hot, RankKey key)
+{
+    switch (key)
+    {
+        case RANK_BY_STOCK: return hot->stock;
+        case RANK_BY_VALUE: return hot->price * (Money)hot->stock;
+        default: return hot->price;
+    }
+}
+
+//比较两个排行项的先后
+//功能：largest为1时键值大的在前，否则键值小的在前；键值相同时按ID升序
+//返回：a应排在b之前返回1，否则返回0
+static int rankBefore(const RankEntry* a, const RankEntry* b, int largest)
+{
+    if (a->key != b->key)
+    {
+        return largest ? a->key > b->key : a->key < b->key;
+    }
+    return strcmp(a->id, b->id) < 0;
+}
+
+//堆下沉
+//功能：维护"堆顶为当前入选项中排名最靠后者"的堆性质
+static void siftDown(RankEntry* heap, int size, int pos, int largest)
+{
+    while (1)
+    {
+        int worst = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        if (left < size && rankBefore(&heap[worst], &heap[left], largest))
+        {
+            worst = left;
+        }
+        if (right < size && rankBefore(&heap[worst], &heap[right], largest))
+        {
+            worst = right;
+        }
+        if (worst == pos)
+        {
+            return;
+        }
+        RankEntry swap = heap[pos];
+        heap[pos] = heap[worst];
+        heap[worst] = swap;
+        pos = worst;
+    }
+}
+
+//堆上浮
+static void siftUp(RankEntry* heap, int pos, int largest)
+{
+    while (pos > 0)
+    {
+        int parent = (pos - 1) / 2;
+        if (!rankBefore(&heap[parent], &heap[pos], largest))
+        {
+            return;
+        }
+        RankEntry swap = heap[pos];
+        heap[pos] = heap[parent];
+        heap[parent] = swap;
+        pos = parent;
+    }
+}
+
+//查询前k名商品
+//功能：按页扫描热数据，用容量为k的堆保留当前排名最靠前的k项，时间复杂度O(n log k)
+//参数：manager - 管理器指针，key - 排序键，k - 名次数，largest - 1取最大的k项/0取最小的k项，
+//      results - 输出数组(至少k个元素)，按名次从前到后排列
+//返回：实际输出的商品数量
+int topGoods(GoodsManager* manager, RankKey key, int k, int largest, Goods* results)
+{
+    if (manager == NULL || results == NULL || k <= 0)
+    {
+        return 0;
+    }
+
+    RankEntry* heap = (RankEntry*)malloc((size_t)k * sizeof(RankEntry));
+    if (heap == NULL)
+    {
+        return 0;
+    }
+
+    STATS_BEGIN(STAT_TOP_N);
+    GoodsStore* store = &manager->store;
+    int size = 0;
+    for (int page = 0; page < store->pageCount; page++)
+    {
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            if (!(hot[i].flags & GOODS_FLAG_USED))
+            {
+                continue;
+            }
+            RankEntry entry;
+            entry.key = rankKeyOf(&hot[i], key);
+            entry.slot = (page << GOODS_PAGE_SHIFT) | i;
+            entry.id = store->pages[page]->cold[i].id;
+
+            if (size < k)
+            {
+                heap[size] = entry;
+                siftUp(heap, size, largest);
+                size++;
+            }
+            else if (rankBefore(&entry, &heap[0], largest))
+            {
+                heap[0] = entry;  //替换排名最靠后的入选项
+                siftDown(heap, size, 0, largest);
+            }
+        }
+        STATS_VISIT_N(GOODS_PAGE_SIZE);
+    }
+
+    //依次取出堆顶，从最后一名倒序写入结果
+    for (int remaining = size; remaining > 0; remaining--)
+    {
+        slotToGoods(manager, heap[0].slot, &results[remaining - 1]);
+        heap[0] = heap[remaining - 1];
+        siftDown(heap, remaining - 1, 0, largest);
+    }
+
+    STATS_END();
+    free(heap);
+    return size;
+}
+
+//区间查询结果比较函数：键值升序，键值相同时按ID升序
+static int compareRangeEntries(const void* a, const void* b)
+{
+    const RankEntry* x = (const RankEntry*)a;
+    const RankEntry* y = (const RankEntry*)b;
+    if (x->key != y->key)
+    {
+        return x->key < y->key ? -1 : 1;
+    }
+    return strcmp(x->id, y->id);
+}
+
+//查询键值位于区间内的商品
+//功能：按页扫描热数据筛选low<=键值<=high的商品，结果按键值升序排列；
+//      例如补货提醒"库存<N"可用rangeGoods(manager, RANK_BY_STOCK, 0, N - 1, &list)
+//参数：manager - 管理器指针，key - 排序键，low,high - 区间上下界(含)，
+//      results - 输出新分配的商品数组，由调用者free
+//返回：命中的商品数量，失败返回-1
+int rangeGoods(GoodsManager* manager, RankKey key, long long low, long long high, Goods** results)
+{
+    if (manager == NULL || results == NULL)
+    {
+        return -1;
+    }
+    *results = NULL;
+
+    STATS_BEGIN(STAT_RANGE);
+    GoodsStore* store = &manager->store;
+    int capacity = 64;
+    int count = 0;
+    RankEntry* entries = (RankEntry*)malloc((size_t)capacity * sizeof(RankEntry));
+    if (entries == NULL)
+    {
+        STATS_END();
+        return -1;
+    }
+
+    //筛选命中的槽位
+    for (int page = 0; page < store->pageCount; page++)
+    {
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            long long value = rankKeyOf(&hot[i], key);
+            if (!(hot[i].flags & GOODS_FLAG_USED) || value < low || value > high)
+            {
+                continue;
+            }
+            if (count == capacity)
+            {
+                capacity *= 2;
+                RankEntry* grown = (RankEntry*)realloc(entries, (size_t)capacity * sizeof(RankEntry));
+                if (grown == NULL)
+                {
+                    free(entries);
+                    STATS_END();
+                    return -1;
+                }
+                entries = grown;
+            }
+            entries[count].key = value;
+            entries[count].slot = (page << GOODS_PAGE_SHIFT) | i;
+            entries[count].id = store->pages[page]->cold[i].id;
+            count++;
+        }
+        STATS_VISIT_N(GOODS_PAGE_SIZE);
+    }
+
+    //只对命中的结果排序
+    qsort(entries, count, sizeof(RankEntry), compareRangeEntries);
+
+    Goods* list = (Goods*)malloc((size_t)(count > 0 ? count : 1) * sizeof(Goods));
+    if (list == NULL)
+    {
+        free(entries);
+        STATS_END();
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        slotToGoods(manager, entries[i].slot, &list[i]);
+    }
+
+    free(entries);
+    *results = list;
+    STATS_END();
+    return count;
+}
@@ -0,0 +1,20 @@
+#ifndef RANK_H
+#define RANK_H
+
+#include "goods.h"
+
+// 排行/区间查询的排序键
+typedef enum
+{
+    RANK_BY_PRICE, // 按单价(分)
+    RANK_BY_STOCK, // 按库存数量
+    RANK_BY_VALUE  // 按库存价值(单价*库存，分)
+} RankKey;
+
+// 排行与区间查询函数声明
+// 两类查询都只扫描热数据，不改变链表顺序
+int topGoods(GoodsManager *manager, RankKey key, int k, int largest, Goods *results);                 // 查询前k名，返回实际条数
+int rangeGoods(GoodsManager *manager, RankKey key, long long low, long long high, Goods **results);   // 查询键值在[low,high]内的商品，返回条数
+const char *rankKeyToString(RankKey key);                                                              // 将排序键转换为字符串
+
+#endif
@@ -0,0 +1,80 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "reorder.h"
+#include <stdlib.h>
+
+//初始化补货集合
+void initReorderSet(ReorderSet* set)
+{
+    set->slots = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
+
+//释放补货集合
+void freeReorderSet(ReorderSet* set)
+{
+    free(set->slots);
+    initReorderSet(set);
+}
+
+//将槽位加入集合
+//返回：成功返回1，内存不足返回0
+static int reorderAdd(ReorderSet* set, GoodsStore* store, int slot)
+{
+    if (set->count == set->capacity)
+    {
+        int newCapacity = set->capacity == 0 ? 64 : set->capacity * 2;
+        int* newSlots = (int*)realloc(set->slots, (size_t)newCapacity * sizeof(int));
+        if (newSlots == NULL)
+        {
+            return 0;
+        }
+        set->slots = newSlots;
+        set->capacity = newCapacity;
+    }
+    STORE_COLD_W(store, slot)->reorderPos = set->count;
+    set->slots[set->count++] = slot;
+    return 1;
+}
+
+//将槽位移出集合
+//功能：用最后一个成员填补空位，O(1)完成删除；槽位不在集合中时不做任何事
+void reorderRemove(ReorderSet* set, GoodsStore* store, int slot)
+{
+    int pos = STORE_COLD(store, slot)->reorderPos;
+    if (pos == GOODS_NIL)
+    {
+        return;
+    }
+
+    int last = set->slots[--set->count];
+    if (last != slot)
+    {
+        set->slots[pos] = last;
+        STORE_COLD_W(store, last)->reorderPos = pos;
+    }
+    STORE_COLD_W(store, slot)->reorderPos = GOODS_NIL;
+}
+
+//更新槽位的成员状态
+//功能：补货点大于0且库存低于补货点时加入集合，否则移出集合；库存或补货点变化后调用
+//返回：更新后槽位在集合中返回1，否则返回0
+int reorderRefresh(ReorderSet* set, GoodsStore* store, int slot)
+{
+    const GoodsCold* cold = STORE_COLD(store, slot);
+    int below = cold->reorderPoint > 0 && STORE_HOT(store, slot)->stock < cold->reorderPoint;
+
+    if (below && cold->reorderPos == GOODS_NIL)
+    {
+        if (!reorderAdd(set, store, slot))
+        {
+            return 0;
+        }
+    }
+    else if (!below && cold->reorderPos != GOODS_NIL)
+    {
+        reorderRemove(set, store, slot);
+    }
+    return below;
+}
@@ -0,0 +1,22 @@
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "store.h"
+
+// 补货集合结构体
+// 记录所有库存低于各自补货点的商品槽位；每个成员在集合中的位置保存在其冷数据的reorderPos中，
+// 因此加入和移出都是O(1)，列出全部成员无需扫描整个商品库
+typedef struct
+{
+    int *slots;   // 成员槽位号数组
+    int count;    // 成员数量
+    int capacity; // 数组容量
+} ReorderSet;
+
+// 补货集合函数声明
+void initReorderSet(ReorderSet *set);                               // 初始化补货集合
+void freeReorderSet(ReorderSet *set);                               // 释放补货集合
+int reorderRefresh(ReorderSet *set, GoodsStore *store, int slot);   // 根据当前库存和补货点更新槽位的成员状态
+void reorderRemove(ReorderSet *set, GoodsStore *store, int slot);   // 将槽位移出集合(删除商品前调用)
+
+#endif
@@ -0,0 +1,921 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#include <windows.h>
+#include "server.h"
+#include "catalog.h"
+#include "snapshot.h"
+#include "persist.h"
+#include <stdlib.h>
+
+#pragma comment(lib, "ws2_32.lib")
+
+#define RECV_CHUNK 16384     // 每次接收的字节数
+#define SEND_TIMEOUT_MS 5000 // 发送超时，防止不读取响应的客户端长期占用工作线程
+#define FRAME_MAX (PROTO_HEADER_SIZE + PROTO_MAX_PAYLOAD) // 单帧最大字节数
+#define CATALOG_PUBLISH_MS 1000 // 有修改时重新发布共享目录的最短间隔
+
+// 客户端连接
+// busy为1时连接已交给工作线程，I/O线程不再读取或关闭它，直到工作线程处理完毕
+typedef struct Connection
+{
+    SOCKET socket;              // 连接套接字
+    unsigned char *in;          // 接收缓冲区
+    size_t inLength;            // 接收缓冲区中的字节数
+    size_t inCapacity;          // 接收缓冲区容量
+    unsigned char *out;         // 响应缓冲区
+    size_t outCapacity;         // 响应缓冲区容量
+    volatile LONG busy;         // 是否正在由工作线程处理
+    volatile LONG broken;       // 发送失败，等待I/O线程关闭
+    struct Connection *nextJob; // 任务队列中的下一个连接
+} Connection;
+
+// 服务运行状态
+typedef struct
+{
+    GoodsManager *manager;          // 商品管理器
+    SOCKET listener;                // 监听套接字
+    SOCKET wakeSocket;              // 唤醒I/O线程用的本地UDP套接字
+    struct sockaddr_in wakeAddress; // 唤醒套接字地址
+    Connection **connections;       // 连接数组
+    int connectionCount;            // 连接数
+    int connectionCapacity;         // 连接数组容量
+    CRITICAL_SECTION queueLock;     // 任务队列锁
+    CONDITION_VARIABLE queueReady;  // 任务队列非空或服务停止
+    Connection *jobHead;            // 任务队列头
+    Connection *jobTail;            // 任务队列尾
+    volatile LONG stopping;         // 是否正在停止
+    volatile LONG modified;         // 是否有修改
+    PersistWriter *persist;         // 后台持久化线程，NULL表示退出时才保存
+    volatile LONG catalogDirty;     // 共享目录发布后是否又有修改
+    CatalogPublisher *catalog;      // 共享目录发布者，NULL表示不发布
+    volatile LONGLONG requests;     // 已处理的请求数
+} GoodsServer;
+
+static GoodsServer* volatile g_server = NULL; //正在运行的服务，供停止信号使用
+
+//记录数据已被修改
+static void markModified(GoodsServer* server)
+{
+    InterlockedExchange(&server->modified, 1);
+    persistChanged(server->persist);
+    InterlockedExchange(&server->catalogDirty, 1);
+}
+
+//唤醒I/O线程
+//功能：向唤醒套接字发送1字节，使阻塞在WSAPoll中的I/O线程返回
+static void wakeServer(GoodsServer* server)
+{
+    char signal = 1;
+    sendto(server->wakeSocket, &signal, 1, 0, (const struct sockaddr*)&server->wakeAddress, sizeof(server->wakeAddress));
+}
+
+//请求停止正在运行的服务
+void stopGoodsServer()
+{
+    GoodsServer* server = g_server;
+    if (server != NULL)
+    {
+        InterlockedExchange(&server->stopping, 1);
+        wakeServer(server);
+    }
+}
+
+//控制台停止信号处理
+static BOOL WINAPI serverCtrlHandler(DWORD type)
+{
+    (void)type;
+    stopGoodsServer();
+    return TRUE;
+}
+
+//构造只有帧头的响应
+static size_t writeStatus(unsigned char* response, const ProtoHeader* request, ProtoStatus status)
+{
+    ProtoHeader header = { 0, request->op, (unsigned char)status, 0, request->requestId };
+    protoEncodeHeader(response, &header);
+    return PROTO_HEADER_SIZE;
+}
+
+// 批量请求条目
+typedef struct
+{
+    char id[20]; // 商品ID
+    int delta;   // 库存增量(仅批量调整)
+    int valid;   // ID长度是否合法
+} BatchItem;
+
+//处理批量请求
+//功能：先在锁外解码全部条目，再只加一次锁依次执行并写出结果；
+//      批量查找持共享锁，批量调整持独占锁，各条目独立成功或失败
+//返回：响应的总字节数
+static size_t handleBatch(GoodsServer* server, const ProtoHeader* request, ProtoBuffer* in, unsigned char* response)
+{
+    GoodsManager* manager = server->manager;
+    int adjust = request->op == PROTO_OP_BATCH_ADJUST;
+    int count = request->count;
+    BatchItem items[PROTO_MAX_BATCH];
+    char text[256];
+
+    if (count == 0 || count > PROTO_MAX_BATCH)
+    {
+        return writeStatus(response, request, PROTO_BAD_REQUEST);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        protoGetString(in, text, sizeof(text));
+        items[i].valid = strlen(text) < sizeof(items[i].id);
+        strncpy_s(items[i].id, sizeof(items[i].id), text, _TRUNCATE);
+        items[i].delta = adjust ? protoGetI32(in) : 0;
+    }
+    if (in->overflow || in->pos != in->size)
+    {
+        return writeStatus(response, request, PROTO_BAD_REQUEST);
+    }
+
+    ProtoBuffer out;
+    Goods goods;
+    int changed = 0;
+    protoBufferInit(&out, response + PROTO_HEADER_SIZE, PROTO_MAX_PAYLOAD);
+    if (adjust)
+    {
+        lockGoodsExclusive(manager);
+    }
+    else
+    {
+        lockGoodsShared(manager);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int found = items[i].valid && findGoodsById(manager, items[i].id, &goods);
+        if (!adjust)
+        {
+            protoPutU8(&out, (unsigned char)(found ? PROTO_OK : PROTO_NOT_FOUND));
+            if (found)
+            {
+                protoPutGoods(&out, &goods);
+            }
+        }
+        else if (!found)
+        {
+            protoPutU8(&out, PROTO_NOT_FOUND);
+            protoPutI32(&out, 0);
+        }
+        else if (adjustStock(manager, items[i].id, items[i].delta))
+        {
+            protoPutU8(&out, PROTO_OK);
+            protoPutI32(&out, goods.stock + items[i].delta);
+            changed = 1;
+        }
+        else
+        {
+            protoPutU8(&out, PROTO_REJECTED);
+            protoPutI32(&out, goods.stock);
+        }
+    }
+    if (adjust)
+    {
+        unlockGoodsExclusive(manager);
+    }
+    else
+    {
+        unlockGoodsShared(manager);
+    }
+
+    if (changed)
+    {
+        markModified(server);
+    }
+    if (out.overflow)
+    {
+        return writeStatus(response, request, PROTO_SERVER_ERROR);
+    }
+    ProtoHeader header = { (unsigned int)out.pos, request->op, PROTO_OK, (unsigned short)count, request->requestId };
+    protoEncodeHeader(response, &header);
+    return PROTO_HEADER_SIZE + out.pos;
+}
+
+//处理一个请求
+//参数：request - 请求帧头，payload - 请求负载，response - 输出缓冲区(至少FRAME_MAX字节)
+//返回：响应的总字节数
+static size_t handleRequest(GoodsServer* server, const ProtoHeader* request,
+                            const unsigned char* payload, unsigned char* response)
+{
+    GoodsManager* manager = server->manager;
+    ProtoBuffer in;
+    ProtoBuffer out;
+    char text[256];
+    Goods goods;
+    int found = 0;
+
+    protoBufferInit(&in, (unsigned char*)payload, request->length);
+    protoBufferInit(&out, response + PROTO_HEADER_SIZE, PROTO_MAX_PAYLOAD);
+    InterlockedIncrement64(&server->requests);
+
+    switch (request->op)
+    {
+        case PROTO_OP_PING:
+            break;
+
+        case PROTO_OP_FIND_BY_ID:
+        case PROTO_OP_FIND_BY_NAME:
+        case PROTO_OP_FIND_BY_BRAND:
+            protoGetString(&in, text, sizeof(text));
+            if (in.overflow || in.pos != in.size)
+            {
+                return writeStatus(response, request, PROTO_BAD_REQUEST);
+            }
+            lockGoodsShared(manager);
+            if (request->op == PROTO_OP_FIND_BY_ID)
+            {
+                found = findGoodsById(manager, text, &goods);
+            }
+            else if (request->op == PROTO_OP_FIND_BY_NAME)
+            {
+                found = findGoodsByName(manager, text, &goods);
+            }
+            else
+            {
+                found = findGoodsByBrand(manager, text, &goods);
+            }
+            unlockGoodsShared(manager);
+            if (!found)
+            {
+                return writeStatus(response, request, PROTO_NOT_FOUND);
+            }
+            protoPutGoods(&out, &goods);
+            break;
+
+        case PROTO_OP_STATS:
+        {
+            //只在创建快照时持读锁，全表扫描期间调整库存无需等待
+            ProtoSummary summary;
+            lockGoodsShared(manager);
+            GoodsSnapshot* snapshot = createGoodsSnapshot(manager);
+            unlockGoodsShared(manager);
+            if (snapshot == NULL)
+            {
+                return writeStatus(response, request, PROTO_SERVER_ERROR);
+            }
+            summary.goodsCount = snapshot->count;
+            summary.reorderCount = snapshot->reorderCount;
+            summary.totalValue = snapshotTotalValue(snapshot);
+            for (int i = 0; i < 4; i++)
+            {
+                summary.categoryCounts[i] = snapshotCountByCategory(snapshot, (GoodsCategory)i);
+            }
+            releaseGoodsSnapshot(snapshot);
+            protoPutSummary(&out, &summary);
+            break;
+        }
+
+        case PROTO_OP_ADJUST_STOCK:
+        {
+            protoGetString(&in, text, sizeof(text));
+            int delta = protoGetI32(&in);
+            if (in.overflow || in.pos != in.size)
+            {
+                return writeStatus(response, request, PROTO_BAD_REQUEST);
+            }
+            ProtoStatus status = PROTO_OK;
+            lockGoodsExclusive(manager);
+            if (!findGoodsById(manager, text, NULL))
+            {
+                status = PROTO_NOT_FOUND;
+            }
+            else if (!adjustStock(manager, text, delta))
+            {
+                status = PROTO_REJECTED;
+            }
+            else
+            {
+                findGoodsById(manager, text, &goods);
+            }
+            unlockGoodsExclusive(manager);
+            if (status != PROTO_OK)
+            {
+                return writeStatus(response, request, status);
+            }
+            markModified(server);
+            protoPutGoods(&out, &goods);
+            break;
+        }
+
+        case PROTO_OP_BATCH_FIND:
+        case PROTO_OP_BATCH_ADJUST:
+            return handleBatch(server, request, &in, response);
+
+        case PROTO_OP_SUGGEST:
+        {
+            Goods results[PROTO_MAX_SUGGEST];
+            int field = protoGetU8(&in);
+            int limit = protoGetU8(&in);
+            protoGetString(&in, text, sizeof(text));
+            if (in.overflow || in.pos != in.size || field > PREFIX_BY_NAME || limit < 1 || limit > PROTO_MAX_SUGGEST)
+            {
+                return writeStatus(response, request, PROTO_BAD_REQUEST);
+            }
+            lockGoodsShared(manager);
+            int count = suggestGoods(manager, (PrefixField)field, text, results, limit);
+            unlockGoodsShared(manager);
+            for (int i = 0; i < count; i++)
+            {
+                protoPutGoods(&out, &results[i]);
+            }
+            if (out.overflow)
+            {
+                return writeStatus(response, request, PROTO_SERVER_ERROR);
+            }
+            ProtoHeader header = { (unsigned int)out.pos, request->op, PROTO_OK, (unsigned short)count, request->requestId };
+            protoEncodeHeader(response, &header);
+            return PROTO_HEADER_SIZE + out.pos;
+        }
+
+        default:
+            return writeStatus(response, request, PROTO_BAD_REQUEST);
+    }
+
+    if (out.overflow)
+    {
+        return writeStatus(response, request, PROTO_SERVER_ERROR);
+    }
+    int hasRecord = request->op != PROTO_OP_PING;
+    ProtoHeader header = { (unsigned int)out.pos, request->op, PROTO_OK, (unsigned short)hasRecord, request->requestId };
+    protoEncodeHeader(response, &header);
+    return PROTO_HEADER_SIZE + out.pos;
+}
+
+//检查接收缓冲区开头是否为完整的请求帧
+//返回：完整帧的字节数，不完整返回0，帧长度非法返回-1
+static long long completeFrameLength(const unsigned char* data, size_t length)
+{
+    if (length < PROTO_HEADER_SIZE)
+    {
+        return 0;
+    }
+    ProtoHeader header;
+    protoDecodeHeader(data, &header);
+    if (header.length > PROTO_MAX_PAYLOAD)
+    {
+        return -1;
+    }
+    size_t total = PROTO_HEADER_SIZE + (size_t)header.length;
+    return length >= total ? (long long)total : 0;
+}
+
+//发送全部数据
+//返回：成功返回1，失败返回0
+static int sendAll(SOCKET socket, const unsigned char* data, size_t length)
+{
+    while (length > 0)
+    {
+        int chunk = length > 65536 ? 65536 : (int)length;
+        int sent = send(socket, (const char*)data, chunk, 0);
+        if (sent <= 0)
+        {
+            return 0;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+    return 1;
+}
+
+//处理连接中所有完整的请求帧
+//功能：按接收顺序依次处理，响应按相同顺序拼接后一次发送，客户端可在同一连接上连续发送多个请求
+//参数：scratch - 工作线程的响应缓冲区(FRAME_MAX字节)
+static void serveConnection(GoodsServer* server, Connection* connection, unsigned char* scratch)
+{
+    size_t consumed = 0;
+    size_t outLength = 0;
+    long long frameLength;
+
+    while ((frameLength = completeFrameLength(connection->in + consumed, connection->inLength - consumed)) > 0)
+    {
+        ProtoHeader request;
+        protoDecodeHeader(connection->in + consumed, &request);
+        size_t responseLength = handleRequest(server, &request, connection->in + consumed + PROTO_HEADER_SIZE, scratch);
+        consumed += (size_t)frameLength;
+
+        if (outLength + responseLength > connection->outCapacity)
+        {
+            size_t newCapacity = connection->outCapacity * 2 + responseLength;
+            unsigned char* grown = (unsigned char*)realloc(connection->out, newCapacity);
+            if (grown == NULL)
+            {
+                InterlockedExchange(&connection->broken, 1);
+                break;
+            }
+            connection->out = grown;
+            connection->outCapacity = newCapacity;
+        }
+        memcpy(connection->out + outLength, scratch, responseLength);
+        outLength += responseLength;
+    }
+
+    //保留未完整接收的帧
+    memmove(connection->in, connection->in + consumed, connection->inLength - consumed);
+    connection->inLength -= consumed;
+
+    if (!connection->broken && !sendAll(connection->socket, connection->out, outLength))
+    {
+        InterlockedExchange(&connection->broken, 1);
+    }
+}
+
+//工作线程
+//功能：从任务队列取出有完整请求的连接并处理，服务停止且队列为空时退出
+static DWORD WINAPI workerMain(LPVOID param)
+{
+    GoodsServer* server = (GoodsServer*)param;
+    unsigned char* scratch = (unsigned char*)malloc(FRAME_MAX);
+    if (scratch == NULL)
+    {
+        return 1;
+    }
+
+    while (1)
+    {
+        EnterCriticalSection(&server->queueLock);
+        while (server->jobHead == NULL && !server->stopping)
+        {
+            SleepConditionVariableCS(&server->queueReady, &server->queueLock, INFINITE);
+        }
+        Connection* connection = server->jobHead;
+        if (connection == NULL)
+        {
+            LeaveCriticalSection(&server->queueLock);
+            break;  //服务停止且队列已空
+        }
+        server->jobHead = connection->nextJob;
+        if (server->jobHead == NULL)
+        {
+            server->jobTail = NULL;
+        }
+        LeaveCriticalSection(&server->queueLock);
+
+        serveConnection(server, connection, scratch);
+        InterlockedExchange(&connection->busy, 0);
+        wakeServer(server);  //让I/O线程重新监听该连接
+    }
+
+    free(scratch);
+    return 0;
+}
+
+//将连接加入任务队列
+static void enqueueConnection(GoodsServer* server, Connection* connection)
+{
+    InterlockedExchange(&connection->busy, 1);
+    connection->nextJob = NULL;
+    EnterCriticalSection(&server->queueLock);
+    if (server->jobTail != NULL)
+    {
+        server->jobTail->nextJob = connection;
+    }
+    else
+    {
+        server->jobHead = connection;
+    }
+    server->jobTail = connection;
+    LeaveCriticalSection(&server->queueLock);
+    WakeConditionVariable(&server->queueReady);
+}
+
+//将连接加入连接数组
+//返回：成功返回1，内存不足返回0
+static int addConnection(GoodsServer* server, Connection* connection)
+{
+    if (server->connectionCount == server->connectionCapacity)
+    {
+        int newCapacity = server->connectionCapacity == 0 ? 16 : server->connectionCapacity * 2;
+        Connection** grown = (Connection**)realloc(server->connections, (size_t)newCapacity * sizeof(Connection*));
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        server->connections = grown;
+        server->connectionCapacity = newCapacity;
+    }
+    server->connections[server->connectionCount++] = connection;
+    return 1;
+}
+
+//接受新连接
+//功能：监听套接字为非阻塞模式，一次接受所有排队的连接
+static void acceptConnections(GoodsServer* server)
+{
+    while (1)
+    {
+        SOCKET socket = accept(server->listener, NULL, NULL);
+        if (socket == INVALID_SOCKET)
+        {
+            return;  //没有更多待接受的连接
+        }
+
+        //接受的套接字会继承非阻塞模式，这里改回阻塞模式供工作线程发送，并设置发送超时
+        u_long blocking = 0;
+        DWORD timeout = SEND_TIMEOUT_MS;
+        ioctlsocket(socket, FIONBIO, &blocking);
+        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+
+        Connection* connection = (Connection*)calloc(1, sizeof(Connection));
+        if (connection == NULL || !addConnection(server, connection))
+        {
+            free(connection);
+            closesocket(socket);
+            continue;
+        }
+        connection->socket = socket;
+    }
+}
+
+//关闭连接并从连接数组中移除
+static void closeConnection(GoodsServer* server, int index)
+{
+    Connection* connection = server->connections[index];
+    closesocket(connection->socket);
+    free(connection->in);
+    free(connection->out);
+    free(connection);
+    server->connections[index] = server->connections[--server->connectionCount];
+}
+
+//读取连接上的数据
+//功能：收到至少一个完整请求帧后把连接交给工作线程
+//返回：连接仍可用返回1，需要关闭返回0
+static int readConnection(GoodsServer* server, Connection* connection)
+{
+    if (connection->inCapacity - connection->inLength < RECV_CHUNK)
+    {
+        size_t newCapacity = connection->inLength + RECV_CHUNK * 2;
+        unsigned char* grown = (unsigned char*)realloc(connection->in, newCapacity);
+        if (grown == NULL)
+        {
+            return 0;
+        }
+        connection->in = grown;
+        connection->inCapacity = newCapacity;
+    }
+
+    int received = recv(connection->socket, (char*)connection->in + connection->inLength, RECV_CHUNK, 0);
+    if (received <= 0)
+    {
+        return 0;  //对方关闭连接或出错
+    }
+    connection->inLength += (size_t)received;
+
+    long long frameLength = completeFrameLength(connection->in, connection->inLength);
+    if (frameLength < 0)
+    {
+        return 0;  //帧长度非法
+    }
+    if (frameLength > 0)
+    {
+        enqueueConnection(server, connection);
+    }
+    return 1;
+}
+
+//创建监听套接字
+//功能：删除残留的套接字文件后绑定并监听，监听套接字设为非阻塞模式
+static SOCKET createListener(const char* path)
+{
+    SOCKADDR_UN address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        printf("Socket path is too long: %s\n", path);
+        return INVALID_SOCKET;
+    }
+    strncpy_s(address.sun_path, sizeof(address.sun_path), path, _TRUNCATE);
+
+    SOCKET listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET)
+    {
+        printf("Failed to create socket (error %d).\n", WSAGetLastError());
+        return INVALID_SOCKET;
+    }
+    DeleteFileA(path);
+    u_long nonBlocking = 1;
+    if (bind(listener, (const struct sockaddr*)&address, sizeof(address)) == SOCKET_ERROR ||
+        listen(listener, SOMAXCONN) == SOCKET_ERROR ||
+        ioctlsocket(listener, FIONBIO, &nonBlocking) == SOCKET_ERROR)
+    {
+        printf("Failed to listen on %s (error %d).\n", path, WSAGetLastError());
+        closesocket(listener);
+        return INVALID_SOCKET;
+    }
+    return listener;
+}
+
+//创建唤醒套接字
+//功能：绑定在127.0.0.1的随机端口上，工作线程和停止信号向它发送数据以唤醒I/O线程
+static SOCKET createWakeSocket(struct sockaddr_in* address)
+{
+    SOCKET wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (wake == INVALID_SOCKET)
+    {
+        return INVALID_SOCKET;
+    }
+    int length = sizeof(*address);
+    u_long nonBlocking = 1;
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address->sin_port = 0;
+    if (bind(wake, (const struct sockaddr*)address, sizeof(*address)) == SOCKET_ERROR ||
+        getsockname(wake, (struct sockaddr*)address, &length) == SOCKET_ERROR ||
+        ioctlsocket(wake, FIONBIO, &nonBlocking) == SOCKET_ERROR)
+    {
+        closesocket(wake);
+        return INVALID_SOCKET;
+    }
+    return wake;
+}
+
+//重新发布共享目录
+//功能：只在创建快照时持读锁，生成映像期间查询和调整库存都照常进行
+static void publishServerCatalog(GoodsServer* server)
+{
+    InterlockedExchange(&server->catalogDirty, 0);
+    lockGoodsShared(server->manager);
+    GoodsSnapshot* snapshot = createGoodsSnapshot(server->manager);
+    unlockGoodsShared(server->manager);
+    int published = publishCatalog(server->catalog, snapshot);
+    releaseGoodsSnapshot(snapshot);
+    if (!published)
+    {
+        InterlockedExchange(&server->catalogDirty, 1);
+    }
+}
+
+//I/O事件循环
+//功能：监听套接字、唤醒套接字和所有空闲连接一起交给WSAPoll；正在由工作线程处理的连接不参与监听。
+//      共享目录有修改时最多每CATALOG_PUBLISH_MS毫秒重新发布一次，连续的修改合并为一次发布
+static void runEventLoop(GoodsServer* server)
+{
+    WSAPOLLFD* fds = NULL;
+    Connection** polled = NULL;
+    int fdCapacity = 0;
+    ULONGLONG lastPublish = GetTickCount64();
+
+    while (!server->stopping)
+    {
+        //关闭发送失败的连接，收集空闲连接
+        if (fdCapacity < server->connectionCount + 2)
+        {
+            int newCapacity = server->connectionCount * 2 + 16;
+            WSAPOLLFD* newFds = (WSAPOLLFD*)realloc(fds, (size_t)newCapacity * sizeof(WSAPOLLFD));
+            if (newFds == NULL)
+            {
+                break;
+            }
+            fds = newFds;
+            Connection** newPolled = (Connection**)realloc(polled, (size_t)newCapacity * sizeof(Connection*));
+            if (newPolled == NULL)
+            {
+                break;
+            }
+            polled = newPolled;
+            fdCapacity = newCapacity;
+        }
+        fds[0].fd = server->listener;
+        fds[1].fd = server->wakeSocket;
+        int count = 2;
+        for (int i = 0; i < server->connectionCount; )
+        {
+            Connection* connection = server->connections[i];
+            if (connection->busy)
+            {
+                i++;
+                continue;
+            }
+            if (connection->broken)
+            {
+                closeConnection(server, i);
+                continue;
+            }
+            fds[count].fd = connection->socket;
+            polled[count] = connection;
+            count++;
+            i++;
+        }
+        for (int i = 0; i < count; i++)
+        {
+            fds[i].events = POLLRDNORM;
+            fds[i].revents = 0;
+        }
+
+        int timeout = -1;
+        if (server->catalog != NULL && server->catalogDirty)
+        {
+            ULONGLONG elapsed = GetTickCount64() - lastPublish;
+            if (elapsed >= CATALOG_PUBLISH_MS)
+            {
+                publishServerCatalog(server);
+                lastPublish = GetTickCount64();
+            }
+            else
+            {
+                timeout = (int)(CATALOG_PUBLISH_MS - elapsed);
+            }
+        }
+
+        if (WSAPoll(fds, (unsigned long)count, timeout) == SOCKET_ERROR)
+        {
+            if (WSAGetLastError() == WSAEINTR)
+            {
+                continue;
+            }
+            printf("WSAPoll failed (error %d).\n", WSAGetLastError());
+            break;
+        }
+
+        //清空唤醒信号
+        if (fds[1].revents)
+        {
+            char drain[64];
+            while (recv(server->wakeSocket, drain, sizeof(drain), 0) > 0)
+            {
+            }
+        }
+
+        //读取连接数据，需要关闭的连接暂时记为broken，下一轮统一关闭
+        for (int i = 2; i < count; i++)
+        {
+            if (fds[i].revents && !readConnection(server, polled[i]))
+            {
+                polled[i]->broken = 1;
+            }
+        }
+
+        if (fds[0].revents)
+        {
+            acceptConnections(server);
+        }
+    }
+
+    free(fds);
+    free(polled);
+}
+
+//运行查询服务
+//功能：启动工作线程池和I/O事件循环，直到Ctrl+C或stopGoodsServer；停止后如有修改则保存数据文件
+//返回：正常停止返回1，启动失败返回0
+int runGoodsServer(GoodsManager* manager, const ServerConfig* config)
+{
+    if (manager == NULL || config == NULL || config->socketPath == NULL)
+    {
+        return 0;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        printf("Failed to initialize Winsock.\n");
+        return 0;
+    }
+
+    GoodsServer server;
+    memset(&server, 0, sizeof(server));
+    server.manager = manager;
+    server.listener = createListener(config->socketPath);
+    server.wakeSocket = createWakeSocket(&server.wakeAddress);
+    if (server.listener == INVALID_SOCKET || server.wakeSocket == INVALID_SOCKET)
+    {
+        if (server.listener != INVALID_SOCKET)
+        {
+            closesocket(server.listener);
+            DeleteFileA(config->socketPath);
+        }
+        if (server.wakeSocket != INVALID_SOCKET)
+        {
+            closesocket(server.wakeSocket);
+        }
+        WSACleanup();
+        return 0;
+    }
+    InitializeCriticalSection(&server.queueLock);
+    InitializeConditionVariable(&server.queueReady);
+
+    //修改由后台线程定期保存，启动失败时退出前再保存
+    if (config->dataFile != NULL)
+    {
+        server.persist = startPersistWriter(manager, config->dataFile, PERSIST_DEFAULT_INTERVAL_MS, PERSIST_DEFAULT_MAX_PENDING);
+        if (server.persist == NULL)
+        {
+            printf("Failed to start background saving, changes will be saved on exit.\n");
+        }
+    }
+
+    //发布共享目录，失败时服务照常运行
+    CatalogPublisher catalog;
+    if (config->catalogName != NULL)
+    {
+        GoodsSnapshot* snapshot = createGoodsSnapshot(manager);
+        int published = initCatalogPublisher(&catalog, config->catalogName) && publishCatalog(&catalog, snapshot);
+        releaseGoodsSnapshot(snapshot);
+        if (published)
+        {
+            server.catalog = &catalog;
+            printf("Published shared catalog %s.\n", config->catalogName);
+        }
+        else
+        {
+            closeCatalogPublisher(&catalog);
+            printf("Failed to publish shared catalog %s.\n", config->catalogName);
+        }
+    }
+
+    //启动工作线程
+    int workerCount = config->workerCount;
+    if (workerCount <= 0)
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        workerCount = (int)info.dwNumberOfProcessors;
+    }
+    HANDLE* workers = (HANDLE*)calloc((size_t)workerCount, sizeof(HANDLE));
+    int started = 0;
+    while (workers != NULL && started < workerCount)
+    {
+        workers[started] = CreateThread(NULL, 0, workerMain, &server, 0, NULL);
+        if (workers[started] == NULL)
+        {
+            break;
+        }
+        started++;
+    }
+
+    if (started > 0)
+    {
+        g_server = &server;
+        SetConsoleCtrlHandler(serverCtrlHandler, TRUE);
+        printf("Serving %d products on %s with %d workers. Press Ctrl+C to stop.\n",
+               manager->count, config->socketPath, started);
+        runEventLoop(&server);
+        SetConsoleCtrlHandler(serverCtrlHandler, FALSE);
+        g_server = NULL;
+    }
+    else
+    {
+        printf("Failed to start worker threads.\n");
+    }
+
+    //等待工作线程处理完队列中的连接后退出
+    EnterCriticalSection(&server.queueLock);
+    server.stopping = 1;
+    LeaveCriticalSection(&server.queueLock);
+    WakeAllConditionVariable(&server.queueReady);
+    for (int i = 0; i < started; i++)
+    {
+        WaitForSingleObject(workers[i], INFINITE);
+        CloseHandle(workers[i]);
+    }
+    free(workers);
+
+    while (server.connectionCount > 0)
+    {
+        closeConnection(&server, server.connectionCount - 1);
+    }
+    free(server.connections);
+    closesocket(server.listener);
+    closesocket(server.wakeSocket);
+    DeleteFileA(config->socketPath);
+    DeleteCriticalSection(&server.queueLock);
+    WSACleanup();
+    if (server.catalog != NULL)
+    {
+        closeCatalogPublisher(server.catalog);
+    }
+
+    printf("Server stopped after %lld requests.\n", (long long)server.requests);
+    if (server.persist != NULL)
+    {
+        //保存剩余修改后结束后台线程
+        if (!stopPersistWriter(server.persist))
+        {
+            printf("Failed to save file!\n");
+        }
+        else if (server.modified)
+        {
+            printf("Changes saved to %s.\n", config->dataFile);
+        }
+    }
+    else if (server.modified && config->dataFile != NULL)
+    {
+        if (saveToFile(manager, config->dataFile))
+        {
+            printf("Changes saved to %s.\n", config->dataFile);
+        }
+        else
+        {
+            printf("Failed to save file!\n");
+        }
+    }
+    return started > 0;
+}
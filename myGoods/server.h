@@ -0,0 +1,22 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "goods.h"
+#include "protocol.h"
+
+// 查询服务配置
+typedef struct
+{
+    const char *socketPath; // Unix域套接字路径
+    int workerCount;        // 工作线程数，0表示与处理器数相同
+    const char *dataFile;   // 退出时保存修改的数据文件，NULL表示不保存
+    const char *catalogName; // 共享目录名称，NULL表示不发布
+} ServerConfig;
+
+// 查询服务函数声明
+// 服务进程只加载一次商品数据，由一个I/O线程用WSAPoll监听所有连接，
+// 收到完整请求帧后交给工作线程池处理；只读请求持共享锁并发执行，调整库存持独占锁
+int runGoodsServer(GoodsManager *manager, const ServerConfig *config); // 运行服务直到收到停止信号，成功返回1
+void stopGoodsServer();                                                // 请求停止正在运行的服务
+
+#endif
@@ -0,0 +1,571 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "shard.h"
+#include "loadindex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHARD_BENCH_FILE "goods_shard_%d.txt" // 基准测试拆出的分片文件
+#define SHARD_BENCH_LOOKUPS 100000            // 基准测试中路由查找的次数
+
+// 并行加载的状态
+typedef struct
+{
+    ShardSet *set;          // 分片集合
+    double ms;              // 每个计时器刻度的毫秒数
+    volatile long failed;   // 是否有分片初始化失败(内存不足)
+} ShardLoad;
+
+// 统计任务：一个分片中的一段页
+typedef struct
+{
+    int shard;     // 分片序号
+    int firstPage; // 起始页
+    int endPage;   // 结束页(不含)
+} ShardScanTask;
+
+// 并行统计的状态
+typedef struct
+{
+    ShardSet *set;          // 分片集合
+    ShardScanTask *tasks;   // 任务，按分片、页的顺序
+    ShardTotals *partials;  // 各任务的统计
+} ShardScan;
+
+//当前计时器刻度
+static long long shardNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//初始化为空集合
+void initShardSet(ShardSet* set)
+{
+    set->shards = NULL;
+    set->count = 0;
+    set->capacity = 0;
+}
+
+//释放全部分片及其管理器
+void freeShardSet(ShardSet* set)
+{
+    for (int i = 0; i < set->count; i++)
+    {
+        freeGoodsManager(set->shards[i].manager);
+    }
+    free(set->shards);
+    initShardSet(set);
+}
+
+//登记分片
+//功能：只记录门店名和数据文件，由loadShards创建管理器并加载
+//返回：分片序号，门店名为空、过长或重复、路径过长、分片数已满或内存不足返回-1
+int addShard(ShardSet* set, const char* name, const char* filename)
+{
+    if (name[0] == '\0' || strlen(name) >= SHARD_NAME_SIZE || strlen(filename) >= SHARD_PATH_SIZE
+        || findShard(set, name) >= 0 || set->count >= SHARD_MAX)
+    {
+        return -1;
+    }
+    if (set->count == set->capacity)
+    {
+        int newCapacity = set->capacity == 0 ? 8 : set->capacity * 2;
+        GoodsShard* shards = (GoodsShard*)realloc(set->shards, (size_t)newCapacity * sizeof(GoodsShard));
+        if (shards == NULL)
+        {
+            return -1;
+        }
+        set->shards = shards;
+        set->capacity = newCapacity;
+    }
+    GoodsShard* shard = &set->shards[set->count];
+    strcpy_s(shard->name, sizeof(shard->name), name);
+    strcpy_s(shard->filename, sizeof(shard->filename), filename);
+    shard->manager = NULL;
+    shard->loaded = 0;
+    shard->loadMs = 0;
+    return set->count++;
+}
+
+//读取门店列表
+//功能：每行"门店名 数据文件"，空行和以#开头的行跳过；任何一行无效时不登记该文件中的任何分片
+//返回：登记的分片数，文件无法打开或有无效行返回-1
+int loadShardList(ShardSet* set, const char* filename)
+{
+    FILE* file = NULL;
+    errno_t err = fopen_s(&file, filename, "r");
+    if (err != 0 || file == NULL)
+    {
+        return -1;
+    }
+
+    int first = set->count;
+    int lineNumber = 0;
+    int valid = 1;
+    char line[GOODS_LINE_MAX];
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        char name[SHARD_NAME_SIZE], path[SHARD_PATH_SIZE], extra[2];
+        int fields = sscanf_s(line, "%31s %259s %1s", name, (unsigned)sizeof(name), path, (unsigned)sizeof(path),
+                              extra, (unsigned)sizeof(extra));
+        if (fields <= 0 || name[0] == '#')
+        {
+            continue;  //空行或注释
+        }
+        if (fields != 2)
+        {
+            printf("Warning: Line %d - Expected 'store file' in %s\n", lineNumber, filename);
+            valid = 0;
+        }
+        else if (addShard(set, name, path) < 0)
+        {
+            printf("Warning: Line %d - Store '%s' is a duplicate, too long, or over the limit of %d stores\n",
+                   lineNumber, name, SHARD_MAX);
+            valid = 0;
+        }
+    }
+    fclose(file);
+    if (!valid)
+    {
+        set->count = first;
+        return -1;
+    }
+    return set->count - first;
+}
+
+//任务：创建并加载一个分片，已加载的分片跳过
+static void loadShardTask(void* context, int index)
+{
+    ShardLoad* load = (ShardLoad*)context;
+    GoodsShard* shard = &load->set->shards[index];
+    if (shard->manager != NULL)
+    {
+        return;
+    }
+    long long start = shardNow();
+    shard->manager = initGoodsManager();
+    if (shard->manager == NULL)
+    {
+        InterlockedExchange(&load->failed, 1);
+        return;
+    }
+    shard->loaded = loadFromFile(shard->manager, shard->filename);
+    shard->loadMs = (double)(shardNow() - start) * load->ms;
+}
+
+//并行加载全部分片
+//功能：每个尚未加载的分片一个任务，各自创建管理器并解析自己的数据文件；数据文件不存在时分片为空
+//返回：加载成功的分片数，内存不足返回-1
+int loadShards(ShardSet* set, TaskPool* pool)
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    ShardLoad load = { set, 1000.0 / (double)frequency.QuadPart, 0 };
+    runPoolTasks(pool, loadShardTask, &load, set->count);
+    if (load.failed)
+    {
+        return -1;
+    }
+    int loaded = 0;
+    for (int i = 0; i < set->count; i++)
+    {
+        loaded += set->shards[i].loaded;
+    }
+    return loaded;
+}
+
+//按门店名查找分片
+//返回：分片序号，未找到返回-1
+int findShard(const ShardSet* set, const char* name)
+{
+    for (int i = 0; i < set->count; i++)
+    {
+        if (strcmp(set->shards[i].name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//按门店和编号查找商品
+//功能：门店名确定分片，再在该分片的编号索引中查找，只锁该分片
+//返回：找到返回1，未找到返回0，门店不存在或未加载返回-1
+int findShardGoods(ShardSet* set, const char* store, const char* id, Goods* result)
+{
+    int index = findShard(set, store);
+    if (index < 0 || set->shards[index].manager == NULL)
+    {
+        return -1;
+    }
+    GoodsManager* manager = set->shards[index].manager;
+    lockGoodsShared(manager);
+    int found = findGoodsById(manager, id, result);
+    unlockGoodsShared(manager);
+    return found;
+}
+
+//任务：统计一个分片中的一段页
+//功能：空闲槽位的单价和库存均为0，只有计数需要检查使用标志
+static void scanShardTask(void* context, int index)
+{
+    ShardScan* scan = (ShardScan*)context;
+    const ShardScanTask* task = &scan->tasks[index];
+    const GoodsStore* store = &scan->set->shards[task->shard].manager->store;
+    ShardTotals totals;
+    memset(&totals, 0, sizeof(totals));
+    for (int page = task->firstPage; page < task->endPage; page++)
+    {
+        const GoodsHot* hot = store->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            int used = (hot[i].flags & GOODS_FLAG_USED) != 0;
+            totals.value += hot[i].price * (Money)hot[i].stock;
+            totals.stock += hot[i].stock;
+            totals.categories[hot[i].category & (SHARD_CATEGORY_COUNT - 1)] += used;
+        }
+    }
+    for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+    {
+        totals.goods += totals.categories[c];
+    }
+    scan->partials[index] = totals;
+}
+
+//累加统计
+static void addShardTotals(ShardTotals* sum, const ShardTotals* part)
+{
+    sum->goods += part->goods;
+    sum->stock += part->stock;
+    sum->value += part->value;
+    for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+    {
+        sum->categories[c] += part->categories[c];
+    }
+}
+
+//并行统计各分片和全公司
+//功能：按SHARD_SCAN_PAGES页把各分片切成任务，统计期间对全部分片加共享锁；
+//      各任务的结果按分片、页的顺序汇总，与线程数和任务的执行顺序无关
+//参数：perShard - 输出各分片的统计(至少set->count项)，可为NULL；total - 输出全公司的统计
+//返回：成功返回1，内存不足返回0
+int gatherShardTotals(ShardSet* set, TaskPool* pool, ShardTotals* perShard, ShardTotals* total)
+{
+    memset(total, 0, sizeof(*total));
+    if (perShard != NULL)
+    {
+        memset(perShard, 0, (size_t)set->count * sizeof(ShardTotals));
+    }
+    for (int s = 0; s < set->count; s++)
+    {
+        if (set->shards[s].manager != NULL)
+        {
+            lockGoodsShared(set->shards[s].manager);
+        }
+    }
+
+    //分散：每个分片切成若干段页
+    int taskCount = 0;
+    for (int s = 0; s < set->count; s++)
+    {
+        GoodsManager* manager = set->shards[s].manager;
+        int pages = manager != NULL ? manager->store.pageCount : 0;
+        taskCount += (pages + SHARD_SCAN_PAGES - 1) / SHARD_SCAN_PAGES;
+    }
+    ShardScan scan = { set, NULL, NULL };
+    scan.tasks = (ShardScanTask*)malloc((size_t)(taskCount > 0 ? taskCount : 1) * sizeof(ShardScanTask));
+    scan.partials = (ShardTotals*)malloc((size_t)(taskCount > 0 ? taskCount : 1) * sizeof(ShardTotals));
+    int ok = scan.tasks != NULL && scan.partials != NULL;
+    if (ok)
+    {
+        int t = 0;
+        for (int s = 0; s < set->count; s++)
+        {
+            GoodsManager* manager = set->shards[s].manager;
+            int pages = manager != NULL ? manager->store.pageCount : 0;
+            for (int page = 0; page < pages; page += SHARD_SCAN_PAGES)
+            {
+                scan.tasks[t].shard = s;
+                scan.tasks[t].firstPage = page;
+                scan.tasks[t].endPage = page + SHARD_SCAN_PAGES < pages ? page + SHARD_SCAN_PAGES : pages;
+                t++;
+            }
+        }
+        runPoolTasks(pool, scanShardTask, &scan, taskCount);
+
+        //汇总：按任务顺序，即分片、页的顺序
+        for (int t = 0; t < taskCount; t++)
+        {
+            if (perShard != NULL)
+            {
+                addShardTotals(&perShard[scan.tasks[t].shard], &scan.partials[t]);
+            }
+            addShardTotals(total, &scan.partials[t]);
+        }
+    }
+
+    for (int s = 0; s < set->count; s++)
+    {
+        if (set->shards[s].manager != NULL)
+        {
+            unlockGoodsShared(set->shards[s].manager);
+        }
+    }
+    free(scan.tasks);
+    free(scan.partials);
+    return ok;
+}
+
+//显示一行统计
+static void displayShardTotalsRow(const char* name, const ShardTotals* totals)
+{
+    char valueText[MONEY_TEXT_SIZE];
+    printf("%-20s %10d %12lld %18s", name, totals->goods, totals->stock,
+           formatMoney(totals->value, valueText, sizeof(valueText)));
+    for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+    {
+        printf(" %9d", totals->categories[c]);
+    }
+    printf("\n");
+}
+
+//以表格显示各门店和全公司的统计
+void displayShardTotals(const ShardSet* set, const ShardTotals* perShard, const ShardTotals* total)
+{
+    printf("%-20s %10s %12s %18s", "Store", "Products", "Stock", "Value");
+    for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+    {
+        printf(" %9s", categoryToString((GoodsCategory)c));
+    }
+    printf("\n");
+    for (int s = 0; perShard != NULL && s < set->count; s++)
+    {
+        displayShardTotalsRow(set->shards[s].name, &perShard[s]);
+    }
+    displayShardTotalsRow("(all stores)", total);
+}
+
+//删除基准测试拆出的分片文件
+static void removeBenchShards(int shardCount)
+{
+    char path[SHARD_PATH_SIZE];
+    for (int s = 0; s < shardCount; s++)
+    {
+        snprintf(path, sizeof(path), SHARD_BENCH_FILE, s);
+        remove(path);
+        removeLoadIndex(path);
+    }
+}
+
+//把数据文件按行轮流拆到shardCount个分片文件中
+//功能：校验和行只对整个文件有效，不拷贝到分片中
+//返回：成功返回1，失败返回0
+static int splitBenchShards(const char* filename, int shardCount)
+{
+    FILE* in = NULL;
+    if (fopen_s(&in, filename, "r") != 0 || in == NULL)
+    {
+        return 0;
+    }
+    FILE** out = (FILE**)calloc((size_t)shardCount, sizeof(FILE*));
+    int ok = out != NULL;
+    char path[SHARD_PATH_SIZE];
+    for (int s = 0; ok && s < shardCount; s++)
+    {
+        snprintf(path, sizeof(path), SHARD_BENCH_FILE, s);
+        ok = fopen_s(&out[s], path, "w") == 0 && out[s] != NULL;
+    }
+    char line[GOODS_LINE_MAX];
+    unsigned int crc;
+    for (int n = 0; ok && fgets(line, sizeof(line), in); n++)
+    {
+        ok = parseChecksumLine(line, &crc) != 0 || fputs(line, out[n % shardCount]) >= 0;
+    }
+    for (int s = 0; out != NULL && s < shardCount; s++)
+    {
+        if (out[s] != NULL)
+        {
+            ok &= fclose(out[s]) == 0;
+        }
+    }
+    free(out);
+    fclose(in);
+    return ok;
+}
+
+//登记基准测试的分片并用指定线程池加载
+//返回：加载耗时(计时器刻度)，失败返回-1
+static long long loadBenchShards(ShardSet* set, TaskPool* pool, int shardCount)
+{
+    char name[SHARD_NAME_SIZE], path[SHARD_PATH_SIZE];
+    initShardSet(set);
+    for (int s = 0; s < shardCount; s++)
+    {
+        snprintf(name, sizeof(name), "store%d", s);
+        snprintf(path, sizeof(path), SHARD_BENCH_FILE, s);
+        if (addShard(set, name, path) < 0)
+        {
+            return -1;
+        }
+    }
+    long long start = shardNow();
+    int loaded = loadShards(set, pool);
+    long long ticks = shardNow() - start;
+    return loaded == shardCount ? ticks : -1;
+}
+
+//比较两份统计
+static int sameShardTotals(const ShardTotals* a, const ShardTotals* b)
+{
+    int same = a->goods == b->goods && a->stock == b->stock && a->value == b->value;
+    for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+    {
+        same &= a->categories[c] == b->categories[c];
+    }
+    return same;
+}
+
+//测量分片的加载、路由查找和全公司统计耗时
+//功能：把数据文件按行轮流拆成shardCount个分片文件，分别用单线程和共享线程池加载并统计，
+//      核对全公司统计与整个文件加载到一个管理器中的结果、各分片统计与该分片串行统计的结果；结束后删除分片文件
+//返回：结果一致返回1，否则返回0
+int runShardBenchmark(const char* filename, int shardCount, int rounds)
+{
+    if (shardCount <= 0)
+    {
+        shardCount = 8;
+    }
+    if (shardCount > SHARD_MAX)
+    {
+        shardCount = SHARD_MAX;
+    }
+    if (rounds <= 0)
+    {
+        rounds = 3;
+    }
+
+    //整个文件加载到一个管理器，作为核对的基准
+    GoodsManager* whole = initGoodsManager();
+    if (whole == NULL || !loadFromFile(whole, filename))
+    {
+        printf("Failed to load %s.\n", filename);
+        freeGoodsManager(whole);
+        return 0;
+    }
+    ShardTotals expected;
+    memset(&expected, 0, sizeof(expected));
+    expected.goods = whole->count;
+    expected.value = calculateTotalValue(whole);
+    for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+    {
+        expected.categories[c] = countGoodsByCategory(whole, (GoodsCategory)c);
+    }
+    for (int page = 0; page < whole->store.pageCount; page++)
+    {
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            expected.stock += whole->store.pages[page]->hot[i].stock;
+        }
+    }
+    freeGoodsManager(whole);
+
+    if (!splitBenchShards(filename, shardCount))
+    {
+        printf("Failed to write shard files.\n");
+        removeBenchShards(shardCount);
+        return 0;
+    }
+    TaskPool* serial = createTaskPool(1);
+    TaskPool* pool = getTaskPool();
+    ShardSet serialSet, set;
+    long long serialLoad = serial != NULL && pool != NULL ? loadBenchShards(&serialSet, serial, shardCount) : -1;
+    long long parallelLoad = serialLoad >= 0 ? loadBenchShards(&set, pool, shardCount) : -1;
+    removeBenchShards(shardCount);
+    if (parallelLoad < 0)
+    {
+        printf("Failed to load the shards.\n");
+        if (serialLoad >= 0)
+        {
+            freeShardSet(&serialSet);
+        }
+        destroyTaskPool(serial);
+        return 0;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ms = 1000.0 / (double)frequency.QuadPart;
+    printf("\n=== Shard Benchmark (%d products in %d shards, %d threads, best of %d) ===\n",
+           expected.goods, shardCount, poolThreadCount(pool), rounds);
+    printf("Load:    %.1f ms one shard at a time, %.1f ms in parallel (%.2fx)\n",
+           serialLoad * ms, parallelLoad * ms, (double)serialLoad / (double)(parallelLoad > 0 ? parallelLoad : 1));
+
+    //全公司统计
+    int identical = 1;
+    ShardTotals* perShard = (ShardTotals*)malloc((size_t)shardCount * sizeof(ShardTotals));
+    long long best[2] = { -1, -1 };
+    TaskPool* pools[2] = { serial, pool };
+    for (int r = 0; r < rounds && perShard != NULL; r++)
+    {
+        for (int p = 0; p < 2; p++)
+        {
+            ShardTotals total;
+            long long start = shardNow();
+            identical &= gatherShardTotals(&set, pools[p], perShard, &total);
+            long long ticks = shardNow() - start;
+            best[p] = best[p] < 0 || ticks < best[p] ? ticks : best[p];
+            identical &= sameShardTotals(&total, &expected);
+        }
+    }
+    identical &= perShard != NULL;
+    printf("Company totals and category counts: %.2f ms one thread, %.2f ms scatter-gather (%.2fx)\n",
+           best[0] * ms, best[1] * ms, (double)best[0] / (double)(best[1] > 0 ? best[1] : 1));
+    for (int s = 0; s < shardCount && perShard != NULL; s++)
+    {
+        GoodsManager* manager = set.shards[s].manager;
+        identical &= perShard[s].goods == manager->count && perShard[s].value == calculateTotalValue(manager)
+                  && perShard[s].goods == serialSet.shards[s].manager->count;
+        for (int c = 0; c < SHARD_CATEGORY_COUNT; c++)
+        {
+            identical &= perShard[s].categories[c] == countGoodsByCategory(manager, (GoodsCategory)c);
+        }
+    }
+
+    //路由查找：编号取自各分片的前缀索引
+    int* slots = (int*)malloc((size_t)(expected.goods > 0 ? expected.goods : 1) * sizeof(int));
+    if (slots != NULL && expected.goods > 0)
+    {
+        unsigned int seed = 2024;
+        int found = 0;
+        long long start = shardNow();
+        for (int s = 0; s < shardCount; s++)
+        {
+            GoodsManager* manager = set.shards[s].manager;
+            int count = prefixSearch(&manager->idPrefix, "", slots, manager->count);
+            for (int i = 0; i < SHARD_BENCH_LOOKUPS / shardCount && count > 0; i++)
+            {
+                seed = seed * 1103515245u + 12345u;
+                const char* id = STORE_COLD(&manager->store, slots[(seed >> 8) % (unsigned int)count])->id;
+                Goods goods;
+                found += findShardGoods(&set, set.shards[s].name, id, &goods) == 1 && strcmp(goods.id, id) == 0;
+            }
+        }
+        long long ticks = shardNow() - start;
+        int lookups = SHARD_BENCH_LOOKUPS / shardCount * shardCount;
+        printf("Routed lookups (store + ID): %.0f ns each, %d of %d found\n",
+               (double)ticks * ms * 1e6 / (lookups > 0 ? lookups : 1), found, lookups);
+        identical &= found == lookups;
+    }
+    free(slots);
+    free(perShard);
+    freeShardSet(&serialSet);
+    freeShardSet(&set);
+    destroyTaskPool(serial);
+    printf(identical ? "Shard totals match the single catalog.\n" : "MISMATCH: shard totals differ from the single catalog!\n");
+    return identical;
+}
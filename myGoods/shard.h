@@ -0,0 +1,59 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "goods.h"
+#include "pool.h"
+
+// 多门店分片
+// 每个门店或仓库是一个分片，有自己的数据文件和独立的管理器(记录、索引和读写锁)，同一编号可以出现在多个门店。
+// 门店列表文件每行"门店名 数据文件"，空行和以#开头的行跳过。
+// 加载时每个分片一个任务，在线程池中并行解析各自的文件；查找按(门店,编号)路由到一个分片的编号索引。
+// 全公司统计把每个分片的页按SHARD_SCAN_PAGES页切成任务分散到线程池(大分片切成多块，由工作窃取平衡负载)，
+// 各块扫描一遍热数据得到商品数、库存、价值和各类别商品数，再按分片、块的顺序汇总，全部使用整数运算，结果与逐个分片串行统计相同。
+#define SHARD_LIST_FILE "stores.txt" // 默认门店列表文件路径
+#define SHARD_MAX 256                // 最多分片数
+#define SHARD_NAME_SIZE 32           // 门店名缓冲区大小
+#define SHARD_PATH_SIZE 260          // 数据文件路径缓冲区大小
+#define SHARD_SCAN_PAGES 16          // 统计时每个任务扫描的页数
+#define SHARD_CATEGORY_COUNT 4       // 商品类别数
+
+// 分片
+typedef struct
+{
+    char name[SHARD_NAME_SIZE];     // 门店名
+    char filename[SHARD_PATH_SIZE]; // 数据文件
+    GoodsManager *manager;          // 分片的管理器，加载前为NULL
+    int loaded;                     // 数据文件是否加载成功(文件不存在时分片为空)
+    double loadMs;                  // 加载耗时(毫秒)
+} GoodsShard;
+
+// 分片集合
+typedef struct
+{
+    GoodsShard *shards; // 分片数组，按登记顺序
+    int count;          // 分片数
+    int capacity;       // 数组容量
+} ShardSet;
+
+// 一个分片或全公司的统计
+typedef struct
+{
+    int goods;                              // 商品数
+    long long stock;                        // 总库存
+    Money value;                            // 总库存价值(分)
+    int categories[SHARD_CATEGORY_COUNT];   // 各类别商品数
+} ShardTotals;
+
+// 分片函数声明(查找和统计时自行对涉及的分片加共享锁)
+void initShardSet(ShardSet *set);                                      // 初始化为空集合
+void freeShardSet(ShardSet *set);                                      // 释放全部分片及其管理器
+int addShard(ShardSet *set, const char *name, const char *filename);   // 登记分片，返回序号，门店名重复或无效返回-1
+int loadShardList(ShardSet *set, const char *filename);                // 读取门店列表并登记分片，返回登记数，文件无效返回-1
+int loadShards(ShardSet *set, TaskPool *pool);                         // 并行加载全部分片，返回加载成功的分片数，内存不足返回-1
+int findShard(const ShardSet *set, const char *name);                  // 按门店名查找分片，未找到返回-1
+int findShardGoods(ShardSet *set, const char *store, const char *id, Goods *result); // 按门店和编号查找，找到返回1，未找到返回0，门店不存在返回-1
+int gatherShardTotals(ShardSet *set, TaskPool *pool, ShardTotals *perShard, ShardTotals *total); // 并行统计各分片和全公司，perShard可为NULL，内存不足返回0
+void displayShardTotals(const ShardSet *set, const ShardTotals *perShard, const ShardTotals *total); // 以表格显示各门店和全公司的统计
+int runShardBenchmark(const char *filename, int shardCount, int rounds); // 把数据文件拆成若干分片，对比串行与并行的加载和统计耗时并核对结果
+
+#endif
@@ -0,0 +1,216 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "snapshot.h"
+#include "stats.h"
+#include "pack.h"
+#include "crc32c.h"
+#include <stdlib.h>
+
+//创建快照
+//功能：复制页指针数组、字符串池块指针和品牌名指针，并为每页增加一个引用；
+//      调用者持有读锁，期间没有写入者，各页引用计数只会被增加或被其他快照并发减少
+//返回：快照指针，内存不足返回NULL
+GoodsSnapshot* createGoodsSnapshot(GoodsManager* manager)
+{
+    if (manager == NULL)
+    {
+        return NULL;
+    }
+
+    GoodsStore* store = &manager->store;
+    GoodsSnapshot* snapshot = (GoodsSnapshot*)calloc(1, sizeof(GoodsSnapshot));
+    if (snapshot == NULL)
+    {
+        return NULL;
+    }
+    snapshot->pages = (GoodsPage**)malloc((size_t)(store->pageCount > 0 ? store->pageCount : 1) * sizeof(GoodsPage*));
+    snapshot->names.chunks = (char**)malloc((size_t)(manager->names.chunkCount > 0 ? manager->names.chunkCount : 1) * sizeof(char*));
+    snapshot->brands = (const char**)malloc((size_t)(manager->brands.count > 0 ? manager->brands.count : 1) * sizeof(const char*));
+    if (snapshot->pages == NULL || snapshot->names.chunks == NULL || snapshot->brands == NULL)
+    {
+        free(snapshot->pages);
+        free(snapshot->names.chunks);
+        free((void*)snapshot->brands);
+        free(snapshot);
+        return NULL;
+    }
+
+    //先登记快照再增加页引用，写入者看到快照计数为0时所有页都未被共享
+    snapshot->storeSnapshots = &store->snapshots;
+    InterlockedIncrement(&store->snapshots);
+    for (int i = 0; i < store->pageCount; i++)
+    {
+        InterlockedIncrement(&store->pages[i]->refs);
+        snapshot->pages[i] = store->pages[i];
+    }
+    snapshot->pageCount = store->pageCount;
+    snapshot->head = store->head;
+    snapshot->count = manager->count;
+    snapshot->reorderCount = manager->reorder.count;
+    snapshot->packed = manager->packed;
+
+    if (manager->names.chunkCount > 0)
+    {
+        memcpy(snapshot->names.chunks, manager->names.chunks, (size_t)manager->names.chunkCount * sizeof(char*));
+    }
+    snapshot->names.chunkCount = manager->names.chunkCount;
+    snapshot->names.chunkCapacity = manager->names.chunkCount;
+    for (int brandId = 0; brandId < manager->brands.count; brandId++)
+    {
+        snapshot->brands[brandId] = brandName(&manager->brands, brandId);
+    }
+    snapshot->brandCount = manager->brands.count;
+    return snapshot;
+}
+
+//释放快照
+//功能：减少各页的引用计数，写入者已复制过的旧页在此释放；最后减少存储的快照计数
+void releaseGoodsSnapshot(GoodsSnapshot* snapshot)
+{
+    if (snapshot == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < snapshot->pageCount; i++)
+    {
+        releaseGoodsPage(snapshot->pages[i]);
+    }
+    InterlockedDecrement(snapshot->storeSnapshots);
+    free(snapshot->pages);
+    free(snapshot->names.chunks);
+    free((void*)snapshot->brands);
+    free(snapshot);
+}
+
+//快照中商品的名称
+const char* snapshotGoodsName(const GoodsSnapshot* snapshot, int slot)
+{
+    return getGoodsName(&SNAPSHOT_COLD(snapshot, slot)->name, &snapshot->names);
+}
+
+//快照中商品的品牌名
+const char* snapshotBrandName(const GoodsSnapshot* snapshot, int slot)
+{
+    int brandId = SNAPSHOT_HOT(snapshot, slot)->brandId;
+    return brandId < snapshot->brandCount ? snapshot->brands[brandId] : "";
+}
+
+//将快照中的槽位还原为完整的商品信息
+void snapshotToGoods(const GoodsSnapshot* snapshot, int slot, Goods* goods)
+{
+    const GoodsHot* hot = SNAPSHOT_HOT(snapshot, slot);
+    strcpy_s(goods->id, sizeof(goods->id), SNAPSHOT_COLD(snapshot, slot)->id);
+    strcpy_s(goods->name, sizeof(goods->name), snapshotGoodsName(snapshot, slot));
+    strcpy_s(goods->brand, sizeof(goods->brand), snapshotBrandName(snapshot, slot));
+    goods->category = (GoodsCategory)hot->category;
+    goods->price = hot->price;
+    goods->stock = hot->stock;
+}
+
+//计算快照的库存总价值
+//功能：与calculateTotalValue相同，按页顺序扫描热数据，空闲槽位的单价和库存均为0
+//返回：库存总价值，单位为分
+Money snapshotTotalValue(const GoodsSnapshot* snapshot)
+{
+    STATS_BEGIN(STAT_TOTAL_VALUE);
+    Money totalValue = 0;
+    for (int page = 0; page < snapshot->pageCount; page++)
+    {
+        const GoodsHot* hot = snapshot->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            totalValue += hot[i].price * (Money)hot[i].stock;
+        }
+        STATS_VISIT_N(GOODS_PAGE_SIZE);
+    }
+    STATS_END();
+    return totalValue;
+}
+
+//统计快照中指定类别的商品数量
+int snapshotCountByCategory(const GoodsSnapshot* snapshot, GoodsCategory category)
+{
+    STATS_BEGIN(STAT_COUNT_BY_CATEGORY);
+    int count = 0;
+    for (int page = 0; page < snapshot->pageCount; page++)
+    {
+        const GoodsHot* hot = snapshot->pages[page]->hot;
+        for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+        {
+            count += hot[i].category == (unsigned char)category;
+        }
+        STATS_VISIT_N(GOODS_PAGE_SIZE);
+    }
+    STATS_END();
+    return count;
+}
+
+//将快照中的一条商品格式化为数据文件的一行
+//功能：列顺序与goods.txt相同，设置了补货点的商品追加第7列，以换行结尾
+//返回：写入的字符数
+int formatSnapshotLine(const GoodsSnapshot* snapshot, int slot, char* buf, size_t size)
+{
+    char price_text[MONEY_TEXT_SIZE];
+    const GoodsHot* hot = SNAPSHOT_HOT(snapshot, slot);
+    const GoodsCold* cold = SNAPSHOT_COLD(snapshot, slot);
+    int written = sprintf_s(buf, size, "%s %s %s %s %s %d",
+            cold->id,
+            snapshotGoodsName(snapshot, slot),
+            categoryToString((GoodsCategory)hot->category),
+            snapshotBrandName(snapshot, slot),
+            formatMoney(hot->price, price_text, sizeof(price_text)),
+            hot->stock);
+    written += cold->reorderPoint > 0 ? sprintf_s(buf + written, size - written, " %d\n", cold->reorderPoint)
+                                      : sprintf_s(buf + written, size - written, "\n");
+    return written;
+}
+
+//将快照保存到文件
+//功能：按链表顺序写出快照中的所有商品，文本格式最后写一行全部行的校验和(见parseChecksumLine)；
+//      快照来自压缩格式的数据文件时按压缩格式写出；全程不持锁
+//返回：成功返回1，失败返回0
+int saveSnapshotToFile(const GoodsSnapshot* snapshot, const char* filename)
+{
+    if (snapshot == NULL)
+    {
+        return 0;
+    }
+
+    STATS_BEGIN(STAT_SAVE);
+    if (snapshot->packed)
+    {
+        int saved = savePackedSnapshot(snapshot, filename);
+        STATS_VISIT_N(snapshot->count);
+        STATS_END();
+        return saved;
+    }
+
+    FILE* file = NULL;
+    errno_t err = fopen_s(&file, filename, "w");
+    if (err != 0 || file == NULL)
+    {
+        STATS_END();
+        return 0;
+    }
+
+    char line[GOODS_LINE_MAX];
+    unsigned int crc = 0;
+    int current = snapshot->head;
+    while (current != GOODS_NIL)
+    {
+        STATS_VISIT();
+        int written = formatSnapshotLine(snapshot, current, line, sizeof(line));
+        crc = crc32c(crc, line, (size_t)written);  //每行以"\n"结尾，与crc32cGoodsLine的结果相同
+        if (fputs(line, file) >= 0)
+        {
+            STATS_WRITTEN(written);
+        }
+        current = SNAPSHOT_HOT(snapshot, current)->next;
+    }
+
+    int ok = fprintf(file, "%s%08x\n", GOODS_CHECKSUM_PREFIX, crc) > 0;
+    ok &= fclose(file) == 0;
+    STATS_END();
+    return ok;
+}
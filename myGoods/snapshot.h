@@ -0,0 +1,40 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "goods.h"
+
+// 时间点快照
+// 创建快照只复制页指针数组并增加各页的引用计数，代价与页数成正比而与记录数无关；
+// 之后写入者修改某页时先复制该页(写时复制)，快照继续看到创建时的内容。
+// 快照可以在不持有任何锁的情况下遍历，报表和保存文件期间写入者无需等待。
+// 长名称和品牌名所在的字符串池只追加不回收，快照只复制其块指针，须在释放管理器之前释放快照。
+typedef struct
+{
+    GoodsPage **pages;   // 快照时的页指针数组
+    int pageCount;       // 页数
+    int head;            // 链表头槽位号
+    int count;           // 商品数
+    int reorderCount;    // 需要补货的商品数
+    int packed;          // 保存时使用压缩格式
+    StringArena names;   // 长名称字符串池(只含块指针数组副本)
+    const char **brands; // 按品牌ID索引的品牌名
+    int brandCount;      // 品牌数
+    volatile long *storeSnapshots; // 所属存储的快照计数，释放快照时减1
+} GoodsSnapshot;
+
+// 按槽位号访问快照中的热/冷数据
+#define SNAPSHOT_HOT(snapshot, slot) (&(snapshot)->pages[(slot) >> GOODS_PAGE_SHIFT]->hot[(slot) & GOODS_PAGE_MASK])
+#define SNAPSHOT_COLD(snapshot, slot) (&(snapshot)->pages[(slot) >> GOODS_PAGE_SHIFT]->cold[(slot) & GOODS_PAGE_MASK])
+
+// 快照函数声明
+GoodsSnapshot *createGoodsSnapshot(GoodsManager *manager);   // 创建快照(调用者需持有读锁)，失败返回NULL
+void releaseGoodsSnapshot(GoodsSnapshot *snapshot);          // 释放快照，无需持锁
+void snapshotToGoods(const GoodsSnapshot *snapshot, int slot, Goods *goods); // 将快照中的槽位还原为商品信息
+const char *snapshotGoodsName(const GoodsSnapshot *snapshot, int slot);      // 快照中商品的名称
+const char *snapshotBrandName(const GoodsSnapshot *snapshot, int slot);      // 快照中商品的品牌名
+Money snapshotTotalValue(const GoodsSnapshot *snapshot);                     // 快照的库存总价值(分)
+int snapshotCountByCategory(const GoodsSnapshot *snapshot, GoodsCategory category); // 快照中指定类别的商品数
+int formatSnapshotLine(const GoodsSnapshot *snapshot, int slot, char *buf, size_t size); // 将一条商品格式化为数据文件的一行，返回字符数
+int saveSnapshotToFile(const GoodsSnapshot *snapshot, const char *filename); // 将快照保存到文件，成功返回1
+
+#endif
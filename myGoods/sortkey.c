@@ -0,0 +1,592 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "sortkey.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 各排序字段的名称和规范化编码的字节数
+static const char* const g_sortFieldNames[SORT_FIELD_COUNT] = { "category", "brand", "name", "price", "stock", "value" };
+static const int g_sortFieldBytes[SORT_FIELD_COUNT] = { 1, 2, 4, 8, 4, 8 };
+
+// 排序项编码的状态
+// 每个排序项为4字节槽位号+规范化排序键，长度补齐到4的倍数
+typedef struct
+{
+    const GoodsStore *store;    // 记录存储
+    const SortKey *keys;        // 排序字段
+    int keyCount;               // 排序字段数
+    int width;                  // 规范化排序键的字节数
+    int stride;                 // 排序项的字节数
+    unsigned short *brandRanks; // 按品牌ID索引的品牌名名次
+    int *nameRanks;             // 按槽位号索引的名称名次
+} SortLayout;
+
+// 品牌名次计算项
+typedef struct
+{
+    const char *name; // 品牌名
+    int id;           // 品牌ID
+} BrandRankEntry;
+
+//比较函数：按品牌名排序(供qsort使用)
+static int compareBrandRankEntries(const void* a, const void* b)
+{
+    return strcmp(((const BrandRankEntry*)a)->name, ((const BrandRankEntry*)b)->name);
+}
+
+//计算品牌名次
+//功能：品牌字典中的品牌按名称排序，ranks[品牌ID]为名次；品牌数不超过65535，名次用2字节表示
+//返回：成功返回1，内存不足返回0
+static int rankBrands(const BrandDict* brands, unsigned short* ranks)
+{
+    BrandRankEntry* entries = (BrandRankEntry*)malloc((size_t)(brands->count > 0 ? brands->count : 1) * sizeof(BrandRankEntry));
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i < brands->count; i++)
+    {
+        entries[i].name = brandName(brands, i);
+        entries[i].id = i;
+    }
+    qsort(entries, (size_t)brands->count, sizeof(BrandRankEntry), compareBrandRankEntries);
+    for (int i = 0; i < brands->count; i++)
+    {
+        ranks[entries[i].id] = (unsigned short)i;
+    }
+    free(entries);
+    return 1;
+}
+
+//按大端序写入整数
+//参数：invert - 非0时按位取反(降序字段)
+static void putSortBytes(unsigned char* out, unsigned long long value, int bytes, int invert)
+{
+    unsigned char mask = invert ? 0xFF : 0x00;
+    for (int i = bytes - 1; i >= 0; i--)
+    {
+        out[i] = (unsigned char)value ^ mask;
+        value >>= 8;
+    }
+}
+
+//生成一件商品的排序项
+//功能：写入槽位号，再依次写入各字段的规范化编码；有符号整数翻转符号位，使无符号字节序与数值大小一致
+static void encodeSortEntry(const SortLayout* layout, int slot, unsigned char* entry)
+{
+    const GoodsHot* hot = STORE_HOT(layout->store, slot);
+    unsigned char* out = entry + sizeof(int);
+    memcpy(entry, &slot, sizeof(int));
+    for (int k = 0; k < layout->keyCount; k++)
+    {
+        SortField field = layout->keys[k].field;
+        unsigned long long value = 0;
+        switch (field)
+        {
+        case SORT_BY_CATEGORY:
+            value = hot->category;
+            break;
+        case SORT_BY_BRAND:
+            value = layout->brandRanks[hot->brandId];
+            break;
+        case SORT_BY_NAME:
+            value = (unsigned int)layout->nameRanks[slot];
+            break;
+        case SORT_BY_PRICE:
+            value = (unsigned long long)hot->price ^ 0x8000000000000000ull;
+            break;
+        case SORT_BY_STOCK:
+            value = (unsigned int)hot->stock ^ 0x80000000u;
+            break;
+        default:
+            value = (unsigned long long)(hot->price * (Money)hot->stock) ^ 0x8000000000000000ull;
+            break;
+        }
+        putSortBytes(out, value, g_sortFieldBytes[field], layout->keys[k].descending);
+        out += g_sortFieldBytes[field];
+    }
+    memset(out, 0, (size_t)(layout->stride - sizeof(int) - layout->width));
+}
+
+//LSD基数排序
+//功能：先一次扫描统计每个字节位置上各取值的个数，再从最后一个字节到第一个字节逐轮按字节稳定分配；
+//      所有排序项在某个字节上都相同时跳过该轮。结果保留在entries中
+//返回：执行的轮数，内存不足返回-1
+static int radixSortEntries(unsigned char* entries, unsigned char* buffer, int count, int width, int stride)
+{
+    unsigned int (*counts)[256] = (unsigned int (*)[256])calloc((size_t)(width > 0 ? width : 1), sizeof(*counts));
+    if (counts == NULL)
+    {
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        const unsigned char* key = entries + (size_t)i * stride + sizeof(int);
+        for (int b = 0; b < width; b++)
+        {
+            counts[b][key[b]]++;
+        }
+    }
+
+    int passes = 0;
+    unsigned char* src = entries;
+    unsigned char* dst = buffer;
+    for (int b = width - 1; b >= 0; b--)
+    {
+        if (counts[b][src[sizeof(int) + b]] == (unsigned int)count)
+        {
+            continue;
+        }
+        //各取值在输出中的起点
+        size_t offsets[256];
+        size_t offset = 0;
+        for (int v = 0; v < 256; v++)
+        {
+            offsets[v] = offset;
+            offset += counts[b][v];
+        }
+        for (int i = 0; i < count; i++)
+        {
+            const unsigned char* entry = src + (size_t)i * stride;
+            memcpy(dst + offsets[entry[sizeof(int) + b]]++ * stride, entry, (size_t)stride);
+        }
+        unsigned char* swap = src;
+        src = dst;
+        dst = swap;
+        passes++;
+    }
+    if (src != entries)
+    {
+        memcpy(entries, src, (size_t)count * stride);
+    }
+    free(counts);
+    return passes;
+}
+
+//归并排序
+//功能：自底向上归并，排序键用memcmp比较，相等时保持原顺序(稳定)；结果保留在entries中
+static void mergeSortEntries(unsigned char* entries, unsigned char* buffer, int count, int width, int stride)
+{
+    unsigned char* src = entries;
+    unsigned char* dst = buffer;
+    for (int run = 1; run < count; run *= 2)
+    {
+        for (int start = 0; start < count; start += 2 * run)
+        {
+            int i = start;
+            int mid = start + run < count ? start + run : count;
+            int j = mid;
+            int end = start + 2 * run < count ? start + 2 * run : count;
+            unsigned char* out = dst + (size_t)start * stride;
+            while (i < mid && j < end)
+            {
+                const unsigned char* a = src + (size_t)i * stride;
+                const unsigned char* b = src + (size_t)j * stride;
+                if (memcmp(a + sizeof(int), b + sizeof(int), (size_t)width) <= 0)
+                {
+                    memcpy(out, a, (size_t)stride);
+                    i++;
+                }
+                else
+                {
+                    memcpy(out, b, (size_t)stride);
+                    j++;
+                }
+                out += stride;
+            }
+            memcpy(out, src + (size_t)i * stride, (size_t)(mid - i) * stride);
+            out += (size_t)(mid - i) * stride;
+            memcpy(out, src + (size_t)j * stride, (size_t)(end - j) * stride);
+        }
+        unsigned char* swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != entries)
+    {
+        memcpy(entries, src, (size_t)count * stride);
+    }
+}
+
+// 名称名次计算项(排序的槽位较少时使用)
+typedef struct
+{
+    const char *name; // 商品名称
+    int slot;         // 槽位号
+} NameRankEntry;
+
+//比较函数：按名称排序(供qsort使用)
+static int compareNameRankEntries(const void* a, const void* b)
+{
+    return strcmp(((const NameRankEntry*)a)->name, ((const NameRankEntry*)b)->name);
+}
+
+//计算名称名次
+//功能：要排序的槽位占全部商品的比例较大时遍历名称前缀索引(按字典序，代价与商品总数成正比)；
+//      较少时只对这些槽位的名称排序。两种方法得到的名次大小关系相同，相同的名称名次相同
+//返回：成功返回1，内存不足返回0
+static int rankNames(GoodsManager* manager, const int* slots, int count, int* ranks)
+{
+    if ((long long)count * 16 >= manager->count)
+    {
+        prefixRanks(&manager->namePrefix, ranks);
+        return 1;
+    }
+    NameRankEntry* entries = (NameRankEntry*)malloc((size_t)count * sizeof(NameRankEntry));
+    if (entries == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        entries[i].name = getGoodsName(&STORE_COLD(&manager->store, slots[i])->name, &manager->names);
+        entries[i].slot = slots[i];
+    }
+    qsort(entries, (size_t)count, sizeof(NameRankEntry), compareNameRankEntries);
+    int rank = 0;
+    for (int i = 0; i < count; i++)
+    {
+        rank += i > 0 && strcmp(entries[i - 1].name, entries[i].name) != 0;
+        ranks[entries[i].slot] = rank;
+    }
+    free(entries);
+    return 1;
+}
+
+//按排序字段排列给定的槽位
+//功能：为每个槽位生成规范化排序项，稳定排序后把槽位号依次写回slots，所有字段都相同时保持原顺序
+//参数：keys - 排序字段，keyCount - 字段数，slots - 要排序的槽位，count - 槽位数，
+//      passes - 输出基数排序执行的轮数，使用归并排序时为-1(可为NULL)
+//返回：成功返回1，内存不足返回0(slots保持不变)
+int sortSlotList(GoodsManager* manager, const SortKey* keys, int keyCount, int* slots, int count, int* passes)
+{
+    if (passes != NULL)
+    {
+        *passes = -1;
+    }
+    if (count <= 1 || keyCount <= 0)
+    {
+        return 1;
+    }
+
+    SortLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.store = &manager->store;
+    layout.keys = keys;
+    layout.keyCount = keyCount;
+    int needBrands = 0;
+    int needNames = 0;
+    for (int k = 0; k < keyCount; k++)
+    {
+        layout.width += g_sortFieldBytes[keys[k].field];
+        needBrands |= keys[k].field == SORT_BY_BRAND;
+        needNames |= keys[k].field == SORT_BY_NAME;
+    }
+    layout.stride = (int)sizeof(int) + ((layout.width + 3) & ~3);
+
+    unsigned char* entries = (unsigned char*)malloc((size_t)count * layout.stride);
+    unsigned char* buffer = (unsigned char*)malloc((size_t)count * layout.stride);
+    if (needBrands)
+    {
+        layout.brandRanks = (unsigned short*)malloc((size_t)(manager->brands.count > 0 ? manager->brands.count : 1) * sizeof(unsigned short));
+    }
+    if (needNames)
+    {
+        layout.nameRanks = (int*)malloc((size_t)manager->store.slotLimit * sizeof(int));
+    }
+    int ok = entries != NULL && buffer != NULL && (!needBrands || layout.brandRanks != NULL) && (!needNames || layout.nameRanks != NULL)
+             && (!needBrands || rankBrands(&manager->brands, layout.brandRanks))
+             && (!needNames || rankNames(manager, slots, count, layout.nameRanks));
+    if (ok)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            encodeSortEntry(&layout, slots[i], entries + (size_t)i * layout.stride);
+        }
+        if (count >= SORT_RADIX_MIN)
+        {
+            int radixPasses = radixSortEntries(entries, buffer, count, layout.width, layout.stride);
+            ok = radixPasses >= 0;
+            if (passes != NULL)
+            {
+                *passes = radixPasses;
+            }
+        }
+        else
+        {
+            mergeSortEntries(entries, buffer, count, layout.width, layout.stride);
+        }
+    }
+    if (ok)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            memcpy(&slots[i], entries + (size_t)i * layout.stride, sizeof(int));
+        }
+    }
+    free(entries);
+    free(buffer);
+    free(layout.brandRanks);
+    free(layout.nameRanks);
+    return ok;
+}
+
+//按排序字段排列全部槽位
+//功能：按编号前缀索引取出全部槽位(编号升序)，再稳定排序，因此所有字段都相同时按编号升序
+//参数：slots - 输出槽位(须能容纳manager->count项)，其余同sortSlotList
+//返回：槽位数，内存不足返回-1
+int sortSlotsByKeys(GoodsManager* manager, const SortKey* keys, int keyCount, int* slots, int* passes)
+{
+    if (passes != NULL)
+    {
+        *passes = -1;
+    }
+    int count = manager->count;
+    if (prefixSearch(&manager->idPrefix, "", slots, count) != count)
+    {
+        return -1;
+    }
+    return sortSlotList(manager, keys, keyCount, slots, count, passes) ? count : -1;
+}
+
+//按排序字段重排商品
+//功能：排列槽位后按新顺序重建链表，所有字段都相同时按ID升序
+//参数：keys - 排序字段，keyCount - 字段数
+//返回：成功返回1，内存不足返回0(链表保持不变)
+int sortGoods(GoodsManager* manager, const SortKey* keys, int keyCount)
+{
+    if (manager == NULL || manager->count == 0)
+    {
+        return 1;
+    }
+    STATS_BEGIN(STAT_SORT);
+    GoodsStore* store = &manager->store;
+    int* slots = (int*)malloc((size_t)manager->count * sizeof(int));
+    int ok = slots != NULL && sortSlotsByKeys(manager, keys, keyCount, slots, NULL) == manager->count
+             && reserveGoodsPages(store, store->pageCount);
+    if (ok)
+    {
+        relinkGoodsSlots(store, slots, manager->count);
+    }
+    STATS_VISIT_N(manager->count);
+    free(slots);
+    STATS_END();
+    return ok;
+}
+
+//解析排序说明
+//功能：排序说明为逗号分隔的字段名(category/brand/name/price/stock/value)，字段名前加'-'表示降序，
+//      如"category,-value"；字段名不区分大小写，每个字段最多出现一次
+//参数：keys - 输出排序字段，至少能容纳SORT_MAX_KEYS项
+//返回：字段数，说明无效返回0
+int parseSortKeys(const char* spec, SortKey* keys)
+{
+    int count = 0;
+    const char* p = spec;
+    while (1)
+    {
+        while (*p == ' ')
+        {
+            p++;
+        }
+        int descending = *p == '-';
+        p += descending || *p == '+';
+        const char* start = p;
+        while (*p != '\0' && *p != ',' && *p != ' ')
+        {
+            p++;
+        }
+        size_t length = (size_t)(p - start);
+        int field = 0;
+        while (field < SORT_FIELD_COUNT
+               && !(strlen(g_sortFieldNames[field]) == length && _strnicmp(start, g_sortFieldNames[field], length) == 0))
+        {
+            field++;
+        }
+        if (field == SORT_FIELD_COUNT || count == SORT_MAX_KEYS)
+        {
+            return 0;
+        }
+        for (int k = 0; k < count; k++)
+        {
+            if (keys[k].field == (SortField)field)
+            {
+                return 0;
+            }
+        }
+        keys[count].field = (SortField)field;
+        keys[count].descending = descending;
+        count++;
+        while (*p == ' ')
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            return count;
+        }
+        if (*p != ',')
+        {
+            return 0;
+        }
+        p++;
+    }
+}
+
+//将排序字段格式化为排序说明
+//返回：buf
+char* formatSortKeys(const SortKey* keys, int keyCount, char* buf, size_t size)
+{
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int k = 0; k < keyCount && used < size; k++)
+    {
+        int written = snprintf(buf + used, size - used, "%s%s%s", k > 0 ? "," : "",
+                               keys[k].descending ? "-" : "", g_sortFieldNames[keys[k].field]);
+        if (written < 0)
+        {
+            break;
+        }
+        used += (size_t)written;
+    }
+    return buf;
+}
+
+// 逐字段比较排序的参数(qsort没有上下文参数，基准测试在单线程中使用)
+static GoodsManager* g_compareManager = NULL;
+static const SortKey* g_compareKeys = NULL;
+static int g_compareKeyCount = 0;
+
+//比较函数：逐字段直接比较两个槽位，字符串字段用strcmp，全部相同时按编号
+static int compareSlotsByFields(const void* a, const void* b)
+{
+    GoodsStore* store = &g_compareManager->store;
+    int slotA = *(const int*)a;
+    int slotB = *(const int*)b;
+    const GoodsHot* hotA = STORE_HOT(store, slotA);
+    const GoodsHot* hotB = STORE_HOT(store, slotB);
+    for (int k = 0; k < g_compareKeyCount; k++)
+    {
+        int order = 0;
+        Money valueA = 0, valueB = 0;
+        switch (g_compareKeys[k].field)
+        {
+        case SORT_BY_CATEGORY:
+            valueA = hotA->category;
+            valueB = hotB->category;
+            break;
+        case SORT_BY_BRAND:
+            order = strcmp(brandName(&g_compareManager->brands, hotA->brandId), brandName(&g_compareManager->brands, hotB->brandId));
+            break;
+        case SORT_BY_NAME:
+            order = strcmp(getGoodsName(&STORE_COLD(store, slotA)->name, &g_compareManager->names),
+                           getGoodsName(&STORE_COLD(store, slotB)->name, &g_compareManager->names));
+            break;
+        case SORT_BY_PRICE:
+            valueA = hotA->price;
+            valueB = hotB->price;
+            break;
+        case SORT_BY_STOCK:
+            valueA = hotA->stock;
+            valueB = hotB->stock;
+            break;
+        default:
+            valueA = hotA->price * (Money)hotA->stock;
+            valueB = hotB->price * (Money)hotB->stock;
+            break;
+        }
+        if (order == 0)
+        {
+            order = valueA < valueB ? -1 : valueA > valueB;
+        }
+        if (order != 0)
+        {
+            return g_compareKeys[k].descending ? -order : order;
+        }
+    }
+    return strcmp(STORE_COLD(store, slotA)->id, STORE_COLD(store, slotB)->id);
+}
+
+//计时(计时器刻度)
+static long long sortNow()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//对比规范化键排序与逐字段比较排序
+//功能：对几组常用的排序字段，分别取rounds次中最快的一次：规范化键排序(含生成排序键)，
+//      以及用qsort逐字段比较(字符串用strcmp)；检查两种方法的结果完全相同
+//返回：结果全部一致返回1，否则返回0
+int runSortBenchmark(const char* filename, int rounds)
+{
+    static const char* const specs[] = { "price", "-price", "name", "brand,name", "category,-value", "category,brand,-stock" };
+    if (rounds <= 0)
+    {
+        rounds = 3;
+    }
+    GoodsManager* manager = initGoodsManager();
+    if (manager == NULL || !loadFromFile(manager, filename))
+    {
+        printf("Failed to load %s.\n", filename);
+        freeGoodsManager(manager);
+        return 0;
+    }
+    int count = manager->count;
+    int* slots = (int*)malloc((size_t)(count > 0 ? count : 1) * sizeof(int));
+    int* expected = (int*)malloc((size_t)(count > 0 ? count : 1) * sizeof(int));
+    if (slots == NULL || expected == NULL)
+    {
+        printf("Out of memory.\n");
+        free(slots);
+        free(expected);
+        freeGoodsManager(manager);
+        return 0;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    double ms = 1000.0 / (double)frequency.QuadPart;
+    printf("\n=== Sort Benchmark (%d products, best of %d) ===\n", count, rounds);
+    printf("%-24s %10s %10s %8s %7s\n", "Keys", "Keyed ms", "Compare ms", "Speedup", "Passes");
+
+    int identical = 1;
+    for (size_t s = 0; s < sizeof(specs) / sizeof(specs[0]); s++)
+    {
+        SortKey keys[SORT_MAX_KEYS];
+        int keyCount = parseSortKeys(specs[s], keys);
+        long long bestKeyed = -1, bestCompare = -1;
+        int passes = -1;
+        for (int r = 0; r < rounds; r++)
+        {
+            long long start = sortNow();
+            int sorted = sortSlotsByKeys(manager, keys, keyCount, slots, &passes);
+            long long keyedTicks = sortNow() - start;
+            identical &= sorted == count;
+
+            prefixSearch(&manager->idPrefix, "", expected, count);
+            g_compareManager = manager;
+            g_compareKeys = keys;
+            g_compareKeyCount = keyCount;
+            start = sortNow();
+            qsort(expected, (size_t)count, sizeof(int), compareSlotsByFields);
+            long long compareTicks = sortNow() - start;
+            identical &= memcmp(slots, expected, (size_t)count * sizeof(int)) == 0;
+
+            bestKeyed = bestKeyed < 0 || keyedTicks < bestKeyed ? keyedTicks : bestKeyed;
+            bestCompare = bestCompare < 0 || compareTicks < bestCompare ? compareTicks : bestCompare;
+        }
+        printf("%-24s %10.2f %10.2f %7.2fx %7d\n", specs[s], bestKeyed * ms, bestCompare * ms,
+               (double)bestCompare / (double)(bestKeyed > 0 ? bestKeyed : 1), passes);
+    }
+    free(slots);
+    free(expected);
+    freeGoodsManager(manager);
+    printf(identical ? "Both methods produced the same order for every key set.\n"
+                     : "MISMATCH: keyed sort differs from the field-by-field sort!\n");
+    return identical;
+}
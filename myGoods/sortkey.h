@@ -0,0 +1,46 @@
+#ifndef SORTKEY_H
+#define SORTKEY_H
+
+#include "goods.h"
+
+// 多字段排序
+// 排序前为每件商品生成定长的规范化排序键：各字段按排序顺序依次编码为大端字节串，
+// 有符号整数翻转符号位，降序字段按位取反，因此两件商品的先后只需一次memcmp。
+// 字符串字段不放原文：品牌按品牌名排序后的名次编码(2字节)，名称按名称前缀索引遍历得到的名次编码(4字节)，
+// 相同的字符串名次相同。排序项按编号前缀索引的顺序(编号升序)生成，排序是稳定的，
+// 所有字段都相同时按编号升序，结果唯一。
+// 排序项较多时用LSD基数排序，每轮按一个字节分配，所有排序项在该字节上都相同的轮次直接跳过；
+// 排序项较少时用memcmp比较的归并排序。
+#define SORT_MAX_KEYS 6      // 最多排序字段数(每个字段最多出现一次)
+#define SORT_KEY_BYTES 27    // 规范化排序键的最大字节数(全部字段：1+2+4+8+4+8)
+#define SORT_RADIX_MIN 256   // 排序项达到此数时使用基数排序
+#define SORT_SPEC_SIZE 64    // 排序说明字符串的缓冲区大小
+
+// 排序字段
+typedef enum
+{
+    SORT_BY_CATEGORY, // 类别
+    SORT_BY_BRAND,    // 品牌名
+    SORT_BY_NAME,     // 名称
+    SORT_BY_PRICE,    // 单价
+    SORT_BY_STOCK,    // 库存
+    SORT_BY_VALUE,    // 库存价值(单价*库存)
+    SORT_FIELD_COUNT  // 字段总数
+} SortField;
+
+// 排序字段及方向
+typedef struct
+{
+    SortField field; // 排序字段
+    int descending;  // 是否降序
+} SortKey;
+
+// 排序函数声明(调用者按sortGoodsByPrice的要求加锁)
+int sortGoods(GoodsManager *manager, const SortKey *keys, int keyCount);    // 按排序字段重排商品链表，内存不足返回0且不修改链表
+int sortSlotList(GoodsManager *manager, const SortKey *keys, int keyCount, int *slots, int count, int *passes); // 稳定排列给定的槽位，内存不足返回0
+int sortSlotsByKeys(GoodsManager *manager, const SortKey *keys, int keyCount, int *slots, int *passes); // 按排序字段排列槽位，返回数量，内存不足返回-1
+int parseSortKeys(const char *spec, SortKey *keys);                         // 解析"brand,-price"形式的排序说明，返回字段数，无效返回0
+char *formatSortKeys(const SortKey *keys, int keyCount, char *buf, size_t size); // 将排序字段格式化为排序说明
+int runSortBenchmark(const char *filename, int rounds);                     // 对比规范化键排序与逐字段比较排序的耗时，并检查结果一致
+
+#endif
@@ -0,0 +1,207 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "stats.h"
+#include <string.h>
+#include <windows.h>
+
+//全局统计数据，按操作类型索引
+static OpStats g_opStats[STAT_OP_COUNT];
+
+//读取高精度计时器
+static long long statsNow()
+{
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+}
+
+//将计时器刻度换算为微秒
+static double ticksToMicros(long long ticks)
+{
+    static long long frequency = 0;
+    if (frequency == 0)
+    {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        frequency = freq.QuadPart;
+    }
+    return (double)ticks * 1000000.0 / (double)frequency;
+}
+
+//开始一次操作计时
+//功能：初始化统计作用域并记录开始时刻
+void statsBegin(StatsScope* scope, StatOp op)
+{
+    scope->op = op;
+    scope->visited = 0;
+    scope->bytesParsed = 0;
+    scope->bytesWritten = 0;
+    scope->start = statsNow();
+}
+
+//结束一次操作计时
+//功能：计算耗时并将本次调用的计数累加到全局统计；使用原子操作累加，服务器的多个工作线程可同时调用
+void statsEnd(StatsScope* scope)
+{
+    long long elapsed = statsNow() - scope->start;
+    OpStats* stats = &g_opStats[scope->op];
+
+    InterlockedIncrement64((volatile LONGLONG*)&stats->calls);
+    InterlockedExchangeAdd64((volatile LONGLONG*)&stats->nodesVisited, scope->visited);
+    InterlockedExchangeAdd64((volatile LONGLONG*)&stats->bytesParsed, scope->bytesParsed);
+    InterlockedExchangeAdd64((volatile LONGLONG*)&stats->bytesWritten, scope->bytesWritten);
+    InterlockedExchangeAdd64((volatile LONGLONG*)&stats->totalTicks, elapsed);
+    long long observed = stats->maxTicks;
+    while (elapsed > observed)
+    {
+        long long previous = InterlockedCompareExchange64((volatile LONGLONG*)&stats->maxTicks, elapsed, observed);
+        if (previous == observed)
+        {
+            break;
+        }
+        observed = previous;
+    }
+}
+
+//获取指定操作的统计数据
+const OpStats* getOpStats(StatOp op)
+{
+    if (op < 0 || op >= STAT_OP_COUNT)
+    {
+        return NULL;
+    }
+    return &g_opStats[op];
+}
+
+//操作类型转换为字符串
+const char* statOpToString(StatOp op)
+{
+    switch (op)
+    {
+        case STAT_FIND_BY_ID: return "findById";
+        case STAT_FIND_BY_NAME: return "findByName";
+        case STAT_FIND_BY_BRAND: return "findByBrand";
+        case STAT_COUNT_BY_CATEGORY: return "countByCategory";
+        case STAT_SHOW_BY_CATEGORY: return "showByCategory";
+        case STAT_SORT: return "sort";
+        case STAT_TOTAL_VALUE: return "totalValue";
+        case STAT_ADD: return "add";
+        case STAT_DELETE: return "delete";
+        case STAT_UPDATE: return "update";
+        case STAT_LOAD: return "load";
+        case STAT_SAVE: return "save";
+        case STAT_TOP_N: return "topN";
+        case STAT_RANGE: return "range";
+        case STAT_ADJUST: return "adjustStock";
+        case STAT_SUGGEST: return "suggest";
+        case STAT_FUZZY: return "fuzzy";
+        case STAT_QUERY: return "query";
+        case STAT_GROUP: return "group";
+        case STAT_COMMIT: return "commit";
+        default: return "unknown";
+    }
+}
+
+//清零全部统计数据
+void resetStats()
+{
+    memset(g_opStats, 0, sizeof(g_opStats));
+}
+
+//统计功能是否已编译
+int isStatsEnabled()
+{
+    return GOODS_ENABLE_STATS;
+}
+
+//显示统计数据
+//功能：以表格形式显示各操作的调用次数、访问节点数、字节数和耗时
+void displayStats()
+{
+    if (!isStatsEnabled())
+    {
+        printf("Statistics are disabled at compile time (GOODS_ENABLE_STATS=0).\n");
+        return;
+    }
+
+    //打印表头
+    printf("\n");
+    printf("%-16s  ", "Operation");
+    printf("%10s  ", "Calls");
+    printf("%12s  ", "Nodes");
+    printf("%12s  ", "Parsed(B)");
+    printf("%12s  ", "Written(B)");
+    printf("%12s  ", "Total(us)");
+    printf("%10s  ", "Avg(us)");
+    printf("%10s\n", "Max(us)");
+
+    printf("----------------  ");
+    printf("----------  ");
+    printf("------------  ");
+    printf("------------  ");
+    printf("------------  ");
+    printf("------------  ");
+    printf("----------  ");
+    printf("----------\n");
+
+    //只显示被调用过的操作
+    int shown = 0;
+    for (int i = 0; i < STAT_OP_COUNT; i++)
+    {
+        const OpStats* stats = &g_opStats[i];
+        if (stats->calls == 0)
+        {
+            continue;
+        }
+        double total = ticksToMicros(stats->totalTicks);
+        printf("%-16s  ", statOpToString((StatOp)i));
+        printf("%10lld  ", stats->calls);
+        printf("%12lld  ", stats->nodesVisited);
+        printf("%12lld  ", stats->bytesParsed);
+        printf("%12lld  ", stats->bytesWritten);
+        printf("%12.1f  ", total);
+        printf("%10.2f  ", total / (double)stats->calls);
+        printf("%10.1f\n", ticksToMicros(stats->maxTicks));
+        shown++;
+    }
+
+    if (shown == 0)
+    {
+        printf("No operations recorded yet.\n");
+    }
+}
+
+//导出统计数据为JSON
+//功能：将各操作的统计数据写入JSON文件，耗时单位为微秒
+//返回：成功返回1，失败返回0
+int exportStatsJson(const char* filename)
+{
+    FILE* file = NULL;
+    errno_t err = fopen_s(&file, filename, "w");
+    if (err != 0 || file == NULL)
+    {
+        return 0;
+    }
+
+    fprintf(file, "{\n  \"enabled\": %s,\n  \"operations\": {\n",
+            isStatsEnabled() ? "true" : "false");
+    for (int i = 0; i < STAT_OP_COUNT; i++)
+    {
+        const OpStats* stats = &g_opStats[i];
+        fprintf(file, "    \"%s\": {\"calls\": %lld, \"nodesVisited\": %lld, "
+                      "\"bytesParsed\": %lld, \"bytesWritten\": %lld, "
+                      "\"totalUs\": %.3f, \"maxUs\": %.3f}%s\n",
+                statOpToString((StatOp)i),
+                stats->calls,
+                stats->nodesVisited,
+                stats->bytesParsed,
+                stats->bytesWritten,
+                ticksToMicros(stats->totalTicks),
+                ticksToMicros(stats->maxTicks),
+                i + 1 < STAT_OP_COUNT ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+
+    fclose(file);
+    return 1;
+}
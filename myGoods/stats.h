@@ -0,0 +1,88 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+// 性能统计编译开关
+// 定义为1时在goods.c的热点路径中编译计数与计时代码；
+// 定义为0时所有统计宏展开为空语句，不产生任何运行时开销
+#ifndef GOODS_ENABLE_STATS
+#define GOODS_ENABLE_STATS 1
+#endif
+
+// 被统计的操作类型枚举
+typedef enum
+{
+    STAT_FIND_BY_ID,       // 按ID查找
+    STAT_FIND_BY_NAME,     // 按名称搜索
+    STAT_FIND_BY_BRAND,    // 按品牌搜索
+    STAT_COUNT_BY_CATEGORY,// 按类别统计
+    STAT_SHOW_BY_CATEGORY, // 按类别显示
+    STAT_SORT,             // 排序
+    STAT_TOTAL_VALUE,      // 计算总价值
+    STAT_ADD,              // 添加商品
+    STAT_DELETE,           // 删除商品
+    STAT_UPDATE,           // 更新商品
+    STAT_LOAD,             // 从文件加载
+    STAT_SAVE,             // 保存到文件
+    STAT_TOP_N,            // 前N名查询
+    STAT_RANGE,            // 区间查询
+    STAT_ADJUST,           // 调整库存
+    STAT_SUGGEST,          // 前缀查询
+    STAT_FUZZY,            // 模糊查找
+    STAT_QUERY,            // 查询语言
+    STAT_GROUP,            // 分组统计
+    STAT_COMMIT,           // 提交事务
+    STAT_OP_COUNT          // 操作类型总数
+} StatOp;
+
+// 单项操作的统计数据
+typedef struct
+{
+    long long calls;        // 调用次数
+    long long nodesVisited; // 访问的链表节点数
+    long long bytesParsed;  // 解析的字节数
+    long long bytesWritten; // 写出的字节数
+    long long totalTicks;   // 累计耗时(计时器刻度)
+    long long maxTicks;     // 单次最大耗时(计时器刻度)
+} OpStats;
+
+// 单次调用的统计作用域，由STATS_BEGIN在函数栈上创建
+typedef struct
+{
+    StatOp op;              // 操作类型
+    long long start;        // 开始时刻
+    long long visited;      // 本次访问的节点数
+    long long bytesParsed;  // 本次解析的字节数
+    long long bytesWritten; // 本次写出的字节数
+} StatsScope;
+
+// 统计功能函数声明
+void statsBegin(StatsScope *scope, StatOp op);  // 开始一次操作计时
+void statsEnd(StatsScope *scope);               // 结束计时并累加到全局统计
+const OpStats *getOpStats(StatOp op);           // 获取指定操作的统计数据
+const char *statOpToString(StatOp op);          // 将操作类型转换为字符串
+void resetStats();                              // 清零全部统计数据
+void displayStats();                            // 以表格形式显示统计数据
+int exportStatsJson(const char *filename);      // 将统计数据导出为JSON文件
+int isStatsEnabled();                           // 统计功能是否已编译
+
+// 热点路径统计宏
+// 用法：函数入口处STATS_BEGIN(op)，每个返回点之前STATS_END()
+#if GOODS_ENABLE_STATS
+#define STATS_BEGIN(op)  StatsScope stats_scope_; statsBegin(&stats_scope_, (op))
+#define STATS_VISIT()    (stats_scope_.visited++)
+#define STATS_VISIT_N(n) (stats_scope_.visited += (long long)(n))
+#define STATS_PARSED(n)  (stats_scope_.bytesParsed += (long long)(n))
+#define STATS_WRITTEN(n) (stats_scope_.bytesWritten += (long long)(n))
+#define STATS_END()      statsEnd(&stats_scope_)
+#else
+#define STATS_BEGIN(op)  ((void)0)
+#define STATS_VISIT()    ((void)0)
+#define STATS_VISIT_N(n) ((void)0)
+#define STATS_PARSED(n)  ((void)0)
+#define STATS_WRITTEN(n) ((void)0)
+#define STATS_END()      ((void)0)
+#endif
+
+#endif
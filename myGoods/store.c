@@ -0,0 +1,492 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include <windows.h>
+#include "store.h"
+#include <stdlib.h>
+#include <string.h>
+
+//初始化存储
+//功能：将存储置为空，页和索引在首次添加记录时分配
+void initGoodsStore(GoodsStore* store)
+{
+    store->pages = NULL;
+    store->pageCount = 0;
+    store->pageCapacity = 0;
+    store->slotLimit = 0;
+    store->freeList = GOODS_NIL;
+    store->head = GOODS_NIL;
+    store->tail = GOODS_NIL;
+    store->index = NULL;
+    store->indexSize = 0;
+    store->indexUsed = 0;
+    store->spares = NULL;
+    store->spareCount = 0;
+    store->spareCapacity = 0;
+    store->snapshots = 0;
+}
+
+//释放预留页
+static void freeSpares(GoodsStore* store)
+{
+    for (int i = 0; i < store->spareCount; i++)
+    {
+        free(store->spares[i]);
+    }
+    store->spareCount = 0;
+}
+
+//释放存储
+//功能：仍被快照持有的页只减少引用计数，由最后释放它的快照负责释放
+void freeGoodsStore(GoodsStore* store)
+{
+    for (int i = 0; i < store->pageCount; i++)
+    {
+        releaseGoodsPage(store->pages[i]);
+    }
+    free(store->pages);
+    free(store->index);
+    freeSpares(store);
+    free(store->spares);
+    initGoodsStore(store);
+}
+
+//将槽位置为空闲状态
+//功能：清零数值字段并把类别设为空闲值，使统计循环无需判断槽位是否占用
+static void clearHot(GoodsHot* hot)
+{
+    hot->price = 0;
+    hot->idHash = 0;
+    hot->stock = 0;
+    hot->brandId = 0;
+    hot->category = GOODS_FREE_CATEGORY;
+    hot->flags = 0;
+    hot->next = GOODS_NIL;
+}
+
+//分配新页
+//返回：成功返回1，失败返回0
+static int addPage(GoodsStore* store)
+{
+    if (store->pageCount == store->pageCapacity)
+    {
+        int newCapacity = store->pageCapacity == 0 ? 8 : store->pageCapacity * 2;
+        GoodsPage** newPages = (GoodsPage**)realloc(store->pages, newCapacity * sizeof(GoodsPage*));
+        if (newPages == NULL)
+        {
+            return 0;
+        }
+        store->pages = newPages;
+        store->pageCapacity = newCapacity;
+    }
+
+    GoodsPage* page = (GoodsPage*)malloc(sizeof(GoodsPage));
+    if (page == NULL)
+    {
+        return 0;
+    }
+    page->refs = 1;
+    for (int i = 0; i < GOODS_PAGE_SIZE; i++)
+    {
+        clearHot(&page->hot[i]);
+    }
+    memset(page->cold, 0, sizeof(page->cold));
+    store->pages[store->pageCount++] = page;
+    return 1;
+}
+
+//分配一个空闲槽位
+//功能：优先复用已删除的槽位(所在页被快照共享时先复制)，否则使用末页的下一个槽位，必要时分配新页
+//返回：槽位号，失败返回GOODS_NIL
+int allocGoodsSlot(GoodsStore* store)
+{
+    int slot;
+    if (store->freeList != GOODS_NIL)
+    {
+        slot = store->freeList;
+        if (ownGoodsPage(store, slot) == NULL)
+        {
+            return GOODS_NIL;
+        }
+        store->freeList = STORE_HOT(store, slot)->next;
+    }
+    else
+    {
+        if (store->slotLimit == store->pageCount * GOODS_PAGE_SIZE && !addPage(store))
+        {
+            return GOODS_NIL;
+        }
+        slot = store->slotLimit++;
+    }
+
+    GoodsHot* hot = STORE_HOT_W(store, slot);
+    GoodsCold* cold = STORE_COLD_W(store, slot);
+    hot->flags = GOODS_FLAG_USED;
+    hot->next = GOODS_NIL;
+    cold->prev = GOODS_NIL;
+    cold->reorderPoint = 0;
+    cold->reorderPos = GOODS_NIL;
+    return slot;
+}
+
+//归还槽位
+//功能：清空槽位并放入空闲链表，调用前需先将其从链表和索引中摘除
+void freeGoodsSlot(GoodsStore* store, int slot)
+{
+    GoodsHot* hot = STORE_HOT_W(store, slot);
+    clearHot(hot);
+    memset(STORE_COLD_W(store, slot), 0, sizeof(GoodsCold));
+    hot->next = store->freeList;
+    store->freeList = slot;
+}
+
+//将槽位插入链表头部
+void linkGoodsSlotFront(GoodsStore* store, int slot)
+{
+    STORE_HOT_W(store, slot)->next = store->head;
+    STORE_COLD_W(store, slot)->prev = GOODS_NIL;
+    if (store->head != GOODS_NIL)
+    {
+        STORE_COLD_W(store, store->head)->prev = slot;
+    }
+    else
+    {
+        store->tail = slot;
+    }
+    store->head = slot;
+}
+
+//将槽位插入到prev之后
+//功能：prev为GOODS_NIL时插入链表头部
+void linkGoodsSlotAfter(GoodsStore* store, int slot, int prev)
+{
+    if (prev == GOODS_NIL)
+    {
+        linkGoodsSlotFront(store, slot);
+        return;
+    }
+    int next = STORE_HOT(store, prev)->next;
+    STORE_HOT_W(store, slot)->next = next;
+    STORE_COLD_W(store, slot)->prev = prev;
+    STORE_HOT_W(store, prev)->next = slot;
+    if (next != GOODS_NIL)
+    {
+        STORE_COLD_W(store, next)->prev = slot;
+    }
+    else
+    {
+        store->tail = slot;
+    }
+}
+
+//将槽位从链表中摘除
+//功能：利用双向链接在O(1)时间内摘除节点
+void unlinkGoodsSlot(GoodsStore* store, int slot)
+{
+    int next = STORE_HOT(store, slot)->next;
+    int prev = STORE_COLD(store, slot)->prev;
+
+    if (prev != GOODS_NIL)
+    {
+        STORE_HOT_W(store, prev)->next = next;
+    }
+    else
+    {
+        store->head = next;
+    }
+    if (next != GOODS_NIL)
+    {
+        STORE_COLD_W(store, next)->prev = prev;
+    }
+    else
+    {
+        store->tail = prev;
+    }
+}
+
+//按给定顺序重建链表
+//参数：slots - 新顺序下的槽位号数组，count - 数组长度
+void relinkGoodsSlots(GoodsStore* store, const int* slots, int count)
+{
+    store->head = count > 0 ? slots[0] : GOODS_NIL;
+    store->tail = count > 0 ? slots[count - 1] : GOODS_NIL;
+    for (int i = 0; i < count; i++)
+    {
+        STORE_HOT_W(store, slots[i])->next = i + 1 < count ? slots[i + 1] : GOODS_NIL;
+        STORE_COLD_W(store, slots[i])->prev = i > 0 ? slots[i - 1] : GOODS_NIL;
+    }
+}
+
+//存储占用的总字节数
+size_t goodsStoreBytes(const GoodsStore* store)
+{
+    return (size_t)(store->pageCount + store->spareCount) * sizeof(GoodsPage)
+         + (size_t)store->pageCapacity * sizeof(GoodsPage*)
+         + (size_t)store->indexSize * sizeof(GoodsIndexEntry);
+}
+
+//预留空白页
+//功能：有未释放的快照时，保证至少有count个预留页，使随后的写时复制不会因内存不足而失败；
+//      没有快照时不需要复制，顺便释放以前预留的页
+//返回：成功返回1，失败返回0(此时尚未修改任何记录)
+int reserveGoodsPages(GoodsStore* store, int count)
+{
+    if (store->snapshots == 0)
+    {
+        freeSpares(store);
+        return 1;
+    }
+    if (count > store->spareCapacity)
+    {
+        GoodsPage** newSpares = (GoodsPage**)realloc(store->spares, (size_t)count * sizeof(GoodsPage*));
+        if (newSpares == NULL)
+        {
+            return 0;
+        }
+        store->spares = newSpares;
+        store->spareCapacity = count;
+    }
+    while (store->spareCount < count)
+    {
+        GoodsPage* page = (GoodsPage*)malloc(sizeof(GoodsPage));
+        if (page == NULL)
+        {
+            return 0;
+        }
+        store->spares[store->spareCount++] = page;
+    }
+    return 1;
+}
+
+//取得槽位所在的私有页
+//功能：页只被存储引用时直接返回；被快照共享时复制到预留页(没有预留页时新分配)，存储改用副本，旧页留给快照
+//说明：调用者持有独占锁，此时不会有新快照增加引用计数，只可能有快照并发释放
+//返回：私有页，复制失败返回NULL(共享页保持不变，不能原地写入)
+GoodsPage* ownGoodsPage(GoodsStore* store, int slot)
+{
+    GoodsPage** entry = &store->pages[slot >> GOODS_PAGE_SHIFT];
+    GoodsPage* page = *entry;
+    if (page->refs == 1)
+    {
+        return page;
+    }
+    GoodsPage* copy = store->spareCount > 0 ? store->spares[--store->spareCount]
+                                            : (GoodsPage*)malloc(sizeof(GoodsPage));
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, (const void*)page, sizeof(GoodsPage));
+    copy->refs = 1;
+    *entry = copy;
+    releaseGoodsPage(page);
+    return copy;
+}
+
+//把一组槽位所在的页都变为私有
+//功能：修改记录前调用，之后对这些槽位的写入不会再复制页；GOODS_NIL项跳过。
+//      中途失败时已复制的页保持私有，内容与原页相同，不影响快照和存储
+//返回：成功返回1，内存不足返回0(此时尚未修改任何记录)
+int ownGoodsSlots(GoodsStore* store, const int* slots, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (slots[i] != GOODS_NIL && ownGoodsPage(store, slots[i]) == NULL)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//释放页的一个引用
+void releaseGoodsPage(GoodsPage* page)
+{
+    if (InterlockedDecrement(&page->refs) == 0)
+    {
+        free(page);
+    }
+}
+
+//计算编号哈希值
+//功能：FNV-1a哈希，结果为0时改为1，保证有效记录的哈希值非0
+unsigned int hashGoodsId(const char* id)
+{
+    unsigned int hash = 2166136261u;
+    while (*id)
+    {
+        hash ^= (unsigned char)*id++;
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+//按编号查找槽位
+//功能：先比较索引项中缓存的哈希值，哈希相同时才访问冷数据核对编号
+//参数：probes - 输出探测次数(可为NULL)
+//返回：槽位号，未找到返回GOODS_NIL
+int indexFindGoods(const GoodsStore* store, const char* id, int* probes)
+{
+    int count = 0;
+    int result = GOODS_NIL;
+    if (store->indexSize > 0)
+    {
+        unsigned int hash = hashGoodsId(id);
+        unsigned int mask = (unsigned int)store->indexSize - 1;
+        unsigned int pos = hash & mask;
+        while (store->index[pos].slot != GOODS_NIL)
+        {
+            count++;
+            const GoodsIndexEntry* entry = &store->index[pos];
+            if (entry->hash == hash && strcmp(STORE_COLD(store, entry->slot)->id, id) == 0)
+            {
+                result = entry->slot;
+                break;
+            }
+            pos = (pos + 1) & mask;  //线性探测
+        }
+    }
+    if (probes != NULL)
+    {
+        *probes = count;
+    }
+    return result;
+}
+
+//将索引项放入表中(不检查装载因子)
+static void placeEntry(GoodsIndexEntry* table, int size, unsigned int hash, int slot)
+{
+    unsigned int mask = (unsigned int)size - 1;
+    unsigned int pos = hash & mask;
+    while (table[pos].slot != GOODS_NIL)
+    {
+        pos = (pos + 1) & mask;
+    }
+    table[pos].hash = hash;
+    table[pos].slot = slot;
+}
+
+//扩大索引
+//功能：索引容量翻倍并重新放入所有项，保持装载因子不超过1/2
+static int growIndex(GoodsStore* store)
+{
+    int newSize = store->indexSize == 0 ? 1024 : store->indexSize * 2;
+    GoodsIndexEntry* table = (GoodsIndexEntry*)malloc(newSize * sizeof(GoodsIndexEntry));
+    if (table == NULL)
+    {
+        return 0;
+    }
+    for (int i = 0; i < newSize; i++)
+    {
+        table[i].slot = GOODS_NIL;
+    }
+    for (int i = 0; i < store->indexSize; i++)
+    {
+        if (store->index[i].slot != GOODS_NIL)
+        {
+            placeEntry(table, newSize, store->index[i].hash, store->index[i].slot);
+        }
+    }
+    free(store->index);
+    store->index = table;
+    store->indexSize = newSize;
+    return 1;
+}
+
+//将槽位登记到索引
+//功能：使用槽位热数据中已计算好的编号哈希值
+//返回：成功返回1，失败返回0
+int indexInsertGoods(GoodsStore* store, int slot)
+{
+    if ((store->indexUsed + 1) * 2 > store->indexSize && !growIndex(store))
+    {
+        return 0;
+    }
+    placeEntry(store->index, store->indexSize, STORE_HOT(store, slot)->idHash, slot);
+    store->indexUsed++;
+    return 1;
+}
+
+//从索引中删除槽位
+//功能：删除后将同一探测序列中的后续项向前移动，避免留下删除标记
+void indexRemoveGoods(GoodsStore* store, int slot)
+{
+    if (store->indexSize == 0)
+    {
+        return;
+    }
+    unsigned int mask = (unsigned int)store->indexSize - 1;
+    unsigned int pos = STORE_HOT(store, slot)->idHash & mask;
+    while (store->index[pos].slot != slot)
+    {
+        if (store->index[pos].slot == GOODS_NIL)
+        {
+            return;  //不在索引中
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    //向后移位删除
+    unsigned int hole = pos;
+    unsigned int next = (pos + 1) & mask;
+    while (store->index[next].slot != GOODS_NIL)
+    {
+        unsigned int home = store->index[next].hash & mask;
+        //home不在(hole, next]区间内时，该项可以移入空洞
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            store->index[hole] = store->index[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    store->index[hole].slot = GOODS_NIL;
+    store->indexUsed--;
+}
+
+//设置名称
+//功能：短名称直接存入记录，长名称存入字符串池并在记录中保存引用
+//返回：成功返回1，失败返回0
+int setGoodsName(GoodsName* name, StringArena* arena, const char* text)
+{
+    size_t length = strlen(text);
+    if (length <= GOODS_NAME_INLINE)
+    {
+        memcpy(name->text, text, length + 1);
+    }
+    else
+    {
+        StrRef ref;
+        if (!arenaAdd(arena, text, &ref))
+        {
+            return 0;
+        }
+        memcpy(name->text, &ref, sizeof(ref));
+    }
+    name->length = (unsigned char)length;
+    return 1;
+}
+
+//释放名称占用的字符串池空间
+void releaseGoodsName(GoodsName* name, StringArena* arena)
+{
+    if (name->length > GOODS_NAME_INLINE)
+    {
+        StrRef ref;
+        memcpy(&ref, name->text, sizeof(ref));
+        arenaRelease(arena, ref);
+    }
+    name->length = 0;
+    name->text[0] = '\0';
+}
+
+//获取名称字符串
+const char* getGoodsName(const GoodsName* name, const StringArena* arena)
+{
+    if (name->length <= GOODS_NAME_INLINE)
+    {
+        return name->text;
+    }
+    StrRef ref;
+    memcpy(&ref, name->text, sizeof(ref));
+    return arenaGet(arena, ref);
+}
@@ -0,0 +1,125 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include "dict.h"
+
+// 金额类型
+// 以整数"分"为单位存储金额，避免浮点累加误差；仅在显示时格式化为"元.角分"
+typedef long long Money;
+
+#define GOODS_PAGE_SHIFT 10                     // 每页记录数的位数
+#define GOODS_PAGE_SIZE (1 << GOODS_PAGE_SHIFT) // 每页1024条记录
+#define GOODS_PAGE_MASK (GOODS_PAGE_SIZE - 1)   // 页内下标掩码
+#define GOODS_NIL (-1)                          // 空槽位/链表结束标记
+#define GOODS_FREE_CATEGORY 0xFF                // 空闲槽位的类别值，统计时不会与任何类别相等
+#define GOODS_NAME_INLINE 14                    // 名称不超过该长度时直接存放在记录内
+
+#define GOODS_FLAG_USED 0x01 // 槽位已被占用
+#define GOODS_WRITE_PAGES 4  // 单条记录的增删改最多写入的页数(本槽位、链表前后槽位、补货集合中被移动的槽位)
+
+// 商品名称(小字符串优化)
+// 长度不超过GOODS_NAME_INLINE时直接存放在text中；否则text的前4字节存放字符串池引用
+typedef struct
+{
+    unsigned char length; // 名称长度
+    char text[15];        // 内联名称或字符串池引用
+} GoodsName;
+
+// 热数据记录(24字节)
+// 查找、排序和统计时需要访问的字段，连续存放以提高缓存命中率
+typedef struct
+{
+    Money price;            // 商品单价(分)，空闲槽位为0
+    unsigned int idHash;    // 商品编号的哈希值
+    int stock;              // 库存数量，空闲槽位为0
+    unsigned short brandId; // 品牌字典中的品牌ID
+    unsigned char category; // 商品类别，空闲槽位为GOODS_FREE_CATEGORY
+    unsigned char flags;    // 槽位状态标志
+    int next;               // 链表中下一条记录的槽位号，空闲时指向下一个空闲槽位
+} GoodsHot;
+
+// 冷数据记录
+// 只在显示、保存和核对编号时才访问的字段
+typedef struct
+{
+    char id[20];      // 商品编号
+    GoodsName name;   // 商品名称
+    int prev;         // 链表中上一条记录的槽位号
+    int reorderPoint; // 补货点，库存低于该值时需要补货，0表示不监视
+    int reorderPos;   // 在补货集合中的位置，GOODS_NIL表示不在集合中
+} GoodsCold;
+
+// 记录页
+// 热数据和冷数据分别连续存放。页可以被快照共享：写入共享页前先复制一份私有页再修改(写时复制)，
+// 快照持有的旧页内容保持不变
+typedef struct
+{
+    volatile long refs;              // 引用计数：存储本身计1，每个持有该页的快照再计1
+    GoodsHot hot[GOODS_PAGE_SIZE];   // 热数据数组
+    GoodsCold cold[GOODS_PAGE_SIZE]; // 冷数据数组
+} GoodsPage;
+
+// 编号索引项
+typedef struct
+{
+    unsigned int hash; // 编号哈希值
+    int slot;          // 记录槽位号，GOODS_NIL表示空项
+} GoodsIndexEntry;
+
+// 商品记录存储结构体
+// 记录按槽位号存放在分页数组中，链表顺序由next/prev维护，编号索引为开放寻址哈希表
+typedef struct
+{
+    GoodsPage **pages;        // 页指针数组
+    int pageCount;            // 已分配的页数
+    int pageCapacity;         // 页指针数组容量
+    int slotLimit;            // 已使用过的最大槽位号+1
+    int freeList;             // 空闲槽位链表头
+    int head;                 // 链表头槽位号
+    int tail;                 // 链表尾槽位号
+    GoodsIndexEntry *index;   // 编号哈希索引
+    int indexSize;            // 索引槽数(2的幂)
+    int indexUsed;            // 索引中已使用的项数
+    GoodsPage **spares;       // 预留的空白页，写时复制从中取页，保证复制不会失败
+    int spareCount;           // 预留页数
+    int spareCapacity;        // 预留页数组容量
+    volatile long snapshots;  // 仍未释放的快照数
+} GoodsStore;
+
+// 按槽位号访问热/冷数据(只读)
+#define STORE_HOT(store, slot) (&(store)->pages[(slot) >> GOODS_PAGE_SHIFT]->hot[(slot) & GOODS_PAGE_MASK])
+#define STORE_COLD(store, slot) (&(store)->pages[(slot) >> GOODS_PAGE_SHIFT]->cold[(slot) & GOODS_PAGE_MASK])
+// 按槽位号写入热/冷数据：页被快照共享时先复制。修改前需已用ownGoodsSlots取得私有页，
+// 或用reserveGoodsPages预留足够的页，保证这里的复制不会失败
+#define STORE_HOT_W(store, slot) (&ownGoodsPage((store), (slot))->hot[(slot) & GOODS_PAGE_MASK])
+#define STORE_COLD_W(store, slot) (&ownGoodsPage((store), (slot))->cold[(slot) & GOODS_PAGE_MASK])
+
+// 存储管理函数声明
+void initGoodsStore(GoodsStore *store);                  // 初始化存储
+void freeGoodsStore(GoodsStore *store);                  // 释放存储
+int allocGoodsSlot(GoodsStore *store);                   // 分配一个空闲槽位，失败返回GOODS_NIL
+void freeGoodsSlot(GoodsStore *store, int slot);         // 归还槽位
+void linkGoodsSlotFront(GoodsStore *store, int slot);    // 将槽位插入链表头部
+void linkGoodsSlotAfter(GoodsStore *store, int slot, int prev); // 将槽位插入到prev之后，prev为GOODS_NIL时插入头部
+void unlinkGoodsSlot(GoodsStore *store, int slot);       // 将槽位从链表中摘除
+void relinkGoodsSlots(GoodsStore *store, const int *slots, int count); // 按给定顺序重建链表
+size_t goodsStoreBytes(const GoodsStore *store);         // 存储占用的总字节数
+
+// 写时复制函数声明
+int reserveGoodsPages(GoodsStore *store, int count);     // 有快照时预留count个空白页，失败返回0
+GoodsPage *ownGoodsPage(GoodsStore *store, int slot);    // 返回槽位所在的私有页，页被共享时先复制，复制失败返回NULL
+int ownGoodsSlots(GoodsStore *store, const int *slots, int count); // 修改前把各槽位所在的页变为私有，内存不足返回0
+void releaseGoodsPage(GoodsPage *page);                  // 引用计数减1，减到0时释放页
+
+// 编号索引函数声明
+unsigned int hashGoodsId(const char *id);                                // 计算编号哈希值
+int indexFindGoods(const GoodsStore *store, const char *id, int *probes); // 按编号查找槽位，未找到返回GOODS_NIL
+int indexInsertGoods(GoodsStore *store, int slot);                       // 将槽位登记到索引
+void indexRemoveGoods(GoodsStore *store, int slot);                      // 从索引中删除槽位
+
+// 名称函数声明
+int setGoodsName(GoodsName *name, StringArena *arena, const char *text); // 设置名称，长名称存入字符串池
+void releaseGoodsName(GoodsName *name, StringArena *arena);              // 释放名称占用的字符串池空间
+const char *getGoodsName(const GoodsName *name, const StringArena *arena); // 获取名称字符串
+
+#endif
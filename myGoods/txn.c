@@ -0,0 +1,469 @@
+#pragma warning(disable:4819)  // 禁用代码页警告
+#define _CRT_SECURE_NO_WARNINGS
+#include "txn.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// 提交检查时一件商品的状态(考虑了同一事务中之前的修改)
+typedef struct
+{
+    char id[20];     // 商品编号
+    int exists;      // 商品是否存在
+    long long stock; // 库存
+} TxnState;
+
+// 提交检查用的商品状态表
+typedef struct
+{
+    TxnState *states; // 涉及的商品，按首次出现的顺序
+    int count;        // 商品数
+    int *table;       // 开放寻址哈希表，存放states下标+1，0表示空项
+    int size;         // 表大小(2的幂)
+} TxnOverlay;
+
+// 撤销记录：修改前的内容
+typedef struct
+{
+    Goods before;     // 修改前的商品信息(更新和删除)
+    int reorderPoint; // 修改前的补货点(删除和设置补货点)
+    char prevId[20];  // 删除前链表中前一件商品的ID，空串表示位于链表头部
+} TxnUndo;
+
+//开始事务
+//功能：清空暂存的修改，保留已分配的数组
+void beginTxn(GoodsTxn* txn)
+{
+    txn->count = 0;
+    txn->active = 1;
+}
+
+//放弃暂存的修改并结束事务
+void abortTxn(GoodsTxn* txn)
+{
+    free(txn->ops);
+    txn->ops = NULL;
+    txn->count = 0;
+    txn->capacity = 0;
+    txn->active = 0;
+}
+
+//追加一条暂存的修改
+//返回：成功返回新项指针，内存不足返回NULL
+static TxnOp* pushTxnOp(GoodsTxn* txn, TxnOpType type, const char* id)
+{
+    if (txn->count == txn->capacity)
+    {
+        int newCapacity = txn->capacity == 0 ? TXN_INITIAL_CAPACITY : txn->capacity * 2;
+        TxnOp* ops = (TxnOp*)realloc(txn->ops, (size_t)newCapacity * sizeof(TxnOp));
+        if (ops == NULL)
+        {
+            return NULL;
+        }
+        txn->ops = ops;
+        txn->capacity = newCapacity;
+    }
+    TxnOp* op = &txn->ops[txn->count++];
+    memset(op, 0, sizeof(*op));
+    op->type = type;
+    strncpy_s(op->goods.id, sizeof(op->goods.id), id, _TRUNCATE);
+    return op;
+}
+
+//暂存添加商品
+int txnAdd(GoodsTxn* txn, Goods goods)
+{
+    TxnOp* op = pushTxnOp(txn, TXN_ADD, goods.id);
+    if (op == NULL)
+    {
+        return 0;
+    }
+    op->goods = goods;
+    return 1;
+}
+
+//暂存更新商品信息
+//功能：与updateGoods相同，编号保持不变
+int txnUpdate(GoodsTxn* txn, const char* id, Goods newData)
+{
+    TxnOp* op = pushTxnOp(txn, TXN_UPDATE, id);
+    if (op == NULL)
+    {
+        return 0;
+    }
+    op->goods = newData;
+    strncpy_s(op->goods.id, sizeof(op->goods.id), id, _TRUNCATE);
+    return 1;
+}
+
+//暂存删除商品
+int txnDelete(GoodsTxn* txn, const char* id)
+{
+    return pushTxnOp(txn, TXN_DELETE, id) != NULL;
+}
+
+//暂存调整库存
+int txnAdjustStock(GoodsTxn* txn, const char* id, int delta)
+{
+    TxnOp* op = pushTxnOp(txn, TXN_ADJUST, id);
+    if (op == NULL)
+    {
+        return 0;
+    }
+    op->value = delta;
+    return 1;
+}
+
+//暂存设置补货点
+int txnSetReorderPoint(GoodsTxn* txn, const char* id, int reorderPoint)
+{
+    TxnOp* op = pushTxnOp(txn, TXN_REORDER, id);
+    if (op == NULL)
+    {
+        return 0;
+    }
+    op->value = reorderPoint;
+    return 1;
+}
+
+//查找商品的检查状态
+//功能：商品第一次出现时从管理器读取当前状态
+//返回：状态指针
+static TxnState* overlayState(TxnOverlay* overlay, GoodsManager* manager, const char* id)
+{
+    unsigned int mask = (unsigned int)overlay->size - 1;
+    unsigned int pos = hashGoodsId(id) & mask;
+    while (overlay->table[pos] != 0)
+    {
+        TxnState* state = &overlay->states[overlay->table[pos] - 1];
+        if (strcmp(state->id, id) == 0)
+        {
+            return state;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    TxnState* state = &overlay->states[overlay->count++];
+    overlay->table[pos] = overlay->count;
+    Goods current;
+    strcpy_s(state->id, sizeof(state->id), id);
+    state->exists = findGoodsById(manager, id, &current);
+    state->stock = state->exists ? current.stock : 0;
+    return state;
+}
+
+//修改类型的名称
+static const char* txnOpName(TxnOpType type)
+{
+    switch (type)
+    {
+        case TXN_ADD: return "add";
+        case TXN_UPDATE: return "update";
+        case TXN_DELETE: return "delete";
+        case TXN_ADJUST: return "adjust";
+        default: return "reorder";
+    }
+}
+
+//检查全部暂存的修改
+//功能：按暂存顺序在商品状态表上模拟执行，不修改管理器
+//返回：全部可以应用返回1，否则返回0并写入第一个不能应用的修改及原因
+static int checkTxn(GoodsManager* manager, const GoodsTxn* txn, char* error, size_t errorSize)
+{
+    TxnOverlay overlay;
+    overlay.count = 0;
+    overlay.size = 16;
+    while (overlay.size < txn->count * 2)
+    {
+        overlay.size *= 2;
+    }
+    overlay.states = (TxnState*)malloc((size_t)(txn->count > 0 ? txn->count : 1) * sizeof(TxnState));
+    overlay.table = (int*)calloc((size_t)overlay.size, sizeof(int));
+    if (overlay.states == NULL || overlay.table == NULL)
+    {
+        free(overlay.states);
+        free(overlay.table);
+        snprintf(error, errorSize, "Out of memory");
+        return 0;
+    }
+
+    const char* reason = NULL;
+    int newBrands = 0;
+    int i;
+    for (i = 0; i < txn->count; i++)
+    {
+        const TxnOp* op = &txn->ops[i];
+        if (strlen(op->goods.id) == 0 || strlen(op->goods.id) >= 19)
+        {
+            reason = "invalid product ID";
+            break;
+        }
+        TxnState* state = overlayState(&overlay, manager, op->goods.id);
+        if (op->type == TXN_ADD ? state->exists : !state->exists)
+        {
+            reason = op->type == TXN_ADD ? "product ID already exists" : "product not found";
+            break;
+        }
+        switch (op->type)
+        {
+        case TXN_ADD:
+        case TXN_UPDATE:
+            if (!isValidGoods(op->goods))
+            {
+                reason = "invalid product information";
+                break;
+            }
+            //新品牌数按上限估计：同一个新品牌出现多次也分别计数
+            newBrands += findBrand(&manager->brands, op->goods.brand) < 0;
+            if (manager->brands.count + newBrands > MAX_BRANDS)
+            {
+                reason = "too many new brands";
+                break;
+            }
+            state->exists = 1;
+            state->stock = op->goods.stock;
+            break;
+        case TXN_DELETE:
+            state->exists = 0;
+            break;
+        case TXN_ADJUST:
+            state->stock += op->value;
+            if (state->stock < 0 || state->stock > INT_MAX)
+            {
+                reason = state->stock < 0 ? "stock would go below 0" : "stock too large";
+            }
+            break;
+        default:
+            if (op->value < 0)
+            {
+                reason = "reorder point must be >= 0";
+            }
+            break;
+        }
+        if (reason != NULL)
+        {
+            break;
+        }
+    }
+    if (reason != NULL)
+    {
+        snprintf(error, errorSize, "Change %d (%s %s): %s", i + 1, txnOpName(txn->ops[i].type), txn->ops[i].goods.id, reason);
+    }
+    free(overlay.states);
+    free(overlay.table);
+    return reason == NULL;
+}
+
+//应用一条修改
+//功能：更新、删除和设置补货点之前先记下修改前的内容
+//返回：成功返回1，内存不足返回0
+static int applyTxnOp(GoodsManager* manager, const TxnOp* op, TxnUndo* undo)
+{
+    const char* id = op->goods.id;
+    switch (op->type)
+    {
+    case TXN_ADD:
+        return addGoods(manager, op->goods);
+    case TXN_UPDATE:
+        findGoodsById(manager, id, &undo->before);
+        return updateGoods(manager, id, op->goods);
+    case TXN_DELETE:
+    {
+        findGoodsById(manager, id, &undo->before);
+        undo->reorderPoint = getReorderPoint(manager, id);
+        int prev = STORE_COLD(&manager->store, indexFindGoods(&manager->store, id, NULL))->prev;
+        strcpy_s(undo->prevId, sizeof(undo->prevId), prev != GOODS_NIL ? STORE_COLD(&manager->store, prev)->id : "");
+        return deleteGoods(manager, id);
+    }
+    case TXN_ADJUST:
+        return adjustStock(manager, id, op->value);
+    default:
+        undo->reorderPoint = getReorderPoint(manager, id);
+        return setReorderPoint(manager, id, op->value);
+    }
+}
+
+//撤销一条已应用的修改
+//功能：按相反顺序撤销时，删除前的前一件商品此时一定在链表中(之后的修改都已撤销)，被删除的商品放回它之后
+//返回：成功返回1，失败返回0
+static int undoTxnOp(GoodsManager* manager, const TxnOp* op, const TxnUndo* undo)
+{
+    const char* id = op->goods.id;
+    switch (op->type)
+    {
+    case TXN_ADD:
+        return deleteGoods(manager, id);
+    case TXN_UPDATE:
+        return updateGoods(manager, id, undo->before);
+    case TXN_DELETE:
+        return insertGoodsAfter(manager, undo->before, undo->prevId[0] != '\0' ? undo->prevId : NULL)
+            && (undo->reorderPoint == 0 || setReorderPoint(manager, id, undo->reorderPoint));
+    case TXN_ADJUST:
+        return adjustStock(manager, id, -op->value);
+    default:
+        return setReorderPoint(manager, id, undo->reorderPoint);
+    }
+}
+
+//提交事务
+//功能：先检查全部修改，不通过时不做任何修改；通过后为所有写入预留写时复制页，再依次应用，
+//      中途失败时按相反顺序撤销已应用的修改。应用期间的变更记录和库存变动先记在暂存的集合和内存日志中，
+//      成功后才并入管理器的变更集合和变动日志，撤销时直接丢弃，已撤销的修改不会留下记录。无论成功与否事务都结束
+//参数：error - 失败时写入原因
+//返回：成功返回应用的修改数，失败返回-1
+int commitTxn(GoodsManager* manager, GoodsTxn* txn, char* error, size_t errorSize)
+{
+    if (!txn->active)
+    {
+        snprintf(error, errorSize, "No transaction in progress");
+        return -1;
+    }
+    STATS_BEGIN(STAT_COMMIT);
+    int count = txn->count;
+    TxnUndo* undo = (TxnUndo*)malloc((size_t)(count > 0 ? count : 1) * sizeof(TxnUndo));
+    MoveLog* stagedMoves = manager->moves != NULL ? openMoveLog(NULL) : NULL;
+    //写时复制的页数不会超过现有页数，撤销时写入同样的页，不再需要新页
+    int pages = count * GOODS_WRITE_PAGES < manager->store.pageCount ? count * GOODS_WRITE_PAGES : manager->store.pageCount;
+    if (undo == NULL || (manager->moves != NULL && stagedMoves == NULL) || !reserveGoodsPages(&manager->store, pages))
+    {
+        free(undo);
+        closeMoveLog(stagedMoves);
+        abortTxn(txn);
+        snprintf(error, errorSize, "Out of memory");
+        STATS_END();
+        return -1;
+    }
+    if (!checkTxn(manager, txn, error, errorSize))
+    {
+        free(undo);
+        closeMoveLog(stagedMoves);
+        abortTxn(txn);
+        STATS_END();
+        return -1;
+    }
+
+    //暂存变更记录和库存变动
+    MoveLog* moves = manager->moves;
+    ChangeSet changes = manager->changes;
+    manager->moves = stagedMoves;
+    initChangeSet(&manager->changes);
+
+    int applied = 0;
+    while (applied < count && applyTxnOp(manager, &txn->ops[applied], &undo[applied]))
+    {
+        applied++;
+    }
+    STATS_VISIT_N(applied);
+    if (applied < count)
+    {
+        int failedAt = applied;
+        int restored = 1;
+        while (applied > 0)
+        {
+            applied--;
+            restored &= undoTxnOp(manager, &txn->ops[applied], &undo[applied]);
+        }
+        snprintf(error, errorSize, "Out of memory at change %d; %s", failedAt + 1,
+                 restored ? "earlier changes were rolled back" : "rollback incomplete");
+        count = -1;
+    }
+
+    //成功时并入管理器，失败时丢弃
+    ChangeSet staged = manager->changes;
+    manager->changes = changes;
+    manager->moves = moves;
+    if (count >= 0)
+    {
+        mergeChangeSet(&manager->changes, &staged);
+        appendMoveLog(moves, stagedMoves);
+    }
+    freeChangeSet(&staged);
+    closeMoveLog(stagedMoves);
+    free(undo);
+    abortTxn(txn);
+    STATS_END();
+    return count;
+}
+
+//显示暂存的修改
+void displayTxn(const GoodsTxn* txn)
+{
+    if (txn->count == 0)
+    {
+        printf("No staged changes.\n");
+        return;
+    }
+    for (int i = 0; i < txn->count; i++)
+    {
+        const TxnOp* op = &txn->ops[i];
+        char price[MONEY_TEXT_SIZE];
+        printf("%4d. %-8s %-18s ", i + 1, txnOpName(op->type), op->goods.id);
+        switch (op->type)
+        {
+        case TXN_ADD:
+        case TXN_UPDATE:
+            printf("%s %s %s %s stock %d\n", op->goods.name, categoryToString(op->goods.category), op->goods.brand,
+                   formatMoney(op->goods.price, price, sizeof(price)), op->goods.stock);
+            break;
+        case TXN_ADJUST:
+            printf("%+d\n", op->value);
+            break;
+        case TXN_REORDER:
+            printf("reorder point %d\n", op->value);
+            break;
+        default:
+            printf("\n");
+            break;
+        }
+    }
+    printf("%d staged changes.\n", txn->count);
+}
+
+//暂存到货单
+//功能：每行为"编号 数量"，数量为库存增量(退货为负)；空行和以#开头的行跳过。
+//      任何一行无效时打印警告，并撤回本文件已暂存的修改
+//返回：暂存的条数，文件打开失败或有无效行返回-1
+int stageDeliveryFile(GoodsTxn* txn, const char* filename)
+{
+    FILE* file = NULL;
+    errno_t err = fopen_s(&file, filename, "r");
+    if (err != 0 || file == NULL)
+    {
+        return -1;
+    }
+
+    int first = txn->count;
+    int lineNumber = 0;
+    int valid = 1;
+    char line[GOODS_LINE_MAX];
+    while (valid && fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        char id[20], extra[2];
+        int delta;
+        int fields = sscanf_s(line, "%19s %d %1s", id, (unsigned)sizeof(id), &delta, extra, (unsigned)sizeof(extra));
+        if (fields <= 0 || id[0] == '#')
+        {
+            continue;  //空行或注释
+        }
+        if (fields != 2 || strlen(id) >= 19)
+        {
+            printf("Warning: Line %d - Expected 'ID quantity', nothing staged from %s\n", lineNumber, filename);
+            valid = 0;
+        }
+        else if (!txnAdjustStock(txn, id, delta))
+        {
+            printf("Out of memory at line %d, nothing staged from %s\n", lineNumber, filename);
+            valid = 0;
+        }
+    }
+    fclose(file);
+    if (!valid)
+    {
+        txn->count = first;
+        return -1;
+    }
+    return txn->count - first;
+}
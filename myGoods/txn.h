@@ -0,0 +1,55 @@
+#ifndef TXN_H
+#define TXN_H
+
+#include "goods.h"
+
+// 事务
+// 一组修改先暂存在事务中，不改动管理器；提交时在调用者持有的写锁内一次应用：
+// 先按暂存顺序逐条检查(编号是否存在、库存是否越界、品牌字典是否放得下等)，同一事务中前面的修改对后面的检查可见，
+// 任何一条不通过都不做任何修改；全部通过后依次应用，并为每条修改保留修改前的内容，
+// 应用中途因内存不足失败时按相反顺序撤销已应用的修改，删除的商品放回原来的链表位置；
+// 变更集合和库存变动日志只在提交成功后才记录，撤销的修改不留下记录。
+// 提交在一次加锁内完成，后台保存的快照要么不含、要么包含整个事务，提交后只需一次保存即可写入文件。
+#define TXN_ERROR_SIZE 128        // 错误信息缓冲区大小
+#define TXN_INITIAL_CAPACITY 16   // 暂存数组的初始容量
+
+// 暂存的修改类型
+typedef enum
+{
+    TXN_ADD,     // 添加商品
+    TXN_UPDATE,  // 更新商品信息
+    TXN_DELETE,  // 删除商品
+    TXN_ADJUST,  // 调整库存
+    TXN_REORDER  // 设置补货点
+} TxnOpType;
+
+// 暂存的修改
+typedef struct
+{
+    TxnOpType type; // 修改类型
+    Goods goods;    // 商品信息(添加和更新为新的内容，其余只使用编号)
+    int value;      // 库存增量(调整库存)或补货点(设置补货点)
+} TxnOp;
+
+// 事务结构体(使用前清零)
+typedef struct
+{
+    TxnOp *ops;    // 暂存的修改，按暂存顺序
+    int count;     // 暂存的修改数
+    int capacity;  // 数组容量
+    int active;    // 事务是否已开始且尚未提交或放弃
+} GoodsTxn;
+
+// 事务函数声明(暂存不需要加锁，提交时调用者持有写锁)
+void beginTxn(GoodsTxn *txn);                                   // 开始事务(放弃之前暂存的修改)
+int txnAdd(GoodsTxn *txn, Goods goods);                          // 暂存添加商品，内存不足返回0
+int txnUpdate(GoodsTxn *txn, const char *id, Goods newData);     // 暂存更新商品信息，内存不足返回0
+int txnDelete(GoodsTxn *txn, const char *id);                    // 暂存删除商品，内存不足返回0
+int txnAdjustStock(GoodsTxn *txn, const char *id, int delta);    // 暂存调整库存，内存不足返回0
+int txnSetReorderPoint(GoodsTxn *txn, const char *id, int reorderPoint); // 暂存设置补货点，内存不足返回0
+int commitTxn(GoodsManager *manager, GoodsTxn *txn, char *error, size_t errorSize); // 检查并应用全部修改，返回应用的修改数，失败返回-1且不做任何修改
+void abortTxn(GoodsTxn *txn);                                    // 放弃暂存的修改并结束事务
+void displayTxn(const GoodsTxn *txn);                            // 显示暂存的修改
+int stageDeliveryFile(GoodsTxn *txn, const char *filename);      // 将"编号 数量"形式的到货单暂存为库存调整，返回暂存条数，文件无效返回-1
+
+#endif